@@ -0,0 +1,166 @@
+// Compares virtual (PixelPainter based) and statically dispatched (sink template based) painters.
+// Usage: painter_benchmark [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_sink.h"
+
+namespace {
+
+const unsigned int IMAGE_WIDTH = 1024;
+const unsigned int IMAGE_HEIGHT = 768;
+const unsigned int SHAPE_COUNT = 2000;
+
+struct Shape {
+    Point p1;
+    Point p2;
+    Point p3;
+    Point p4;
+    unsigned int radius;
+    RgbColor color;
+};
+
+// shapes are generated with fixed seed, so both paths draw the same scene
+std::vector<Shape> makeShapes() {
+    std::vector<Shape> result;
+    unsigned int seed = 12345;
+    auto next = [&seed](unsigned int range) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) % range;
+    };
+
+    for (unsigned int i = 0; i < SHAPE_COUNT; ++i) {
+        Shape shape;
+        shape.p1 = Point(static_cast<int>(next(IMAGE_WIDTH)), static_cast<int>(next(IMAGE_HEIGHT)));
+        shape.p2 = Point(static_cast<int>(next(IMAGE_WIDTH)), static_cast<int>(next(IMAGE_HEIGHT)));
+        // triangle points are kept close to the first one, so triangles are of moderate size
+        shape.p3 = Point(std::max(0, shape.p1.x + static_cast<int>(next(121)) - 60),
+                         std::max(0, shape.p1.y + static_cast<int>(next(121)) - 60));
+        shape.p4 = Point(std::max(0, shape.p1.x + static_cast<int>(next(121)) - 60),
+                         std::max(0, shape.p1.y + static_cast<int>(next(121)) - 60));
+        shape.radius = 5 + next(60);
+        shape.color = {static_cast<unsigned char>(next(256)), static_cast<unsigned char>(next(256)),
+                       static_cast<unsigned char>(next(256))};
+        result.push_back(shape);
+    }
+    return result;
+}
+
+unsigned int clampCoord(int value, unsigned int radius) {
+    return static_cast<unsigned int>(std::max(value, static_cast<int>(radius)));
+}
+
+template<typename LinePainterType>
+void drawLines(LinePainterType &painter, const std::vector<Shape> &shapes) {
+    for (const auto &shape : shapes)
+        painter.drawLine(static_cast<unsigned int>(shape.p1.x), static_cast<unsigned int>(shape.p1.y),
+                         static_cast<unsigned int>(shape.p2.x), static_cast<unsigned int>(shape.p2.y), shape.color);
+}
+
+template<typename CirclePainterType>
+void drawCircles(CirclePainterType &painter, const std::vector<Shape> &shapes) {
+    for (const auto &shape : shapes) {
+        unsigned int x = clampCoord(shape.p1.x, shape.radius);
+        unsigned int y = clampCoord(shape.p1.y, shape.radius);
+        painter.drawFull(x, y, shape.radius, shape.color);
+        painter.drawEmpty(x, y, shape.radius, shape.color);
+    }
+}
+
+template<typename TrianglePainterType>
+void drawTriangles(TrianglePainterType &painter, const std::vector<Shape> &shapes) {
+    for (const auto &shape : shapes) {
+        // painter requires counter-clockwise order, so both orders are drawn
+        painter.drawFull(shape.p1, shape.p3, shape.p4, shape.color);
+        painter.drawFull(shape.p1, shape.p4, shape.p3, shape.color);
+    }
+}
+
+// simple checksum used to verify both paths produce the same image
+unsigned long long checksum(RgbImage &image) {
+    const unsigned char *data = static_cast<const unsigned char *>(image.data());
+    unsigned long long sum = 0;
+    for (size_t i = 0, epos = image.dataSize(); i < epos; ++i)
+        sum = sum * 31 + data[i];
+    return sum;
+}
+
+template<typename DrawFunc>
+double measure(RgbImage &image, unsigned int iterations, DrawFunc draw, unsigned long long &imageChecksum) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; ++i)
+        draw();
+    auto end = std::chrono::steady_clock::now();
+    imageChecksum = checksum(image);
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+void report(const std::string &name, double virtualMs, double staticMs, bool sameOutput) {
+    std::cout << std::left << std::setw(12) << name
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << virtualMs
+              << std::setw(12) << staticMs
+              << std::setw(10) << std::setprecision(2) << (staticMs > 0.0 ? virtualMs / staticMs : 0.0)
+              << (sameOutput ? "" : "  OUTPUT MISMATCH") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    unsigned int iterations = 20;
+    if (argc > 1)
+        iterations = static_cast<unsigned int>(std::max(1, atoi(argv[1])));
+
+    std::vector<Shape> shapes = makeShapes();
+
+    RgbImage virtualImage(IMAGE_WIDTH, IMAGE_HEIGHT);
+    RgbImage staticImage(IMAGE_WIDTH, IMAGE_HEIGHT);
+    PixelPainterForRgbImage pixelPainter(virtualImage);
+    RgbImagePixelSink sink(staticImage);
+    Point canvasSize = staticImage.getSize();
+
+    std::cout << "shapes: " << SHAPE_COUNT << ", iterations: " << iterations
+              << ", image: " << IMAGE_WIDTH << "x" << IMAGE_HEIGHT << std::endl;
+    std::cout << std::left << std::setw(12) << "primitive"
+              << std::right << std::setw(12) << "virtual ms" << std::setw(12) << "static ms"
+              << std::setw(10) << "speedup" << std::endl;
+
+    unsigned long long virtualSum, staticSum;
+    double virtualMs, staticMs;
+
+    {
+        LinePainterForPixels virtualPainter(pixelPainter);
+        LinePainterForSink<RgbImagePixelSink> staticPainter(sink, canvasSize);
+        virtualMs = measure(virtualImage, iterations, [&]() { drawLines(virtualPainter, shapes); }, virtualSum);
+        staticMs = measure(staticImage, iterations, [&]() { drawLines(staticPainter, shapes); }, staticSum);
+        report("lines", virtualMs, staticMs, virtualSum == staticSum);
+    }
+
+    {
+        CirclePainterForPixels virtualPainter(pixelPainter);
+        CirclePainterForSink<RgbImagePixelSink> staticPainter(sink);
+        virtualMs = measure(virtualImage, iterations, [&]() { drawCircles(virtualPainter, shapes); }, virtualSum);
+        staticMs = measure(staticImage, iterations, [&]() { drawCircles(staticPainter, shapes); }, staticSum);
+        report("circles", virtualMs, staticMs, virtualSum == staticSum);
+    }
+
+    {
+        TrianglePainterForPixels virtualPainter(pixelPainter);
+        TrianglePainterForSink<RgbImagePixelSink> staticPainter(sink);
+        virtualMs = measure(virtualImage, iterations, [&]() { drawTriangles(virtualPainter, shapes); }, virtualSum);
+        staticMs = measure(staticImage, iterations, [&]() { drawTriangles(staticPainter, shapes); }, staticSum);
+        report("triangles", virtualMs, staticMs, virtualSum == staticSum);
+    }
+
+    return 0;
+}
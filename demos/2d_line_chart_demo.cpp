@@ -55,7 +55,7 @@ int main(int argc, char *argv[]) {
         std::cout << "Usage: 2d_line_chart_demo -font <path/to/font.bdf> [options]" << std::endl;
         std::cout << "Options:" << std::endl;
         std::cout << "  -font <path>       : Path to the BDF font file (required)" << std::endl;
-        std::cout << "  -out <file.ppm>    : Output file path (default: 2d_line_chart_demo_output.ppm)" << std::endl; 
+        std::cout << "  -out <file.ppm>    : Output file path, .png for PNG (default: 2d_line_chart_demo_output.ppm)" << std::endl; 
         std::cout << "  -thickness <value> : Line thickness (default: 2.0)" << std::endl;
         std::cout << "  -charts <num>      : Number of charts to display (1-4, default: 2)" << std::endl;
         std::cout << "  -dark              : Use dark theme for charts" << std::endl;
@@ -8,23 +8,31 @@
 #include "chart_z_fxy_3d.h"
 #include "chart3d_z_fxy.h"
 #include "dlog/dlog.h"
+#include "uimg/filters/filter_for_pixels.h"
 #include "uimg/filters/pixel_tracing_filter.h"
+#include "uimg/images/image_view.h"
+#include "uimg/painters/painter_for_rgb_image.h"
 #include "uimg/utils/cast.h"
+#include "uimg/utils/thread_pool.h"
 #include <memory>
 #include <vector>
 
 /**
  * @brief Multi-chart renderer for 3D charts
+ *
+ * When created for an image, every chart is painted into its own ImageView (window of image memory),
+ * so charts placed in disjoint windows are rendered in parallel.
+ * When created for a pixel painter, charts are painted sequentially through OffsetFilter.
  */
 class Chart3DRenderer {
 public:
-    Chart3DRenderer(RgbImage& image, PixelPainter& painter, bool useAntiAliasing = false, bool drawBorders = false) 
-        : image_(&image), painter_(painter), useAntiAliasing_(useAntiAliasing), drawBorders_(drawBorders),
+    Chart3DRenderer(RgbImageBase& image, bool useAntiAliasing = false, bool drawBorders = false) 
+        : image_(&image), painter_(nullptr), useAntiAliasing_(useAntiAliasing), drawBorders_(drawBorders),
           layoutManager_(image.getSize().x, image.getSize().y) {}
     
     // Simple constructor for single chart rendering
     Chart3DRenderer(PixelPainter& painter) 
-        : image_(nullptr), painter_(painter), useAntiAliasing_(false), drawBorders_(false),
+        : image_(nullptr), painter_(&painter), useAntiAliasing_(false), drawBorders_(false),
           layoutManager_(800, 600) {}
     
     /**
@@ -32,17 +40,41 @@ public:
      * @param chart The chart to render
      */
     void render(const Chart3D_Z_FXY& chart) {
-        // Create offset painter for chart position
-        Point offset = chart.getOffset();
-        OffsetPixelPainter offsetPainter(painter_, offset);
+        if (image_) {
+            // Chart window as a view of image memory
+            ImageView view(*image_, chart.getOffset(), chart.getSize());
+            PixelPainterForRgbImage viewPainter(view);
+            paintChart(chart, viewPainter);
+        } else {
+            OffsetFilter offsetPainter(*painter_, chart.getOffset());
+            paintChart(chart, offsetPainter);
+        }
+    }
+    
+    /**
+     * @brief Render a set of Chart3D_Z_FXY charts
+     * @param charts Charts to render, in parallel if rendering into image and chart windows do not overlap
+     */
+    void render(const std::vector<Chart3D_Z_FXY>& charts) {
+        std::vector<ChartRect> rects;
+        for (const auto& chart : charts) {
+            Point offset = chart.getOffset();
+            Point size = chart.getSize();
+            rects.push_back(ChartRect::make_rect(offset.x, offset.y, offset.x + size.x, offset.y + size.y));
+        }
         
-        // Create the internal chart implementation
-        auto internalChart = chart.createInternalChart(offsetPainter, useAntiAliasing_);
+        if (!canRenderInParallel(rects)) {
+            for (const auto& chart : charts) {
+                render(chart);
+            }
+            return;
+        }
         
-        // Paint the chart
-        if (internalChart) {
-            internalChart->paint();
+        ThreadPool pool(static_cast<unsigned int>(charts.size()));
+        for (const auto& chart : charts) {
+            pool.submit([this, &chart]() { render(chart); });
         }
+        pool.wait();
     }
     
     /**
@@ -61,28 +93,67 @@ public:
         // Calculate layout
         auto rects = layoutManager_.calculateLayout(numCharts);
         
-        // Create and render charts based on the number requested
         for (int i = 0; i < numCharts; ++i) {
             Point chartSize = rects[static_cast<size_t>(i)].getSize();
             Point chartOffset = rects[static_cast<size_t>(i)].getTopLeft();
 
             logger->debug("Chart {0} layout: size={1}x{2}, offset=({3},{4})", 
                          i, chartSize.x, chartSize.y, chartOffset.x, chartOffset.y);
-            
-            // Create chart with adjusted size and offset
-            renderSingleChart(i % 4, chartSize, chartOffset);
         }
+        
+        // Create and render charts based on the number requested, each chart in its own window
+        if (!canRenderInParallel(rects)) {
+            for (int i = 0; i < numCharts; ++i) {
+                renderSingleChart(i % 4, rects[static_cast<size_t>(i)].getSize(), rects[static_cast<size_t>(i)].getTopLeft());
+            }
+            return;
+        }
+        
+        ThreadPool pool(static_cast<unsigned int>(numCharts));
+        for (int i = 0; i < numCharts; ++i) {
+            ChartRect rect = rects[static_cast<size_t>(i)];
+            pool.submit([this, i, rect]() { renderSingleChart(i % 4, rect.getSize(), rect.getTopLeft()); });
+        }
+        pool.wait();
     }
 
 private:
+    // Charts can be painted concurrently only into views of image with non-overlapping windows
+    bool canRenderInParallel(const std::vector<ChartRect>& rects) const {
+        if (!image_ || rects.size() < 2) {
+            return false;
+        }
+        
+        for (size_t i = 0; i < rects.size(); ++i) {
+            for (size_t j = i + 1; j < rects.size(); ++j) {
+                if (rects[i].x1 < rects[j].x2 && rects[j].x1 < rects[i].x2 &&
+                    rects[i].y1 < rects[j].y2 && rects[j].y1 < rects[i].y2) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    
+    void paintChart(const Chart3D_Z_FXY& chart, PixelPainter& painter) {
+        // Create the internal chart implementation
+        auto internalChart = chart.createInternalChart(painter, useAntiAliasing_);
+        
+        // Paint the chart
+        if (internalChart) {
+            internalChart->paint();
+        }
+    }
+    
     void renderSingleChart(int chartType, Point chartSize, Point offset) {
         auto logger = dlog::Logger::getInstance();
         logger->debug("--- Rendering single chart {0} ---", chartType);
         logger->debug("Chart type: {0}, Canvas size: {1}x{2}, Offset: ({3},{4})", 
                      chartType, chartSize.x, chartSize.y, offset.x, offset.y);
         
-        // Create an offset painter
-        OffsetPixelPainter offsetPainter(painter_, offset);
+        // Chart window as a view of image memory
+        ImageView view(*image_, offset, chartSize);
+        PixelPainterForRgbImage viewPainter(view);
         
         // Create chart type name for tracing
         std::string chartTypeName;
@@ -95,7 +166,7 @@ private:
         }
         
         // Create pixel tracing filter for this chart
-        PixelTracingFilter tracingFilter(offsetPainter, chartTypeName);
+        PixelTracingFilter tracingFilter(viewPainter, chartTypeName);
         
         // Create the appropriate chart type using the tracing filter
         std::unique_ptr<chart_z_fxy_3d_with_title> chart;
@@ -128,29 +199,8 @@ private:
         }
     }
     
-    /**
-     * @brief Pixel painter that applies an offset to all drawing operations
-     */
-    class OffsetPixelPainter : public PixelPainter {
-    public:
-        OffsetPixelPainter(PixelPainter& basePainter, Point offset) 
-            : basePainter_(basePainter), offset_(offset) {}
-        
-        virtual void putPixel(unsigned int x, unsigned int y, const RgbColor& color) override {
-            basePainter_.putPixel(x + UNSIGNED_CAST(unsigned int, offset_.x), y + UNSIGNED_CAST(unsigned int, offset_.y), color);
-        }
-        
-        virtual void getPixel(unsigned int x, unsigned int y, RgbColor& output) override {
-            basePainter_.getPixel(x + UNSIGNED_CAST(unsigned int, offset_.x), y + UNSIGNED_CAST(unsigned int, offset_.y), output);
-        }
-        
-    private:
-        PixelPainter& basePainter_;
-        Point offset_;
-    };
-    
-    RgbImage* image_;  // Changed to pointer to allow null for simple constructor
-    PixelPainter& painter_;
+    RgbImageBase* image_;  // null when rendering through painter
+    PixelPainter* painter_;  // null when rendering into image
     bool useAntiAliasing_;
     bool drawBorders_;
     Chart3DLayoutManager layoutManager_;
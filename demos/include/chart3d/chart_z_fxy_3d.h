@@ -293,8 +293,8 @@ public:
         double sampleToInputRatioX = (inputRangeX.second - inputRangeX.first) / (2 * midSampleSpaceX);
         double sampleToInputRatioY = (inputRangeY.second - inputRangeY.first) / (2 * midSampleSpaceY);
 
-        static const double sampleToInputShiftX = inputRangeX.first;
-        static const double sampleToInputShiftY = inputRangeY.first;
+        const double sampleToInputShiftX = inputRangeX.first;
+        const double sampleToInputShiftY = inputRangeY.first;
 
         double degreesToRadiansFactor = math_utils::pi_const_d() / 180;
         double sampleScaleForX = sampleScale * cos(skewAngle * degreesToRadiansFactor);
@@ -302,6 +302,7 @@ public:
 
         // Debug logging
         auto logger = dlog::Logger::getInstance();
+        int noRenderDebugCount = 0;
         
         logger->debug("=== Using getAllowedDrawingArea() for Chart Sizing ===");
         logger->debug("Canvas size: {0}x{1}", canvasSize_.x, canvasSize_.y);
@@ -582,10 +583,9 @@ public:
                         }
                     } else if (currentLineInfo != nullptr) {
                         // Debug: Track why certain lines don't get data rendered
-                        static int debugCount = 0;
-                        if (debugCount < 3) { // Limit debug output to avoid spam
+                        if (noRenderDebugCount < 3) { // Limit debug output to avoid spam
                             logger->debug("Line q=%d: f1*f2=%d (f1=%d, f2=%d) - no rendering", q, f1*f2, f1, f2);
-                            debugCount++;
+                            noRenderDebugCount++;
                         }
                     }
 
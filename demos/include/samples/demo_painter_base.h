@@ -11,6 +11,8 @@
 #include "uimg/images/rgb_image.h"
 #include "uimg/painters/painter_for_rgb_image.h"
 #include "uimg/images/ppm_image.h"
+#include "uimg/images/png_image.h"
+#include "uimg/images/async_image_writer.h"
 #include "uimg/utils/cast.h"
 #include "dlog/dlog.h"
 
@@ -151,14 +153,7 @@ protected:
     }
 
     virtual void write() {
-        using namespace std;
-        std::ofstream output(get_output_fname(), ios::out | ios::binary);
-
-        PpmWriterForRgbImage writer(output);
-
-        writer.writeImage(*img_);
-        
-        output.close();
+        AsyncImageWriter::writeImageFile(*img_, get_output_fname());
     }
 
     RgbImage &getImage() {
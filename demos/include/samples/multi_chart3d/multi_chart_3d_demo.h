@@ -113,9 +113,9 @@ protected:
         // Initialize text rendering for chart titles (after image is set up)
         initializeTextRenderer();
         
-        // Render each chart
-        Chart3DRenderer renderer(*pixelPainter);
-        
+        // Charts are collected first and rendered together - without anti-aliasing each chart
+        // is painted directly into its own view of the image, in parallel
+        std::vector<Chart3D_Z_FXY> charts;
         bool boundaryViolation = false;
         
         for (int i = 0; i < std::min(numCharts_, static_cast<int>(functions.size())); i++) {
@@ -185,8 +185,15 @@ protected:
             // Log chart layout for debugging
             logChartLayout(i, layout);
             
-            // Render this chart
-            renderer.render(chart);
+            charts.push_back(chart);
+        }
+        
+        if (useAntiAliasing_) {
+            Chart3DRenderer renderer(*pixelPainter);
+            renderer.render(charts);
+        } else {
+            Chart3DRenderer renderer(getImage());
+            renderer.render(charts);
         }
         
         // Exit with error status if boundary violations detected
@@ -53,7 +53,9 @@
 #ifndef __DLOG_H__
 #define __DLOG_H__
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <sstream>
 #include <functional>
@@ -247,7 +249,8 @@ public:
  */
 class Logger {
 private:
-    LogLevel level_ = LogLevel::INFO;                                       ///< Current minimum log level
+    std::atomic<LogLevel> level_{LogLevel::INFO};                           ///< Current minimum log level
+    mutable std::mutex mutex_;                                              ///< Guards outputs, buffer and configuration below
     bool consoleEnabled_ = true;                                            ///< Whether to output to console
     bool bufferEnabled_ = true;                                             ///< Whether to store in internal buffer
     bool timestampEnabled_ = false;                                         ///< Whether to add timestamps to console output
@@ -309,13 +312,19 @@ public:
      * @brief Enable or disable console output
      * @param enabled true to enable console output, false to disable
      */
-    void setConsoleEnabled(bool enabled) { consoleEnabled_ = enabled; }
+    void setConsoleEnabled(bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        consoleEnabled_ = enabled;
+    }
     
     /**
      * @brief Enable or disable internal buffer storage
      * @param enabled true to enable buffer storage, false to disable
      */
-    void setBufferEnabled(bool enabled) { bufferEnabled_ = enabled; }
+    void setBufferEnabled(bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bufferEnabled_ = enabled;
+    }
     
     /**
      * @brief Enable or disable timestamps in console output
@@ -323,7 +332,10 @@ public:
      * 
      * @note Timestamps are only added to console output, not buffer storage
      */
-    void setTimestampEnabled(bool enabled) { timestampEnabled_ = enabled; }
+    void setTimestampEnabled(bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timestampEnabled_ = enabled;
+    }
     
     /**
      * @brief Set the maximum number of entries in the internal buffer
@@ -331,7 +343,10 @@ public:
      * 
      * When the limit is reached, older entries are automatically removed.
      */
-    void setBufferLimit(size_t limit) { buffer_ = LogBuffer(limit); }
+    void setBufferLimit(size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_ = LogBuffer(limit);
+    }
 
     /**
      * @brief Set a custom callback for log processing
@@ -341,6 +356,7 @@ public:
      * log entry that passes the level filter.
      */
     void setLogCallback(std::function<void(LogLevel, const std::string&)> callback) {
+        std::lock_guard<std::mutex> lock(mutex_);
         callback_ = callback;
     }
 
@@ -350,6 +366,7 @@ public:
      * Removes any previously set custom callback function.
      */
     void clearLogCallback() {
+        std::lock_guard<std::mutex> lock(mutex_);
         callback_ = nullptr;
     }
 
@@ -398,10 +415,14 @@ public:
      * 
      * This is the core logging method that handles output routing to
      * console, buffer, and custom callbacks based on current configuration.
+     * Messages logged from several threads are written whole and in the same
+     * order to all outputs; the callback is called with the logger locked and
+     * must not log itself.
      */
     void log(LogLevel level, const std::string& message) {
         if (level < level_ || level_ == LogLevel::OFF) return;
 
+        std::lock_guard<std::mutex> lock(mutex_);
         std::string finalMessage = message;
         if (timestampEnabled_) {
             finalMessage = "[" + formatTimestamp() + "] " + message;
@@ -712,6 +733,8 @@ public:
     /**
      * @brief Get direct access to the internal buffer
      * @return Const reference to the LogBuffer
+     *
+     * @note The reference is not guarded, use getBufferEntries() while other threads may log
      */
     const LogBuffer& buffer() const { return buffer_; }
     
@@ -729,13 +752,17 @@ public:
      * @endcode
      */
     const std::vector<LogEntry> getBufferEntries(LogLevel minLevel = LogLevel::TRACE) const {
+        std::lock_guard<std::mutex> lock(mutex_);
         return buffer_.getEntries(minLevel);
     }
 
     /**
      * @brief Clear all entries from the internal buffer
      */
-    void clearBuffer() { buffer_.clear(); }
+    void clearBuffer() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_.clear();
+    }
 
     /**
      * @brief Get count of buffer entries at or above specified level
@@ -743,6 +770,7 @@ public:
      * @return Number of entries matching the criteria
      */
     size_t getBufferCount(LogLevel level = LogLevel::TRACE) const {
+        std::lock_guard<std::mutex> lock(mutex_);
         return buffer_.getCount(level);
     }
     
@@ -0,0 +1,14 @@
+#ifndef __UIMG_PLATFORM_H__
+#define __UIMG_PLATFORM_H__
+
+// UIMG_HAS_POSIX - non-zero if POSIX API (file descriptors, writev, mmap) is available.
+// Can be defined before including uimg headers to force (or disable) POSIX specific code.
+#ifndef UIMG_HAS_POSIX
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#define UIMG_HAS_POSIX 1
+#else
+#define UIMG_HAS_POSIX 0
+#endif
+#endif
+
+#endif
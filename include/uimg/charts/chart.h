@@ -32,7 +32,7 @@ struct DataPoint {
 class Series {
 public:
     Series(const std::string& name, const RgbColor& color, float lineThickness = 1.0f) 
-        : style_({color, lineThickness, name}) {}
+        : style_({color, lineThickness, name, {}}) {}
     
     Series(const SeriesStyle& style) : style_(style) {}
 
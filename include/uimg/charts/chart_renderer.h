@@ -2,63 +2,28 @@
 
 #include "uimg/charts/chart.h"
 #include "uimg/images/rgb_image.h"
+#include "uimg/images/image_view.h"
 #include "uimg/painters/painter_for_rgb_image.h"
 #include "uimg/painters/painter_for_pixels.h"
 #include "uimg/painters/antialiased_painter_for_pixels.h"
 #include "uimg/fonts/bdf_font.h"
 #include "uimg/fonts/painter_for_bdf_font.h"
 #include "uimg/images/ppm_image.h"
+#include "uimg/images/png_image.h"
+#include "uimg/images/async_image_writer.h"
 #include "uimg/utils/cast.h"
+#include "uimg/utils/thread_pool.h"
 
 #include <vector>
 #include <string>
 #include <memory>
 #include <fstream>
+#include <future>
 #include <stdexcept>
 
 namespace uimg {
 namespace charts {
 
-/**
- * Helper class for drawing thick lines
- */
-class ThickLinePainter {
-public:
-    ThickLinePainter(RgbImage& image, float thickness) 
-        : image_(image), 
-          pixelPainter_(image), 
-          thickLinePainter_(pixelPainter_, thickness) {}
-    
-    void drawLine(int x1, int y1, int x2, int y2, const RgbColor& color) {
-        thickLinePainter_.drawLine(UNSIGNED_CAST(unsigned int, x1), UNSIGNED_CAST(unsigned int, y1), UNSIGNED_CAST(unsigned int, x2), UNSIGNED_CAST(unsigned int, y2), color);
-    }
-    
-private:
-    RgbImage& image_;
-    PixelPainterForRgbImage pixelPainter_;
-    ThickLinePainterForPixels thickLinePainter_;
-};
-
-/**
- * Helper class for drawing anti-aliased thick lines
- */
-class AntiAliasedThickLinePainter {
-public:
-    AntiAliasedThickLinePainter(RgbImage& image, float thickness) 
-        : image_(image), 
-          pixelPainter_(image), 
-          antiAliasedThickLinePainter_(pixelPainter_, thickness) {}
-    
-    void drawLine(int x1, int y1, int x2, int y2, const RgbColor& color) {
-        antiAliasedThickLinePainter_.drawLine(UNSIGNED_CAST(unsigned int, x1), UNSIGNED_CAST(unsigned int, y1), UNSIGNED_CAST(unsigned int, x2), UNSIGNED_CAST(unsigned int, y2), color);
-    }
-    
-private:
-    RgbImage& image_;
-    PixelPainterForRgbImage pixelPainter_;
-    AntiAliasedThickLinePainterForPixels antiAliasedThickLinePainter_;
-};
-
 /**
  * @brief Layout configuration for chart placement
  */
@@ -90,6 +55,11 @@ struct ChartLayout {
 
 /**
  * @brief The ChartRenderer renders multiple charts onto a single canvas
+ *
+ * Plot of every chart (background, grid, axes and series) is painted into its own ImageView of the canvas, using
+ * chart-local coordinates; plots of charts with non-overlapping rectangles are rendered in parallel.
+ * Decorations (title, ticks, tick and axis labels, legend) can reach outside of the chart rectangle, so they are
+ * painted afterwards with painters for the whole image, one chart after another.
  */
 class ChartRenderer {
 public:
@@ -105,8 +75,8 @@ public:
           pixelPainter_(image_),
           linePainter_(image_),
           rectPainter_(image_),
-          font_(),
           textPainter_(pixelPainter_, Point(width, height)),
+          font_(),
           imageWidth_(width),
           imageHeight_(height),
           useAntiAliasing_(useAntiAliasing) {
@@ -136,26 +106,49 @@ public:
     }
     
     /**
-     * @brief Render all charts and save to a file
-     * @param outputPath Path to the output image file
+     * @brief Render all charts into the image
      */
-    void renderToFile(const std::string& outputPath) {
+    void render() {
         // Process auto-layouts
         processAutoLayouts();
         
         // Render each chart
-        for (size_t i = 0; i < charts_.size(); ++i) {
-            renderChart(charts_[i], layouts_[i].rect);
-        }
-        
-        // Save image to file
-        std::ofstream outFile(outputPath, std::ios::binary);
-        if (!outFile) {
-            throw std::runtime_error("Failed to open output file: " + outputPath);
+        if (canRenderInParallel()) {
+            ThreadPool pool(static_cast<unsigned int>(charts_.size()));
+            for (size_t i = 0; i < charts_.size(); ++i) {
+                pool.submit([this, i]() { renderPlot(charts_[i], layouts_[i].rect); });
+            }
+            pool.wait();
+            for (size_t i = 0; i < charts_.size(); ++i) {
+                drawDecorations(charts_[i], layouts_[i].rect);
+            }
+        } else {
+            // overlapping charts are painted whole, one over another
+            for (size_t i = 0; i < charts_.size(); ++i) {
+                renderPlot(charts_[i], layouts_[i].rect);
+                drawDecorations(charts_[i], layouts_[i].rect);
+            }
         }
-        
-        PpmWriterForRgbImage writer(outFile);
-        writer.writeImage(image_);
+    }
+    
+    /**
+     * @brief Render all charts and save to a file
+     * @param outputPath Path to the output image file, written as PNG if it ends with ".png", PPM otherwise
+     */
+    void renderToFile(const std::string& outputPath) {
+        render();
+        AsyncImageWriter::writeImageFile(image_, outputPath);
+    }
+    
+    /**
+     * @brief Render all charts and queue the image to be saved on the writer thread
+     * @param outputPath Path to the output image file, written as PNG if it ends with ".png", PPM otherwise
+     * @param writer Writer which saves a snapshot of the image, so the renderer can be reused right away
+     * @return Future which is ready when the file is written (and rethrows write errors from get())
+     */
+    std::future<void> renderToFileAsync(const std::string& outputPath, AsyncImageWriter& writer) {
+        render();
+        return writer.writeFile(image_, outputPath);
     }
     
     /**
@@ -174,6 +167,36 @@ public:
     }
 
 private:
+    /**
+     * @brief Painters bound to a view of one chart rectangle
+     */
+    struct PanelPainters {
+        PanelPainters(RgbImageBase& image, const Rect& chartRect)
+            : view(image, RectInclusive::make_rect(chartRect.x1, chartRect.y1, chartRect.x2, chartRect.y2)),
+              pixelPainter(view),
+              linePainter(view),
+              rectPainter(view) {}
+
+        ImageView view;
+        PixelPainterForRgbImage pixelPainter;
+        LinePainterForRgbImage linePainter;
+        RectPainterForRgbImage rectPainter;
+    };
+
+    // Charts can be painted concurrently only if their rectangles (inclusive) do not overlap
+    bool canRenderInParallel() const {
+        if (layouts_.size() < 2) return false;
+
+        for (size_t i = 0; i < layouts_.size(); ++i) {
+            for (size_t j = i + 1; j < layouts_.size(); ++j) {
+                const Rect& a = layouts_[i].rect;
+                const Rect& b = layouts_[j].rect;
+                if (a.x1 <= b.x2 && b.x1 <= a.x2 && a.y1 <= b.y2 && b.y1 <= a.y2) return false;
+            }
+        }
+        return true;
+    }
+
     // Process auto-layouts to position charts automatically
     void processAutoLayouts() {
         int autoCount = 0;
@@ -240,20 +263,24 @@ private:
         }
     }
     
-    // Convert world coordinates to screen coordinates
-    PointF worldToScreen(float x, float y, const Rect& plotArea, float xMin, float xMax, float yMin, float yMax) {
+    // Convert world coordinates to screen (chart view) coordinates.
+    // Position is calculated on canvas (origin = view position) and then moved into view, so that
+    // rounding does not depend on chart position.
+    PointF worldToScreen(float x, float y, const Rect& plotArea, const Point& origin, float xMin, float xMax, float yMin, float yMax) {
         if (xMax <= xMin || yMax <= yMin) {
             return {static_cast<float>(plotArea.x1), static_cast<float>(plotArea.y1)};
         }
 
-        float screenX = static_cast<float>(plotArea.x1) + (x - xMin) / (xMax - xMin) * static_cast<float>(plotArea.width());
-        float screenY = static_cast<float>(plotArea.y2) - (y - yMin) / (yMax - yMin) * static_cast<float>(plotArea.height());
+        float screenX = static_cast<float>(plotArea.x1 + origin.x) + (x - xMin) / (xMax - xMin) * static_cast<float>(plotArea.width());
+        float screenY = static_cast<float>(plotArea.y2 + origin.y) - (y - yMin) / (yMax - yMin) * static_cast<float>(plotArea.height());
+        screenX -= static_cast<float>(origin.x);
+        screenY -= static_cast<float>(origin.y);
 
         return {screenX, screenY};
     }
     
     // Draw the chart legend
-    void drawLegend(const Chart& chart, [[maybe_unused]] const Rect& chartRect, const Rect& legendArea) {
+    void drawLegend(const Chart& chart, const Rect& legendArea) {
         const ChartStyle& style = chart.getStyle();
         const std::vector<Series>& seriesSet = chart.getSeries();
         
@@ -282,8 +309,36 @@ private:
         }
     }
     
-    // Draw chart axes
-    void drawAxes(const Chart& chart, const Rect& plotArea) {
+    // Draw axes lines and grid inside of plot area (in coordinates of chart view)
+    void drawAxes(PanelPainters& painters, const Chart& chart, const Rect& plotArea) {
+        Point origin = painters.view.offset();
+        const ChartStyle& style = chart.getStyle();
+        
+        // Draw axes lines
+        painters.linePainter.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, plotArea.y2), UNSIGNED_CAST(unsigned int, plotArea.x2), UNSIGNED_CAST(unsigned int, plotArea.y2), style.axisColor); // X-axis
+        painters.linePainter.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, plotArea.y1), UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, plotArea.y2), style.axisColor); // Y-axis
+
+        if (!style.showGrid) {
+            return;
+        }
+
+        // Draw X-axis grid, positions are calculated on canvas as for the ticks
+        for (int i = 0; i <= style.numXTicks; ++i) {
+            float xPos = static_cast<float>(plotArea.x1 + origin.x) + static_cast<float>(plotArea.width()) * static_cast<float>(i) / static_cast<float>(style.numXTicks);
+            xPos -= static_cast<float>(origin.x);
+            painters.linePainter.drawLine(UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y1), UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y2), style.gridColor);
+        }
+
+        // Draw Y-axis grid
+        for (int i = 0; i <= style.numYTicks; ++i) {
+            float yPos = static_cast<float>(plotArea.y1 + origin.y) + static_cast<float>(plotArea.height()) * static_cast<float>(i) / static_cast<float>(style.numYTicks);
+            yPos -= static_cast<float>(origin.y);
+            painters.linePainter.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, yPos), UNSIGNED_CAST(unsigned int, plotArea.x2), UNSIGNED_CAST(unsigned int, yPos), style.gridColor);
+        }
+    }
+    
+    // Draw axes ticks and their labels outside of plot area (in canvas coordinates)
+    void drawTicks(const Chart& chart, const Rect& plotArea) {
         const ChartStyle& style = chart.getStyle();
         const AxisConfig& xAxis = chart.getXAxis();
         const AxisConfig& yAxis = chart.getYAxis();
@@ -293,22 +348,13 @@ private:
         float yMin = yAxis.min;
         float yMax = yAxis.max;
         
-        // Draw axes lines
-        linePainter_.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, plotArea.y2), UNSIGNED_CAST(unsigned int, plotArea.x2), UNSIGNED_CAST(unsigned int, plotArea.y2), style.axisColor); // X-axis
-        linePainter_.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, plotArea.y1), UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, plotArea.y2), style.axisColor); // Y-axis
-
-        // Draw X-axis ticks and grid
+        // Draw X-axis ticks, pixel on the axis belongs to the axis or grid line
         for (int i = 0; i <= style.numXTicks; ++i) {
             float value = xMin + (xMax - xMin) * static_cast<float>(i) / static_cast<float>(style.numXTicks);
             float xPos = static_cast<float>(plotArea.x1) + static_cast<float>(plotArea.width()) * static_cast<float>(i) / static_cast<float>(style.numXTicks);
             
             // Draw tick
-            linePainter_.drawLine(UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y2), UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y2 + 5), style.axisColor);
-            
-            // Draw grid line
-            if (style.showGrid) {
-                linePainter_.drawLine(UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y1), UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y2), style.gridColor);
-            }
+            linePainter_.drawLine(UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y2 + 1), UNSIGNED_CAST(unsigned int, xPos), UNSIGNED_CAST(unsigned int, plotArea.y2 + 5), style.axisColor);
             
             // Draw tick label
             char buffer[20];
@@ -319,18 +365,13 @@ private:
             textPainter_.drawText(UNSIGNED_CAST(unsigned int, xPos) - labelWidth / 2, UNSIGNED_CAST(unsigned int, plotArea.y2 + 15), label, style.textColor);
         }
 
-        // Draw Y-axis ticks and grid
+        // Draw Y-axis ticks
         for (int i = 0; i <= style.numYTicks; ++i) {
             float value = yMin + (yMax - yMin) * static_cast<float>(style.numYTicks - i) / static_cast<float>(style.numYTicks);
             float yPos = static_cast<float>(plotArea.y1) + static_cast<float>(plotArea.height()) * static_cast<float>(i) / static_cast<float>(style.numYTicks);
             
             // Draw tick
-            linePainter_.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1 - 5), UNSIGNED_CAST(unsigned int, yPos), UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, yPos), style.axisColor);
-            
-            // Draw grid line
-            if (style.showGrid) {
-                linePainter_.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1), UNSIGNED_CAST(unsigned int, yPos), UNSIGNED_CAST(unsigned int, plotArea.x2), UNSIGNED_CAST(unsigned int, yPos), style.gridColor);
-            }
+            linePainter_.drawLine(UNSIGNED_CAST(unsigned int, plotArea.x1 - 5), UNSIGNED_CAST(unsigned int, yPos), UNSIGNED_CAST(unsigned int, plotArea.x1 - 1), UNSIGNED_CAST(unsigned int, yPos), style.axisColor);
             
             // Draw tick label
             char buffer[20];
@@ -343,7 +384,8 @@ private:
     }
     
     // Draw chart series data
-    void drawSeries(const Chart& chart, const Rect& plotArea) {
+    void drawSeries(PanelPainters& painters, const Chart& chart, const Rect& plotArea) {
+        Point origin = painters.view.offset();
         const std::vector<Series>& seriesSet = chart.getSeries();
         const AxisConfig& xAxis = chart.getXAxis();
         const AxisConfig& yAxis = chart.getYAxis();
@@ -360,17 +402,17 @@ private:
             float lineThickness = series.getStyle().lineThickness;
             
             // Use appropriate line painter based on thickness
-            if (lineThickness <= 1.0f) {
+            if (lineThickness <= 1.0f && series.getStyle().dashPattern.empty()) {
                 if (useAntiAliasing_) {
                     // Anti-aliased line painter for thin lines
-                    AntiAliasedLinePainterForPixels antiAliasedPainter(pixelPainter_);
+                    AntiAliasedLinePainterForPixels antiAliasedPainter(painters.pixelPainter);
                     
                     for (size_t i = 0; i < points.size() - 1; ++i) {
                         const auto& p1 = points[i];
                         const auto& p2 = points[i+1];
                         
-                        PointF p1_screen = worldToScreen(p1.x, p1.y, plotArea, xMin, xMax, yMin, yMax);
-                        PointF p2_screen = worldToScreen(p2.x, p2.y, plotArea, xMin, xMax, yMin, yMax);
+                        PointF p1_screen = worldToScreen(p1.x, p1.y, plotArea, origin, xMin, xMax, yMin, yMax);
+                        PointF p2_screen = worldToScreen(p2.x, p2.y, plotArea, origin, xMin, xMax, yMin, yMax);
                         
                         antiAliasedPainter.drawLine(UNSIGNED_CAST(unsigned int, p1_screen.x), UNSIGNED_CAST(unsigned int, p1_screen.y),
                                                     UNSIGNED_CAST(unsigned int, p2_screen.x), UNSIGNED_CAST(unsigned int, p2_screen.y), 
@@ -382,65 +424,71 @@ private:
                         const auto& p1 = points[i];
                         const auto& p2 = points[i+1];
                         
-                        PointF p1_screen = worldToScreen(p1.x, p1.y, plotArea, xMin, xMax, yMin, yMax);
-                        PointF p2_screen = worldToScreen(p2.x, p2.y, plotArea, xMin, xMax, yMin, yMax);
+                        PointF p1_screen = worldToScreen(p1.x, p1.y, plotArea, origin, xMin, xMax, yMin, yMax);
+                        PointF p2_screen = worldToScreen(p2.x, p2.y, plotArea, origin, xMin, xMax, yMin, yMax);
                         
-                        linePainter_.drawLine(UNSIGNED_CAST(unsigned int, p1_screen.x), UNSIGNED_CAST(unsigned int, p1_screen.y),
+                        painters.linePainter.drawLine(UNSIGNED_CAST(unsigned int, p1_screen.x), UNSIGNED_CAST(unsigned int, p1_screen.y),
                                             UNSIGNED_CAST(unsigned int, p2_screen.x), UNSIGNED_CAST(unsigned int, p2_screen.y), 
                                             series.getStyle().color);
                     }
                 }
             } else {
-                // Choose between standard or anti-aliased thick line painter
-                if (useAntiAliasing_) {
-                    // Anti-aliased thick line painter
-                    AntiAliasedThickLinePainter thickPainter(image_, lineThickness);
-                    
-                    for (size_t i = 0; i < points.size() - 1; ++i) {
-                        const auto& p1 = points[i];
-                        const auto& p2 = points[i+1];
-                        
-                        PointF p1_screen = worldToScreen(p1.x, p1.y, plotArea, xMin, xMax, yMin, yMax);
-                        PointF p2_screen = worldToScreen(p2.x, p2.y, plotArea, xMin, xMax, yMin, yMax);
-                        
-                        thickPainter.drawLine(static_cast<int>(p1_screen.x), static_cast<int>(p1_screen.y),
-                                            static_cast<int>(p2_screen.x), static_cast<int>(p2_screen.y),
-                                            series.getStyle().color);
-                    }
-                } else {
-                    // Standard thick line painter
-                    ThickLinePainter thickPainter(image_, lineThickness);
-                    
-                    for (size_t i = 0; i < points.size() - 1; ++i) {
-                        const auto& p1 = points[i];
-                        const auto& p2 = points[i+1];
-                        
-                        PointF p1_screen = worldToScreen(p1.x, p1.y, plotArea, xMin, xMax, yMin, yMax);
-                        PointF p2_screen = worldToScreen(p2.x, p2.y, plotArea, xMin, xMax, yMin, yMax);
-                        
-                        thickPainter.drawLine(static_cast<int>(p1_screen.x), static_cast<int>(p1_screen.y),
-                                            static_cast<int>(p2_screen.x), static_cast<int>(p2_screen.y),
-                                            series.getStyle().color);
-                    }
+                // Thick or dashed line: whole series is stroked as one polyline with round joins and caps and
+                // filled once, with coverage anti-aliasing when enabled
+                StrokeStyle strokeStyle;
+                strokeStyle.width = lineThickness;
+                strokeStyle.join = StrokeStyle::ROUND_JOIN;
+                strokeStyle.cap = StrokeStyle::ROUND_CAP;
+                strokeStyle.dashes = series.getStyle().dashPattern;
+                StrokePainterForPixels strokePainter(painters.pixelPainter, painters.view.getSize(), strokeStyle,
+                                                     useAntiAliasing_);
+
+                // screen positions are pixels, which are drawn around their centers
+                std::vector<PointF> polyline;
+                polyline.reserve(points.size());
+                for (const auto& point : points) {
+                    PointF screen = worldToScreen(point.x, point.y, plotArea, origin, xMin, xMax, yMin, yMax);
+                    polyline.push_back(PointF(screen.x + 0.5f, screen.y + 0.5f));
                 }
+                strokePainter.drawPolyline(polyline, series.getStyle().color);
             }
         }
     }
     
-    // Render a single chart
-    void renderChart(const Chart& chart, const Rect& chartRect) {
-        const ChartStyle& style = chart.getStyle();
-        
-        // Apply chart background color
-        rectPainter_.drawFull(UNSIGNED_CAST(unsigned int, chartRect.x1), UNSIGNED_CAST(unsigned int, chartRect.y1), UNSIGNED_CAST(unsigned int, chartRect.x2), UNSIGNED_CAST(unsigned int, chartRect.y2), style.backgroundColor);
-        
-        // Calculate plot area
-        Rect plotArea = Rect::make_rect(
+    // Plot area of chart placed in a rectangle
+    static Rect plotAreaOf(const ChartStyle& style, const Rect& chartRect) {
+        return Rect::make_rect(
             chartRect.x1 + style.marginLeft,
             chartRect.y1 + style.marginTop,
             chartRect.x2 - style.marginRight,
             chartRect.y2 - style.marginBottom
         );
+    }
+    
+    // Render background, axes, grid and series of a chart into view of its rectangle
+    void renderPlot(const Chart& chart, const Rect& canvasChartRect) {
+        const ChartStyle& style = chart.getStyle();
+        PanelPainters painters(image_, canvasChartRect);
+        
+        // Chart rectangle in coordinates of its view
+        Rect chartRect = Rect::make_rect(0, 0, canvasChartRect.x2 - canvasChartRect.x1, canvasChartRect.y2 - canvasChartRect.y1);
+        
+        // Apply chart background color
+        painters.rectPainter.drawFull(UNSIGNED_CAST(unsigned int, chartRect.x1), UNSIGNED_CAST(unsigned int, chartRect.y1), UNSIGNED_CAST(unsigned int, chartRect.x2), UNSIGNED_CAST(unsigned int, chartRect.y2), style.backgroundColor);
+        
+        Rect plotArea = plotAreaOf(style, chartRect);
+        
+        // Draw axes
+        drawAxes(painters, chart, plotArea);
+        
+        // Draw data series
+        drawSeries(painters, chart, plotArea);
+    }
+    
+    // Draw title, ticks, labels and legend of a chart on the whole image
+    void drawDecorations(const Chart& chart, const Rect& chartRect) {
+        const ChartStyle& style = chart.getStyle();
+        Rect plotArea = plotAreaOf(style, chartRect);
         
         // Draw chart title
         unsigned int titleWidth = textPainter_.textWidth(chart.getTitle());
@@ -448,11 +496,8 @@ private:
         int titleY = chartRect.y1 + 20;
         textPainter_.drawText(UNSIGNED_CAST(unsigned int, titleX), UNSIGNED_CAST(unsigned int, titleY), chart.getTitle(), style.textColor);
         
-        // Draw axes
-        drawAxes(chart, plotArea);
-        
-        // Draw data series
-        drawSeries(chart, plotArea);
+        // Draw ticks and their labels
+        drawTicks(chart, plotArea);
         
         // Draw X-axis label
         unsigned int xLabelWidth = textPainter_.textWidth(chart.getXAxis().label);
@@ -480,16 +525,17 @@ private:
             plotArea.x2,
             plotArea.y1 + static_cast<int>(chart.getSeries().size()) * 25
         );
-        drawLegend(chart, chartRect, legendArea);
+        drawLegend(chart, legendArea);
     }
     
     RgbImage image_;
+    // painters for the whole image, used by one thread at a time
     PixelPainterForRgbImage pixelPainter_;
     LinePainterForRgbImage linePainter_;
     RectPainterForRgbImage rectPainter_;
+    TextPainterForBdfFont textPainter_;
     
     BdfFont font_;
-    TextPainterForBdfFont textPainter_;
     
     int imageWidth_;
     int imageHeight_;
@@ -2,6 +2,7 @@
 
 #include "uimg/base/structs.h"
 #include <string>
+#include <vector>
 
 namespace uimg {
 namespace charts {
@@ -13,6 +14,7 @@ struct SeriesStyle {
     RgbColor color;                // Color of the line
     float lineThickness = 1.0f;    // Thickness of the line
     std::string name;              // Name for the legend
+    std::vector<float> dashPattern; // Lengths of dashes and gaps in pixels, empty for solid line
     
     // Factory method for creating default styles with different colors
     static SeriesStyle createDefault(const RgbColor& color, const std::string& name) {
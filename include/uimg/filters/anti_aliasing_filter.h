@@ -35,9 +35,10 @@ public:
           filteredPainter_(*this) {
         
         // Clear the super-sample buffer to white initially
-        unsigned char* data = static_cast<unsigned char*>(superSampleImage_.data());
-        size_t dataSize = superSampleImage_.dataSize();
-        std::fill(data, data + dataSize, 255);
+        for (unsigned int y = 0; y < superSampleImage_.height(); ++y) {
+            unsigned char* row = superSampleImage_.row(y);
+            std::fill(row, row + superSampleImage_.rowSize(), 255);
+        }
     }
 
     /**
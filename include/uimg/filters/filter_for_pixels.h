@@ -42,6 +42,19 @@ public:
     virtual void getPixel(unsigned int x, unsigned int y, RgbColor &output) {
         getTarget().getPixel(x, y, output);
     }
+
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        getTarget().fillSpan(x, y, length, color);
+    }
+
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        getTarget().copySpan(x, y, length, colors);
+    }
+
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        getTarget().blendSpan(x, y, length, color, coverage);
+    }
 };
 
 // position rotation filter - rotation given by discrete values (-180,-90,0,+90,180)
@@ -137,6 +150,23 @@ public:
         getTarget().getPixel(x, y, output);
     }
 
+    // rows are moved as a whole, so spans are forwarded unchanged
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        recalculatePos(x, y);
+        getTarget().fillSpan(x, y, length, color);
+    }
+
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        recalculatePos(x, y);
+        getTarget().copySpan(x, y, length, colors);
+    }
+
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        recalculatePos(x, y);
+        getTarget().blendSpan(x, y, length, color, coverage);
+    }
+
 protected:    void recalculatePos([[maybe_unused]] unsigned int &x, unsigned int &y) {
         y = UNSIGNED_CAST(unsigned int, FlipUtils::flipPos(y, UNSIGNED_CAST(unsigned int, offset_.y), evenFlip_));
     }
@@ -159,6 +189,17 @@ public:
         getTarget().getPixel(x, y, output);
     }
 
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        if (color != transparencyColor_)
+            getTarget().fillSpan(x, y, length, color);
+    }
+
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        if (color != transparencyColor_)
+            getTarget().blendSpan(x, y, length, color, coverage);
+    }
+
 private:
     RgbColor transparencyColor_;
 };
@@ -240,7 +281,48 @@ public:
             output.clear();
     }
 
-protected:    bool recalculatePos(unsigned int &x, unsigned int &y) {
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        unsigned int skip;
+        if (recalculateSpan(x, y, length, skip))
+            getTarget().fillSpan(x, y, length, color);
+    }
+
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        unsigned int skip;
+        if (recalculateSpan(x, y, length, skip))
+            getTarget().copySpan(x, y, length, colors + skip);
+    }
+
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        unsigned int skip;
+        if (recalculateSpan(x, y, length, skip))
+            getTarget().blendSpan(x, y, length, color, coverage + skip);
+    }
+
+protected:
+    // moves span by offset, part of span shifted below zero is cut off (skip = number of removed pixels)
+    bool recalculateSpan(unsigned int &x, unsigned int &y, unsigned int &length, unsigned int &skip) {
+        skip = 0;
+        long long sx = static_cast<long long>(x) + offset_.x;
+        long long sy = static_cast<long long>(y) + offset_.y;
+        if (sy < 0)
+            return false;
+
+        if (sx < 0) {
+            if (static_cast<unsigned long long>(-sx) >= length)
+                return false;
+            skip = static_cast<unsigned int>(-sx);
+            sx = 0;
+        }
+
+        x = static_cast<unsigned int>(sx);
+        y = static_cast<unsigned int>(sy);
+        length -= skip;
+        return true;
+    }
+
+    bool recalculatePos(unsigned int &x, unsigned int &y) {
         // handle shift below zero
         if (offset_.x < 0) {
             if (UNSIGNED_CAST(unsigned int, -offset_.x) > x) {
@@ -282,7 +364,49 @@ public:
             output.clear();
     }
 
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        unsigned int skip;
+        if (clipSpan(x, y, length, skip))
+            getTarget().fillSpan(x, y, length, color);
+    }
+
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        unsigned int skip;
+        if (clipSpan(x, y, length, skip))
+            getTarget().copySpan(x, y, length, colors + skip);
+    }
+
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        unsigned int skip;
+        if (clipSpan(x, y, length, skip))
+            getTarget().blendSpan(x, y, length, color, coverage + skip);
+    }
+
 protected:
+    // limits span to clip window, skip = number of pixels removed from span start
+    bool clipSpan(unsigned int &x, unsigned int y, unsigned int &length, unsigned int &skip) {
+        skip = 0;
+        if (length == 0)
+            return false;
+
+        long long sy = static_cast<long long>(y);
+        if (sy < clipWindow_.y1 || sy > clipWindow_.y2)
+            return false;
+
+        long long x1 = static_cast<long long>(x);
+        long long x2 = x1 + length - 1;
+        long long cx1 = std::max<long long>(x1, clipWindow_.x1);
+        long long cx2 = std::min<long long>(x2, clipWindow_.x2);
+        if (cx1 > cx2)
+            return false;
+
+        skip = static_cast<unsigned int>(cx1 - x1);
+        x = static_cast<unsigned int>(cx1);
+        length = static_cast<unsigned int>(cx2 - cx1 + 1);
+        return true;
+    }
+
     bool checkPos(int x, int y) {
         if (x < clipWindow_.x1 || x > clipWindow_.x2)
             return false;
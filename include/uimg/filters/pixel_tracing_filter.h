@@ -86,6 +86,44 @@ public:
         basePainter_.putPixel(x, y, color);
     }
 
+    /**
+     * @brief Fill horizontal span (tracks both span ends)
+     * @param x X coordinate of span start
+     * @param y Y coordinate
+     * @param length Number of pixels
+     * @param color Pixel color
+     */
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) override {
+        trackSpan(x, y, length);
+        basePainter_.fillSpan(x, y, length, color);
+    }
+
+    /**
+     * @brief Copy colors to horizontal span
+     * @param x X coordinate of span start
+     * @param y Y coordinate
+     * @param length Number of pixels
+     * @param colors Pixel colors
+     */
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) override {
+        trackSpan(x, y, length);
+        basePainter_.copySpan(x, y, length, colors);
+    }
+
+    /**
+     * @brief Blend color into horizontal span
+     * @param x X coordinate of span start
+     * @param y Y coordinate
+     * @param length Number of pixels
+     * @param color Pixel color
+     * @param coverage Per-pixel opacity (0-255)
+     */
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) override {
+        trackSpan(x, y, length);
+        basePainter_.blendSpan(x, y, length, color, coverage);
+    }
+
     /**
      * @brief Reset tracking to initial state
      */
@@ -167,6 +205,19 @@ private:
         }
     }
 
+    /**
+     * @brief Track both ends of a horizontal span
+     * @param x X coordinate of span start
+     * @param y Y coordinate
+     * @param length Number of pixels
+     */
+    void trackSpan(unsigned int x, unsigned int y, unsigned int length) {
+        if (length == 0)
+            return;
+        trackPixel(x, y);
+        trackPixel(x + length - 1, y);
+    }
+
     PixelPainter& basePainter_;       ///< The base painter to forward requests to
     std::string chartName_;           ///< Name of the chart for logging
     unsigned int minX_, minY_;        ///< Minimum coordinates
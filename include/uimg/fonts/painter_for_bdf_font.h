@@ -151,6 +151,27 @@ public:
         return {width, height};
     }
 
+    /**
+     * @brief Calculate rectangle of pixels painted by drawText
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param text Text to measure
+     * @return Rectangle containing every pixel of the text, empty (x2 < x1) if no glyph has pixels
+     *
+     * Taken from bounding boxes (BBX) of glyphs, so negative x offsets, glyphs wider than their advance
+     * and parts below base line are included.
+     */
+    RectInclusive textBounds(unsigned int x, unsigned int y, const std::string &text) override {
+        RectInclusive bounds = RectInclusive::make_rect(0, 0, -1, -1);
+        int penX = static_cast<int>(x);
+        for (char c : text) {
+            text_char_code_t charCode = static_cast<text_char_code_t>(UNSIGNED_CAST(unsigned char, c));
+            includeGlyphBounds(bounds, penX, static_cast<int>(y), charCode, 1);
+            penX += static_cast<int>(glyphWidth(charCode));
+        }
+        return bounds;
+    }
+
     /**
      * @brief Calculate text size from TextSource
      * @param src Source of characters
@@ -215,6 +236,34 @@ protected:
         return '?';
     }
 
+    /**
+     * @brief Extend bounds by bounding box of a glyph
+     * @param bounds Rectangle to extend, empty (x2 < x1) at start
+     * @param x Pen X coordinate
+     * @param y Base line Y coordinate
+     * @param charCode Character code
+     * @param scale Glyph is painted scale x scale times, shifted right and down by up to scale - 1 pixels
+     */
+    void includeGlyphBounds(RectInclusive &bounds, int x, int y, text_char_code_t charCode, int scale) const {
+        const BdfGlyph *g = get_glyph(charCode);
+        assert(g != nullptr);
+        Point size = g->bbxSize();
+        Point offset = g->bbxOffset();
+        if (size.x <= 0 || size.y <= 0)
+            return;
+
+        RectInclusive glyph = RectInclusive::make_rect(x + offset.x, y - size.y - offset.y,
+                                                       x + offset.x + size.x - 1 + scale - 1, y - offset.y - 1 + scale - 1);
+        if (bounds.x2 < bounds.x1) {
+            bounds = glyph;
+        } else {
+            bounds.x1 = std::min(bounds.x1, glyph.x1);
+            bounds.y1 = std::min(bounds.y1, glyph.y1);
+            bounds.x2 = std::max(bounds.x2, glyph.x2);
+            bounds.y2 = std::max(bounds.y2, glyph.y2);
+        }
+    }
+
     /**
      * @brief Calculate width of a glyph
      * @param glyph Glyph pointer
@@ -258,14 +307,24 @@ private:
         for (int yi = 0; yi < h; ++yi) {
             const BdfGlyph::pixel_line_t row = g->pixelData()[yi];
             BdfGlyph::pixel_line_t pixelMask = 0x80000000;
-
-            for (int xi = 0; xi < w; ++xi, pixelMask >>= 1) {
-                if (row & pixelMask) {
-                    int pixel_x = static_cast<int>(x) + xi;
-                    int pixel_y = y0 + yi;
-                    if (pixel_x >= 0 && pixel_y >= 0) {
-                        painter->putPixel(UNSIGNED_CAST(unsigned int, pixel_x), UNSIGNED_CAST(unsigned int, pixel_y), color);
+            int pixel_y = y0 + yi;
+            if (pixel_y < 0)
+                continue;
+
+            // runs of set bits are painted as spans
+            int runStart = -1;
+            for (int xi = 0; xi <= w; ++xi, pixelMask >>= 1) {
+                bool set = (xi < w) && (row & pixelMask);
+                if (set && runStart < 0) {
+                    runStart = xi;
+                } else if (!set && runStart >= 0) {
+                    int pixel_x1 = std::max(0, static_cast<int>(x) + runStart);
+                    int pixel_x2 = static_cast<int>(x) + xi - 1;
+                    if (pixel_x2 >= pixel_x1) {
+                        painter->fillSpan(UNSIGNED_CAST(unsigned int, pixel_x1), UNSIGNED_CAST(unsigned int, pixel_y),
+                                          UNSIGNED_CAST(unsigned int, pixel_x2 - pixel_x1 + 1), color);
                     }
+                    runStart = -1;
                 }
             }
         }
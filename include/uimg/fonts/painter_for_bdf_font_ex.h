@@ -147,6 +147,33 @@ public:
         };
     }
 
+    /**
+     * @brief Calculate rectangle of pixels painted by drawText, with alignment and scaling applied
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param text Text to measure
+     * @return Rectangle containing every pixel of the text, empty (x2 < x1) if no glyph has pixels
+     */
+    RectInclusive textBounds(unsigned int x, unsigned int y, const std::string &text) override {
+        Point pos{static_cast<int>(x), static_cast<int>(y)};
+        Point adjustedPos = calculateAlignedPosition(pos, text);
+        if (scale_ == 1.0f) {
+            return TextPainterForBdfFont::textBounds(static_cast<unsigned int>(adjustedPos.x), static_cast<unsigned int>(adjustedPos.y), text);
+        }
+
+        // same pen positions and glyph copies as drawTextScaled
+        int scaleInt = std::max(1, static_cast<int>(scale_));
+        RectInclusive bounds = RectInclusive::make_rect(0, 0, -1, -1);
+        unsigned int currentX = static_cast<unsigned int>(adjustedPos.x);
+        for (char c : text) {
+            text_char_code_t charCode = static_cast<text_char_code_t>(static_cast<unsigned char>(c));
+            includeGlyphBounds(bounds, static_cast<int>(currentX), adjustedPos.y, charCode, scaleInt);
+            unsigned int charWidth = TextPainterForBdfFont::glyphWidth(charCode);
+            currentX += static_cast<unsigned int>(static_cast<float>(charWidth) * scale_);
+        }
+        return bounds;
+    }
+
 protected:
     /**
      * @brief Calculate the aligned position for text rendering
@@ -0,0 +1,160 @@
+#ifndef __UIMG_ASYNC_IMAGE_WRITER_H__
+#define __UIMG_ASYNC_IMAGE_WRITER_H__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "uimg/images/pixel_image.h"
+#include "uimg/images/png_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/utils/bounded_queue.h"
+
+// Writes finished images on a background thread, so the caller can draw the next image while the previous one
+// is encoded and written to disk.
+// Every write() takes an image - moved in, or snapshot (copied) when given by reference - and returns future
+// which becomes ready when the image is written (or holds the exception thrown while writing it).
+// Images are written in submission order by one thread. At most `maxPending` images wait in the queue besides the
+// one being written; write() blocks when the queue is full, which keeps memory bounded when drawing is faster
+// than output (the default of one gives double buffering: one image drawn while one is written).
+class AsyncImageWriter {
+public:
+    // encodes image and writes it, called on writer thread
+    using WriteFunction = std::function<void(PixelImageBase &)>;
+
+    explicit AsyncImageWriter(size_t maxPending = 1) : jobs_(maxPending) {
+        writerThread_ = std::thread(&AsyncImageWriter::writerLoop, this);
+    }
+
+    AsyncImageWriter(const AsyncImageWriter &) = delete;
+    AsyncImageWriter &operator=(const AsyncImageWriter &) = delete;
+
+    // writes all queued images, results are available through their futures
+    ~AsyncImageWriter() {
+        jobs_.close();
+        if (writerThread_.joinable())
+            writerThread_.join();
+    }
+
+    // queues image for `writeFunction`, image is owned by writer from now on
+    std::future<void> write(RgbImage &&image, WriteFunction writeFunction) {
+        Job job;
+        job.image = std::move(image);
+        job.writeFunction = std::move(writeFunction);
+        std::future<void> result = job.done.get_future();
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            ++pending_;
+        }
+        if (!jobs_.push(std::move(job))) {
+            finishJob();
+            throw std::logic_error("AsyncImageWriter: writer stopped");
+        }
+        return result;
+    }
+
+    // queues copy of image, so caller can modify image right after this call
+    std::future<void> write(const PixelImageBase &image, WriteFunction writeFunction) {
+        return write(snapshot(image), std::move(writeFunction));
+    }
+
+    // queues image for writeImageFile()
+    std::future<void> writeFile(RgbImage &&image, const std::string &path) {
+        return write(std::move(image), [path](PixelImageBase &output) { writeImageFile(output, path); });
+    }
+
+    std::future<void> writeFile(const PixelImageBase &image, const std::string &path) {
+        return writeFile(snapshot(image), path);
+    }
+
+    // number of images queued or being written
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        return pending_;
+    }
+
+    // blocks until all queued images are written; errors are reported only through futures
+    void wait() {
+        std::unique_lock<std::mutex> lock(pendingMutex_);
+        allWritten_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+    // writes image to file as PNG if name ends with ".png", as PPM otherwise; throws std::runtime_error on failure
+    static void writeImageFile(PixelImageBase &image, const std::string &path) {
+        std::ofstream output(path, std::ios::binary);
+        if (!output)
+            throw std::runtime_error("Failed to open output file: " + path);
+
+        if (PngImageWriter::isPngFileName(path)) {
+            PngImageWriter writer(output);
+            writer.writeImage(image);
+        } else {
+            PpmImageWriter writer(output);
+            writer.writeImage(image);
+        }
+
+        output.flush();
+        if (!output)
+            throw std::runtime_error("Failed to write output file: " + path);
+    }
+
+    // copy of any image as RgbImage, rows are copied in packed RGB form
+    static RgbImage snapshot(const PixelImageBase &image) {
+        RgbImage copy(image.width(), image.height());
+        for (unsigned int y = 0; y < copy.height(); ++y) {
+            unsigned char *target = copy.row(y);
+            const unsigned char *row = image.readRow(y, target);
+            if (row != target)
+                memcpy(target, row, copy.rowSize());
+        }
+        return copy;
+    }
+
+private:
+    struct Job {
+        RgbImage image{0, 0};
+        WriteFunction writeFunction;
+        std::promise<void> done;
+    };
+
+    void writerLoop() {
+        Job job;
+        while (jobs_.pop(job)) {
+            try {
+                job.writeFunction(job.image);
+                job.done.set_value();
+            } catch (...) {
+                job.done.set_exception(std::current_exception());
+            }
+            // image memory is released before the next job starts
+            job = Job();
+            finishJob();
+        }
+    }
+
+    void finishJob() {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            --pending_;
+        }
+        allWritten_.notify_all();
+    }
+
+    BoundedQueue<Job> jobs_;
+    std::thread writerThread_;
+    mutable std::mutex pendingMutex_;
+    std::condition_variable allWritten_;
+    size_t pending_ = 0;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef __UIMG_DIRTY_TILE_TRACKER_H__
+#define __UIMG_DIRTY_TILE_TRACKER_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/utils/checksum.h"
+#include "uimg/utils/thread_pool.h"
+
+// Finds tiles of an image which changed since the previous frame, so encoders and frame outputs can re-encode or
+// transmit only those (e.g. dashboards re-rendered every few seconds where most of the frame stays the same).
+// Every update() hashes all tiles (XxHash64 of their packed RGB rows) in one row-major pass - rows of RgbImage and
+// ImageView are hashed straight from image memory - and compares the hashes with those of the previous frame.
+// Tile rows are hashed in parallel when threadCount > 1.
+class DirtyTileTracker {
+public:
+    struct Tile {
+        unsigned int column;
+        unsigned int row;
+        RectInclusive bounds; // pixels of tile, edge tiles are smaller
+    };
+
+    explicit DirtyTileTracker(unsigned int tileSize = 64, unsigned int threadCount = 1) : tileSize_(tileSize) {
+        if (tileSize == 0)
+            throw std::invalid_argument("DirtyTileTracker: tile size has to be positive");
+        if (threadCount > 1)
+            pool_.reset(new ThreadPool(threadCount));
+    }
+
+    // hashes tiles of new frame, returns tiles which differ from previous frame (all tiles for the first frame and
+    // after change of image size), ordered by row, then column
+    const std::vector<Tile> &update(const PixelImageBase &image) {
+        unsigned int columns = (image.width() + tileSize_ - 1) / tileSize_;
+        unsigned int rows = (image.height() + tileSize_ - 1) / tileSize_;
+        bool sameSize = image.width() == width_ && image.height() == height_;
+        width_ = image.width();
+        height_ = image.height();
+        columns_ = columns;
+        rows_ = rows;
+
+        previous_.swap(hashes_);
+        hashes_.assign(static_cast<size_t>(columns) * rows, 0);
+        if (pool_ && rows > 1) {
+            for (unsigned int row = 0; row < rows; ++row)
+                pool_->submit([this, &image, row]() { hashTileRow(image, row); });
+            pool_->wait();
+        } else {
+            for (unsigned int row = 0; row < rows; ++row)
+                hashTileRow(image, row);
+        }
+
+        changed_.clear();
+        for (unsigned int row = 0; row < rows; ++row)
+            for (unsigned int column = 0; column < columns; ++column) {
+                size_t index = static_cast<size_t>(row) * columns + column;
+                if (!sameSize || !hasPrevious_ || hashes_[index] != previous_[index])
+                    changed_.push_back(tile(column, row));
+            }
+        hasPrevious_ = true;
+        return changed_;
+    }
+
+    // forgets previous frame, so next update() reports all tiles as changed
+    void reset() {
+        hasPrevious_ = false;
+    }
+
+    // tiles reported by last update()
+    const std::vector<Tile> &changedTiles() const {
+        return changed_;
+    }
+
+    // smallest rectangle covering all changed tiles; false if nothing changed
+    bool changedBounds(RectInclusive &bounds) const {
+        if (changed_.empty())
+            return false;
+        bounds = changed_.front().bounds;
+        for (const Tile &changed : changed_) {
+            bounds.x1 = std::min(bounds.x1, changed.bounds.x1);
+            bounds.y1 = std::min(bounds.y1, changed.bounds.y1);
+            bounds.x2 = std::max(bounds.x2, changed.bounds.x2);
+            bounds.y2 = std::max(bounds.y2, changed.bounds.y2);
+        }
+        return true;
+    }
+
+    unsigned int tileSize() const {
+        return tileSize_;
+    }
+
+    unsigned int columns() const {
+        return columns_;
+    }
+
+    unsigned int rows() const {
+        return rows_;
+    }
+
+    // hash of tile in last frame
+    uint64_t tileHash(unsigned int column, unsigned int row) const {
+        return hashes_.at(static_cast<size_t>(row) * columns_ + column);
+    }
+
+    Tile tile(unsigned int column, unsigned int row) const {
+        unsigned int x = column * tileSize_;
+        unsigned int y = row * tileSize_;
+        unsigned int x2 = std::min(x + tileSize_, width_) - 1;
+        unsigned int y2 = std::min(y + tileSize_, height_) - 1;
+        return {column, row, RectInclusive::make_rect(static_cast<int>(x), static_cast<int>(y),
+                                                      static_cast<int>(x2), static_cast<int>(y2))};
+    }
+
+private:
+    // hashes all tiles of one tile row, row by row
+    void hashTileRow(const PixelImageBase &image, unsigned int tileRow) {
+        std::vector<XxHash64> states(columns_);
+        std::vector<unsigned char> buffer(static_cast<size_t>(width_) * 3);
+        size_t tileBytes = static_cast<size_t>(tileSize_) * 3;
+        size_t rowBytes = static_cast<size_t>(width_) * 3;
+
+        unsigned int y2 = std::min((tileRow + 1) * tileSize_, height_);
+        for (unsigned int y = tileRow * tileSize_; y < y2; ++y) {
+            const unsigned char *row = image.readRow(y, buffer.data());
+            for (size_t column = 0, offset = 0; column < columns_; ++column, offset += tileBytes)
+                states[column].update(row + offset, std::min(tileBytes, rowBytes - offset));
+        }
+
+        uint64_t *hashes = hashes_.data() + static_cast<size_t>(tileRow) * columns_;
+        for (size_t column = 0; column < columns_; ++column)
+            hashes[column] = states[column].digest();
+    }
+
+    unsigned int tileSize_;
+    std::unique_ptr<ThreadPool> pool_;
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    unsigned int columns_ = 0;
+    unsigned int rows_ = 0;
+    bool hasPrevious_ = false;
+    std::vector<uint64_t> hashes_;
+    std::vector<uint64_t> previous_;
+    std::vector<Tile> changed_;
+};
+
+#endif
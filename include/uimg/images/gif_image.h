@@ -0,0 +1,585 @@
+#ifndef __UIMG_GIF_IMAGE_H__
+#define __UIMG_GIF_IMAGE_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+
+// Palette of up to 256 colors for an image, built by median cut.
+// When the image has no more distinct colors than requested (typical for charts) they are used exactly,
+// otherwise colors are counted in a 15-bit histogram which is split along the longest axis of the box
+// with the largest count * extent until the requested number of boxes is reached.
+class MedianCutQuantizer {
+public:
+    // `exactColors` (optional) is set to true when palette has all colors of the image
+    static std::vector<RgbColor> buildPalette(const PixelImageBase &image, unsigned int maxColors = 256,
+                                              bool *exactColors = nullptr) {
+        if (maxColors == 0 || maxColors > 256)
+            throw std::invalid_argument("MedianCutQuantizer: color count has to be in range 1..256");
+
+        std::vector<Bin> bins(HISTOGRAM_SIZE);
+        ExactColors exact(maxColors);
+        std::vector<unsigned char> rowBuffer(static_cast<size_t>(image.width()) * 3);
+
+        for (unsigned int y = 0; y < image.height(); ++y) {
+            const unsigned char *rgb = image.readRow(y, rowBuffer.data());
+            for (unsigned int x = 0; x < image.width(); ++x, rgb += 3) {
+                Bin &bin = bins[histogramIndex(rgb[0], rgb[1], rgb[2])];
+                ++bin.count;
+                bin.red += rgb[0];
+                bin.green += rgb[1];
+                bin.blue += rgb[2];
+                exact.add(rgb[0], rgb[1], rgb[2]);
+            }
+        }
+
+        if (exactColors)
+            *exactColors = !exact.overflow();
+        if (!exact.overflow())
+            return exact.colors();
+
+        std::vector<uint16_t> entries;
+        for (size_t i = 0; i < HISTOGRAM_SIZE; ++i)
+            if (bins[i].count > 0)
+                entries.push_back(static_cast<uint16_t>(i));
+
+        std::vector<Box> boxes(1, makeBox(bins, entries, 0, entries.size()));
+        while (boxes.size() < maxColors) {
+            size_t best = boxes.size();
+            uint64_t bestScore = 0;
+            for (size_t i = 0; i < boxes.size(); ++i) {
+                uint64_t score = boxes[i].count * boxes[i].extent;
+                if (boxes[i].end - boxes[i].begin > 1 && score > bestScore) {
+                    best = i;
+                    bestScore = score;
+                }
+            }
+            if (best == boxes.size())
+                break;
+
+            Box box = boxes[best];
+            unsigned int axis = box.axis;
+            std::sort(entries.begin() + static_cast<std::ptrdiff_t>(box.begin),
+                      entries.begin() + static_cast<std::ptrdiff_t>(box.end),
+                      [axis](uint16_t a, uint16_t b) { return component(a, axis) < component(b, axis); });
+
+            // first entry past half of the pixels, at least one entry on both sides
+            uint64_t half = box.count / 2, sum = 0;
+            size_t split = box.begin;
+            while (split < box.end - 1 && sum + bins[entries[split]].count <= half)
+                sum += bins[entries[split++]].count;
+            if (split == box.begin)
+                ++split;
+
+            boxes[best] = makeBox(bins, entries, box.begin, split);
+            boxes.push_back(makeBox(bins, entries, split, box.end));
+        }
+
+        std::vector<RgbColor> palette;
+        for (const Box &box : boxes) {
+            uint64_t red = 0, green = 0, blue = 0;
+            for (size_t i = box.begin; i < box.end; ++i) {
+                red += bins[entries[i]].red;
+                green += bins[entries[i]].green;
+                blue += bins[entries[i]].blue;
+            }
+            palette.push_back(RgbColor::make_rgb(static_cast<int>((red + box.count / 2) / box.count),
+                                                 static_cast<int>((green + box.count / 2) / box.count),
+                                                 static_cast<int>((blue + box.count / 2) / box.count)));
+        }
+        return palette;
+    }
+
+private:
+    static constexpr size_t HISTOGRAM_SIZE = 1 << 15;
+
+    struct Bin {
+        uint64_t count = 0;
+        uint64_t red = 0, green = 0, blue = 0;
+    };
+
+    struct Box {
+        size_t begin, end;
+        uint64_t count;
+        uint64_t extent;   // length of longest axis
+        unsigned int axis; // 0 - red, 1 - green, 2 - blue
+    };
+
+    // distinct colors as long as there are at most `limit` of them
+    class ExactColors {
+    public:
+        explicit ExactColors(unsigned int limit) : limit_(limit), slots_(TABLE_SIZE, 0) {}
+
+        void add(unsigned char r, unsigned char g, unsigned char b) {
+            if (overflow_)
+                return;
+            uint32_t key = (1u << 24) | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+            if (key == lastKey_)
+                return;
+            lastKey_ = key;
+            size_t slot = (key * 2654435761u) >> 22;
+            while (slots_[slot] != 0 && slots_[slot] != key)
+                slot = (slot + 1) & (TABLE_SIZE - 1);
+            if (slots_[slot] == key)
+                return;
+            if (colors_.size() == limit_) {
+                overflow_ = true;
+                return;
+            }
+            slots_[slot] = key;
+            colors_.push_back(RgbColor::make_rgb(r, g, b));
+        }
+
+        bool overflow() const {
+            return overflow_;
+        }
+
+        const std::vector<RgbColor> &colors() const {
+            return colors_;
+        }
+
+    private:
+        static constexpr size_t TABLE_SIZE = 1024;
+
+        unsigned int limit_;
+        std::vector<uint32_t> slots_;
+        std::vector<RgbColor> colors_;
+        uint32_t lastKey_ = 0;
+        bool overflow_ = false;
+    };
+
+    static size_t histogramIndex(unsigned char r, unsigned char g, unsigned char b) {
+        return (static_cast<size_t>(r >> 3) << 10) | (static_cast<size_t>(g >> 3) << 5) | static_cast<size_t>(b >> 3);
+    }
+
+    static unsigned int component(uint16_t index, unsigned int axis) {
+        return (index >> (10 - 5 * axis)) & 0x1Fu;
+    }
+
+    static Box makeBox(const std::vector<Bin> &bins, const std::vector<uint16_t> &entries, size_t begin, size_t end) {
+        Box box;
+        box.begin = begin;
+        box.end = end;
+        box.count = 0;
+        unsigned int low[3] = {31, 31, 31}, high[3] = {0, 0, 0};
+        for (size_t i = begin; i < end; ++i) {
+            box.count += bins[entries[i]].count;
+            for (unsigned int axis = 0; axis < 3; ++axis) {
+                unsigned int value = component(entries[i], axis);
+                low[axis] = std::min(low[axis], value);
+                high[axis] = std::max(high[axis], value);
+            }
+        }
+        box.axis = 0;
+        for (unsigned int axis = 1; axis < 3; ++axis)
+            if (high[axis] - low[axis] > high[box.axis] - low[box.axis])
+                box.axis = axis;
+        box.extent = high[box.axis] - low[box.axis] + 1;
+        return box;
+    }
+};
+
+// Maps RGB pixels to nearest palette entries (squared RGB distance) with optional ordered (8x8 Bayer) dithering.
+// Results are kept in a direct-mapped cache, so images with few colors are mapped at the cost of a lookup.
+class PaletteMapper {
+public:
+    explicit PaletteMapper(const std::vector<RgbColor> &palette)
+            : palette_(palette), cacheKeys_(CACHE_SIZE, 0), cacheValues_(CACHE_SIZE, 0) {
+        if (palette.empty() || palette.size() > 256)
+            throw std::invalid_argument("PaletteMapper: palette has to have 1..256 colors");
+    }
+
+    unsigned char map(unsigned char r, unsigned char g, unsigned char b) {
+        uint32_t key = (1u << 24) | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+        size_t slot = (key * 2654435761u) >> (32 - CACHE_BITS);
+        if (cacheKeys_[slot] != key) {
+            cacheKeys_[slot] = key;
+            cacheValues_[slot] = nearest(r, g, b);
+        }
+        return cacheValues_[slot];
+    }
+
+    // maps row y of packed RGB pixels to palette indices
+    void mapRow(const unsigned char *rgb, unsigned int width, unsigned int y, bool dither, unsigned char *indices) {
+        if (!dither) {
+            uint32_t lastKey = 0;
+            unsigned char lastIndex = 0;
+            for (unsigned int x = 0; x < width; ++x, rgb += 3) {
+                uint32_t key = (1u << 24) | (static_cast<uint32_t>(rgb[0]) << 16) | (static_cast<uint32_t>(rgb[1]) << 8) | rgb[2];
+                if (key != lastKey) {
+                    lastKey = key;
+                    lastIndex = map(rgb[0], rgb[1], rgb[2]);
+                }
+                indices[x] = lastIndex;
+            }
+            return;
+        }
+
+        const unsigned char *thresholds = BAYER_8X8 + (y % 8) * 8;
+        for (unsigned int x = 0; x < width; ++x, rgb += 3) {
+            int offset = ((2 * thresholds[x % 8] - 63) * DITHER_SPREAD) / 128;
+            indices[x] = map(clamp(rgb[0] + offset), clamp(rgb[1] + offset), clamp(rgb[2] + offset));
+        }
+    }
+
+private:
+    static constexpr unsigned int CACHE_BITS = 12;
+    static constexpr size_t CACHE_SIZE = 1 << CACHE_BITS;
+    static constexpr int DITHER_SPREAD = 32;
+    static constexpr unsigned char BAYER_8X8[64] = {
+            0, 32, 8, 40, 2, 34, 10, 42, 48, 16, 56, 24, 50, 18, 58, 26,
+            12, 44, 4, 36, 14, 46, 6, 38, 60, 28, 52, 20, 62, 30, 54, 22,
+            3, 35, 11, 43, 1, 33, 9, 41, 51, 19, 59, 27, 49, 17, 57, 25,
+            15, 47, 7, 39, 13, 45, 5, 37, 63, 31, 55, 23, 61, 29, 53, 21};
+
+    static unsigned char clamp(int value) {
+        return static_cast<unsigned char>(std::min(255, std::max(0, value)));
+    }
+
+    unsigned char nearest(int r, int g, int b) const {
+        unsigned int best = 0;
+        int bestDistance = 3 * 256 * 256;
+        for (unsigned int i = 0; i < palette_.size(); ++i) {
+            int dr = palette_[i].red - r, dg = palette_[i].green - g, db = palette_[i].blue - b;
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < bestDistance) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+        return static_cast<unsigned char>(best);
+    }
+
+    std::vector<RgbColor> palette_;
+    std::vector<uint32_t> cacheKeys_;
+    std::vector<unsigned char> cacheValues_;
+};
+
+// Variable code length LZW compressor of GIF image data (codes up to 12 bits, clear code when table is full).
+// Output is split into data sub-blocks of at most 255 bytes and ends with block terminator.
+class GifLzwEncoder {
+public:
+    static constexpr unsigned int MAX_CODE_SIZE = 12;
+
+    // `minCodeSize` - bits of palette index (2..8), all indices have to be below 1 << minCodeSize
+    void encode(const unsigned char *indices, size_t count, unsigned int minCodeSize, std::vector<unsigned char> &output) {
+        output_ = &output;
+        blockStart_ = output.size();
+        output.push_back(0);
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+
+        const unsigned int clearCode = 1u << minCodeSize;
+        const unsigned int endCode = clearCode + 1;
+        unsigned int codeSize = minCodeSize + 1;
+        unsigned int nextCode = clearCode + 2;
+        resetTable();
+        putCode(clearCode, codeSize);
+
+        if (count > 0) {
+            unsigned int prefix = indices[0];
+            for (size_t i = 1; i < count; ++i) {
+                unsigned int symbol = indices[i];
+                uint32_t key = (static_cast<uint32_t>(prefix) << 8) | symbol;
+                size_t slot = findSlot(key);
+                if (keys_[slot] == key + 1) {
+                    prefix = codes_[slot];
+                    continue;
+                }
+
+                putCode(prefix, codeSize);
+                if (nextCode < (1u << MAX_CODE_SIZE)) {
+                    keys_[slot] = key + 1;
+                    codes_[slot] = static_cast<uint16_t>(nextCode);
+                    // decoder switches to longer codes one entry later than encoder adds it
+                    if (nextCode++ == (1u << codeSize) && codeSize < MAX_CODE_SIZE)
+                        ++codeSize;
+                } else {
+                    putCode(clearCode, codeSize);
+                    resetTable();
+                    codeSize = minCodeSize + 1;
+                    nextCode = clearCode + 2;
+                }
+                prefix = symbol;
+            }
+            putCode(prefix, codeSize);
+            if (nextCode == (1u << codeSize) && codeSize < MAX_CODE_SIZE)
+                ++codeSize;
+        }
+
+        putCode(endCode, codeSize);
+        if (bitCount_ > 0)
+            putByte(static_cast<unsigned char>(bitBuffer_));
+        if (output.size() - blockStart_ > 1)
+            output[blockStart_] = static_cast<unsigned char>(output.size() - blockStart_ - 1);
+        else
+            output.pop_back();
+        output.push_back(0);
+    }
+
+private:
+    // twice the number of codes, so probe sequences stay short
+    static constexpr size_t TABLE_SIZE = 1 << 13;
+
+    void resetTable() {
+        keys_.assign(TABLE_SIZE, 0);
+        codes_.resize(TABLE_SIZE);
+    }
+
+    size_t findSlot(uint32_t key) const {
+        size_t slot = ((key * 2654435761u) >> 19) & (TABLE_SIZE - 1);
+        while (keys_[slot] != 0 && keys_[slot] != key + 1)
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        return slot;
+    }
+
+    void putCode(unsigned int code, unsigned int codeSize) {
+        bitBuffer_ |= static_cast<uint32_t>(code) << bitCount_;
+        bitCount_ += codeSize;
+        while (bitCount_ >= 8) {
+            putByte(static_cast<unsigned char>(bitBuffer_));
+            bitBuffer_ >>= 8;
+            bitCount_ -= 8;
+        }
+    }
+
+    void putByte(unsigned char value) {
+        std::vector<unsigned char> &output = *output_;
+        if (output.size() - blockStart_ == 256) {
+            output[blockStart_] = 255;
+            blockStart_ = output.size();
+            output.push_back(0);
+        }
+        output.push_back(value);
+    }
+
+    std::vector<uint32_t> keys_; // (prefix << 8 | symbol) + 1, 0 marks empty slot
+    std::vector<uint16_t> codes_;
+    std::vector<unsigned char> *output_ = nullptr;
+    size_t blockStart_ = 0; // position of length byte of current sub-block
+    uint32_t bitBuffer_ = 0;
+    unsigned int bitCount_ = 0;
+};
+
+// Single or multi-frame (animated) GIF output.
+// Every writeImage() call appends one frame, finish() (or destructor) writes the trailer.
+// Palette is built from the first frame (or set with setPalette()) and reused by all frames as global color
+// table. Each frame after the first one encodes only the bounding rectangle of pixels whose palette index
+// changed, drawn over the previous frame, so animated charts with moving parts stay small and fast to encode.
+class GifImageWriter : public PixelImageWriter {
+public:
+    // delay - time between frames in 1/100 s, loopCount - 0 for infinite animation, negative for no looping block
+    explicit GifImageWriter(std::ostream &output, unsigned int delay = 10, int loopCount = 0, bool dither = false)
+            : output_(output), delay_(delay), loopCount_(loopCount), dither_(dither) {}
+
+    GifImageWriter(const GifImageWriter &) = delete;
+    GifImageWriter &operator=(const GifImageWriter &) = delete;
+
+    virtual ~GifImageWriter() {
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+
+    // sets palette used for all frames, has to be called before the first frame
+    void setPalette(const std::vector<RgbColor> &palette) {
+        if (frameCount_ > 0)
+            throw std::logic_error("GifImageWriter: palette cannot be changed after first frame");
+        if (palette.empty() || palette.size() > 256)
+            throw std::invalid_argument("GifImageWriter: palette has to have 1..256 colors");
+        palette_ = palette;
+        exactPalette_ = false;
+    }
+
+    const std::vector<RgbColor> &palette() const {
+        return palette_;
+    }
+
+    virtual void writeImage(PixelImageBase &image) {
+        writeFrame(image, delay_);
+    }
+
+    // appends frame shown for `delay` 1/100 s; size of all frames has to be equal to size of the first one
+    void writeFrame(const PixelImageBase &image, unsigned int delay) {
+        if (finished_)
+            throw std::logic_error("GifImageWriter: writer already finished");
+        if (image.width() == 0 || image.height() == 0 || image.width() > 0xFFFF || image.height() > 0xFFFF)
+            throw std::invalid_argument("GifImageWriter: invalid image size");
+        if (frameCount_ == 0) {
+            start(image);
+        } else if (image.width() != width_ || image.height() != height_) {
+            throw std::invalid_argument("GifImageWriter: frame size differs from first frame");
+        }
+
+        bool dither = dither_ && !exactPalette_;
+        std::vector<unsigned char> &indices = frameCount_ == 0 ? previous_ : current_;
+        for (unsigned int y = 0; y < height_; ++y) {
+            const unsigned char *rgb = image.readRow(y, rowBuffer_.data());
+            mapper_->mapRow(rgb, width_, y, dither, indices.data() + static_cast<size_t>(y) * width_);
+        }
+
+        unsigned int left = 0, top = 0, right = width_, bottom = height_;
+        if (frameCount_ > 0) {
+            changedRect(left, top, right, bottom);
+            previous_.swap(current_);
+        }
+        writeFrameBlock(left, top, right, bottom, delay);
+        ++frameCount_;
+    }
+
+    // writes trailer, no frames can be added afterwards
+    void finish() {
+        if (finished_)
+            return;
+        finished_ = true;
+        if (frameCount_ == 0)
+            return;
+        output_.put(0x3B);
+        output_.flush();
+        if (!output_)
+            throw std::runtime_error("GifImageWriter: cannot write output");
+    }
+
+    size_t frameCount() const {
+        return frameCount_;
+    }
+
+private:
+    void start(const PixelImageBase &image) {
+        width_ = image.width();
+        height_ = image.height();
+        if (palette_.empty()) {
+            // dithering is skipped when the first frame fits in the palette exactly (charts)
+            palette_ = MedianCutQuantizer::buildPalette(image, 256, &exactPalette_);
+        }
+
+        mapper_.reset(new PaletteMapper(palette_));
+        rowBuffer_.resize(static_cast<size_t>(width_) * 3);
+        previous_.resize(static_cast<size_t>(width_) * height_);
+        current_.resize(previous_.size());
+
+        tableBits_ = 1;
+        while ((1u << tableBits_) < palette_.size())
+            ++tableBits_;
+
+        std::vector<unsigned char> header;
+        header.insert(header.end(), {'G', 'I', 'F', '8', '9', 'a'});
+        putUint16(header, width_);
+        putUint16(header, height_);
+        header.push_back(static_cast<unsigned char>(0xF0 | (tableBits_ - 1)));
+        header.push_back(0); // background color index
+        header.push_back(0); // pixel aspect ratio
+        for (unsigned int i = 0; i < (1u << tableBits_); ++i) {
+            RgbColor color = i < palette_.size() ? palette_[i] : RgbColor::make_rgb(0, 0, 0);
+            header.insert(header.end(), {color.red, color.green, color.blue});
+        }
+
+        if (loopCount_ >= 0) {
+            header.insert(header.end(), {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01});
+            putUint16(header, static_cast<unsigned int>(std::min(loopCount_, 0xFFFF)));
+            header.push_back(0);
+        }
+        writeBytes(header);
+    }
+
+    // bounding rectangle of indices which differ between previous_ and current_; 1x1 if nothing changed
+    void changedRect(unsigned int &left, unsigned int &top, unsigned int &right, unsigned int &bottom) const {
+        size_t rowSize = width_;
+        top = 0;
+        while (top < height_ && memcmp(&previous_[top * rowSize], &current_[top * rowSize], rowSize) == 0)
+            ++top;
+        if (top == height_) {
+            left = top = 0;
+            right = bottom = 1;
+            return;
+        }
+        bottom = height_;
+        while (memcmp(&previous_[(bottom - 1) * rowSize], &current_[(bottom - 1) * rowSize], rowSize) == 0)
+            --bottom;
+
+        left = width_;
+        right = 0;
+        for (unsigned int y = top; y < bottom; ++y) {
+            const unsigned char *a = &previous_[y * rowSize], *b = &current_[y * rowSize];
+            unsigned int x = 0;
+            while (x < left && a[x] == b[x])
+                ++x;
+            left = std::min(left, x);
+            unsigned int end = width_;
+            while (end > right && a[end - 1] == b[end - 1])
+                --end;
+            right = std::max(right, end);
+        }
+    }
+
+    // graphic control extension, image descriptor and compressed indices of rectangle of previous_
+    void writeFrameBlock(unsigned int left, unsigned int top, unsigned int right, unsigned int bottom, unsigned int delay) {
+        block_.clear();
+        // disposal method 1: leave frame in place, next frame is drawn over it
+        block_.insert(block_.end(), {0x21, 0xF9, 0x04, 0x04});
+        putUint16(block_, std::min(delay, 0xFFFFu));
+        block_.insert(block_.end(), {0x00, 0x00});
+
+        block_.push_back(0x2C);
+        putUint16(block_, left);
+        putUint16(block_, top);
+        putUint16(block_, right - left);
+        putUint16(block_, bottom - top);
+        block_.push_back(0x00);
+
+        const unsigned char *data = previous_.data();
+        if (right - left != width_) {
+            rect_.clear();
+            for (unsigned int y = top; y < bottom; ++y)
+                rect_.insert(rect_.end(), data + static_cast<size_t>(y) * width_ + left, data + static_cast<size_t>(y) * width_ + right);
+            data = rect_.data();
+        } else {
+            data += static_cast<size_t>(top) * width_;
+        }
+
+        unsigned int minCodeSize = std::max(2u, tableBits_);
+        block_.push_back(static_cast<unsigned char>(minCodeSize));
+        lzw_.encode(data, static_cast<size_t>(right - left) * (bottom - top), minCodeSize, block_);
+        writeBytes(block_);
+    }
+
+    static void putUint16(std::vector<unsigned char> &output, unsigned int value) {
+        output.push_back(static_cast<unsigned char>(value & 0xFF));
+        output.push_back(static_cast<unsigned char>((value >> 8) & 0xFF));
+    }
+
+    void writeBytes(const std::vector<unsigned char> &bytes) {
+        output_.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!output_)
+            throw std::runtime_error("GifImageWriter: cannot write output");
+    }
+
+    std::ostream &output_;
+    unsigned int delay_;
+    int loopCount_;
+    bool dither_;
+    bool exactPalette_ = false;
+    bool finished_ = false;
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    unsigned int tableBits_ = 1;
+    size_t frameCount_ = 0;
+    std::vector<RgbColor> palette_;
+    std::unique_ptr<PaletteMapper> mapper_;
+    std::vector<unsigned char> rowBuffer_;
+    std::vector<unsigned char> previous_; // palette indices of last written frame
+    std::vector<unsigned char> current_;
+    std::vector<unsigned char> rect_;
+    std::vector<unsigned char> block_;
+    GifLzwEncoder lzw_;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef __UIMG_GRAY_IMAGE_H__
+#define __UIMG_GRAY_IMAGE_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/utils/aligned_allocator.h"
+#include "uimg/utils/cast.h"
+#include "uimg/utils/color_utils.h"
+
+// Grayscale in-memory image container with one sample per pixel: 8-bit (GrayImage) or 16-bit (GrayImage16).
+// Samples are stored in native byte order, rows `stride()` bytes apart (by default 64 byte aligned).
+// As PixelImageBase it reads gray colors (16-bit samples are reduced to 8 bits) and stores luminance
+// of written colors; use value / setValue to access samples at full precision.
+template<typename Sample>
+class GrayImageT : public PixelImageBase {
+public:
+    static constexpr unsigned int BYTES_PER_PIXEL = sizeof(Sample);
+    static constexpr size_t ROW_ALIGNMENT = 64;
+    static constexpr unsigned int MAX_VALUE = std::numeric_limits<Sample>::max();
+
+    // stride = 0 means default: row size rounded up to ROW_ALIGNMENT
+    GrayImageT(unsigned int width, unsigned int height, size_t stride = 0)
+            : width_(width), height_(height), stride_(stride ? stride : alignedStride(width)) {
+        if (stride_ < rowSize() || stride_ % sizeof(Sample) != 0)
+            throw std::invalid_argument("GrayImage: invalid stride");
+        data_.resize(stride_ * height_);
+    }
+
+    // returns row size rounded up to given alignment (power of two)
+    static size_t alignedStride(unsigned int width, size_t alignment = ROW_ALIGNMENT) {
+        size_t size = static_cast<size_t>(width) * BYTES_PER_PIXEL;
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    virtual unsigned int width() const {
+        return width_;
+    }
+
+    virtual unsigned int height() const {
+        return height_;
+    }
+
+    virtual Point getSize() const {
+        return Point(static_cast<int>(width_), static_cast<int>(height_));
+    }
+
+    // distance in bytes between starts of two consecutive rows
+    size_t stride() const {
+        return stride_;
+    }
+
+    // number of bytes used by samples of one row
+    size_t rowSize() const {
+        return static_cast<size_t>(width_) * BYTES_PER_PIXEL;
+    }
+
+    Sample *row(unsigned int y) {
+        return reinterpret_cast<Sample *>(data_.data() + static_cast<size_t>(y) * stride_);
+    }
+
+    const Sample *row(unsigned int y) const {
+        return reinterpret_cast<const Sample *>(data_.data() + static_cast<size_t>(y) * stride_);
+    }
+
+    // sample at given position, 0 outside of image
+    Sample value(const Point &pos) const {
+        return isInside(pos) ? row(UNSIGNED_CAST(unsigned int, pos.y))[pos.x] : Sample(0);
+    }
+
+    void setValue(const Point &pos, Sample sample) {
+        if (isInside(pos))
+            row(UNSIGNED_CAST(unsigned int, pos.y))[pos.x] = sample;
+    }
+
+    virtual RgbColor getPixel(const Point &pos) const {
+        unsigned char level = toByte(value(pos));
+        RgbColor result;
+        result.red = result.green = result.blue = level;
+        return result;
+    }
+
+    virtual void setPixel(const Point &pos, const RgbColor &color) {
+        setValue(pos, fromByte(color_utils::luminance(color)));
+    }
+
+    virtual const unsigned char *readRow(unsigned int y, unsigned char *buffer) const {
+        const Sample *src = row(y);
+        unsigned char *dst = buffer;
+        for (unsigned int x = 0; x < width_; ++x, dst += 3)
+            dst[0] = dst[1] = dst[2] = toByte(src[x]);
+        return buffer;
+    }
+
+    virtual void writeRow(unsigned int y, unsigned int x, unsigned int count, const unsigned char *rgb) {
+        if (y >= height_ || x >= width_)
+            return;
+        Sample *dst = row(y) + x;
+        for (unsigned int i = 0, end = std::min(count, width_ - x); i < end; ++i, rgb += 3)
+            dst[i] = fromByte(color_utils::luminance(rgb[0], rgb[1], rgb[2]));
+    }
+
+    void fill(Sample sample) {
+        for (unsigned int y = 0; y < height_; ++y)
+            std::fill(row(y), row(y) + width_, sample);
+    }
+
+    // returns raw pointer to internal data (first row)
+    void *data() {
+        return data_.data();
+    }
+
+    // returns size in bytes of data, including row padding (stride * height)
+    size_t dataSize() const {
+        return data_.size();
+    }
+
+    // 8-bit level of sample
+    static unsigned char toByte(Sample sample) {
+        return static_cast<unsigned char>(sample >> (8 * (sizeof(Sample) - 1)));
+    }
+
+    // sample of 8-bit level (0..255 mapped to 0..MAX_VALUE)
+    static Sample fromByte(unsigned char level) {
+        return static_cast<Sample>(static_cast<unsigned int>(level) * (MAX_VALUE / 255u));
+    }
+
+private:
+    bool isInside(const Point &pos) const {
+        return pos.x >= 0 && pos.y >= 0 &&
+               UNSIGNED_CAST(unsigned int, pos.x) < width_ &&
+               UNSIGNED_CAST(unsigned int, pos.y) < height_;
+    }
+
+    unsigned int width_;
+    unsigned int height_;
+    size_t stride_;
+    std::vector<unsigned char, AlignedAllocator<unsigned char, ROW_ALIGNMENT>> data_;
+};
+
+using GrayImage = GrayImageT<uint8_t>;
+using GrayImage16 = GrayImageT<uint16_t>;
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef __UIMG_IMAGE_VIEW_H__
+#define __UIMG_IMAGE_VIEW_H__
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+
+// Zero-copy window into rectangular part of other RGB image (RgbImage or another ImageView).
+// View shares pixel memory with its parent (pointer + parent stride), pixel (0,0) of view is
+// pixel `offset()` of parent. Painting into a view never touches pixels outside of its window,
+// so views of disjoint windows can be painted in parallel.
+// View does not own memory - parent image must outlive it.
+class ImageView : public RgbImageBase {
+public:
+    // view of whole image
+    explicit ImageView(RgbImageBase &parent) : offset_(0, 0) {
+        setLayout(parent.row(0), parent.width(), parent.height(), parent.stride());
+    }
+
+    // view of window with top-left corner at `offset` (must be inside of parent) and given size,
+    // size is reduced to fit inside of parent
+    ImageView(RgbImageBase &parent, const Point &offset, const Point &size) : offset_(offset) {
+        if (offset.x < 0 || offset.y < 0 || size.x < 0 || size.y < 0)
+            throw std::invalid_argument("ImageView: negative window position or size");
+
+        unsigned int x = UNSIGNED_CAST(unsigned int, offset.x);
+        unsigned int y = UNSIGNED_CAST(unsigned int, offset.y);
+        unsigned int viewWidth = x < parent.width() ? std::min(parent.width() - x, UNSIGNED_CAST(unsigned int, size.x)) : 0;
+        unsigned int viewHeight = y < parent.height() ? std::min(parent.height() - y, UNSIGNED_CAST(unsigned int, size.y)) : 0;
+
+        if (viewWidth == 0 || viewHeight == 0) {
+            setLayout(nullptr, 0, 0, parent.stride());
+            return;
+        }
+
+        setLayout(parent.row(y) + static_cast<size_t>(x) * BYTES_PER_PIXEL, viewWidth, viewHeight, parent.stride());
+    }
+
+    // view of window given by inclusive rectangle
+    ImageView(RgbImageBase &parent, const RectInclusive &rect)
+            : ImageView(parent, rect.topLeft(), Point(rect.x2 - rect.x1 + 1, rect.y2 - rect.y1 + 1)) {}
+
+    // position of view inside of its direct parent
+    Point offset() const {
+        return offset_;
+    }
+
+private:
+    Point offset_;
+};
+
+#endif
@@ -0,0 +1,553 @@
+#ifndef __UIMG_JPEG_IMAGE_H__
+#define __UIMG_JPEG_IMAGE_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "uimg/images/pixel_image.h"
+#include "uimg/utils/thread_pool.h"
+
+// Tables and transforms of baseline (sequential, Huffman coded, 8-bit) JPEG, ITU-T T.81.
+class JpegFormat {
+public:
+    // natural (row-major) index of coefficients in zig-zag order
+    static constexpr unsigned char ZIGZAG[64] = {
+            0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+            12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+            35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+            58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+    // example quantization tables of Annex K.1, natural order
+    static constexpr unsigned char LUMA_QUANT[64] = {
+            16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55,
+            14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62,
+            18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92,
+            49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+    static constexpr unsigned char CHROMA_QUANT[64] = {
+            17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+            24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+
+    // standard Huffman tables of Annex K.3: number of codes of each length 1..16, then symbols
+    static constexpr unsigned char DC_LUMA_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+    static constexpr unsigned char DC_CHROMA_BITS[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+    static constexpr unsigned char DC_VALUES[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    static constexpr unsigned char AC_LUMA_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D};
+    static constexpr unsigned char AC_LUMA_VALUES[162] = {
+            0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+            0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+            0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+            0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+            0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+            0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+            0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+            0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+            0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+            0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+            0xF9, 0xFA};
+    static constexpr unsigned char AC_CHROMA_BITS[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+    static constexpr unsigned char AC_CHROMA_VALUES[162] = {
+            0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+            0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+            0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+            0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+            0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+            0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+            0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+            0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+            0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+            0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+            0xF9, 0xFA};
+
+    // quantization table for quality 1..100 (IJG scaling of Annex K tables), natural order
+    static void scaleQuantTable(const unsigned char *base, unsigned int quality, unsigned char *output) {
+        quality = std::min(100u, std::max(1u, quality));
+        unsigned int scale = quality < 50 ? 5000 / quality : 200 - 2 * quality;
+        for (unsigned int i = 0; i < 64; ++i)
+            output[i] = static_cast<unsigned char>(std::min(255u, std::max(1u, (base[i] * scale + 50) / 100)));
+    }
+
+    // Forward DCT of 8x8 block of level shifted samples (AAN algorithm in 12-bit fixed point).
+    // Both passes work on eight columns at once with no dependency between them, so compilers vectorize
+    // them with SSE2 / AVX2 / NEON. Output is transposed (index u * 8 + v for horizontal frequency u and
+    // vertical frequency v) and scaled by OUTPUT_SCALE * AAN_SCALE[u] * AAN_SCALE[v] - both are handled by quantizer.
+    static void forwardDct(int32_t *block) {
+        // two fraction bits are kept through both passes, to limit rounding errors of fixed point multiplications
+        for (int i = 0; i < 64; ++i)
+            block[i] *= 4;
+        dctColumns(block);
+        transpose(block);
+        dctColumns(block);
+    }
+
+    static constexpr double OUTPUT_SCALE = 32.0;
+    static constexpr double AAN_SCALE[8] = {1.0, 1.387039845, 1.306562965, 1.175875602,
+                                            1.0, 0.785694958, 0.541196100, 0.275899379};
+
+private:
+    static constexpr int CONST_BITS = 12;
+    static constexpr int32_t FIX_0_382683433 = 1567;
+    static constexpr int32_t FIX_0_541196100 = 2217;
+    static constexpr int32_t FIX_0_707106781 = 2896;
+    static constexpr int32_t FIX_1_306562965 = 5352;
+
+    static int32_t multiply(int32_t value, int32_t constant) {
+        return (value * constant + (1 << (CONST_BITS - 1))) >> CONST_BITS;
+    }
+
+    // 1-D DCT of every column
+    static void dctColumns(int32_t *data) {
+        for (int i = 0; i < 8; ++i) {
+            int32_t tmp0 = data[i] + data[56 + i], tmp7 = data[i] - data[56 + i];
+            int32_t tmp1 = data[8 + i] + data[48 + i], tmp6 = data[8 + i] - data[48 + i];
+            int32_t tmp2 = data[16 + i] + data[40 + i], tmp5 = data[16 + i] - data[40 + i];
+            int32_t tmp3 = data[24 + i] + data[32 + i], tmp4 = data[24 + i] - data[32 + i];
+
+            // even part
+            int32_t tmp10 = tmp0 + tmp3, tmp13 = tmp0 - tmp3;
+            int32_t tmp11 = tmp1 + tmp2, tmp12 = tmp1 - tmp2;
+            data[i] = tmp10 + tmp11;
+            data[32 + i] = tmp10 - tmp11;
+            int32_t z1 = multiply(tmp12 + tmp13, FIX_0_707106781);
+            data[16 + i] = tmp13 + z1;
+            data[48 + i] = tmp13 - z1;
+
+            // odd part
+            tmp10 = tmp4 + tmp5;
+            tmp11 = tmp5 + tmp6;
+            tmp12 = tmp6 + tmp7;
+            int32_t z5 = multiply(tmp10 - tmp12, FIX_0_382683433);
+            int32_t z2 = multiply(tmp10, FIX_0_541196100) + z5;
+            int32_t z4 = multiply(tmp12, FIX_1_306562965) + z5;
+            int32_t z3 = multiply(tmp11, FIX_0_707106781);
+            int32_t z11 = tmp7 + z3, z13 = tmp7 - z3;
+            data[40 + i] = z13 + z2;
+            data[24 + i] = z13 - z2;
+            data[8 + i] = z11 + z4;
+            data[56 + i] = z11 - z4;
+        }
+    }
+
+    static void transpose(int32_t *data) {
+        for (int y = 0; y < 8; ++y)
+            for (int x = y + 1; x < 8; ++x)
+                std::swap(data[y * 8 + x], data[x * 8 + y]);
+    }
+};
+
+// Huffman code table for encoding: code and its length for each symbol
+class JpegHuffmanTable {
+public:
+    JpegHuffmanTable(const unsigned char *bits, const unsigned char *values) : bits_(bits), values_(values) {
+        memset(codes_, 0, sizeof(codes_));
+        memset(sizes_, 0, sizeof(sizes_));
+        unsigned int code = 0, index = 0;
+        for (unsigned int length = 1; length <= 16; ++length) {
+            for (unsigned int i = 0; i < bits[length - 1]; ++i, ++index, ++code) {
+                codes_[values[index]] = static_cast<uint16_t>(code);
+                sizes_[values[index]] = static_cast<unsigned char>(length);
+            }
+            code <<= 1;
+        }
+        valueCount_ = index;
+    }
+
+    uint16_t code(unsigned int symbol) const {
+        return codes_[symbol];
+    }
+
+    unsigned int size(unsigned int symbol) const {
+        return sizes_[symbol];
+    }
+
+    // DHT segment content of table: counts of code lengths and symbols
+    void appendDefinition(std::vector<unsigned char> &output) const {
+        output.insert(output.end(), bits_, bits_ + 16);
+        output.insert(output.end(), values_, values_ + valueCount_);
+    }
+
+    unsigned int valueCount() const {
+        return valueCount_;
+    }
+
+private:
+    const unsigned char *bits_;
+    const unsigned char *values_;
+    unsigned int valueCount_;
+    uint16_t codes_[256];
+    unsigned char sizes_[256];
+};
+
+// class which writes RGB image as baseline JPEG (JFIF, YCbCr, 4:2:0 or 4:4:4 sampling, standard Huffman tables)
+// Image is split into strips of one MCU row (16 pixel rows for 4:2:0, 8 for 4:4:4) separated by restart markers,
+// so strips are entropy coded independently and in parallel. Only a batch of strips is kept in memory:
+// image can be written at once (writeImage) or in bands of rows as PixelImageStreamWriter (e.g. from
+// BandedRenderer). Output does not depend on number of threads or on how rows are passed to writeRows().
+class JpegImageWriter : public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    static constexpr unsigned int DEFAULT_QUALITY = 85;
+
+    // threadCount = 0 means one thread per hardware core; subsampling = false writes full resolution chroma
+    JpegImageWriter(std::ostream &output, unsigned int quality = DEFAULT_QUALITY, bool subsampling = true,
+                    unsigned int threadCount = 0)
+            : output_(output), subsampling_(subsampling),
+              dcLuma_(JpegFormat::DC_LUMA_BITS, JpegFormat::DC_VALUES),
+              acLuma_(JpegFormat::AC_LUMA_BITS, JpegFormat::AC_LUMA_VALUES),
+              dcChroma_(JpegFormat::DC_CHROMA_BITS, JpegFormat::DC_VALUES),
+              acChroma_(JpegFormat::AC_CHROMA_BITS, JpegFormat::AC_CHROMA_VALUES) {
+        JpegFormat::scaleQuantTable(JpegFormat::LUMA_QUANT, quality, lumaQuant_);
+        JpegFormat::scaleQuantTable(JpegFormat::CHROMA_QUANT, quality, chromaQuant_);
+        prepareScales(lumaQuant_, lumaScales_);
+        prepareScales(chromaQuant_, chromaScales_);
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        if (threadCount > 1)
+            pool_.reset(new ThreadPool(threadCount));
+        batchStrips_ = 2 * threadCount;
+    }
+
+    virtual void writeImage(PixelImageBase &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        if (width == 0 || height == 0 || width > 0xFFFF || height > 0xFFFF)
+            throw std::invalid_argument("JpegImageWriter: image size has to be in range 1..65535");
+
+        width_ = width;
+        height_ = height;
+        rowsWritten_ = 0;
+        stripsWritten_ = 0;
+        mcuSize_ = subsampling_ ? 16 : 8;
+        mcusPerRow_ = (width + mcuSize_ - 1) / mcuSize_;
+        stripCount_ = (height + mcuSize_ - 1) / mcuSize_;
+        rows_.resize(static_cast<size_t>(batchStrips_) * mcuSize_ * rowSize());
+        bufferedRows_ = 0;
+        writeHeaders();
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        if (rows.width() != width_)
+            throw std::invalid_argument("JpegImageWriter: row width differs from image width");
+        if (rows.height() > height_ - rowsWritten_)
+            throw std::invalid_argument("JpegImageWriter: too many rows");
+
+        size_t size = rowSize();
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            unsigned char *slot = rows_.data() + bufferedRows_ * size;
+            const unsigned char *row = rows.readRow(y, slot);
+            if (row != slot)
+                memcpy(slot, row, size);
+            ++bufferedRows_;
+            ++rowsWritten_;
+            if (bufferedRows_ == static_cast<size_t>(batchStrips_) * mcuSize_)
+                encodeBuffered();
+        }
+    }
+
+    virtual void endImage() {
+        if (rowsWritten_ != height_)
+            throw std::runtime_error("JpegImageWriter: image is incomplete");
+
+        // last strip is completed by repeating last row
+        size_t size = rowSize();
+        while (bufferedRows_ % mcuSize_ != 0) {
+            memcpy(rows_.data() + bufferedRows_ * size, rows_.data() + (bufferedRows_ - 1) * size, size);
+            ++bufferedRows_;
+        }
+        encodeBuffered();
+
+        static const unsigned char EOI[] = {0xFF, 0xD9};
+        output_.write(reinterpret_cast<const char *>(EOI), sizeof(EOI));
+        output_.flush();
+        if (!output_)
+            throw std::runtime_error("JpegImageWriter: cannot write output");
+    }
+
+private:
+    // Huffman coded bits with byte stuffing (0x00 after each 0xFF byte)
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<unsigned char> &output) : output_(output) {}
+
+        void put(uint32_t bits, unsigned int count) {
+            buffer_ = (buffer_ << count) | (bits & ((1u << count) - 1));
+            count_ += count;
+            while (count_ >= 8) {
+                count_ -= 8;
+                unsigned char byte = static_cast<unsigned char>(buffer_ >> count_);
+                output_.push_back(byte);
+                if (byte == 0xFF)
+                    output_.push_back(0);
+            }
+        }
+
+        // pads last byte with one bits
+        void flush() {
+            if (count_ > 0)
+                put(0x7F, 8 - count_);
+        }
+
+    private:
+        std::vector<unsigned char> &output_;
+        uint64_t buffer_ = 0;
+        unsigned int count_ = 0;
+    };
+
+    size_t rowSize() const {
+        return static_cast<size_t>(width_) * 3;
+    }
+
+    // quantizer multipliers in layout of forwardDct output, AAN scaling included
+    static void prepareScales(const unsigned char *quant, float *scales) {
+        for (unsigned int u = 0; u < 8; ++u)
+            for (unsigned int v = 0; v < 8; ++v)
+                scales[u * 8 + v] = static_cast<float>(
+                        1.0 / (quant[v * 8 + u] * JpegFormat::AAN_SCALE[u] * JpegFormat::AAN_SCALE[v] * JpegFormat::OUTPUT_SCALE));
+    }
+
+    static void putUint16(std::vector<unsigned char> &output, unsigned int value) {
+        output.push_back(static_cast<unsigned char>(value >> 8));
+        output.push_back(static_cast<unsigned char>(value & 0xFF));
+    }
+
+    static void beginSegment(std::vector<unsigned char> &output, unsigned char marker, unsigned int length) {
+        output.push_back(0xFF);
+        output.push_back(marker);
+        putUint16(output, length);
+    }
+
+    void writeHeaders() {
+        std::vector<unsigned char> header = {0xFF, 0xD8};
+
+        // JFIF APP0, no thumbnail, aspect ratio 1:1
+        beginSegment(header, 0xE0, 16);
+        header.insert(header.end(), {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0});
+
+        beginSegment(header, 0xDB, 2 + 2 * 65);
+        header.push_back(0);
+        for (unsigned int i = 0; i < 64; ++i)
+            header.push_back(lumaQuant_[JpegFormat::ZIGZAG[i]]);
+        header.push_back(1);
+        for (unsigned int i = 0; i < 64; ++i)
+            header.push_back(chromaQuant_[JpegFormat::ZIGZAG[i]]);
+
+        beginSegment(header, 0xC0, 17);
+        header.push_back(8);
+        putUint16(header, height_);
+        putUint16(header, width_);
+        header.push_back(3);
+        header.insert(header.end(), {1, static_cast<unsigned char>(subsampling_ ? 0x22 : 0x11), 0});
+        header.insert(header.end(), {2, 0x11, 1, 3, 0x11, 1});
+
+        const JpegHuffmanTable *tables[] = {&dcLuma_, &acLuma_, &dcChroma_, &acChroma_};
+        const unsigned char classes[] = {0x00, 0x10, 0x01, 0x11};
+        unsigned int length = 2;
+        for (const JpegHuffmanTable *table : tables)
+            length += 17 + table->valueCount();
+        beginSegment(header, 0xC4, length);
+        for (unsigned int i = 0; i < 4; ++i) {
+            header.push_back(classes[i]);
+            tables[i]->appendDefinition(header);
+        }
+
+        // restart interval: one strip
+        beginSegment(header, 0xDD, 4);
+        putUint16(header, mcusPerRow_);
+
+        beginSegment(header, 0xDA, 12);
+        header.insert(header.end(), {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0});
+
+        output_.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+    }
+
+    // encodes buffered strips (in parallel) and writes them with restart markers between them
+    void encodeBuffered() {
+        size_t strips = bufferedRows_ / mcuSize_;
+        if (strips == 0)
+            return;
+
+        std::vector<std::vector<unsigned char>> encoded(strips);
+        auto encode = [this, &encoded](size_t index) {
+            encodeStrip(rows_.data() + index * mcuSize_ * rowSize(), encoded[index]);
+        };
+        if (pool_ && strips > 1) {
+            for (size_t i = 0; i < strips; ++i)
+                pool_->submit([&encode, i]() { encode(i); });
+            pool_->wait();
+        } else {
+            for (size_t i = 0; i < strips; ++i)
+                encode(i);
+        }
+
+        for (size_t i = 0; i < strips; ++i, ++stripsWritten_) {
+            std::vector<unsigned char> &data = encoded[i];
+            if (stripsWritten_ + 1 < stripCount_)
+                data.insert(data.end(), {0xFF, static_cast<unsigned char>(0xD0 + stripsWritten_ % 8)});
+            output_.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        }
+        if (!output_)
+            throw std::runtime_error("JpegImageWriter: cannot write output");
+        bufferedRows_ = 0;
+    }
+
+    // converts one MCU row of RGB pixels to Y, Cb, Cr planes and entropy codes its blocks
+    void encodeStrip(const unsigned char *rgb, std::vector<unsigned char> &output) const {
+        const size_t planeWidth = static_cast<size_t>(mcusPerRow_) * mcuSize_;
+        std::vector<unsigned char> luma(planeWidth * mcuSize_), cb(luma.size()), cr(luma.size());
+        for (unsigned int y = 0; y < mcuSize_; ++y) {
+            const unsigned char *row = rgb + y * rowSize();
+            size_t offset = y * planeWidth;
+            convertRow(row, width_, &luma[offset], &cb[offset], &cr[offset]);
+            // right edge is completed by repeating last column
+            std::fill(&luma[offset + width_], &luma[offset] + planeWidth, luma[offset + width_ - 1]);
+            std::fill(&cb[offset + width_], &cb[offset] + planeWidth, cb[offset + width_ - 1]);
+            std::fill(&cr[offset + width_], &cr[offset] + planeWidth, cr[offset + width_ - 1]);
+        }
+
+        size_t chromaWidth = planeWidth;
+        if (subsampling_) {
+            chromaWidth = planeWidth / 2;
+            downsample(cb, planeWidth);
+            downsample(cr, planeWidth);
+        }
+
+        output.reserve(planeWidth * mcuSize_ / 4);
+        BitWriter writer(output);
+        int predictors[3] = {0, 0, 0};
+        int32_t block[64];
+        for (unsigned int mcu = 0; mcu < mcusPerRow_; ++mcu) {
+            size_t left = static_cast<size_t>(mcu) * mcuSize_;
+            for (unsigned int by = 0; by < mcuSize_; by += 8)
+                for (unsigned int bx = 0; bx < mcuSize_; bx += 8) {
+                    loadBlock(&luma[by * planeWidth + left + bx], planeWidth, block);
+                    encodeBlock(block, lumaScales_, dcLuma_, acLuma_, predictors[0], writer);
+                }
+            size_t chromaLeft = static_cast<size_t>(mcu) * 8;
+            loadBlock(&cb[chromaLeft], chromaWidth, block);
+            encodeBlock(block, chromaScales_, dcChroma_, acChroma_, predictors[1], writer);
+            loadBlock(&cr[chromaLeft], chromaWidth, block);
+            encodeBlock(block, chromaScales_, dcChroma_, acChroma_, predictors[2], writer);
+        }
+        writer.flush();
+    }
+
+    // JFIF YCbCr (BT.601 full range) in 16-bit fixed point
+    static void convertRow(const unsigned char *rgb, size_t width, unsigned char *luma, unsigned char *cb, unsigned char *cr) {
+        for (size_t x = 0; x < width; ++x) {
+            const unsigned char *pixel = rgb + 3 * x;
+            int32_t r = pixel[0], g = pixel[1], b = pixel[2];
+            luma[x] = static_cast<unsigned char>((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+            cb[x] = static_cast<unsigned char>((-11059 * r - 21709 * g + 32768 * b + (128 << 16) + 32767) >> 16);
+            cr[x] = static_cast<unsigned char>((32768 * r - 27439 * g - 5329 * b + (128 << 16) + 32767) >> 16);
+        }
+    }
+
+    // averages 2x2 pixels of 16 rows into 8 rows of half width, in place
+    static void downsample(std::vector<unsigned char> &plane, size_t width) {
+        size_t half = width / 2;
+        for (size_t y = 0; y < 8; ++y) {
+            const unsigned char *row0 = &plane[2 * y * width];
+            const unsigned char *row1 = row0 + width;
+            unsigned char *output = &plane[y * half];
+            for (size_t x = 0; x < half; ++x)
+                output[x] = static_cast<unsigned char>((row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1] + 2) >> 2);
+        }
+    }
+
+    static void loadBlock(const unsigned char *samples, size_t stride, int32_t *block) {
+        for (size_t y = 0; y < 8; ++y, samples += stride)
+            for (size_t x = 0; x < 8; ++x)
+                block[y * 8 + x] = static_cast<int32_t>(samples[x]) - 128;
+    }
+
+    // number of bits of magnitude of value (JPEG size category)
+    static unsigned int category(int value) {
+        unsigned int magnitude = static_cast<unsigned int>(value < 0 ? -value : value), bits = 0;
+        while (magnitude != 0) {
+            ++bits;
+            magnitude >>= 1;
+        }
+        return bits;
+    }
+
+    // negative values are written as one's complement of magnitude in `bits` bits
+    static uint32_t valueBits(int value, unsigned int bits) {
+        return static_cast<uint32_t>(value < 0 ? value - 1 : value) & ((1u << bits) - 1);
+    }
+
+    static void encodeBlock(int32_t *block, const float *scales, const JpegHuffmanTable &dcTable,
+                            const JpegHuffmanTable &acTable, int &predictor, BitWriter &writer) {
+        JpegFormat::forwardDct(block);
+
+        int quantized[64];
+        for (int i = 0; i < 64; ++i)
+            quantized[i] = static_cast<int>(static_cast<float>(block[i]) * scales[i] + 16384.5f) - 16384;
+
+        // coefficients in zig-zag order, forwardDct output is transposed
+        int coefficients[64];
+        for (int i = 0; i < 64; ++i) {
+            unsigned int natural = JpegFormat::ZIGZAG[i];
+            coefficients[i] = quantized[(natural % 8) * 8 + natural / 8];
+        }
+
+        int difference = coefficients[0] - predictor;
+        predictor = coefficients[0];
+        unsigned int bits = category(difference);
+        writer.put(dcTable.code(bits), dcTable.size(bits));
+        if (bits > 0)
+            writer.put(valueBits(difference, bits), bits);
+
+        unsigned int run = 0;
+        for (int i = 1; i < 64; ++i) {
+            int value = coefficients[i];
+            if (value == 0) {
+                ++run;
+                continue;
+            }
+            for (; run >= 16; run -= 16)
+                writer.put(acTable.code(0xF0), acTable.size(0xF0));
+            bits = category(value);
+            unsigned int symbol = (run << 4) | bits;
+            writer.put(acTable.code(symbol), acTable.size(symbol));
+            writer.put(valueBits(value, bits), bits);
+            run = 0;
+        }
+        if (run > 0)
+            writer.put(acTable.code(0x00), acTable.size(0x00));
+    }
+
+    std::ostream &output_;
+    bool subsampling_;
+    unsigned char lumaQuant_[64];
+    unsigned char chromaQuant_[64];
+    float lumaScales_[64];
+    float chromaScales_[64];
+    JpegHuffmanTable dcLuma_;
+    JpegHuffmanTable acLuma_;
+    JpegHuffmanTable dcChroma_;
+    JpegHuffmanTable acChroma_;
+    std::unique_ptr<ThreadPool> pool_;
+    unsigned int batchStrips_ = 1;
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    unsigned int rowsWritten_ = 0;
+    unsigned int mcuSize_ = 16;
+    unsigned int mcusPerRow_ = 0;
+    unsigned int stripCount_ = 0;
+    unsigned int stripsWritten_ = 0;
+    size_t bufferedRows_ = 0;
+    std::vector<unsigned char> rows_; // RGB rows of strips waiting for encoding
+};
+
+#endif
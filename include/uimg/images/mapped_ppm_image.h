@@ -0,0 +1,137 @@
+#ifndef __UIMG_MAPPED_PPM_IMAGE_H__
+#define __UIMG_MAPPED_PPM_IMAGE_H__
+
+#include "uimg/base/platform.h"
+
+#if UIMG_HAS_POSIX
+
+#include <cctype>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/pixels/pixel_source.h"
+#include "uimg/utils/cast.h"
+#include "uimg/utils/mapped_file.h"
+
+// Read-only PPM (P6, maxval 255) image mapped into memory.
+// Pixels are read directly from the file mapping (no copy, no load step), only pages which are
+// actually accessed are read from disk - suitable for picking tiles out of very large files.
+// Throws std::runtime_error if file cannot be mapped or is not a valid binary PPM.
+class MappedPpmImage : public PixelSource {
+public:
+    static constexpr unsigned int BYTES_PER_PIXEL = 3;
+
+    explicit MappedPpmImage(const std::string &path) : file_(path), width_(0), height_(0), pixels_(nullptr) {
+        size_t offset = parseHeader(file_.data(), file_.size(), width_, height_);
+        size_t payload = static_cast<size_t>(width_) * height_ * BYTES_PER_PIXEL;
+        if (file_.size() - offset < payload)
+            throw std::runtime_error("MappedPpmImage: file too short: " + path);
+        pixels_ = file_.data() + offset;
+    }
+
+    unsigned int width() const {
+        return width_;
+    }
+
+    unsigned int height() const {
+        return height_;
+    }
+
+    virtual Point getSize() const {
+        return Point(static_cast<int>(width_), static_cast<int>(height_));
+    }
+
+    // number of bytes of one row (rows are not padded in PPM)
+    size_t rowSize() const {
+        return static_cast<size_t>(width_) * BYTES_PER_PIXEL;
+    }
+
+    // returns pointer to packed RGB pixels of row y inside of mapping
+    const unsigned char *row(unsigned int y) const {
+        return pixels_ + static_cast<size_t>(y) * rowSize();
+    }
+
+    virtual RgbColor getPixel(const Point &pos) const {
+        RgbColor r;
+        if (pos.x >= 0 && pos.y >= 0 &&
+            UNSIGNED_CAST(unsigned int, pos.x) < width_ &&
+            UNSIGNED_CAST(unsigned int, pos.y) < height_) {
+            const unsigned char *pixel = row(UNSIGNED_CAST(unsigned int, pos.y)) + static_cast<size_t>(pos.x) * BYTES_PER_PIXEL;
+            r.red = pixel[0];
+            r.green = pixel[1];
+            r.blue = pixel[2];
+        } else {
+            r.red = r.green = r.blue = 0;
+        }
+        return r;
+    }
+
+    // copies srcPart (inclusive) to output image, srcPart top-left corner is placed at targetOffset
+    // (same semantics as PpmImageLoader::loadImagePartInto)
+    void copyPartInto(PixelImageBase &outputImage, const Rect &srcPart, const Point &targetOffset) const {
+        RectInclusive area;
+        if (!PpmImageLoader::clipFragment(getSize(), srcPart, outputImage.getSize(), targetOffset, area))
+            return;
+
+        unsigned int count = UNSIGNED_CAST(unsigned int, area.x2 - area.x1 + 1);
+        for (int y = area.y1; y <= area.y2; ++y)
+            outputImage.writeRow(UNSIGNED_CAST(unsigned int, y - srcPart.y1 + targetOffset.y),
+                                 UNSIGNED_CAST(unsigned int, area.x1 - srcPart.x1 + targetOffset.x), count,
+                                 row(UNSIGNED_CAST(unsigned int, y)) + UNSIGNED_CAST(size_t, area.x1) * BYTES_PER_PIXEL);
+    }
+
+    // Parses "P6 <width> <height> 255" header (with optional comments) at start of `data`.
+    // Returns offset of pixel data, throws std::runtime_error if header is invalid.
+    static size_t parseHeader(const unsigned char *data, size_t size, unsigned int &width, unsigned int &height) {
+        if (size < 2 || data[0] != 'P' || data[1] != '6')
+            throw std::runtime_error("MappedPpmImage: not a binary PPM file");
+
+        size_t pos = 2;
+        unsigned long values[3];
+        for (unsigned long &value : values) {
+            skipWhitespaceAndComments(data, size, pos);
+            if (pos >= size || !isdigit(data[pos]))
+                throw std::runtime_error("MappedPpmImage: invalid header");
+            value = 0;
+            while (pos < size && isdigit(data[pos]) && value <= 0xFFFFFFFFul)
+                value = value * 10 + static_cast<unsigned long>(data[pos++] - '0');
+        }
+
+        if (values[0] > 0xFFFFFFFFul || values[1] > 0xFFFFFFFFul || values[2] != 255)
+            throw std::runtime_error("MappedPpmImage: unsupported image size or maxval");
+        // exactly one whitespace character separates header from pixel data
+        if (pos >= size || !isspace(data[pos]))
+            throw std::runtime_error("MappedPpmImage: invalid header");
+
+        width = static_cast<unsigned int>(values[0]);
+        height = static_cast<unsigned int>(values[1]);
+        return pos + 1;
+    }
+
+private:
+    static void skipWhitespaceAndComments(const unsigned char *data, size_t size, size_t &pos) {
+        while (pos < size) {
+            if (data[pos] == '#') {
+                while (pos < size && data[pos] != '\n')
+                    ++pos;
+            } else if (isspace(data[pos])) {
+                ++pos;
+            } else {
+                break;
+            }
+        }
+    }
+
+    MappedFile file_;
+    unsigned int width_;
+    unsigned int height_;
+    const unsigned char *pixels_;
+};
+
+#endif
+
+#endif
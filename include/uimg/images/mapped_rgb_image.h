@@ -0,0 +1,93 @@
+#ifndef __UIMG_MAPPED_RGB_IMAGE_H__
+#define __UIMG_MAPPED_RGB_IMAGE_H__
+
+#include "uimg/base/platform.h"
+
+#if UIMG_HAS_POSIX
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+
+#include "uimg/images/mapped_ppm_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/utils/mapped_file.h"
+
+// RGB image stored in a memory-mapped PPM (P6) file, for canvases larger than available RAM.
+// File is a valid PPM at all times: header is written when file is created and pixel rows follow it
+// without padding, so no final write pass is needed (call sync() to flush changes to disk).
+// As RgbImageBase it works with all RGB painters, image views and PPM writers; pages are loaded and
+// evicted by the OS on demand, adviseRows() / releaseRows() can be used to guide it.
+// Throws std::runtime_error if file cannot be created, opened or mapped.
+class MappedRgbImage : public RgbImageBase {
+public:
+    // creates (or overwrites) file with image of given size, pixels are black
+    MappedRgbImage(const std::string &path, unsigned int width, unsigned int height) {
+        char header[PpmImageWriter::MAX_HEADER_SIZE];
+        size_t headerSize = PpmImageWriter::formatHeader(width, height, header);
+        size_t payload = static_cast<size_t>(width) * height * BYTES_PER_PIXEL;
+
+        std::unique_ptr<MappedFile> file(new MappedFile(path, MappedFile::CREATE, headerSize + payload));
+        memcpy(file->data(), header, headerSize);
+        file_ = std::move(file);
+        setLayout(file_->data() + headerSize, width, height, static_cast<size_t>(width) * BYTES_PER_PIXEL);
+    }
+
+    // opens existing PPM file for reading and writing
+    explicit MappedRgbImage(const std::string &path) {
+        std::unique_ptr<MappedFile> file(new MappedFile(path, MappedFile::READ_WRITE));
+        unsigned int width, height;
+        size_t offset = MappedPpmImage::parseHeader(file->data(), file->size(), width, height);
+        if (file->size() - offset < static_cast<size_t>(width) * height * BYTES_PER_PIXEL)
+            throw std::runtime_error("MappedRgbImage: file too short: " + path);
+        file_ = std::move(file);
+        setLayout(file_->data() + offset, width, height, static_cast<size_t>(width) * BYTES_PER_PIXEL);
+    }
+
+    MappedRgbImage(const MappedRgbImage &) = delete;
+
+    MappedRgbImage &operator=(const MappedRgbImage &) = delete;
+
+    // passes madvise() hint (e.g. MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED) for rows y1..y2 (inclusive)
+    void adviseRows(unsigned int y1, unsigned int y2, int advice) const {
+        if (y1 > y2 || y1 >= height())
+            return;
+        y2 = std::min(y2, height() - 1);
+        file_->advise(rowOffset(y1), static_cast<size_t>(y2 - y1 + 1) * stride(), advice);
+    }
+
+    // writes rows y1..y2 (inclusive) to disk and lets OS drop them from memory,
+    // used when painting of a band of rows is finished
+    void releaseRows(unsigned int y1, unsigned int y2) {
+        if (y1 > y2 || y1 >= height())
+            return;
+        y2 = std::min(y2, height() - 1);
+        size_t offset = rowOffset(y1);
+        size_t length = static_cast<size_t>(y2 - y1 + 1) * stride();
+        file_->sync(offset, length);
+        file_->advise(offset, length, MADV_DONTNEED);
+    }
+
+    // flushes all changes to file
+    void sync() {
+        file_->sync();
+    }
+
+private:
+    // offset of row y from start of file
+    size_t rowOffset(unsigned int y) const {
+        return static_cast<size_t>(row(y) - file_->data());
+    }
+
+    std::unique_ptr<MappedFile> file_;
+};
+
+#endif
+
+#endif
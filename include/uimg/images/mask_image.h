@@ -0,0 +1,133 @@
+#ifndef __UIMG_MASK_IMAGE_H__
+#define __UIMG_MASK_IMAGE_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/utils/cast.h"
+#include "uimg/utils/color_utils.h"
+
+// 1-bit in-memory image (mask), eight pixels per byte.
+// Rows use PBM (P4) layout: the most significant bit of the first byte is the leftmost pixel and
+// a set bit means black, so rows are read and written from PBM files without conversion.
+// As PixelImageBase it reads black or white colors and sets bit for dark colors (luminance < 128),
+// which makes it usable as mask source of MaskEqFilter / MaskDiffFilter.
+class MaskImage : public PixelImageBase {
+public:
+    MaskImage(unsigned int width, unsigned int height)
+            : width_(width), height_(height), stride_((static_cast<size_t>(width) + 7) / 8) {
+        data_.resize(stride_ * height_);
+    }
+
+    virtual unsigned int width() const {
+        return width_;
+    }
+
+    virtual unsigned int height() const {
+        return height_;
+    }
+
+    virtual Point getSize() const {
+        return Point(static_cast<int>(width_), static_cast<int>(height_));
+    }
+
+    // number of bytes of one row (rows are not padded beyond the last byte)
+    size_t stride() const {
+        return stride_;
+    }
+
+    unsigned char *row(unsigned int y) {
+        return data_.data() + static_cast<size_t>(y) * stride_;
+    }
+
+    const unsigned char *row(unsigned int y) const {
+        return data_.data() + static_cast<size_t>(y) * stride_;
+    }
+
+    // true if bit of pixel is set (black), false outside of image
+    bool get(const Point &pos) const {
+        if (!isInside(pos))
+            return false;
+        size_t x = UNSIGNED_CAST(size_t, pos.x);
+        return (row(UNSIGNED_CAST(unsigned int, pos.y))[x / 8] & (0x80u >> (x % 8))) != 0;
+    }
+
+    void set(const Point &pos, bool value) {
+        if (!isInside(pos))
+            return;
+        size_t x = UNSIGNED_CAST(size_t, pos.x);
+        unsigned char &byte = row(UNSIGNED_CAST(unsigned int, pos.y))[x / 8];
+        unsigned char bit = static_cast<unsigned char>(0x80u >> (x % 8));
+        byte = value ? static_cast<unsigned char>(byte | bit) : static_cast<unsigned char>(byte & ~bit);
+    }
+
+    // sets or clears all pixels
+    void fill(bool value) {
+        memset(data_.data(), value ? 0xFF : 0x00, data_.size());
+    }
+
+    // number of set pixels
+    size_t count() const {
+        size_t result = 0;
+        for (unsigned int y = 0; y < height_; ++y) {
+            const unsigned char *bytes = row(y);
+            for (unsigned int x = 0; x < width_; ++x)
+                result += (bytes[x / 8] >> (7 - x % 8)) & 1u;
+        }
+        return result;
+    }
+
+    virtual RgbColor getPixel(const Point &pos) const {
+        unsigned char level = get(pos) ? 0 : 255;
+        RgbColor result;
+        result.red = result.green = result.blue = level;
+        return result;
+    }
+
+    virtual void setPixel(const Point &pos, const RgbColor &color) {
+        set(pos, color_utils::luminance(color) < 128);
+    }
+
+    virtual const unsigned char *readRow(unsigned int y, unsigned char *buffer) const {
+        const unsigned char *bits = row(y);
+        unsigned char *dst = buffer;
+        for (unsigned int x = 0; x < width_; ++x, dst += 3)
+            dst[0] = dst[1] = dst[2] = (bits[x / 8] & (0x80u >> (x % 8))) ? 0 : 255;
+        return buffer;
+    }
+
+    virtual void writeRow(unsigned int y, unsigned int x, unsigned int count, const unsigned char *rgb) {
+        if (y >= height_ || x >= width_)
+            return;
+        for (unsigned int i = 0, end = std::min(count, width_ - x); i < end; ++i, rgb += 3)
+            set(Point(static_cast<int>(x + i), static_cast<int>(y)), color_utils::luminance(rgb[0], rgb[1], rgb[2]) < 128);
+    }
+
+    // returns raw pointer to internal data (first row)
+    void *data() {
+        return data_.data();
+    }
+
+    size_t dataSize() const {
+        return data_.size();
+    }
+
+private:
+    bool isInside(const Point &pos) const {
+        return pos.x >= 0 && pos.y >= 0 &&
+               UNSIGNED_CAST(unsigned int, pos.x) < width_ &&
+               UNSIGNED_CAST(unsigned int, pos.y) < height_;
+    }
+
+    unsigned int width_;
+    unsigned int height_;
+    size_t stride_;
+    std::vector<unsigned char> data_;
+};
+
+#endif
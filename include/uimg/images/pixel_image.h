@@ -24,6 +24,32 @@ public:
     virtual RgbColor getPixel(const Point &pos) const = 0;
 
     virtual void setPixel(const Point &pos, const RgbColor &color) = 0;
+
+    // Returns row y as packed RGB bytes (three bytes per pixel, width() pixels).
+    // Images which keep pixels in this format return pointer to their own memory, others convert
+    // the row into `buffer` (at least width() * 3 bytes) and return it.
+    virtual const unsigned char *readRow(unsigned int y, unsigned char *buffer) const {
+        unsigned char *dataPtr = buffer;
+        for (int x = 0, eposx = static_cast<int>(width()); x < eposx; ++x) {
+            RgbColor color = getPixel(Point(x, static_cast<int>(y)));
+            *(dataPtr++) = color.red;
+            *(dataPtr++) = color.green;
+            *(dataPtr++) = color.blue;
+        }
+        return buffer;
+    }
+
+    // Writes `count` packed RGB pixels (three bytes per pixel) starting at (x, y).
+    // Pixels outside of image are skipped.
+    virtual void writeRow(unsigned int y, unsigned int x, unsigned int count, const unsigned char *rgb) {
+        for (unsigned int i = 0; i < count; ++i, rgb += 3) {
+            RgbColor color;
+            color.red = rgb[0];
+            color.green = rgb[1];
+            color.blue = rgb[2];
+            setPixel(Point(static_cast<int>(x + i), static_cast<int>(y)), color);
+        }
+    }
 };
 
 class PixelImageMetaInfo {
@@ -41,6 +67,21 @@ public:
     virtual void writeImage(PixelImageBase &image) = 0;
 };
 
+// abstract class which writes image progressively, in bands of rows from top to bottom
+class PixelImageStreamWriter {
+public:
+    virtual ~PixelImageStreamWriter() {}
+
+    // starts new image of given size
+    virtual void beginImage(unsigned int width, unsigned int height) = 0;
+
+    // appends all rows of `rows` to image, its width has to be equal to image width
+    virtual void writeRows(const PixelImageBase &rows) = 0;
+
+    // finishes image, called after all rows were written
+    virtual void endImage() = 0;
+};
+
 // abstract class which loads image
 class PixelImageLoader {
 public:
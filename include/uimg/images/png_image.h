@@ -0,0 +1,299 @@
+#ifndef __UIMG_PNG_IMAGE_H__
+#define __UIMG_PNG_IMAGE_H__
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "uimg/images/pixel_image.h"
+#include "uimg/utils/checksum.h"
+#include "uimg/utils/deflate.h"
+#include "uimg/utils/thread_pool.h"
+
+// class which writes RGB image as PNG file (8-bit truecolor, not interlaced), without external libraries
+// For each row the PNG filter (None, Sub, Up, Average, Paeth) which gives the smallest sum of absolute
+// filtered values is selected. Filtered data is split into chunks of chunkSize bytes which are deflated
+// in parallel (each chunk uses preceding 32 kB as dictionary and ends with a sync flush), so output
+// of the writer does not depend on number of threads or on how rows are passed to writeRows().
+// Image can be written at once (writeImage) or in bands of rows, as PixelImageStreamWriter.
+class PngImageWriter : public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 256 * 1024;
+    static constexpr unsigned int BYTES_PER_PIXEL = 3;
+
+    // threadCount = 0 means one thread per hardware core
+    PngImageWriter(std::basic_ostream<char> &output, unsigned int threadCount = 0,
+                   size_t chunkSize = DEFAULT_CHUNK_SIZE, unsigned int maxChainLength = 32)
+            : output_(output), chunkSize_(std::max<size_t>(1, chunkSize)), encoder_(maxChainLength) {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        if (threadCount > 1)
+            pool_.reset(new ThreadPool(threadCount));
+        batchSize_ = chunkSize_ * threadCount;
+    }
+
+    virtual void writeImage(PixelImageBase &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        if (width == 0 || height == 0)
+            throw std::invalid_argument("PngImageWriter: image size has to be positive");
+
+        width_ = width;
+        height_ = height;
+        rowsWritten_ = 0;
+        headerWritten_ = false;
+        adler_ = 1;
+        buffer_.clear();
+        historySize_ = 0;
+        previousRow_.assign(rowSize(), 0);
+
+        static const unsigned char SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        output_.write(reinterpret_cast<const char *>(SIGNATURE), sizeof(SIGNATURE));
+
+        unsigned char header[13];
+        putUint32(header, width);
+        putUint32(header + 4, height);
+        header[8] = 8;  // bit depth
+        header[9] = 2;  // color type: truecolor
+        header[10] = 0; // compression: deflate
+        header[11] = 0; // filter method: adaptive
+        header[12] = 0; // no interlace
+        writeChunk("IHDR", header, sizeof(header));
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        if (rows.width() != width_)
+            throw std::invalid_argument("PngImageWriter: row width differs from image width");
+        if (rows.height() > height_ - rowsWritten_)
+            throw std::invalid_argument("PngImageWriter: too many rows");
+
+        size_t size = rowSize();
+        rowBuffer_.resize(size);
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            const unsigned char *row = rows.readRow(y, rowBuffer_.data());
+            appendFilteredRow(row);
+            memcpy(previousRow_.data(), row, size);
+            ++rowsWritten_;
+
+            if (buffer_.size() - historySize_ >= batchSize_)
+                compressBuffered(false);
+        }
+    }
+
+    virtual void endImage() {
+        if (rowsWritten_ != height_)
+            throw std::runtime_error("PngImageWriter: image is incomplete");
+
+        compressBuffered(true);
+        writeChunk("IEND", nullptr, 0);
+        output_.flush();
+    }
+
+    // true if file name has ".png" extension (case insensitive)
+    static bool isPngFileName(const std::string &fileName) {
+        static const char EXTENSION[] = ".png";
+        size_t length = sizeof(EXTENSION) - 1;
+        if (fileName.size() < length)
+            return false;
+        for (size_t i = 0; i < length; ++i) {
+            if (tolower(static_cast<unsigned char>(fileName[fileName.size() - length + i])) != EXTENSION[i])
+                return false;
+        }
+        return true;
+    }
+
+private:
+    enum Filter {
+        FILTER_NONE = 0,
+        FILTER_SUB = 1,
+        FILTER_UP = 2,
+        FILTER_AVERAGE = 3,
+        FILTER_PAETH = 4,
+        FILTER_COUNT = 5
+    };
+
+    size_t rowSize() const {
+        return static_cast<size_t>(width_) * BYTES_PER_PIXEL;
+    }
+
+    static void putUint32(unsigned char *output, uint32_t value) {
+        output[0] = static_cast<unsigned char>(value >> 24);
+        output[1] = static_cast<unsigned char>(value >> 16);
+        output[2] = static_cast<unsigned char>(value >> 8);
+        output[3] = static_cast<unsigned char>(value);
+    }
+
+    void writeChunk(const char *type, const unsigned char *data, size_t size) {
+        unsigned char prefix[8];
+        putUint32(prefix, static_cast<uint32_t>(size));
+        memcpy(prefix + 4, type, 4);
+
+        unsigned char suffix[4];
+        putUint32(suffix, Crc32::update(Crc32::compute(prefix + 4, 4), data, size));
+
+        output_.write(reinterpret_cast<const char *>(prefix), sizeof(prefix));
+        if (size > 0)
+            output_.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+        output_.write(reinterpret_cast<const char *>(suffix), sizeof(suffix));
+    }
+
+    static unsigned char paeth(int left, int up, int upLeft) {
+        int estimate = left + up - upLeft;
+        int distLeft = abs(estimate - left);
+        int distUp = abs(estimate - up);
+        int distUpLeft = abs(estimate - upLeft);
+        if (distLeft <= distUp && distLeft <= distUpLeft)
+            return static_cast<unsigned char>(left);
+        return static_cast<unsigned char>(distUp <= distUpLeft ? up : upLeft);
+    }
+
+    static void filterRow(int filter, const unsigned char *row, const unsigned char *previous, size_t size,
+                          unsigned char *output) {
+        const size_t bpp = BYTES_PER_PIXEL;
+        for (size_t i = 0; i < size; ++i) {
+            int left = i >= bpp ? row[i - bpp] : 0;
+            int up = previous[i];
+            int upLeft = i >= bpp ? previous[i - bpp] : 0;
+            int predicted;
+            switch (filter) {
+                case FILTER_SUB:
+                    predicted = left;
+                    break;
+                case FILTER_UP:
+                    predicted = up;
+                    break;
+                case FILTER_AVERAGE:
+                    predicted = (left + up) / 2;
+                    break;
+                case FILTER_PAETH:
+                    predicted = paeth(left, up, upLeft);
+                    break;
+                default:
+                    predicted = 0;
+                    break;
+            }
+            output[i] = static_cast<unsigned char>(row[i] - predicted);
+        }
+    }
+
+    // sum of filtered bytes taken as signed values - smaller sum usually compresses better
+    static size_t filterScore(const unsigned char *filtered, size_t size) {
+        size_t score = 0;
+        for (size_t i = 0; i < size; ++i)
+            score += filtered[i] < 128 ? filtered[i] : 256u - filtered[i];
+        return score;
+    }
+
+    void appendFilteredRow(const unsigned char *row) {
+        size_t size = rowSize();
+        candidates_.resize(FILTER_COUNT * size);
+
+        int best = FILTER_NONE;
+        size_t bestScore = 0;
+        for (int filter = FILTER_NONE; filter < FILTER_COUNT; ++filter) {
+            unsigned char *candidate = candidates_.data() + static_cast<size_t>(filter) * size;
+            filterRow(filter, row, previousRow_.data(), size, candidate);
+            size_t score = filterScore(candidate, size);
+            if (filter == FILTER_NONE || score < bestScore) {
+                best = filter;
+                bestScore = score;
+            }
+        }
+
+        const unsigned char *chosen = candidates_.data() + static_cast<size_t>(best) * size;
+        buffer_.push_back(static_cast<unsigned char>(best));
+        buffer_.insert(buffer_.end(), chosen, chosen + size);
+    }
+
+    // Deflates buffered data in chunks (in parallel) and writes them as IDAT chunks.
+    // Before end of image only whole chunks are compressed, the rest waits for more rows.
+    void compressBuffered(bool final) {
+        size_t available = buffer_.size() - historySize_;
+        size_t chunkCount = final ? std::max<size_t>(1, (available + chunkSize_ - 1) / chunkSize_)
+                                  : available / chunkSize_;
+        if (chunkCount == 0)
+            return;
+
+        std::vector<std::vector<unsigned char>> compressed(chunkCount);
+        std::vector<uint32_t> checksums(chunkCount, 1);
+        auto compressChunk = [this, final, chunkCount, available, &compressed, &checksums](size_t index) {
+            size_t start = historySize_ + index * chunkSize_;
+            size_t size = std::min(chunkSize_, historySize_ + available - start);
+            size_t dictionarySize = std::min(start, DeflateEncoder::WINDOW_SIZE);
+            const unsigned char *data = buffer_.data() + start;
+            encoder_.compress(data - dictionarySize, dictionarySize, data, size,
+                              final && index + 1 == chunkCount, compressed[index]);
+            checksums[index] = Adler32::compute(data, size);
+        };
+
+        if (pool_ && chunkCount > 1) {
+            for (size_t i = 0; i < chunkCount; ++i)
+                pool_->submit([&compressChunk, i]() { compressChunk(i); });
+            pool_->wait();
+        } else {
+            for (size_t i = 0; i < chunkCount; ++i)
+                compressChunk(i);
+        }
+
+        // every chunk is written as separate IDAT, so output does not depend on batching
+        size_t consumed = 0;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            std::vector<unsigned char> &data = compressed[i];
+            if (!headerWritten_) {
+                // zlib header: deflate with 32 kB window, default compression
+                static const unsigned char ZLIB_HEADER[] = {0x78, 0x9C};
+                data.insert(data.begin(), ZLIB_HEADER, ZLIB_HEADER + sizeof(ZLIB_HEADER));
+                headerWritten_ = true;
+            }
+
+            size_t size = std::min(chunkSize_, available - consumed);
+            adler_ = Adler32::combine(adler_, checksums[i], size);
+            consumed += size;
+
+            if (final && i + 1 == chunkCount) {
+                unsigned char trailer[4];
+                putUint32(trailer, adler_);
+                data.insert(data.end(), trailer, trailer + sizeof(trailer));
+            }
+            writeChunk("IDAT", data.data(), data.size());
+        }
+
+        // keep last 32 kB as dictionary of next chunk
+        size_t end = historySize_ + consumed;
+        size_t keep = std::min(end, DeflateEncoder::WINDOW_SIZE);
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(end - keep));
+        historySize_ = keep;
+    }
+
+    std::basic_ostream<char> &output_;
+    size_t chunkSize_;
+    size_t batchSize_;
+    DeflateEncoder encoder_;
+    std::unique_ptr<ThreadPool> pool_;
+
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    unsigned int rowsWritten_ = 0;
+    bool headerWritten_ = false;
+    uint32_t adler_ = 1;
+
+    std::vector<unsigned char> buffer_; // history (already compressed) followed by filtered rows to compress
+    size_t historySize_ = 0;
+    std::vector<unsigned char> previousRow_;
+    std::vector<unsigned char> rowBuffer_;
+    std::vector<unsigned char> candidates_;
+};
+
+#endif
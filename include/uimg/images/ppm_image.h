@@ -4,14 +4,43 @@
 #include <ostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <cctype>
+#include <cstdint>
 
+#include "uimg/base/platform.h"
 #include "uimg/base/structs.h"
 #include "uimg/images/pixel_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/images/gray_image.h"
+#include "uimg/images/mask_image.h"
 #include "uimg/utils/cast.h"
+#include "uimg/utils/color_utils.h"
+
+#if UIMG_HAS_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 // class which writes RGB image as PPM file (Netpbm / P6)
-class PpmImageWriter : public PixelImageWriter {
+// Rows are pulled with PixelImageBase::readRow() (without copying for RgbImage / ImageView) and
+// collected into blocks of about BLOCK_SIZE bytes, so output stream receives one write per block.
+// Block buffer is reused by following writeImage calls.
+// Image can be also written in bands of rows, as PixelImageStreamWriter.
+class PpmImageWriter : public PixelImageWriter, public PixelImageStreamWriter {
 public:
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+    static constexpr size_t MAX_HEADER_SIZE = 40;
+
     PpmImageWriter(std::basic_ostream<char> &output) : output_(output) {}
 
     virtual void writeImage(PixelImageBase &image) {
@@ -19,29 +48,67 @@ public:
         writePixelMap(image);
     }
 
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        char ppmhead[MAX_HEADER_SIZE];
+        size_t len = formatHeader(width, height, ppmhead);
+        output_.write(ppmhead, static_cast<std::streamsize>(len));
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        writePixelMap(rows);
+    }
+
+    virtual void endImage() {
+        output_.flush();
+    }
+
+    // formats P6 header into `output` (MAX_HEADER_SIZE bytes), returns its length
+    static size_t formatHeader(const PixelImageBase &image, char *output) {
+        return formatHeader(image.width(), image.height(), output);
+    }
+
+    static size_t formatHeader(unsigned int width, unsigned int height, char *output) {
+        int len = snprintf(output, MAX_HEADER_SIZE, "P6\n%u %u\n255\n", width, height);
+        return UNSIGNED_CAST(size_t, len);
+    }
+
+    // number of rows of given size which fit into one block (at least one)
+    static size_t rowsPerBlock(size_t rowSize) {
+        return rowSize == 0 ? 1 : std::max<size_t>(1, BLOCK_SIZE / rowSize);
+    }
+
 protected:
-    void writePixelMap(PixelImageBase &image) {
-        RgbColor color;
-        unsigned char colorData[3];
-
-        for (int y = 0, eposy = static_cast<int>(image.height()); y < eposy; ++y) {
-            for (int x = 0, eposx = static_cast<int>(image.width()); x < eposx; ++x) {
-                color = image.getPixel(Point(x, y));
-                colorData[0] = color.red;
-                colorData[1] = color.green;
-                colorData[2] = color.blue;
-                output_.write(reinterpret_cast<char *>(colorData), sizeof(colorData));
+    void writePixelMap(const PixelImageBase &image) {
+        size_t rowSize = static_cast<size_t>(image.width()) * 3;
+        unsigned int height = image.height();
+        if (rowSize == 0 || height == 0)
+            return;
+
+        size_t blockRows = std::min<size_t>(rowsPerBlock(rowSize), height);
+        if (buffer_.size() < blockRows * rowSize)
+            buffer_.resize(blockRows * rowSize);
+
+        size_t used = 0;
+        for (unsigned int y = 0; y < height; ++y) {
+            unsigned char *slot = buffer_.data() + used;
+            const unsigned char *rowData = image.readRow(y, slot);
+            if (rowData != slot)
+                memcpy(slot, rowData, rowSize);
+            used += rowSize;
+
+            if (used + rowSize > buffer_.size()) {
+                output_.write(reinterpret_cast<const char *>(buffer_.data()), static_cast<std::streamsize>(used));
+                used = 0;
             }
         }
+
+        if (used > 0)
+            output_.write(reinterpret_cast<const char *>(buffer_.data()), static_cast<std::streamsize>(used));
     }
 
     size_t writeHeader(PixelImageBase &image) {
-        char ppmhead[40];
-
-        sprintf(ppmhead, "P6\n%u %u\n255\n", image.width(), image.height());
-
-        size_t len = std::char_traits<char>::length(ppmhead);
-
+        char ppmhead[MAX_HEADER_SIZE];
+        size_t len = formatHeader(image, ppmhead);
         output_.write(ppmhead, static_cast<std::streamsize>(len));
         return len;
     }
@@ -50,23 +117,120 @@ protected:
 
 private:
     std::basic_ostream<char> &output_;
+    std::vector<unsigned char> buffer_;
 };
 
+// kept for compatibility - PpmImageWriter reads rows of RgbImage / ImageView directly from image memory
 class PpmWriterForRgbImage : public PpmImageWriter {
 public:
     PpmWriterForRgbImage(std::basic_ostream<char> &output) : PpmImageWriter(output) {}
+};
+
+#if UIMG_HAS_POSIX
+// PPM writer which bypasses iostreams: rows are passed to writev() on a file descriptor as a list of
+// pointers, so rows of RgbImage / ImageView are written straight from image memory.
+// Other images are converted (readRow) into a reusable block buffer first.
+// Throws std::runtime_error if writing fails.
+class PpmImageFdWriter : public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    // descriptor is not closed by writer
+    PpmImageFdWriter(int fd) : fd_(fd) {}
+
+    // writes image to new file (or truncates existing one)
+    static void writeToFile(const std::string &path, PixelImageBase &image) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            throw std::runtime_error("PpmImageFdWriter: cannot open file: " + path);
+
+        try {
+            PpmImageFdWriter(fd).writeImage(image);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+
+        if (::close(fd) != 0)
+            throw std::runtime_error("PpmImageFdWriter: cannot close file: " + path);
+    }
 
     virtual void writeImage(PixelImageBase &image) {
-        writeHeader(image);
-        writePixelMap(dynamic_cast<RgbImage &>(image));
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
     }
 
-protected:
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        char header[PpmImageWriter::MAX_HEADER_SIZE];
+        std::vector<struct iovec> iov(1, makeIovec(header, PpmImageWriter::formatHeader(width, height, header)));
+        writeAll(iov);
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        size_t rowSize = static_cast<size_t>(rows.width()) * 3;
+        unsigned int height = rowSize > 0 ? rows.height() : 0;
+        if (height == 0)
+            return;
+
+        size_t batchRows = std::min<size_t>(std::min<size_t>(PpmImageWriter::rowsPerBlock(rowSize), MAX_IOVECS), height);
+        if (buffer_.size() < batchRows * rowSize)
+            buffer_.resize(batchRows * rowSize);
 
-    void writePixelMap(RgbImage &image) {
-        getOutput().write(static_cast<char *>(image.data()), static_cast<std::streamsize>(image.dataSize()));
+        std::vector<struct iovec> iov;
+        iov.reserve(batchRows);
+
+        for (unsigned int y = 0; y < height; ++y) {
+            if (iov.size() == batchRows) {
+                writeAll(iov);
+                iov.clear();
+            }
+            unsigned char *slot = buffer_.data() + iov.size() * rowSize;
+            iov.push_back(makeIovec(rows.readRow(y, slot), rowSize));
+        }
+
+        writeAll(iov);
+    }
+
+    virtual void endImage() {
+    }
+
+private:
+    // stays below IOV_MAX of all supported systems (1024)
+    static constexpr size_t MAX_IOVECS = 1024;
+
+    static struct iovec makeIovec(const void *data, size_t size) {
+        struct iovec result;
+        result.iov_base = const_cast<void *>(data);
+        result.iov_len = size;
+        return result;
+    }
+
+    // writes all buffers, continuing after partial writes and interrupts
+    void writeAll(std::vector<struct iovec> &iov) {
+        size_t first = 0;
+        while (first < iov.size()) {
+            ssize_t written = ::writev(fd_, iov.data() + first, static_cast<int>(iov.size() - first));
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("PpmImageFdWriter: write failed");
+            }
+
+            size_t left = static_cast<size_t>(written);
+            while (first < iov.size() && left >= iov[first].iov_len) {
+                left -= iov[first].iov_len;
+                ++first;
+            }
+            if (left > 0) {
+                iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + left;
+                iov[first].iov_len -= left;
+            }
+        }
     }
+
+    int fd_;
+    std::vector<unsigned char> buffer_;
 };
+#endif
 
 class PpmImageLoader : public PixelImageLoader {
 public:
@@ -78,6 +242,18 @@ public:
 
     virtual ~PpmImageLoader() {}
 
+    // Calculates part of source image (of size srcSize) which is inside of srcFragment (inclusive) and is
+    // visible in destination image (of size destSize) when srcFragment top-left corner is placed at destOffset.
+    // Returns false if there is no such pixel.
+    static bool clipFragment(const Point &srcSize, const Rect &srcFragment, const Point &destSize,
+                             const Point &destOffset, RectInclusive &output) {
+        output.x1 = std::max(std::max(0, srcFragment.x1), srcFragment.x1 - destOffset.x);
+        output.y1 = std::max(std::max(0, srcFragment.y1), srcFragment.y1 - destOffset.y);
+        output.x2 = std::min(std::min(srcSize.x - 1, srcFragment.x2), srcFragment.x1 - destOffset.x + destSize.x - 1);
+        output.y2 = std::min(std::min(srcSize.y - 1, srcFragment.y2), srcFragment.y1 - destOffset.y + destSize.y - 1);
+        return output.x1 <= output.x2 && output.y1 <= output.y2;
+    }
+
     virtual PixelImageMetaInfo *loadImageMeta() {
         std::unique_ptr<PixelImageMetaInfoBase> meta(new PixelImageMetaInfoBase);
         if (loadHeader(*meta))
@@ -151,37 +327,47 @@ protected:
         return loadPixelDataInto(outputImage, srcSize, srcPart, targetOffset);
     }
 
+    // Reads only source rows and columns of srcFragment (inclusive) which land inside of output image,
+    // one read per row. Seekable streams are positioned directly at requested pixels, for other streams
+    // unneeded bytes are skipped. Stream must be positioned at start of pixel data.
     virtual bool loadPixelDataInto(PixelImageBase &outputImage, const Point &srcSize, const Rect &srcFragment,
                                    const Point &destOffset) {
-        Point destSize = outputImage.getSize();
-        int xd, yd;
-        RgbColor color;
-        char colorBytes[3];
-        bool result = true;
-
-        for (int y = 0, eposy = srcSize.y; y < eposy; ++y) {
-            for (int x = 0, eposx = srcSize.x; x < eposx; ++x) {
-                if (!input_.read(colorBytes, sizeof(colorBytes))) {
-                    result = false;
-                    break;
-                }
+        RectInclusive area;
+        if (!clipFragment(srcSize, srcFragment, outputImage.getSize(), destOffset, area))
+            return true;
 
-                if (x >= srcFragment.x1 && x <= srcFragment.x2 && y >= srcFragment.y1 && y <= srcFragment.y2) {
-                    color.red = UNSIGNED_CAST(unsigned char, colorBytes[0]);
-                    color.green = UNSIGNED_CAST(unsigned char, colorBytes[1]);
-                    color.blue = UNSIGNED_CAST(unsigned char, colorBytes[2]);
+        std::istream &input = getInput();
+        bool seekable = input.tellg() != std::streampos(-1);
+        std::streamoff rowBytes = static_cast<std::streamoff>(srcSize.x) * 3;
+        unsigned int count = UNSIGNED_CAST(unsigned int, area.x2 - area.x1 + 1);
+        std::vector<unsigned char> buffer(static_cast<size_t>(count) * 3);
+        std::streamoff pos = 0;
 
-                    xd = x - srcFragment.x1 + destOffset.x;
-                    yd = x - srcFragment.y1 + destOffset.y;
+        for (int y = area.y1; y <= area.y2; ++y) {
+            std::streamoff target = y * rowBytes + static_cast<std::streamoff>(area.x1) * 3;
+            if (!skip(target - pos, seekable))
+                return false;
+            if (!input.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size())))
+                return false;
+            pos = target + static_cast<std::streamoff>(buffer.size());
 
-                    if (xd >= 0 && xd < destSize.x && yd >= 0 && yd < destSize.y) {
-                        outputImage.setPixel(Point(xd, yd), color);
-                    }
-                }
-            }
+            outputImage.writeRow(UNSIGNED_CAST(unsigned int, y - srcFragment.y1 + destOffset.y),
+                                 UNSIGNED_CAST(unsigned int, area.x1 - srcFragment.x1 + destOffset.x),
+                                 count, buffer.data());
         }
 
-        return result;
+        return true;
+    }
+
+    // skips `count` bytes of input
+    bool skip(std::streamoff count, bool seekable) {
+        if (count == 0)
+            return true;
+        std::istream &input = getInput();
+        if (seekable)
+            return static_cast<bool>(input.seekg(count, std::ios::cur));
+        input.ignore(static_cast<std::streamsize>(count));
+        return input.gcount() == static_cast<std::streamsize>(count);
     }
 
     bool loadHeader(PixelImageMetaInfoBase &output) {
@@ -234,31 +420,659 @@ private:
 // optimized version of PPM image loader for RgbImage target
 class PpmImageLoaderForRgbImage : public PpmImageLoader {
     using inherited = PpmImageLoader;
+public:
+    PpmImageLoaderForRgbImage(std::basic_istream<char> &input) : PpmImageLoader(input) {}
+
 protected:
     virtual PixelImageBase *newImage(const PixelImageMetaInfo &meta) {
         return new RgbImage(UNSIGNED_CAST(unsigned int, meta.getSize().x), UNSIGNED_CAST(unsigned int, meta.getSize().y));
     }
 
     virtual bool loadPixelDataNew(PixelImageBase &outputImage) {
-        Point srcSize = outputImage.getSize();
-        bool result = true;
+        RgbImage &image = static_cast<RgbImage &>(outputImage);
         std::istream &input = getInput();
-        char *data = static_cast<char *>(static_cast<RgbImage &>(outputImage).data());
 
-        for (int y = 0, eposy = srcSize.y; y < eposy; ++y) {
-            for (int x = 0, eposx = srcSize.x; x < eposx; ++x) {
-                if (!input.read(data, 3)) {
-                    result = false;
-                    break;
-                }
+        // one read per row, directly into image memory
+        for (unsigned int y = 0, eposy = image.height(); y < eposy; ++y) {
+            if (!input.read(reinterpret_cast<char *>(image.row(y)), static_cast<std::streamsize>(image.rowSize())))
+                return false;
+        }
 
-                data += 3;
+        return true;
+    }
+};
+
+// Base of PGM, PBM and PAM writers: header is followed by rows collected into blocks of about
+// PpmImageWriter::BLOCK_SIZE bytes, so output stream receives one write per block.
+class NetpbmBlockWriter {
+public:
+    NetpbmBlockWriter(std::basic_ostream<char> &output) : output_(output), used_(0) {}
+
+protected:
+    void writeHeader(const char *header, size_t size) {
+        used_ = 0;
+        unsigned char *slot = nextRow(size);
+        memcpy(slot, header, size);
+    }
+
+    // returns space for one encoded row of `size` bytes, full block is written first
+    unsigned char *nextRow(size_t size) {
+        if (used_ + size > block_.size()) {
+            flushBlock();
+            if (block_.size() < size)
+                block_.resize(std::max(PpmImageWriter::BLOCK_SIZE, size));
+        }
+        unsigned char *slot = block_.data() + used_;
+        used_ += size;
+        return slot;
+    }
+
+    void flushBlock() {
+        if (used_ > 0)
+            output_.write(reinterpret_cast<const char *>(block_.data()), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+
+    void finish() {
+        flushBlock();
+        output_.flush();
+    }
+
+private:
+    std::basic_ostream<char> &output_;
+    std::vector<unsigned char> block_;
+    size_t used_;
+};
+
+// class which writes grayscale image as PGM file (Netpbm / P5), 8-bit (maxval 255) or 16-bit (maxval 65535)
+// GrayImage / GrayImage16 rows are copied as they are (16-bit samples as big-endian), other images are
+// converted to luminance.
+class PgmImageWriter : public NetpbmBlockWriter, public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    PgmImageWriter(std::basic_ostream<char> &output) : NetpbmBlockWriter(output) {}
+
+    virtual void writeImage(PixelImageBase &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    void writeImage(const GrayImage &image) {
+        beginImage(image.width(), image.height(), 255);
+        writeRows(image);
+        endImage();
+    }
+
+    void writeImage(const GrayImage16 &image) {
+        beginImage(image.width(), image.height(), 65535);
+        writeRows(image);
+        endImage();
+    }
+
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        beginImage(width, height, 255);
+    }
+
+    // maxValue: 255 or 65535
+    void beginImage(unsigned int width, unsigned int height, unsigned int maxValue) {
+        if (maxValue != 255 && maxValue != 65535)
+            throw std::invalid_argument("PgmImageWriter: maxValue has to be 255 or 65535");
+        width_ = width;
+        wide_ = maxValue > 255;
+
+        char header[PpmImageWriter::MAX_HEADER_SIZE];
+        int len = snprintf(header, sizeof(header), "P5\n%u %u\n%u\n", width, height, maxValue);
+        writeHeader(header, UNSIGNED_CAST(size_t, len));
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        checkWidth(rows.width());
+        std::vector<unsigned char> rgb(static_cast<size_t>(width_) * 3);
+        std::vector<uint8_t> levels(width_);
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            const unsigned char *src = rows.readRow(y, rgb.data());
+            for (unsigned int x = 0; x < width_; ++x, src += 3)
+                levels[x] = color_utils::luminance(src[0], src[1], src[2]);
+            writeSamples(levels.data());
+        }
+    }
+
+    void writeRows(const GrayImage &rows) {
+        checkWidth(rows.width());
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y)
+            writeSamples(rows.row(y));
+    }
+
+    void writeRows(const GrayImage16 &rows) {
+        checkWidth(rows.width());
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y)
+            writeSamples(rows.row(y));
+    }
+
+    virtual void endImage() {
+        finish();
+    }
+
+private:
+    void checkWidth(unsigned int width) const {
+        if (width != width_)
+            throw std::invalid_argument("PgmImageWriter: row width differs from image width");
+    }
+
+    void writeSamples(const uint8_t *samples) {
+        if (!wide_) {
+            memcpy(nextRow(width_), samples, width_);
+            return;
+        }
+        unsigned char *out = nextRow(static_cast<size_t>(width_) * 2);
+        for (unsigned int x = 0; x < width_; ++x, out += 2)
+            out[0] = out[1] = samples[x];
+    }
+
+    void writeSamples(const uint16_t *samples) {
+        if (!wide_) {
+            unsigned char *out = nextRow(width_);
+            for (unsigned int x = 0; x < width_; ++x)
+                out[x] = GrayImage16::toByte(samples[x]);
+            return;
+        }
+        unsigned char *out = nextRow(static_cast<size_t>(width_) * 2);
+        for (unsigned int x = 0; x < width_; ++x, out += 2) {
+            out[0] = static_cast<unsigned char>(samples[x] >> 8);
+            out[1] = static_cast<unsigned char>(samples[x]);
+        }
+    }
+
+    unsigned int width_ = 0;
+    bool wide_ = false;
+};
+
+// class which writes 1-bit image as PBM file (Netpbm / P4), eight pixels per byte
+// MaskImage rows are copied as they are, other images are thresholded: dark colors (luminance < 128) are black.
+class PbmImageWriter : public NetpbmBlockWriter, public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    PbmImageWriter(std::basic_ostream<char> &output) : NetpbmBlockWriter(output) {}
+
+    virtual void writeImage(PixelImageBase &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    void writeImage(const MaskImage &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        width_ = width;
+        char header[PpmImageWriter::MAX_HEADER_SIZE];
+        int len = snprintf(header, sizeof(header), "P4\n%u %u\n", width, height);
+        writeHeader(header, UNSIGNED_CAST(size_t, len));
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        checkWidth(rows.width());
+        size_t rowBytes = (static_cast<size_t>(width_) + 7) / 8;
+        std::vector<unsigned char> rgb(static_cast<size_t>(width_) * 3);
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            const unsigned char *src = rows.readRow(y, rgb.data());
+            unsigned char *out = nextRow(rowBytes);
+            memset(out, 0, rowBytes);
+            for (unsigned int x = 0; x < width_; ++x, src += 3) {
+                if (color_utils::luminance(src[0], src[1], src[2]) < 128)
+                    out[x / 8] = static_cast<unsigned char>(out[x / 8] | (0x80u >> (x % 8)));
             }
         }
+    }
 
-        return result;
+    void writeRows(const MaskImage &rows) {
+        checkWidth(rows.width());
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y)
+            memcpy(nextRow(rows.stride()), rows.row(y), rows.stride());
+    }
+
+    virtual void endImage() {
+        finish();
     }
+
+private:
+    void checkWidth(unsigned int width) const {
+        if (width != width_)
+            throw std::invalid_argument("PbmImageWriter: row width differs from image width");
+    }
+
+    unsigned int width_ = 0;
 };
 
+// class which writes image as PAM file (Netpbm / P7): RGB_ALPHA for RgbaImage (alpha is not premultiplied
+// in file), RGB for other images.
+class PamImageWriter : public NetpbmBlockWriter, public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    PamImageWriter(std::basic_ostream<char> &output) : NetpbmBlockWriter(output) {}
+
+    virtual void writeImage(PixelImageBase &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    void writeImage(const RgbaImage &image) {
+        beginImage(image.width(), image.height(), true);
+        writeRows(image);
+        endImage();
+    }
+
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        beginImage(width, height, false);
+    }
+
+    void beginImage(unsigned int width, unsigned int height, bool alpha) {
+        width_ = width;
+        alpha_ = alpha;
+        char header[96];
+        int len = snprintf(header, sizeof(header), "P7\nWIDTH %u\nHEIGHT %u\nDEPTH %u\nMAXVAL 255\nTUPLTYPE %s\nENDHDR\n",
+                           width, height, alpha ? 4u : 3u, alpha ? "RGB_ALPHA" : "RGB");
+        writeHeader(header, UNSIGNED_CAST(size_t, len));
+    }
+
+    // rows are opaque
+    virtual void writeRows(const PixelImageBase &rows) {
+        checkWidth(rows.width());
+        size_t rowSize = static_cast<size_t>(width_) * 3;
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            if (!alpha_) {
+                unsigned char *out = nextRow(rowSize);
+                const unsigned char *src = rows.readRow(y, out);
+                if (src != out)
+                    memcpy(out, src, rowSize);
+                continue;
+            }
+            rgb_.resize(rowSize);
+            const unsigned char *src = rows.readRow(y, rgb_.data());
+            unsigned char *out = nextRow(static_cast<size_t>(width_) * 4);
+            for (unsigned int x = 0; x < width_; ++x, src += 3, out += 4) {
+                memcpy(out, src, 3);
+                out[3] = 255;
+            }
+        }
+    }
+
+    void writeRows(const RgbaImage &rows) {
+        checkWidth(rows.width());
+        if (!alpha_) {
+            writeRows(static_cast<const PixelImageBase &>(rows));
+            return;
+        }
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            const unsigned char *src = rows.row(y);
+            unsigned char *out = nextRow(static_cast<size_t>(width_) * 4);
+            for (unsigned int x = 0; x < width_; ++x, src += 4, out += 4) {
+                RgbaColor color = color_utils::unpremultiply(RgbaColor{src[0], src[1], src[2], src[3]});
+                out[0] = color.red;
+                out[1] = color.green;
+                out[2] = color.blue;
+                out[3] = color.alpha;
+            }
+        }
+    }
+
+    virtual void endImage() {
+        finish();
+    }
+
+private:
+    void checkWidth(unsigned int width) const {
+        if (width != width_)
+            throw std::invalid_argument("PamImageWriter: row width differs from image width");
+    }
+
+    unsigned int width_ = 0;
+    bool alpha_ = false;
+    std::vector<unsigned char> rgb_;
+};
+
+// class which reads any binary Netpbm file: PBM (P4), PGM (P5, 8 or 16-bit), PPM (P6) and PAM (P7, depth 1-4).
+// loadImage returns container matching the file: MaskImage for PBM, GrayImage / GrayImage16 for PGM and PAM
+// GRAYSCALE, RgbImage for PPM and PAM RGB, RgbaImage for PAM with alpha; rows are read in bulk, one read per row.
+// Other load methods convert pixels to RGB and read only the requested region (like PpmImageLoader).
+// Samples with maxval other than 255 / 65535 are rescaled.
+class NetpbmImageLoader : public PixelImageLoader {
+public:
+    enum ErrorCodes {
+        HEADER_INCORRECT,
+        DATA_INCORRECT
+    };
+
+    struct Header {
+        char format = 0;           // '4', '5', '6' or '7'
+        unsigned int width = 0;
+        unsigned int height = 0;
+        unsigned int depth = 0;    // samples per pixel
+        unsigned int maxValue = 0; // 1 for PBM
+
+        unsigned int bytesPerSample() const {
+            return maxValue > 255 ? 2 : 1;
+        }
+
+        size_t rowSize() const {
+            if (format == '4')
+                return (static_cast<size_t>(width) + 7) / 8;
+            return static_cast<size_t>(width) * depth * bytesPerSample();
+        }
+
+        bool hasAlpha() const {
+            return depth == 2 || depth == 4;
+        }
+    };
+
+    NetpbmImageLoader(std::basic_istream<char> &input) : input_(input) {}
+
+    virtual ~NetpbmImageLoader() {}
+
+    // header of last loaded image
+    const Header &header() const {
+        return header_;
+    }
+
+    virtual PixelImageMetaInfo *loadImageMeta() {
+        if (!loadHeader()) {
+            handleError(HEADER_INCORRECT);
+            return nullptr;
+        }
+        std::unique_ptr<PixelImageMetaInfoBase> meta(new PixelImageMetaInfoBase);
+        meta->setSize(Point(static_cast<int>(header_.width), static_cast<int>(header_.height)));
+        return meta.release();
+    }
+
+    virtual PixelImageBase *loadImage() {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return nullptr;
+
+        std::unique_ptr<PixelImageBase> image(newImage());
+        if (!loadNative(*image)) {
+            handleError(DATA_INCORRECT);
+            return nullptr;
+        }
+        return image.release();
+    }
+
+    virtual PixelImageBase *loadImagePart(const Rect &srcPart, const Point &targetOffset) {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return nullptr;
+
+        std::unique_ptr<PixelImageBase> image(newImage());
+        if (!loadPixelDataInto(*image, srcPart, targetOffset))
+            return nullptr;
+        return image.release();
+    }
+
+    virtual bool loadImageInto(PixelImageBase &outputImage) {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return false;
+        Rect srcPart;
+        srcPart.topLeft(Point(0, 0)).size(meta->getSize());
+        return loadPixelDataInto(outputImage, srcPart, Point(0, 0));
+    }
+
+    virtual bool loadImagePartInto(PixelImageBase &outputImage, const Rect &srcPart, const Point &targetOffset) {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return false;
+        return loadPixelDataInto(outputImage, srcPart, targetOffset);
+    }
+
+protected:
+    virtual void handleError(unsigned int errorCode [[maybe_unused]]) {
+        // does nothing
+    }
+
+    std::istream &getInput() { return input_; }
+
+private:
+    PixelImageBase *newImage() const {
+        switch (header_.format) {
+            case '4':
+                return new MaskImage(header_.width, header_.height);
+            case '6':
+                return new RgbImage(header_.width, header_.height);
+            default:
+                break;
+        }
+        if (header_.hasAlpha())
+            return new RgbaImage(header_.width, header_.height);
+        if (header_.depth == 3)
+            return new RgbImage(header_.width, header_.height);
+        if (header_.bytesPerSample() == 2)
+            return new GrayImage16(header_.width, header_.height);
+        return new GrayImage(header_.width, header_.height);
+    }
+
+    // reads rows into container created by newImage()
+    bool loadNative(PixelImageBase &image) {
+        std::vector<unsigned char> raw(header_.rowSize());
+        for (unsigned int y = 0; y < header_.height; ++y) {
+            if (!input_.read(reinterpret_cast<char *>(raw.data()), static_cast<std::streamsize>(raw.size())))
+                return false;
+
+            if (header_.format == '4') {
+                memcpy(static_cast<MaskImage &>(image).row(y), raw.data(), raw.size());
+            } else if (header_.hasAlpha()) {
+                unsigned char *out = static_cast<RgbaImage &>(image).row(y);
+                for (unsigned int x = 0; x < header_.width; ++x, out += 4) {
+                    RgbaColor color;
+                    color.red = sample(raw.data(), x, 0);
+                    color.green = header_.depth == 4 ? sample(raw.data(), x, 1) : color.red;
+                    color.blue = header_.depth == 4 ? sample(raw.data(), x, 2) : color.red;
+                    color.alpha = sample(raw.data(), x, header_.depth - 1);
+                    color = color_utils::premultiply(color);
+                    out[0] = color.red;
+                    out[1] = color.green;
+                    out[2] = color.blue;
+                    out[3] = color.alpha;
+                }
+            } else if (header_.depth == 3) {
+                unsigned char *out = static_cast<RgbImage &>(image).row(y);
+                if (header_.maxValue == 255) {
+                    memcpy(out, raw.data(), raw.size());
+                } else {
+                    for (unsigned int x = 0; x < header_.width; ++x, out += 3) {
+                        out[0] = sample(raw.data(), x, 0);
+                        out[1] = sample(raw.data(), x, 1);
+                        out[2] = sample(raw.data(), x, 2);
+                    }
+                }
+            } else if (header_.bytesPerSample() == 2) {
+                uint16_t *out = static_cast<GrayImage16 &>(image).row(y);
+                for (unsigned int x = 0; x < header_.width; ++x)
+                    out[x] = static_cast<uint16_t>(rescale(sample16(raw.data(), x, 0), 65535));
+            } else {
+                uint8_t *out = static_cast<GrayImage &>(image).row(y);
+                if (header_.maxValue == 255) {
+                    memcpy(out, raw.data(), raw.size());
+                } else {
+                    for (unsigned int x = 0; x < header_.width; ++x)
+                        out[x] = sample(raw.data(), x, 0);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Reads only source rows and bytes of srcFragment (inclusive) which land inside of output image and
+    // writes them as RGB. Seekable streams are positioned directly at requested pixels.
+    bool loadPixelDataInto(PixelImageBase &outputImage, const Rect &srcFragment, const Point &destOffset) {
+        Point srcSize(static_cast<int>(header_.width), static_cast<int>(header_.height));
+        RectInclusive area;
+        if (!PpmImageLoader::clipFragment(srcSize, srcFragment, outputImage.getSize(), destOffset, area))
+            return true;
+
+        size_t x1 = UNSIGNED_CAST(size_t, area.x1);
+        unsigned int count = UNSIGNED_CAST(unsigned int, area.x2 - area.x1 + 1);
+        size_t pixelBytes = static_cast<size_t>(header_.depth) * header_.bytesPerSample();
+        // PBM pixels are read as whole bytes
+        size_t firstByte = header_.format == '4' ? x1 / 8 : x1 * pixelBytes;
+        size_t endByte = header_.format == '4' ? (x1 + count + 7) / 8 : (x1 + count) * pixelBytes;
+
+        bool seekable = input_.tellg() != std::streampos(-1);
+        std::vector<unsigned char> raw(endByte - firstByte);
+        std::vector<unsigned char> rgb(static_cast<size_t>(count) * 3);
+        std::streamoff pos = 0;
+
+        for (int y = area.y1; y <= area.y2; ++y) {
+            std::streamoff target = static_cast<std::streamoff>(y) * static_cast<std::streamoff>(header_.rowSize()) +
+                                    static_cast<std::streamoff>(firstByte);
+            if (!skip(target - pos, seekable) ||
+                !input_.read(reinterpret_cast<char *>(raw.data()), static_cast<std::streamsize>(raw.size()))) {
+                handleError(DATA_INCORRECT);
+                return false;
+            }
+            pos = target + static_cast<std::streamoff>(raw.size());
+
+            unsigned int firstPixel = header_.format == '4' ? static_cast<unsigned int>(x1 % 8) : 0;
+            toRgb(raw.data(), firstPixel, count, rgb.data());
+            outputImage.writeRow(UNSIGNED_CAST(unsigned int, y - srcFragment.y1 + destOffset.y),
+                                 UNSIGNED_CAST(unsigned int, area.x1 - srcFragment.x1 + destOffset.x),
+                                 count, rgb.data());
+        }
+        return true;
+    }
+
+    // converts `count` pixels starting at pixel `first` of raw row data to packed RGB (alpha is dropped)
+    void toRgb(const unsigned char *raw, unsigned int first, unsigned int count, unsigned char *rgb) const {
+        for (unsigned int i = 0, x = first; i < count; ++i, ++x, rgb += 3) {
+            if (header_.format == '4') {
+                rgb[0] = rgb[1] = rgb[2] = (raw[x / 8] & (0x80u >> (x % 8))) ? 0 : 255;
+            } else if (header_.depth >= 3) {
+                rgb[0] = sample(raw, x, 0);
+                rgb[1] = sample(raw, x, 1);
+                rgb[2] = sample(raw, x, 2);
+            } else {
+                rgb[0] = rgb[1] = rgb[2] = sample(raw, x, 0);
+            }
+        }
+    }
+
+    unsigned int sample16(const unsigned char *raw, unsigned int x, unsigned int channel) const {
+        size_t index = static_cast<size_t>(x) * header_.depth + channel;
+        if (header_.bytesPerSample() == 1)
+            return raw[index];
+        return (static_cast<unsigned int>(raw[2 * index]) << 8) | raw[2 * index + 1];
+    }
+
+    // sample scaled to 0..255
+    unsigned char sample(const unsigned char *raw, unsigned int x, unsigned int channel) const {
+        return static_cast<unsigned char>(rescale(sample16(raw, x, channel), 255));
+    }
+
+    unsigned int rescale(unsigned int value, unsigned int range) const {
+        if (header_.maxValue == range)
+            return value;
+        unsigned long long scaled = (static_cast<unsigned long long>(std::min(value, header_.maxValue)) * range +
+                                     header_.maxValue / 2) / header_.maxValue;
+        return static_cast<unsigned int>(scaled);
+    }
+
+    // skips `count` bytes of input
+    bool skip(std::streamoff count, bool seekable) {
+        if (count == 0)
+            return true;
+        if (seekable)
+            return static_cast<bool>(input_.seekg(count, std::ios::cur));
+        input_.ignore(static_cast<std::streamsize>(count));
+        return input_.gcount() == static_cast<std::streamsize>(count);
+    }
+
+    bool loadHeader() {
+        header_ = Header();
+        char magic[2];
+        if (!input_.read(magic, 2) || magic[0] != 'P' || magic[1] < '4' || magic[1] > '7')
+            return false;
+        header_.format = magic[1];
+
+        if (header_.format == '7') {
+            if (!loadPamHeader())
+                return false;
+        } else {
+            unsigned int values[3] = {0, 0, 1};
+            unsigned int valueCount = header_.format == '4' ? 2 : 3;
+            for (unsigned int i = 0; i < valueCount; ++i) {
+                if (!readNumber(values[i]))
+                    return false;
+            }
+            // exactly one whitespace character separates header from pixel data
+            if (!isspace(input_.get()))
+                return false;
+            header_.width = values[0];
+            header_.height = values[1];
+            header_.maxValue = values[2];
+            header_.depth = header_.format == '6' ? 3 : 1;
+        }
+
+        return header_.width > 0 && header_.height > 0 && header_.depth >= 1 && header_.depth <= 4 &&
+               header_.maxValue >= 1 && header_.maxValue <= 65535 && header_.width <= 0x7FFFFFFFu &&
+               header_.height <= 0x7FFFFFFFu;
+    }
+
+    // reads decimal number preceded by whitespace and comments
+    bool readNumber(unsigned int &value) {
+        int c = input_.get();
+        while (c == '#' || isspace(c)) {
+            if (c == '#') {
+                while (c != '\n' && c != EOF)
+                    c = input_.get();
+            }
+            c = input_.get();
+        }
+        if (!isdigit(c))
+            return false;
+
+        unsigned long result = 0;
+        while (isdigit(c) && result <= 0xFFFFFFFFul) {
+            result = result * 10 + static_cast<unsigned long>(c - '0');
+            c = input_.peek();
+            if (isdigit(c))
+                input_.get();
+        }
+        if (result > 0xFFFFFFFFul)
+            return false;
+        value = static_cast<unsigned int>(result);
+        return true;
+    }
+
+    bool loadPamHeader() {
+        std::string line;
+        while (std::getline(input_, line)) {
+            std::istringstream tokens(line);
+            std::string key;
+            if (!(tokens >> key) || key[0] == '#')
+                continue;
+            if (key == "ENDHDR")
+                return true;
+            if (key == "TUPLTYPE")
+                continue;
+
+            unsigned int value;
+            if (!(tokens >> value))
+                return false;
+            if (key == "WIDTH")
+                header_.width = value;
+            else if (key == "HEIGHT")
+                header_.height = value;
+            else if (key == "DEPTH")
+                header_.depth = value;
+            else if (key == "MAXVAL")
+                header_.maxValue = value;
+        }
+        return false;
+    }
+
+    std::istream &input_;
+    Header header_;
+};
 
 #endif
@@ -0,0 +1,508 @@
+#ifndef __UIMG_QOI_IMAGE_H__
+#define __UIMG_QOI_IMAGE_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/utils/cast.h"
+#include "uimg/utils/color_utils.h"
+
+// Constants and helpers of QOI format ("Quite OK Image", https://qoiformat.org/qoi-specification.pdf).
+// QOI is lossless and is encoded / decoded in one pass with a 64 entry color cache, so it is
+// a few times smaller than PPM for rendered images and almost as fast to read and write.
+class QoiFormat {
+public:
+    static constexpr size_t HEADER_SIZE = 14;
+    static constexpr size_t END_MARKER_SIZE = 8;
+    static constexpr unsigned int MAX_RUN = 62;
+
+    static constexpr unsigned char OP_INDEX = 0x00;
+    static constexpr unsigned char OP_DIFF = 0x40;
+    static constexpr unsigned char OP_LUMA = 0x80;
+    static constexpr unsigned char OP_RUN = 0xC0;
+    static constexpr unsigned char OP_RGB = 0xFE;
+    static constexpr unsigned char OP_RGBA = 0xFF;
+    static constexpr unsigned char OP_MASK = 0xC0;
+
+    // pixel as r, g, b, a bytes in one word, so it can be compared at once
+    struct Pixel {
+        unsigned char r, g, b, a;
+
+        bool operator==(const Pixel &rhs) const {
+            return r == rhs.r && g == rhs.g && b == rhs.b && a == rhs.a;
+        }
+
+        unsigned int hash() const {
+            return (r * 3u + g * 5u + b * 7u + a * 11u) % 64u;
+        }
+    };
+
+    static Pixel startPixel() {
+        Pixel result = {0, 0, 0, 255};
+        return result;
+    }
+
+    static void putUint32(unsigned char *output, uint32_t value) {
+        output[0] = static_cast<unsigned char>(value >> 24);
+        output[1] = static_cast<unsigned char>(value >> 16);
+        output[2] = static_cast<unsigned char>(value >> 8);
+        output[3] = static_cast<unsigned char>(value);
+    }
+
+    static uint32_t getUint32(const unsigned char *input) {
+        return (static_cast<uint32_t>(input[0]) << 24) | (static_cast<uint32_t>(input[1]) << 16) |
+               (static_cast<uint32_t>(input[2]) << 8) | input[3];
+    }
+};
+
+// class which writes image as QOI file
+// Rows of RgbImage / ImageView are encoded straight from image memory (readRow), rows of RgbaImage are
+// read from image memory and unpremultiplied on the fly. Output is collected in a block buffer,
+// so stream receives one write per BLOCK_SIZE bytes.
+// Image can be also written in bands of rows, as PixelImageStreamWriter.
+class QoiImageWriter : public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    QoiImageWriter(std::basic_ostream<char> &output) : output_(output) {}
+
+    // writes RGB image (3 channels)
+    virtual void writeImage(PixelImageBase &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    // writes image with alpha channel (4 channels)
+    void writeImage(const RgbaImage &image) {
+        beginImage(image.width(), image.height(), 4);
+        writeRows(image);
+        endImage();
+    }
+
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        beginImage(width, height, 3);
+    }
+
+    // channels (3 or 4) is informative only, it is stored in file header
+    void beginImage(unsigned int width, unsigned int height, unsigned int channels) {
+        width_ = width;
+        previous_ = QoiFormat::startPixel();
+        memset(index_, 0, sizeof(index_));
+        run_ = 0;
+        used_ = 0;
+
+        unsigned char header[QoiFormat::HEADER_SIZE] = {'q', 'o', 'i', 'f'};
+        QoiFormat::putUint32(header + 4, width);
+        QoiFormat::putUint32(header + 8, height);
+        header[12] = static_cast<unsigned char>(channels);
+        header[13] = 0; // sRGB with linear alpha
+        unsigned char *out = reserve();
+        memcpy(out, header, sizeof(header));
+        commit(out + sizeof(header));
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        if (rows.width() != width_)
+            throw std::invalid_argument("QoiImageWriter: row width differs from image width");
+
+        rowBuffer_.resize(static_cast<size_t>(width_) * 3);
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            const unsigned char *rgb = rows.readRow(y, rowBuffer_.data());
+            unsigned char *out = reserve();
+            for (unsigned int x = 0; x < width_; ++x, rgb += 3) {
+                QoiFormat::Pixel pixel = {rgb[0], rgb[1], rgb[2], 255};
+                encodePixel(pixel, out);
+            }
+            commit(out);
+        }
+    }
+
+    void writeRows(const RgbaImage &rows) {
+        if (rows.width() != width_)
+            throw std::invalid_argument("QoiImageWriter: row width differs from image width");
+
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            const unsigned char *rgba = rows.row(y);
+            unsigned char *out = reserve();
+            for (unsigned int x = 0; x < width_; ++x, rgba += 4) {
+                QoiFormat::Pixel pixel = {rgba[0], rgba[1], rgba[2], rgba[3]};
+                if (pixel.a != 255) {
+                    RgbaColor straight = color_utils::unpremultiply(RgbaColor{rgba[0], rgba[1], rgba[2], rgba[3]});
+                    pixel.r = straight.red;
+                    pixel.g = straight.green;
+                    pixel.b = straight.blue;
+                }
+                encodePixel(pixel, out);
+            }
+            commit(out);
+        }
+    }
+
+    virtual void endImage() {
+        unsigned char *out = reserve();
+        if (run_ > 0) {
+            *out++ = static_cast<unsigned char>(QoiFormat::OP_RUN | (run_ - 1));
+            run_ = 0;
+        }
+        static const unsigned char END_MARKER[QoiFormat::END_MARKER_SIZE] = {0, 0, 0, 0, 0, 0, 0, 1};
+        memcpy(out, END_MARKER, sizeof(END_MARKER));
+        commit(out + sizeof(END_MARKER));
+
+        flushBuffer();
+        output_.flush();
+    }
+
+private:
+    // returns write position with space for one encoded row (at most 5 bytes per pixel) and trailer
+    unsigned char *reserve() {
+        size_t needed = static_cast<size_t>(width_) * 5 + 1 + QoiFormat::END_MARKER_SIZE;
+        if (used_ + needed > buffer_.size()) {
+            flushBuffer();
+            if (buffer_.size() < needed)
+                buffer_.resize(std::max(BLOCK_SIZE, needed));
+        }
+        return buffer_.data() + used_;
+    }
+
+    void commit(unsigned char *end) {
+        used_ = static_cast<size_t>(end - buffer_.data());
+    }
+
+    void flushBuffer() {
+        if (used_ > 0)
+            output_.write(reinterpret_cast<const char *>(buffer_.data()), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+
+    void encodePixel(const QoiFormat::Pixel &pixel, unsigned char *&out) {
+        if (pixel == previous_) {
+            if (++run_ == QoiFormat::MAX_RUN) {
+                *out++ = static_cast<unsigned char>(QoiFormat::OP_RUN | (run_ - 1));
+                run_ = 0;
+            }
+            return;
+        }
+
+        if (run_ > 0) {
+            *out++ = static_cast<unsigned char>(QoiFormat::OP_RUN | (run_ - 1));
+            run_ = 0;
+        }
+
+        unsigned int slot = pixel.hash();
+        if (index_[slot] == pixel) {
+            *out++ = static_cast<unsigned char>(QoiFormat::OP_INDEX | slot);
+        } else {
+            index_[slot] = pixel;
+            if (pixel.a == previous_.a) {
+                int dr = static_cast<signed char>(static_cast<unsigned char>(pixel.r - previous_.r));
+                int dg = static_cast<signed char>(static_cast<unsigned char>(pixel.g - previous_.g));
+                int db = static_cast<signed char>(static_cast<unsigned char>(pixel.b - previous_.b));
+                int drg = dr - dg;
+                int dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *out++ = static_cast<unsigned char>(QoiFormat::OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                    *out++ = static_cast<unsigned char>(QoiFormat::OP_LUMA | (dg + 32));
+                    *out++ = static_cast<unsigned char>(((drg + 8) << 4) | (dbg + 8));
+                } else {
+                    *out++ = QoiFormat::OP_RGB;
+                    *out++ = pixel.r;
+                    *out++ = pixel.g;
+                    *out++ = pixel.b;
+                }
+            } else {
+                *out++ = QoiFormat::OP_RGBA;
+                *out++ = pixel.r;
+                *out++ = pixel.g;
+                *out++ = pixel.b;
+                *out++ = pixel.a;
+            }
+        }
+        previous_ = pixel;
+    }
+
+    std::basic_ostream<char> &output_;
+    unsigned int width_ = 0;
+    QoiFormat::Pixel previous_ = QoiFormat::startPixel();
+    QoiFormat::Pixel index_[64] = {};
+    unsigned int run_ = 0;
+    std::vector<unsigned char> buffer_;
+    size_t used_ = 0;
+    std::vector<unsigned char> rowBuffer_;
+};
+
+// Streaming QOI decoder: reads header and then decodes image row by row from top to bottom,
+// input is read in blocks of BLOCK_SIZE bytes.
+class QoiRowDecoder {
+public:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    explicit QoiRowDecoder(std::basic_istream<char> &input) : input_(input) {}
+
+    // reads file header, returns false if it is not a valid QOI header
+    bool readHeader() {
+        unsigned char header[QoiFormat::HEADER_SIZE];
+        if (!input_.read(reinterpret_cast<char *>(header), sizeof(header)))
+            return false;
+        if (memcmp(header, "qoif", 4) != 0 || (header[12] != 3 && header[12] != 4) || header[13] > 1)
+            return false;
+
+        width_ = QoiFormat::getUint32(header + 4);
+        height_ = QoiFormat::getUint32(header + 8);
+        channels_ = header[12];
+        if (width_ > 0x7FFFFFFFu || height_ > 0x7FFFFFFFu)
+            return false;
+
+        previous_ = QoiFormat::startPixel();
+        memset(index_, 0, sizeof(index_));
+        run_ = 0;
+        rowsDecoded_ = 0;
+        pos_ = end_ = 0;
+        return true;
+    }
+
+    unsigned int width() const {
+        return width_;
+    }
+
+    unsigned int height() const {
+        return height_;
+    }
+
+    unsigned int channels() const {
+        return channels_;
+    }
+
+    unsigned int rowsDecoded() const {
+        return rowsDecoded_;
+    }
+
+    // Decodes next row into `output` as packed RGB (outputChannels = 3) or RGBA with straight alpha (4).
+    // Returns false if there are no more rows or data is truncated.
+    bool decodeRow(unsigned char *output, unsigned int outputChannels) {
+        if (rowsDecoded_ >= height_)
+            return false;
+        bool result = outputChannels == 4 ? decodeRowTo<4>(output) : decodeRowTo<3>(output);
+        if (result)
+            ++rowsDecoded_;
+        return result;
+    }
+
+private:
+    template<unsigned int Channels>
+    bool decodeRowTo(unsigned char *output) {
+        QoiFormat::Pixel pixel = previous_;
+        for (unsigned int x = 0; x < width_; ++x, output += Channels) {
+            if (run_ > 0) {
+                --run_;
+            } else {
+                unsigned char op;
+                if (!nextByte(op))
+                    return false;
+
+                if (op == QoiFormat::OP_RGB) {
+                    if (!nextByte(pixel.r) || !nextByte(pixel.g) || !nextByte(pixel.b))
+                        return false;
+                } else if (op == QoiFormat::OP_RGBA) {
+                    if (!nextByte(pixel.r) || !nextByte(pixel.g) || !nextByte(pixel.b) || !nextByte(pixel.a))
+                        return false;
+                } else if ((op & QoiFormat::OP_MASK) == QoiFormat::OP_INDEX) {
+                    pixel = index_[op];
+                } else if ((op & QoiFormat::OP_MASK) == QoiFormat::OP_DIFF) {
+                    pixel.r = static_cast<unsigned char>(pixel.r + ((op >> 4) & 3) - 2);
+                    pixel.g = static_cast<unsigned char>(pixel.g + ((op >> 2) & 3) - 2);
+                    pixel.b = static_cast<unsigned char>(pixel.b + (op & 3) - 2);
+                } else if ((op & QoiFormat::OP_MASK) == QoiFormat::OP_LUMA) {
+                    unsigned char second;
+                    if (!nextByte(second))
+                        return false;
+                    int dg = (op & 0x3F) - 32;
+                    pixel.r = static_cast<unsigned char>(pixel.r + dg - 8 + ((second >> 4) & 0x0F));
+                    pixel.g = static_cast<unsigned char>(pixel.g + dg);
+                    pixel.b = static_cast<unsigned char>(pixel.b + dg - 8 + (second & 0x0F));
+                } else {
+                    run_ = op & 0x3Fu;
+                }
+                index_[pixel.hash()] = pixel;
+            }
+
+            output[0] = pixel.r;
+            output[1] = pixel.g;
+            output[2] = pixel.b;
+            if (Channels == 4)
+                output[3] = pixel.a;
+        }
+        previous_ = pixel;
+        return true;
+    }
+
+    bool nextByte(unsigned char &value) {
+        if (pos_ == end_ && !refill())
+            return false;
+        value = block_[pos_++];
+        return true;
+    }
+
+    bool refill() {
+        block_.resize(BLOCK_SIZE);
+        input_.read(reinterpret_cast<char *>(block_.data()), static_cast<std::streamsize>(block_.size()));
+        pos_ = 0;
+        end_ = static_cast<size_t>(input_.gcount());
+        if (end_ > 0 && input_.eof())
+            input_.clear(input_.rdstate() & ~(std::ios::eofbit | std::ios::failbit));
+        return end_ > 0;
+    }
+
+    std::basic_istream<char> &input_;
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    unsigned int channels_ = 0;
+    unsigned int rowsDecoded_ = 0;
+    QoiFormat::Pixel previous_ = QoiFormat::startPixel();
+    QoiFormat::Pixel index_[64] = {};
+    unsigned int run_ = 0;
+    std::vector<unsigned char> block_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+};
+
+// class which reads QOI file into RgbImage (loadImage / loadImagePart) or into any image (load...Into).
+// QOI can only be decoded sequentially: loading a part decodes rows up to the last requested one,
+// rows above it are decoded without being stored and rows below it are not read at all.
+// Rows of new RgbImage are decoded straight into image memory.
+class QoiImageLoader : public PixelImageLoader {
+public:
+    enum ErrorCodes {
+        HEADER_INCORRECT,
+        DATA_INCORRECT
+    };
+
+    QoiImageLoader(std::basic_istream<char> &input) : decoder_(input) {}
+
+    virtual ~QoiImageLoader() {}
+
+    virtual PixelImageMetaInfo *loadImageMeta() {
+        if (!decoder_.readHeader()) {
+            handleError(HEADER_INCORRECT);
+            return nullptr;
+        }
+        std::unique_ptr<PixelImageMetaInfoBase> meta(new PixelImageMetaInfoBase);
+        meta->setSize(Point(static_cast<int>(decoder_.width()), static_cast<int>(decoder_.height())));
+        return meta.release();
+    }
+
+    virtual PixelImageBase *loadImage() {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return nullptr;
+
+        std::unique_ptr<RgbImage> image(new RgbImage(decoder_.width(), decoder_.height()));
+        for (unsigned int y = 0, height = image->height(); y < height; ++y) {
+            if (!decoder_.decodeRow(image->row(y), 3)) {
+                handleError(DATA_INCORRECT);
+                return nullptr;
+            }
+        }
+        return image.release();
+    }
+
+    virtual PixelImageBase *loadImagePart(const Rect &srcPart, const Point &targetOffset) {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return nullptr;
+
+        std::unique_ptr<PixelImageBase> image(new RgbImage(decoder_.width(), decoder_.height()));
+        if (!loadPixelDataInto(*image, srcPart, targetOffset))
+            return nullptr;
+        return image.release();
+    }
+
+    virtual bool loadImageInto(PixelImageBase &outputImage) {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return false;
+
+        Rect srcPart;
+        srcPart.topLeft(Point(0, 0)).size(meta->getSize());
+        return loadPixelDataInto(outputImage, srcPart, Point(0, 0));
+    }
+
+    virtual bool loadImagePartInto(PixelImageBase &outputImage, const Rect &srcPart, const Point &targetOffset) {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return false;
+        return loadPixelDataInto(outputImage, srcPart, targetOffset);
+    }
+
+    // loads image with its alpha channel, returns nullptr if file is invalid
+    RgbaImage *loadRgbaImage() {
+        std::unique_ptr<PixelImageMetaInfo> meta(loadImageMeta());
+        if (!meta.get())
+            return nullptr;
+
+        std::unique_ptr<RgbaImage> image(new RgbaImage(decoder_.width(), decoder_.height()));
+        for (unsigned int y = 0, height = image->height(); y < height; ++y) {
+            unsigned char *row = image->row(y);
+            if (!decoder_.decodeRow(row, 4)) {
+                handleError(DATA_INCORRECT);
+                return nullptr;
+            }
+            // image keeps colors premultiplied
+            for (unsigned int x = 0, width = image->width(); x < width; ++x, row += 4) {
+                if (row[3] != 255) {
+                    RgbaColor color = color_utils::premultiply(RgbaColor{row[0], row[1], row[2], row[3]});
+                    row[0] = color.red;
+                    row[1] = color.green;
+                    row[2] = color.blue;
+                }
+            }
+        }
+        return image.release();
+    }
+
+protected:
+    // decodes rows up to the last one of srcFragment (inclusive) which is visible in output image
+    bool loadPixelDataInto(PixelImageBase &outputImage, const Rect &srcFragment, const Point &destOffset) {
+        Point srcSize(static_cast<int>(decoder_.width()), static_cast<int>(decoder_.height()));
+        RectInclusive area;
+        if (!PpmImageLoader::clipFragment(srcSize, srcFragment, outputImage.getSize(), destOffset, area))
+            return true;
+
+        std::vector<unsigned char> buffer(static_cast<size_t>(decoder_.width()) * 3);
+        unsigned int count = UNSIGNED_CAST(unsigned int, area.x2 - area.x1 + 1);
+        for (int y = 0; y <= area.y2; ++y) {
+            if (!decoder_.decodeRow(buffer.data(), 3)) {
+                handleError(DATA_INCORRECT);
+                return false;
+            }
+            if (y < area.y1)
+                continue;
+
+            outputImage.writeRow(UNSIGNED_CAST(unsigned int, y - srcFragment.y1 + destOffset.y),
+                                 UNSIGNED_CAST(unsigned int, area.x1 - srcFragment.x1 + destOffset.x),
+                                 count, buffer.data() + UNSIGNED_CAST(size_t, area.x1) * 3);
+        }
+        return true;
+    }
+
+    virtual void handleError(unsigned int errorCode [[maybe_unused]]) {
+        // does nothing
+    }
+
+private:
+    QoiRowDecoder decoder_;
+};
+
+#endif
@@ -2,18 +2,24 @@
 #define _UIMG_RGB_IMAGE_H__
 
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include <cstddef> // For size_t
+#include <stdexcept>
+#include <utility>
 
 #include "uimg/base/structs.h"
 #include "uimg/images/pixel_image.h"
+#include "uimg/utils/aligned_allocator.h"
 #include "uimg/utils/cast.h"
 
-// RGB in-memory image container.
-// Each pixel is represented as three bytes (red, green, blue), from top left to bottom right, (0,0) = top, left
-class RgbImage : public PixelImageBase {
+// Base for RGB pixel containers which keep pixels in memory as rows of three bytes (red, green, blue).
+// Rows are stored `stride()` bytes apart, so row(y) should be used to access pixel data - bytes at the
+// end of row (padding) are not part of image.
+// Memory is not owned by this class - see RgbImage (owning container) and ImageView (window into other image).
+class RgbImageBase : public PixelImageBase {
 public:
-    RgbImage(unsigned int width, unsigned int height) : data_(3 * width * height), width_(width), height_(height) {
-    }
+    static constexpr unsigned int BYTES_PER_PIXEL = 3;
 
     // returns image width
     virtual unsigned int width() const {
@@ -29,61 +35,160 @@ public:
         return Point(static_cast<int>(width_), static_cast<int>(height_));
     }
 
+    // distance in bytes between starts of two consecutive rows
+    size_t stride() const {
+        return stride_;
+    }
+
+    // number of bytes used by pixels of one row
+    size_t rowSize() const {
+        return static_cast<size_t>(width_) * BYTES_PER_PIXEL;
+    }
+
+    // true if there is no padding between rows
+    bool isContiguous() const {
+        return stride_ == rowSize();
+    }
+
+    // returns pointer to first pixel of row y
+    unsigned char *row(unsigned int y) {
+        return pixels_ + static_cast<size_t>(y) * stride_;
+    }
+
+    const unsigned char *row(unsigned int y) const {
+        return pixels_ + static_cast<size_t>(y) * stride_;
+    }
+
     virtual RgbColor getPixel(const Point &pos) const {
         RgbColor r;
-        if (pos.x >= 0 && pos.y >= 0 && 
-            UNSIGNED_CAST(unsigned int, pos.x) < width_ && 
+        if (pos.x >= 0 && pos.y >= 0 &&
+            UNSIGNED_CAST(unsigned int, pos.x) < width_ &&
             UNSIGNED_CAST(unsigned int, pos.y) < height_) {
-            unsigned int offset = (UNSIGNED_CAST(unsigned int, pos.y) * width_ + UNSIGNED_CAST(unsigned int, pos.x)) * 3;
-            r.red = data_[offset];
-            r.green = data_[offset + 1];
-            r.blue = data_[offset + 2];
+            const unsigned char *pixel = row(UNSIGNED_CAST(unsigned int, pos.y)) + static_cast<size_t>(pos.x) * BYTES_PER_PIXEL;
+            r.red = pixel[0];
+            r.green = pixel[1];
+            r.blue = pixel[2];
         } else {
             r.red = r.blue = r.green = 0;
         }
         return r;
     }
-    
+
+    // rows are already packed RGB - returned without copying
+    virtual const unsigned char *readRow(unsigned int y, unsigned char *buffer [[maybe_unused]]) const {
+        return row(y);
+    }
+
+    virtual void writeRow(unsigned int y, unsigned int x, unsigned int count, const unsigned char *rgb) {
+        if (y >= height_ || x >= width_)
+            return;
+        memcpy(row(y) + static_cast<size_t>(x) * BYTES_PER_PIXEL, rgb,
+               static_cast<size_t>(std::min(count, width_ - x)) * BYTES_PER_PIXEL);
+    }
+
     // For direct x,y coordinate access
     RgbColor getPixel(int x, int y) const {
         return getPixel(Point(x, y));
     }
-    
+
     // Alias for width() for consistency with other libraries
     unsigned int getWidth() const {
         return width();
     }
-    
+
     // Alias for height() for consistency with other libraries
     unsigned int getHeight() const {
         return height();
     }
 
     virtual void setPixel(const Point &pos, const RgbColor &color) {
-        if (pos.x >= 0 && pos.y >= 0 && 
-            UNSIGNED_CAST(unsigned int, pos.x) < width_ && 
+        if (pos.x >= 0 && pos.y >= 0 &&
+            UNSIGNED_CAST(unsigned int, pos.x) < width_ &&
             UNSIGNED_CAST(unsigned int, pos.y) < height_) {
-            unsigned int offset = (UNSIGNED_CAST(unsigned int, pos.y) * width_ + UNSIGNED_CAST(unsigned int, pos.x)) * 3;
-            data_[offset] = color.red;
-            data_[offset + 1] = color.green;
-            data_[offset + 2] = color.blue;
+            unsigned char *pixel = row(UNSIGNED_CAST(unsigned int, pos.y)) + static_cast<size_t>(pos.x) * BYTES_PER_PIXEL;
+            pixel[0] = color.red;
+            pixel[1] = color.green;
+            pixel[2] = color.blue;
+        }
+    }
+
+protected:
+    RgbImageBase() : pixels_(nullptr), width_(0), height_(0), stride_(0) {}
+
+    void setLayout(unsigned char *pixels, unsigned int width, unsigned int height, size_t stride) {
+        pixels_ = pixels;
+        width_ = width;
+        height_ = height;
+        stride_ = stride;
+    }
+
+private:
+    unsigned char *pixels_;
+    unsigned int width_;
+    unsigned int height_;
+    size_t stride_;
+};
+
+// RGB in-memory image container.
+// Each pixel is represented as three bytes (red, green, blue), from top left to bottom right, (0,0) = top, left
+// By default rows start at cache-line (64 byte) aligned addresses.
+class RgbImage : public RgbImageBase {
+public:
+    static constexpr size_t ROW_ALIGNMENT = 64;
+
+    // stride = 0 means default: row size rounded up to ROW_ALIGNMENT
+    RgbImage(unsigned int width, unsigned int height, size_t stride = 0) {
+        size_t rowStride = stride ? stride : alignedStride(width);
+        if (rowStride < static_cast<size_t>(width) * BYTES_PER_PIXEL)
+            throw std::invalid_argument("RgbImage: stride smaller than row size");
+        data_.resize(rowStride * height);
+        setLayout(data_.data(), width, height, rowStride);
+    }
+
+    RgbImage(const RgbImage &other) : RgbImageBase(), data_(other.data_) {
+        setLayout(data_.data(), other.width(), other.height(), other.stride());
+    }
+
+    RgbImage(RgbImage &&other) noexcept : RgbImageBase(), data_(std::move(other.data_)) {
+        setLayout(data_.data(), other.width(), other.height(), other.stride());
+        other.setLayout(nullptr, 0, 0, 0);
+    }
+
+    RgbImage &operator=(const RgbImage &other) {
+        if (this != &other) {
+            data_ = other.data_;
+            setLayout(data_.data(), other.width(), other.height(), other.stride());
+        }
+        return *this;
+    }
+
+    RgbImage &operator=(RgbImage &&other) noexcept {
+        if (this != &other) {
+            data_ = std::move(other.data_);
+            setLayout(data_.data(), other.width(), other.height(), other.stride());
+            other.setLayout(nullptr, 0, 0, 0);
         }
+        return *this;
+    }
+
+    // returns row size rounded up to given alignment (power of two)
+    static size_t alignedStride(unsigned int width, size_t alignment = ROW_ALIGNMENT) {
+        size_t size = static_cast<size_t>(width) * BYTES_PER_PIXEL;
+        return (size + alignment - 1) & ~(alignment - 1);
     }
 
-    // returns raw pointer to internal data
+    // returns raw pointer to internal data (first row)
     virtual void *data() {
-        return &(data_[0]);
+        return data_.data();
     }
 
-    // returns size in bytes of data
+    // returns size in bytes of data, including row padding (stride * height)
     virtual size_t dataSize() {
         return data_.size();
     }
 
 private:
-    std::vector<unsigned char> data_;
-    unsigned int width_;
-    unsigned int height_;
+    std::vector<unsigned char, AlignedAllocator<unsigned char, ROW_ALIGNMENT>> data_;
 };
 
 #endif
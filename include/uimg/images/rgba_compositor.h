@@ -0,0 +1,137 @@
+#ifndef __UIMG_RGBA_COMPOSITOR_H__
+#define __UIMG_RGBA_COMPOSITOR_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/utils/cast.h"
+#include "uimg/utils/color_utils.h"
+
+// Porter-Duff compositing of premultiplied RGBA pixels (see RgbaImage).
+// Span functions work on raw rows of `count` pixels, they use integer arithmetic only and have no
+// branches in inner loops, so compilers can vectorize them.
+// Image functions composite layer placed at `offset` of target, parts outside of target are skipped.
+//
+// Typical use: render translucent overlays into separate RgbaImage layers, then composite all of them
+// onto opaque RGB image in a single pass (overLayers).
+class RgbaCompositor {
+public:
+    // dst = src over dst (premultiplied RGBA)
+    static void overSpan(unsigned char *dst, const unsigned char *src, size_t count) {
+        for (size_t i = 0; i < count * 4; i += 4) {
+            unsigned int inv = 255u - src[i + 3];
+            dst[i] = static_cast<unsigned char>(src[i] + color_utils::mul_div_255(dst[i], inv));
+            dst[i + 1] = static_cast<unsigned char>(src[i + 1] + color_utils::mul_div_255(dst[i + 1], inv));
+            dst[i + 2] = static_cast<unsigned char>(src[i + 2] + color_utils::mul_div_255(dst[i + 2], inv));
+            dst[i + 3] = static_cast<unsigned char>(src[i + 3] + color_utils::mul_div_255(dst[i + 3], inv));
+        }
+    }
+
+    // dst = src over dst, where dst is opaque RGB (three bytes per pixel)
+    static void overSpanRgb(unsigned char *dst, const unsigned char *src, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            unsigned int inv = 255u - src[i * 4 + 3];
+            dst[i * 3] = static_cast<unsigned char>(src[i * 4] + color_utils::mul_div_255(dst[i * 3], inv));
+            dst[i * 3 + 1] = static_cast<unsigned char>(src[i * 4 + 1] + color_utils::mul_div_255(dst[i * 3 + 1], inv));
+            dst[i * 3 + 2] = static_cast<unsigned char>(src[i * 4 + 2] + color_utils::mul_div_255(dst[i * 3 + 2], inv));
+        }
+    }
+
+    // dst = src in dst: source visible only where destination is (scaled by destination alpha)
+    static void inSpan(unsigned char *dst, const unsigned char *src, size_t count) {
+        for (size_t i = 0; i < count * 4; i += 4) {
+            unsigned int alpha = dst[i + 3];
+            dst[i] = static_cast<unsigned char>(color_utils::mul_div_255(src[i], alpha));
+            dst[i + 1] = static_cast<unsigned char>(color_utils::mul_div_255(src[i + 1], alpha));
+            dst[i + 2] = static_cast<unsigned char>(color_utils::mul_div_255(src[i + 2], alpha));
+            dst[i + 3] = static_cast<unsigned char>(color_utils::mul_div_255(src[i + 3], alpha));
+        }
+    }
+
+    // dst = src out dst: source visible only where destination is not (scaled by destination transparency)
+    static void outSpan(unsigned char *dst, const unsigned char *src, size_t count) {
+        for (size_t i = 0; i < count * 4; i += 4) {
+            unsigned int inv = 255u - dst[i + 3];
+            dst[i] = static_cast<unsigned char>(color_utils::mul_div_255(src[i], inv));
+            dst[i + 1] = static_cast<unsigned char>(color_utils::mul_div_255(src[i + 1], inv));
+            dst[i + 2] = static_cast<unsigned char>(color_utils::mul_div_255(src[i + 2], inv));
+            dst[i + 3] = static_cast<unsigned char>(color_utils::mul_div_255(src[i + 3], inv));
+        }
+    }
+
+    // composites layer over opaque RGB image (RgbImage or ImageView)
+    static void over(const RgbaImage &layer, RgbImageBase &target, const Point &offset = Point(0, 0)) {
+        Clip clip(layer.getSize(), target.getSize(), offset);
+        for (unsigned int y = 0; y < clip.height; ++y)
+            overSpanRgb(target.row(clip.dstY + y) + clip.dstX * RgbImageBase::BYTES_PER_PIXEL,
+                        layer.row(clip.srcY + y) + clip.srcX * RgbaImage::BYTES_PER_PIXEL, clip.width);
+    }
+
+    static void over(const RgbaImage &layer, RgbaImage &target, const Point &offset = Point(0, 0)) {
+        apply(&RgbaCompositor::overSpan, layer, target, offset);
+    }
+
+    static void in(const RgbaImage &layer, RgbaImage &target, const Point &offset = Point(0, 0)) {
+        apply(&RgbaCompositor::inSpan, layer, target, offset);
+    }
+
+    static void out(const RgbaImage &layer, RgbaImage &target, const Point &offset = Point(0, 0)) {
+        apply(&RgbaCompositor::outSpan, layer, target, offset);
+    }
+
+    // composites all layers (in order, first is bottom) over target in one pass: each target row is
+    // blended with matching rows of all layers while it is still in cache. Layers are aligned to
+    // top-left corner of target.
+    static void overLayers(RgbImageBase &target, const std::vector<const RgbaImage *> &layers) {
+        for (unsigned int y = 0, height = target.height(); y < height; ++y) {
+            unsigned char *dst = target.row(y);
+            for (const RgbaImage *layer : layers) {
+                if (y >= layer->height())
+                    continue;
+                overSpanRgb(dst, layer->row(y), std::min(target.width(), layer->width()));
+            }
+        }
+    }
+
+private:
+    // part of source (of size `srcSize`) which lands inside of target when placed at `offset`
+    struct Clip {
+        Clip(const Point &srcSize, const Point &dstSize, const Point &offset)
+                : srcX(0), srcY(0), dstX(0), dstY(0), width(0), height(0) {
+            int x1 = std::max(0, offset.x);
+            int y1 = std::max(0, offset.y);
+            int x2 = std::min(dstSize.x, offset.x + srcSize.x);
+            int y2 = std::min(dstSize.y, offset.y + srcSize.y);
+            if (x2 <= x1 || y2 <= y1)
+                return;
+            srcX = UNSIGNED_CAST(size_t, x1 - offset.x);
+            srcY = UNSIGNED_CAST(unsigned int, y1 - offset.y);
+            dstX = UNSIGNED_CAST(size_t, x1);
+            dstY = UNSIGNED_CAST(unsigned int, y1);
+            width = UNSIGNED_CAST(size_t, x2 - x1);
+            height = UNSIGNED_CAST(unsigned int, y2 - y1);
+        }
+
+        size_t srcX;
+        unsigned int srcY;
+        size_t dstX;
+        unsigned int dstY;
+        size_t width;
+        unsigned int height;
+    };
+
+    typedef void (*SpanOp)(unsigned char *dst, const unsigned char *src, size_t count);
+
+    static void apply(SpanOp op, const RgbaImage &layer, RgbaImage &target, const Point &offset) {
+        Clip clip(layer.getSize(), target.getSize(), offset);
+        for (unsigned int y = 0; y < clip.height; ++y)
+            op(target.row(clip.dstY + y) + clip.dstX * RgbaImage::BYTES_PER_PIXEL,
+               layer.row(clip.srcY + y) + clip.srcX * RgbaImage::BYTES_PER_PIXEL, clip.width);
+    }
+};
+
+#endif
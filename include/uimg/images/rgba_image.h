@@ -0,0 +1,196 @@
+#ifndef __UIMG_RGBA_IMAGE_H__
+#define __UIMG_RGBA_IMAGE_H__
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/utils/aligned_allocator.h"
+#include "uimg/utils/cast.h"
+#include "uimg/utils/color_utils.h"
+
+// RGBA in-memory image container with premultiplied alpha.
+// Each pixel is represented as four bytes (red, green, blue, alpha), color components are stored
+// already multiplied by alpha, so compositing needs only integer multiply-adds (see RgbaCompositor).
+// Rows are stored `stride()` bytes apart, by default at cache-line (64 byte) aligned addresses.
+// New image is fully transparent.
+//
+// As PixelImageBase it reads colors without alpha (unpremultiplied) and writes opaque colors,
+// use getPixelRgba / setPixelRgba to access alpha (straight, not premultiplied values).
+class RgbaImage : public PixelImageBase {
+public:
+    static constexpr unsigned int BYTES_PER_PIXEL = 4;
+    static constexpr size_t ROW_ALIGNMENT = 64;
+
+    // stride = 0 means default: row size rounded up to ROW_ALIGNMENT
+    RgbaImage(unsigned int width, unsigned int height, size_t stride = 0)
+            : width_(width), height_(height), stride_(stride ? stride : alignedStride(width)) {
+        if (stride_ < rowSize())
+            throw std::invalid_argument("RgbaImage: stride smaller than row size");
+        data_.resize(stride_ * height_);
+    }
+
+    // returns row size rounded up to given alignment (power of two)
+    static size_t alignedStride(unsigned int width, size_t alignment = ROW_ALIGNMENT) {
+        size_t size = static_cast<size_t>(width) * BYTES_PER_PIXEL;
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    virtual unsigned int width() const {
+        return width_;
+    }
+
+    virtual unsigned int height() const {
+        return height_;
+    }
+
+    virtual Point getSize() const {
+        return Point(static_cast<int>(width_), static_cast<int>(height_));
+    }
+
+    // distance in bytes between starts of two consecutive rows
+    size_t stride() const {
+        return stride_;
+    }
+
+    // number of bytes used by pixels of one row
+    size_t rowSize() const {
+        return static_cast<size_t>(width_) * BYTES_PER_PIXEL;
+    }
+
+    // returns pointer to first pixel of row y (premultiplied RGBA)
+    unsigned char *row(unsigned int y) {
+        return data_.data() + static_cast<size_t>(y) * stride_;
+    }
+
+    const unsigned char *row(unsigned int y) const {
+        return data_.data() + static_cast<size_t>(y) * stride_;
+    }
+
+    // returns color without alpha, transparent pixels are black
+    virtual RgbColor getPixel(const Point &pos) const {
+        RgbaColor rgba = getPixelRgba(pos);
+        RgbColor r;
+        r.red = rgba.red;
+        r.green = rgba.green;
+        r.blue = rgba.blue;
+        return r;
+    }
+
+    // sets opaque color
+    virtual void setPixel(const Point &pos, const RgbColor &color) {
+        RgbaColor rgba;
+        rgba.red = color.red;
+        rgba.green = color.green;
+        rgba.blue = color.blue;
+        rgba.alpha = 255;
+        setPremultipliedPixel(pos, rgba);
+    }
+
+    // converts row to RGB without alpha (unpremultiplied)
+    virtual const unsigned char *readRow(unsigned int y, unsigned char *buffer) const {
+        const unsigned char *src = row(y);
+        unsigned char *dst = buffer;
+        for (unsigned int x = 0; x < width_; ++x, src += BYTES_PER_PIXEL, dst += 3) {
+            RgbaColor color;
+            color.red = src[0];
+            color.green = src[1];
+            color.blue = src[2];
+            color.alpha = src[3];
+            color = color_utils::unpremultiply(color);
+            dst[0] = color.red;
+            dst[1] = color.green;
+            dst[2] = color.blue;
+        }
+        return buffer;
+    }
+
+    // writes opaque pixels
+    virtual void writeRow(unsigned int y, unsigned int x, unsigned int count, const unsigned char *rgb) {
+        if (y >= height_ || x >= width_)
+            return;
+        unsigned char *dst = row(y) + static_cast<size_t>(x) * BYTES_PER_PIXEL;
+        for (unsigned int i = 0, end = std::min(count, width_ - x); i < end; ++i, dst += BYTES_PER_PIXEL, rgb += 3) {
+            dst[0] = rgb[0];
+            dst[1] = rgb[1];
+            dst[2] = rgb[2];
+            dst[3] = 255;
+        }
+    }
+
+    // returns color with straight alpha
+    RgbaColor getPixelRgba(const Point &pos) const {
+        return color_utils::unpremultiply(getPremultipliedPixel(pos));
+    }
+
+    // sets color with straight alpha (replaces pixel, without blending)
+    void setPixelRgba(const Point &pos, const RgbaColor &color) {
+        setPremultipliedPixel(pos, color_utils::premultiply(color));
+    }
+
+    RgbaColor getPremultipliedPixel(const Point &pos) const {
+        RgbaColor r;
+        if (isInside(pos)) {
+            const unsigned char *pixel = pixelPtr(pos);
+            r.red = pixel[0];
+            r.green = pixel[1];
+            r.blue = pixel[2];
+            r.alpha = pixel[3];
+        } else {
+            r.clear();
+        }
+        return r;
+    }
+
+    void setPremultipliedPixel(const Point &pos, const RgbaColor &color) {
+        if (isInside(pos)) {
+            unsigned char *pixel = pixelPtr(pos);
+            pixel[0] = color.red;
+            pixel[1] = color.green;
+            pixel[2] = color.blue;
+            pixel[3] = color.alpha;
+        }
+    }
+
+    // makes all pixels fully transparent
+    void clear() {
+        for (unsigned int y = 0; y < height_; ++y)
+            memset(row(y), 0, rowSize());
+    }
+
+    // returns raw pointer to internal data (first row)
+    void *data() {
+        return data_.data();
+    }
+
+    // returns size in bytes of data, including row padding (stride * height)
+    size_t dataSize() const {
+        return data_.size();
+    }
+
+private:
+    bool isInside(const Point &pos) const {
+        return pos.x >= 0 && pos.y >= 0 &&
+               UNSIGNED_CAST(unsigned int, pos.x) < width_ &&
+               UNSIGNED_CAST(unsigned int, pos.y) < height_;
+    }
+
+    unsigned char *pixelPtr(const Point &pos) {
+        return row(UNSIGNED_CAST(unsigned int, pos.y)) + UNSIGNED_CAST(size_t, pos.x) * BYTES_PER_PIXEL;
+    }
+
+    const unsigned char *pixelPtr(const Point &pos) const {
+        return row(UNSIGNED_CAST(unsigned int, pos.y)) + UNSIGNED_CAST(size_t, pos.x) * BYTES_PER_PIXEL;
+    }
+
+    unsigned int width_;
+    unsigned int height_;
+    size_t stride_;
+    std::vector<unsigned char, AlignedAllocator<unsigned char, ROW_ALIGNMENT>> data_;
+};
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef __UIMG_SHARED_RGB_IMAGE_H__
+#define __UIMG_SHARED_RGB_IMAGE_H__
+
+#include "uimg/base/platform.h"
+
+#if UIMG_HAS_POSIX
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "uimg/images/rgb_image.h"
+
+// RGB image allocated in a named POSIX shared memory segment (shm_open), for handing finished frames to another
+// local process (e.g. a compositor) without serialization or copying.
+// Segment starts with a small header (size, stride, sequence number) followed by rows aligned like in RgbImage.
+// Producer creates the segment, paints into it like into any RgbImageBase and brackets every frame with
+// beginFrame() / publishFrame(). Consumer opens the segment by name and reads pixels in place, using the sequence
+// number as a seqlock: it is odd while a frame is being painted and is advanced by two for every published frame.
+// Readers never block the producer - a read which overlapped painting is detected by validateRead() and retried.
+// Throws std::runtime_error if segment cannot be created, opened or mapped.
+class SharedRgbImage : public RgbImageBase {
+public:
+    // creates segment `name` (has to start with '/', e.g. "/uimg_frame") with black image;
+    // segment name is removed when this object is destroyed unless `unlinkOnClose` is false.
+    // An existing segment of the same name is unlinked and a new one is created, never truncated in place:
+    // consumers which still map the old segment keep reading its last frame (shrinking memory mapped by them
+    // would kill them with SIGBUS) and have to open the name again to see the new one.
+    SharedRgbImage(const std::string &name, unsigned int width, unsigned int height, bool unlinkOnClose = true)
+            : name_(name), unlinkOnClose_(unlinkOnClose) {
+        checkName(name);
+        size_t stride = RgbImage::alignedStride(width);
+        size_t size = DATA_OFFSET + stride * height;
+
+        ::shm_unlink(name.c_str());
+        // exclusive create fails if another producer recreated the name in between
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+            throw std::runtime_error("SharedRgbImage: cannot create segment: " + name);
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("SharedRgbImage: cannot resize segment: " + name);
+        }
+        try {
+            map(fd, size);
+        } catch (...) {
+            ::shm_unlink(name.c_str());
+            throw;
+        }
+
+        header_ = new (mapping_) Header();
+        header_->width = width;
+        header_->height = height;
+        header_->stride = stride;
+        header_->dataOffset = DATA_OFFSET;
+        header_->sequence.store(0, std::memory_order_relaxed);
+        // magic is published last, so a consumer never accepts half initialized header
+        header_->magic.store(MAGIC, std::memory_order_release);
+        setLayout(mapping_ + DATA_OFFSET, width, height, stride);
+    }
+
+    // opens existing segment created by another SharedRgbImage (usually in another process)
+    explicit SharedRgbImage(const std::string &name) : name_(name), unlinkOnClose_(false) {
+        checkName(name);
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            throw std::runtime_error("SharedRgbImage: cannot open segment: " + name);
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < DATA_OFFSET) {
+            ::close(fd);
+            throw std::runtime_error("SharedRgbImage: invalid segment: " + name);
+        }
+        map(fd, static_cast<size_t>(info.st_size));
+
+        header_ = reinterpret_cast<Header *>(mapping_);
+        if (header_->magic.load(std::memory_order_acquire) != MAGIC || header_->dataOffset != DATA_OFFSET ||
+            header_->stride < static_cast<size_t>(header_->width) * BYTES_PER_PIXEL ||
+            header_->stride * header_->height > size_ - DATA_OFFSET) {
+            ::munmap(mapping_, size_);
+            throw std::runtime_error("SharedRgbImage: invalid segment header: " + name);
+        }
+        setLayout(mapping_ + DATA_OFFSET, header_->width, header_->height, static_cast<size_t>(header_->stride));
+    }
+
+    SharedRgbImage(const SharedRgbImage &) = delete;
+
+    SharedRgbImage &operator=(const SharedRgbImage &) = delete;
+
+    ~SharedRgbImage() {
+        ::munmap(mapping_, size_);
+        if (unlinkOnClose_)
+            ::shm_unlink(name_.c_str());
+    }
+
+    // removes segment name; processes which mapped it keep their mapping
+    static void unlink(const std::string &name) {
+        ::shm_unlink(name.c_str());
+    }
+
+    const std::string &name() const {
+        return name_;
+    }
+
+    // producer: marks start of painting of next frame (sequence becomes odd)
+    void beginFrame() {
+        uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+        if (sequence % 2 != 0)
+            throw std::logic_error("SharedRgbImage: frame already started");
+        header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+        // pixel writes of the new frame cannot be moved before the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // producer: publishes painted frame (sequence becomes even again)
+    void publishFrame() {
+        uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+        if (sequence % 2 == 0)
+            throw std::logic_error("SharedRgbImage: frame not started");
+        header_->sequence.store(sequence + 1, std::memory_order_release);
+    }
+
+    // number of published frames
+    uint64_t frameCount() const {
+        return header_->sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    // consumer: waits until no frame is being painted and returns sequence number to pass to validateRead()
+    uint64_t beginRead() const {
+        for (;;) {
+            uint64_t sequence = header_->sequence.load(std::memory_order_acquire);
+            if (sequence % 2 == 0)
+                return sequence;
+            std::this_thread::yield();
+        }
+    }
+
+    // consumer: true if pixels read since beginRead() returned `sequence` belong to one complete frame
+    bool validateRead(uint64_t sequence) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header_->sequence.load(std::memory_order_acquire) == sequence;
+    }
+
+    // consumer: waits until at least `count` frames are published, returns false on timeout
+    bool waitForFrame(uint64_t count, std::chrono::milliseconds timeout) const {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (frameCount() < count) {
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    // consumer: copies latest complete frame into `output` (of the same size), returns its frame number
+    uint64_t copyFrame(RgbImageBase &output) const {
+        if (output.width() != width() || output.height() != height())
+            throw std::invalid_argument("SharedRgbImage: output size differs from image size");
+        for (;;) {
+            uint64_t sequence = beginRead();
+            for (unsigned int y = 0; y < height(); ++y)
+                memcpy(output.row(y), row(y), rowSize());
+            if (validateRead(sequence))
+                return sequence / 2;
+        }
+    }
+
+private:
+    static constexpr uint64_t MAGIC = 0x314d4853474d4955ull; // "UIMGSHM1"
+    static constexpr size_t DATA_OFFSET = RgbImage::ROW_ALIGNMENT;
+
+    // layout of start of segment, fixed size fields only; magic and sequence are shared with other processes
+    // while they change, other fields are written before magic and never change after
+    struct Header {
+        std::atomic<uint64_t> magic;
+        uint32_t width;
+        uint32_t height;
+        uint64_t stride;
+        uint64_t dataOffset;
+        std::atomic<uint64_t> sequence;
+    };
+
+    static_assert(sizeof(Header) <= DATA_OFFSET, "header has to fit before first row");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "sequence has to be lock-free to be shared");
+
+    static void checkName(const std::string &name) {
+        if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos)
+            throw std::invalid_argument("SharedRgbImage: name has to be \"/\" followed by other characters");
+    }
+
+    // maps whole segment, descriptor is closed in all cases
+    void map(int fd, size_t size) {
+        void *mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            throw std::runtime_error("SharedRgbImage: cannot map segment: " + name_);
+        mapping_ = static_cast<unsigned char *>(mapped);
+        size_ = size;
+    }
+
+    std::string name_;
+    bool unlinkOnClose_;
+    unsigned char *mapping_ = nullptr;
+    size_t size_ = 0;
+    Header *header_ = nullptr;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,280 @@
+#ifndef __UIMG_TILE_PYRAMID_H__
+#define __UIMG_TILE_PYRAMID_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/images/png_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/utils/thread_pool.h"
+
+// Writes image as deep-zoom pyramid of square tiles, for interactive viewing of very large renders.
+// Level 0 is the full resolution image, every next level is the previous one downsampled 2x (box filter, last
+// column / row of odd size is averaged with itself) down to the level which fits into one tile.
+// Layout in output directory:
+//   <level>/<column>_<row>.png (or .ppm)  - tiles, edge tiles are smaller than tileSize
+//   pyramid.txt                           - image size, tile size, level count and list of uniform tiles
+// Tiles of one color are not written, they are listed in pyramid.txt as "uniform <level> <column> <row> RRGGBB".
+// Works as PixelImageStreamWriter: only one strip of tile rows per level is kept in memory, so the full resolution
+// image never has to be resident (e.g. rows come from BandedRenderer). Tiles of a strip are written in parallel.
+class TilePyramidWriter : public PixelImageWriter, public PixelImageStreamWriter {
+public:
+    enum TileFormat {
+        PNG,
+        PPM
+    };
+
+    // tileSize has to be even; threadCount = 0 means one thread per hardware core
+    explicit TilePyramidWriter(const std::string &directory, unsigned int tileSize = 256, TileFormat format = PNG,
+                               unsigned int threadCount = 0)
+            : directory_(directory), tileSize_(tileSize), format_(format), pool_(threadCount) {
+        if (tileSize < 2 || tileSize % 2 != 0)
+            throw std::invalid_argument("TilePyramidWriter: tile size has to be even");
+    }
+
+    virtual void writeImage(PixelImageBase &image) {
+        beginImage(image.width(), image.height());
+        writeRows(image);
+        endImage();
+    }
+
+    // creates level directories
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        if (width == 0 || height == 0)
+            throw std::invalid_argument("TilePyramidWriter: image size has to be positive");
+
+        width_ = width;
+        height_ = height;
+        tilesWritten_ = 0;
+        uniformTiles_.clear();
+        levels_.clear();
+        for (unsigned int w = width, h = height;; w = (w + 1) / 2, h = (h + 1) / 2) {
+            levels_.push_back(std::unique_ptr<Level>(new Level(w, h, tileSize_)));
+            std::filesystem::create_directories(levelDirectory(levels_.size() - 1));
+            if (w <= tileSize_ && h <= tileSize_)
+                break;
+        }
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        Level &level = *levels_[0];
+        if (rows.width() != width_)
+            throw std::invalid_argument("TilePyramidWriter: row width differs from image width");
+        if (rows.height() > height_ - level.rowsReceived)
+            throw std::invalid_argument("TilePyramidWriter: too many rows");
+
+        for (unsigned int y = 0, height = rows.height(); y < height; ++y) {
+            unsigned char *slot = level.strip.row(level.stripRows);
+            const unsigned char *row = rows.readRow(y, slot);
+            if (row != slot)
+                memcpy(slot, row, level.strip.rowSize());
+            if (rowAdded(0)) {
+                // strips are reused after all their tiles are written
+                pool_.wait();
+            }
+        }
+    }
+
+    // writes pyramid.txt, throws std::runtime_error if image is incomplete or a tile could not be written
+    virtual void endImage() {
+        if (levels_.empty() || levels_[0]->rowsReceived != height_)
+            throw std::runtime_error("TilePyramidWriter: image is incomplete");
+        pool_.wait();
+        writeManifest();
+    }
+
+    // number of levels of last image, level 0 is full resolution
+    unsigned int levelCount() const {
+        return static_cast<unsigned int>(levels_.size());
+    }
+
+    // size of given level
+    Point levelSize(unsigned int level) const {
+        return Point(static_cast<int>(levels_.at(level)->width), static_cast<int>(levels_.at(level)->height));
+    }
+
+    size_t tilesWritten() const {
+        return tilesWritten_;
+    }
+
+    size_t tilesSkipped() const {
+        return uniformTiles_.size();
+    }
+
+    // path of tile file, relative to output directory
+    std::string tilePath(unsigned int level, unsigned int column, unsigned int row) const {
+        return std::to_string(level) + "/" + std::to_string(column) + "_" + std::to_string(row) +
+               (format_ == PNG ? ".png" : ".ppm");
+    }
+
+    // averages 2x2 blocks of rows `row0` and `row1` (packed RGB of `width` pixels) into row of (width + 1) / 2 pixels
+    static void downsampleRows(const unsigned char *row0, const unsigned char *row1, unsigned int width,
+                               unsigned char *output) {
+        size_t pairs = width / 2;
+        for (size_t i = 0; i < pairs * 3; ++i) {
+            size_t x = i / 3 * 6 + i % 3;
+            unsigned int sum = 2u + row0[x] + row0[x + 3] + row1[x] + row1[x + 3];
+            output[i] = static_cast<unsigned char>(sum >> 2);
+        }
+        if (width % 2 != 0) {
+            for (size_t c = 0; c < 3; ++c) {
+                size_t x = pairs * 6 + c;
+                output[pairs * 3 + c] = static_cast<unsigned char>((1u + row0[x] + row1[x]) >> 1);
+            }
+        }
+    }
+
+private:
+    // one zoom level: strip of rows of current tile row
+    struct Level {
+        Level(unsigned int w, unsigned int h, unsigned int tileSize)
+                : width(w), height(h), strip(w, std::min(h, tileSize)) {}
+
+        unsigned int width;
+        unsigned int height;
+        RgbImage strip;
+        unsigned int stripRows = 0;   // rows of strip filled so far
+        unsigned int stripIndex = 0;  // tile row of strip
+        unsigned int rowsReceived = 0;
+    };
+
+    struct UniformTile {
+        unsigned int level;
+        unsigned int column;
+        unsigned int row;
+        RgbColor color;
+
+        bool operator<(const UniformTile &other) const {
+            if (level != other.level)
+                return level < other.level;
+            return row != other.row ? row < other.row : column < other.column;
+        }
+    };
+
+    // counts row just stored in strip of `index` level, returns true if strip was flushed
+    bool rowAdded(size_t index) {
+        Level &level = *levels_[index];
+        ++level.stripRows;
+        ++level.rowsReceived;
+        if (level.stripRows < level.strip.height() && level.rowsReceived < level.height)
+            return false;
+        flushStrip(index);
+        return true;
+    }
+
+    // submits tiles of full (or last) strip and passes it downsampled to next level
+    void flushStrip(size_t index) {
+        Level &level = *levels_[index];
+        for (unsigned int x = 0; x < level.width; x += tileSize_) {
+            unsigned int levelIndex = static_cast<unsigned int>(index);
+            unsigned int column = x / tileSize_;
+            unsigned int tileWidth = std::min(tileSize_, level.width - x);
+            unsigned int tileHeight = level.stripRows;
+            unsigned int stripIndex = level.stripIndex;
+            pool_.submit([this, &level, levelIndex, column, x, tileWidth, tileHeight, stripIndex]() {
+                writeTile(level.strip, levelIndex, column, stripIndex, x, tileWidth, tileHeight);
+            });
+        }
+
+        // strip of next level covers two strips of this one, so it is flushed only after the last row pair
+        // and its rows are never overwritten while its tiles are being written
+        if (index + 1 < levels_.size()) {
+            Level &next = *levels_[index + 1];
+            for (unsigned int y = 0; y < level.stripRows; y += 2) {
+                unsigned int y1 = std::min(y + 1, level.stripRows - 1);
+                downsampleRows(level.strip.row(y), level.strip.row(y1), level.width, next.strip.row(next.stripRows));
+                rowAdded(index + 1);
+            }
+        }
+
+        level.stripRows = 0;
+        ++level.stripIndex;
+    }
+
+    // copies tile out of strip and writes it, or records its color if it is uniform
+    void writeTile(const RgbImage &strip, unsigned int level, unsigned int column, unsigned int row, unsigned int x,
+                   unsigned int tileWidth, unsigned int tileHeight) {
+        RgbImage tile(tileWidth, tileHeight);
+        const unsigned char *first = strip.row(0) + static_cast<size_t>(x) * 3;
+        bool uniform = true;
+        for (unsigned int y = 0; y < tileHeight; ++y) {
+            const unsigned char *source = strip.row(y) + static_cast<size_t>(x) * 3;
+            memcpy(tile.row(y), source, tile.rowSize());
+            for (size_t i = 0; uniform && i < tile.rowSize(); i += 3)
+                uniform = source[i] == first[0] && source[i + 1] == first[1] && source[i + 2] == first[2];
+        }
+
+        if (uniform) {
+            std::lock_guard<std::mutex> lock(resultMutex_);
+            uniformTiles_.push_back({level, column, row, RgbColor::make_rgb(first[0], first[1], first[2])});
+            return;
+        }
+
+        std::string path = directory_ + "/" + tilePath(level, column, row);
+        std::ofstream output(path, std::ios::binary);
+        if (!output)
+            throw std::runtime_error("TilePyramidWriter: cannot create tile: " + path);
+        if (format_ == PNG) {
+            // tiles are already written in parallel
+            PngImageWriter writer(output, 1);
+            writer.writeImage(tile);
+        } else {
+            PpmImageWriter writer(output);
+            writer.writeImage(tile);
+        }
+        output.flush();
+        if (!output)
+            throw std::runtime_error("TilePyramidWriter: cannot write tile: " + path);
+
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        ++tilesWritten_;
+    }
+
+    void writeManifest() {
+        std::sort(uniformTiles_.begin(), uniformTiles_.end());
+        std::string path = directory_ + "/pyramid.txt";
+        std::ofstream output(path);
+        output << "uimg-pyramid 1\n"
+               << "size " << width_ << " " << height_ << "\n"
+               << "tile " << tileSize_ << "\n"
+               << "levels " << levels_.size() << "\n"
+               << "format " << (format_ == PNG ? "png" : "ppm") << "\n";
+        for (const UniformTile &tile : uniformTiles_) {
+            char color[8];
+            snprintf(color, sizeof(color), "%02x%02x%02x", tile.color.red, tile.color.green, tile.color.blue);
+            output << "uniform " << tile.level << " " << tile.column << " " << tile.row << " " << color << "\n";
+        }
+        output.flush();
+        if (!output)
+            throw std::runtime_error("TilePyramidWriter: cannot write " + path);
+    }
+
+    std::string levelDirectory(size_t level) const {
+        return directory_ + "/" + std::to_string(level);
+    }
+
+    std::string directory_;
+    unsigned int tileSize_;
+    TileFormat format_;
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    std::vector<std::unique_ptr<Level>> levels_;
+    ThreadPool pool_;
+    std::mutex resultMutex_;
+    size_t tilesWritten_ = 0;
+    std::vector<UniformTile> uniformTiles_;
+};
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef __UIMG_Y4M_IMAGE_H__
+#define __UIMG_Y4M_IMAGE_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "uimg/images/pixel_image.h"
+#include "uimg/utils/bounded_queue.h"
+
+// RGB to Y'CbCr 4:2:0 conversion (BT.601, limited range) in 8.8 fixed point.
+// Row loops are branch-free and use size_t indices, so the luma loop (two thirds of output samples) is vectorized
+// by the compiler when SSSE3 / AVX2 / NEON is enabled (e.g. -O3 -march=native).
+class YuvConverter {
+public:
+    // Y plane row: one sample per pixel
+    static void lumaRow(const unsigned char *rgb, unsigned int width, unsigned char *luma) {
+        for (size_t x = 0; x < width; ++x) {
+            const unsigned char *pixel = rgb + 3 * x;
+            unsigned int value = 66u * pixel[0] + 129u * pixel[1] + 25u * pixel[2] + 128u;
+            luma[x] = static_cast<unsigned char>((value >> 8) + 16u);
+        }
+    }
+
+    // Cb / Cr rows of a pair of image rows: one sample per 2x2 block (average of its pixels, so samples are
+    // centered between pixels like in JPEG); last column of odd width is paired with itself
+    static void chromaRows(const unsigned char *rgb0, const unsigned char *rgb1, unsigned int width,
+                           unsigned char *cb, unsigned char *cr) {
+        size_t pairs = width / 2;
+        for (size_t cx = 0; cx < pairs; ++cx) {
+            const unsigned char *p0 = rgb0 + 6 * cx;
+            const unsigned char *p1 = rgb1 + 6 * cx;
+            int r = p0[0] + p0[3] + p1[0] + p1[3];
+            int g = p0[1] + p0[4] + p1[1] + p1[4];
+            int b = p0[2] + p0[5] + p1[2] + p1[5];
+            cb[cx] = chromaBlue(r, g, b);
+            cr[cx] = chromaRed(r, g, b);
+        }
+        if (width % 2 != 0) {
+            const unsigned char *p0 = rgb0 + 6 * pairs;
+            const unsigned char *p1 = rgb1 + 6 * pairs;
+            int r = 2 * (p0[0] + p1[0]);
+            int g = 2 * (p0[1] + p1[1]);
+            int b = 2 * (p0[2] + p1[2]);
+            cb[pairs] = chromaBlue(r, g, b);
+            cr[pairs] = chromaRed(r, g, b);
+        }
+    }
+
+    // size of frame in planar 4:2:0 layout (Y plane, then Cb and Cr planes)
+    static size_t frameSize420(unsigned int width, unsigned int height) {
+        size_t chroma = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+        return static_cast<size_t>(width) * height + 2 * chroma;
+    }
+
+    // converts whole image to planar 4:2:0, `output` has to hold frameSize420() bytes;
+    // `rowBuffer` is scratch space for rows of images which are not stored as packed RGB
+    static void toYuv420(const PixelImageBase &image, unsigned char *output, std::vector<unsigned char> &rowBuffer) {
+        unsigned int width = image.width();
+        unsigned int height = image.height();
+        size_t rowSize = static_cast<size_t>(width) * 3;
+        if (rowBuffer.size() < 2 * rowSize)
+            rowBuffer.resize(2 * rowSize);
+
+        size_t chromaWidth = (width + 1) / 2;
+        unsigned char *luma = output;
+        unsigned char *cb = luma + static_cast<size_t>(width) * height;
+        unsigned char *cr = cb + chromaWidth * ((height + 1) / 2);
+
+        for (unsigned int y = 0; y < height; y += 2) {
+            const unsigned char *row0 = image.readRow(y, rowBuffer.data());
+            const unsigned char *row1 = y + 1 < height ? image.readRow(y + 1, rowBuffer.data() + rowSize) : row0;
+
+            lumaRow(row0, width, luma + static_cast<size_t>(y) * width);
+            if (row1 != row0)
+                lumaRow(row1, width, luma + static_cast<size_t>(y + 1) * width);
+
+            size_t offset = (y / 2) * chromaWidth;
+            chromaRows(row0, row1, width, cb + offset, cr + offset);
+        }
+    }
+
+private:
+    // r, g, b are sums of four samples, offsets keep intermediate values positive
+    static unsigned char chromaBlue(int r, int g, int b) {
+        return static_cast<unsigned char>((112 * b - 38 * r - 74 * g + (128 << 10) + 512) >> 10);
+    }
+
+    static unsigned char chromaRed(int r, int g, int b) {
+        return static_cast<unsigned char>((112 * r - 94 * g - 18 * b + (128 << 10) + 512) >> 10);
+    }
+};
+
+// Frame sink: writes sequence of equally sized images to a stream (file or pipe to a video encoder)
+// as YUV4MPEG2 (Y4M, 4:2:0) or as raw packed RGB frames (e.g. for `ffmpeg -f rawvideo -pix_fmt rgb24`).
+// Every writeImage() call appends one frame. The frame is converted on the calling thread into one of
+// `queueDepth` frame buffers and written to the stream by a writer thread, so rendering of the next frame
+// overlaps output of the previous ones; writeImage() blocks only when all buffers wait for output.
+// Stream errors are rethrown (std::runtime_error) by the next writeImage() or by finish().
+class Y4mFrameWriter : public PixelImageWriter {
+public:
+    enum Format {
+        Y4M,
+        RAW_RGB
+    };
+
+    // frame rate is fpsNumerator / fpsDenominator, used only in Y4M header
+    explicit Y4mFrameWriter(std::ostream &output, Format format = Y4M, unsigned int fpsNumerator = 25,
+                            unsigned int fpsDenominator = 1, size_t queueDepth = 2)
+            : output_(output), format_(format), fpsNumerator_(fpsNumerator), fpsDenominator_(fpsDenominator),
+              freeBuffers_(std::max<size_t>(1, queueDepth)), filledBuffers_(std::max<size_t>(1, queueDepth)) {
+        if (fpsNumerator == 0 || fpsDenominator == 0)
+            throw std::invalid_argument("Y4mFrameWriter: invalid frame rate");
+    }
+
+    Y4mFrameWriter(const Y4mFrameWriter &) = delete;
+    Y4mFrameWriter &operator=(const Y4mFrameWriter &) = delete;
+
+    // writes queued frames; errors are ignored here, call finish() to get them
+    virtual ~Y4mFrameWriter() {
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+
+    // appends image as next frame, its size has to be equal to size of first frame
+    virtual void writeImage(PixelImageBase &image) {
+        if (finished_)
+            throw std::logic_error("Y4mFrameWriter: writer already finished");
+        if (!started_)
+            start(image.width(), image.height());
+        else if (image.width() != width_ || image.height() != height_)
+            throw std::invalid_argument("Y4mFrameWriter: frame size differs from first frame");
+
+        std::vector<unsigned char> buffer;
+        if (!freeBuffers_.pop(buffer))
+            rethrowWriterError();
+
+        unsigned char *frame = buffer.data() + frameHeaderSize_;
+        if (format_ == Y4M) {
+            memcpy(buffer.data(), FRAME_HEADER, frameHeaderSize_);
+            YuvConverter::toYuv420(image, frame, rowBuffer_);
+        } else {
+            size_t rowSize = static_cast<size_t>(width_) * 3;
+            for (unsigned int y = 0; y < height_; ++y) {
+                unsigned char *slot = frame + y * rowSize;
+                const unsigned char *row = image.readRow(y, slot);
+                if (row != slot)
+                    memcpy(slot, row, rowSize);
+            }
+        }
+
+        if (!filledBuffers_.push(std::move(buffer)))
+            rethrowWriterError();
+        ++frameCount_;
+    }
+
+    // waits until all frames are written and flushes the stream; no frames can be added afterwards
+    void finish() {
+        if (finished_)
+            return;
+        finished_ = true;
+        filledBuffers_.close();
+        if (writerThread_.joinable())
+            writerThread_.join();
+        if (writerError_)
+            std::rethrow_exception(writerError_);
+        output_.flush();
+        if (!output_)
+            throw std::runtime_error("Y4mFrameWriter: cannot write output");
+    }
+
+    // number of frames accepted so far
+    size_t frameCount() const {
+        return frameCount_;
+    }
+
+    // number of bytes of one frame in the stream, including frame header
+    size_t frameSize() const {
+        return frameHeaderSize_ + (format_ == Y4M ? YuvConverter::frameSize420(width_, height_)
+                                                   : static_cast<size_t>(width_) * height_ * 3);
+    }
+
+    // Y4M stream header
+    static std::string formatHeader(unsigned int width, unsigned int height, unsigned int fpsNumerator,
+                                    unsigned int fpsDenominator) {
+        char header[128];
+        snprintf(header, sizeof(header), "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                 width, height, fpsNumerator, fpsDenominator);
+        return header;
+    }
+
+private:
+    static constexpr const char *FRAME_HEADER = "FRAME\n";
+
+    // allocates frame buffers, writes stream header and starts writer thread
+    void start(unsigned int width, unsigned int height) {
+        started_ = true;
+        width_ = width;
+        height_ = height;
+        if (format_ == Y4M) {
+            frameHeaderSize_ = strlen(FRAME_HEADER);
+            std::string header = formatHeader(width, height, fpsNumerator_, fpsDenominator_);
+            output_.write(header.data(), static_cast<std::streamsize>(header.size()));
+            if (!output_)
+                throw std::runtime_error("Y4mFrameWriter: cannot write output");
+        }
+
+        for (size_t i = 0; i < freeBuffers_.capacity(); ++i)
+            freeBuffers_.push(std::vector<unsigned char>(frameSize()));
+
+        writerThread_ = std::thread(&Y4mFrameWriter::writerLoop, this);
+    }
+
+    void writerLoop() {
+        try {
+            std::vector<unsigned char> buffer;
+            while (filledBuffers_.pop(buffer)) {
+                output_.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                if (!output_)
+                    throw std::runtime_error("Y4mFrameWriter: cannot write output");
+                freeBuffers_.push(std::move(buffer));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            writerError_ = std::current_exception();
+            freeBuffers_.close();
+            filledBuffers_.close();
+        }
+    }
+
+    void rethrowWriterError() {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (writerError_)
+            std::rethrow_exception(writerError_);
+        throw std::runtime_error("Y4mFrameWriter: writer stopped");
+    }
+
+    std::ostream &output_;
+    Format format_;
+    unsigned int fpsNumerator_;
+    unsigned int fpsDenominator_;
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    size_t frameHeaderSize_ = 0; // "FRAME\n" in Y4M, nothing in raw RGB
+    size_t frameCount_ = 0;
+    bool started_ = false;
+    bool finished_ = false;
+    std::vector<unsigned char> rowBuffer_;
+    BoundedQueue<std::vector<unsigned char>> freeBuffers_;
+    BoundedQueue<std::vector<unsigned char>> filledBuffers_;
+    std::thread writerThread_;
+    std::mutex errorMutex_;
+    std::exception_ptr writerError_;
+};
+
+#endif
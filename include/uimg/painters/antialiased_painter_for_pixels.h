@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include "uimg/base/structs.h"
 #include "uimg/pixels/pixel_painter.h"
@@ -239,52 +240,166 @@ protected:
         // Draw the edge pixels with distance-based alpha blending for better anti-aliasing
         float radiusF = static_cast<float>(radius);
         float radiusInnerF = radiusF - 1.0f;
-        
-        // Draw the edge pixels with distance-based alpha
-        for (int yi = -static_cast<int>(radius); yi <= static_cast<int>(radius); yi++) {
-            for (int xi = -static_cast<int>(radius); xi <= static_cast<int>(radius); xi++) {
-                // Calculate the exact distance from center
-                float distF = static_cast<float>(std::sqrt(xi*xi + yi*yi));
-                
-                // Skip pixels clearly inside or outside the circle
-                if (distF < radiusInnerF || distF > radiusF + 0.5f) 
-                    continue;
-                
-                // Calculate alpha based on distance from the edge
-                // Pixels exactly at radius have alpha 0.5
-                // Linear transition for smoother appearance
-                float alpha;
-                if (distF <= radiusF) {
-                    // Inside edge - fade from solid to 0.5 at exact radius
-                    alpha = 1.0f - 0.5f * ((distF - radiusInnerF) / (radiusF - radiusInnerF));
-                } else {
-                    // Outside edge - fade from 0.5 to 0 
-                    alpha = 0.5f * (1.0f - (distF - radiusF) / 0.5f); 
-                }
-                
-                // Ensure alpha is in valid range
-                alpha = std::max(0.0f, std::min(1.0f, alpha));
-                
-                // Skip trivial cases
-                if (alpha < 0.05f)
-                    continue;
-                    
-                // Get existing color for blending
-                unsigned int px = UNSIGNED_CAST(unsigned int, static_cast<int>(x) + xi);
-                unsigned int py = UNSIGNED_CAST(unsigned int, static_cast<int>(y) + yi);
-                
-                RgbColor existingColor;
-                pixelPainter_.getPixel(px, py, existingColor);
-                
-                RgbColor blendedColor;
-                blendedColor.red = UNSIGNED_CAST(unsigned char, std::min(255, static_cast<int>(round(alpha * color.red + (1.0f - alpha) * existingColor.red))));
-                blendedColor.green = UNSIGNED_CAST(unsigned char, std::min(255, static_cast<int>(round(alpha * color.green + (1.0f - alpha) * existingColor.green))));
-                blendedColor.blue = UNSIGNED_CAST(unsigned char, std::min(255, static_cast<int>(round(alpha * color.blue + (1.0f - alpha) * existingColor.blue))));
-                
-                pixelPainter_.putPixel(px, py, blendedColor);
-            }
+        float radiusOuterF = radiusF + 0.5f;
+
+        // Only the edge band (radiusInnerF <= distance <= radiusF + 0.5) of every row is visited; bounds have one
+        // pixel of margin, so rounding can't skip any pixel of it
+        int ir = static_cast<int>(radius);
+        for (int yi = -ir; yi <= ir; yi++) {
+            float yi2 = static_cast<float>(yi * yi);
+            int outerX = std::min(ir, static_cast<int>(std::sqrt(std::max(0.0f, radiusOuterF * radiusOuterF - yi2))) + 1);
+            int innerX = 0;
+            if (radiusInnerF * radiusInnerF > yi2)
+                innerX = std::max(0, static_cast<int>(std::sqrt(radiusInnerF * radiusInnerF - yi2)) - 1);
+            for (int xi = -outerX; xi <= -innerX; xi++)
+                blendEdgePixel(x, y, xi, yi, radiusF, radiusInnerF, color);
+            for (int xi = std::max(innerX, 1); xi <= outerX; xi++)
+                blendEdgePixel(x, y, xi, yi, radiusF, radiusInnerF, color);
+        }
+    }
+
+private:
+    void blendEdgePixel(unsigned int x, unsigned int y, int xi, int yi, float radiusF, float radiusInnerF,
+                        const RgbColor &color) {
+        // Calculate the exact distance from center
+        float distF = static_cast<float>(std::sqrt(xi*xi + yi*yi));
+
+        // Skip pixels clearly inside or outside the circle
+        if (distF < radiusInnerF || distF > radiusF + 0.5f)
+            return;
+
+        // Calculate alpha based on distance from the edge
+        // Pixels exactly at radius have alpha 0.5
+        // Linear transition for smoother appearance
+        float alpha;
+        if (distF <= radiusF) {
+            // Inside edge - fade from solid to 0.5 at exact radius
+            alpha = 1.0f - 0.5f * ((distF - radiusInnerF) / (radiusF - radiusInnerF));
+        } else {
+            // Outside edge - fade from 0.5 to 0
+            alpha = 0.5f * (1.0f - (distF - radiusF) / 0.5f);
+        }
+
+        // Ensure alpha is in valid range
+        alpha = std::max(0.0f, std::min(1.0f, alpha));
+
+        // Skip trivial cases
+        if (alpha < 0.05f)
+            return;
+
+        // Get existing color for blending
+        unsigned int px = UNSIGNED_CAST(unsigned int, static_cast<int>(x) + xi);
+        unsigned int py = UNSIGNED_CAST(unsigned int, static_cast<int>(y) + yi);
+
+        RgbColor existingColor;
+        pixelPainter_.getPixel(px, py, existingColor);
+
+        RgbColor blendedColor;
+        blendedColor.red = UNSIGNED_CAST(unsigned char, std::min(255, static_cast<int>(round(alpha * color.red + (1.0f - alpha) * existingColor.red))));
+        blendedColor.green = UNSIGNED_CAST(unsigned char, std::min(255, static_cast<int>(round(alpha * color.green + (1.0f - alpha) * existingColor.green))));
+        blendedColor.blue = UNSIGNED_CAST(unsigned char, std::min(255, static_cast<int>(round(alpha * color.blue + (1.0f - alpha) * existingColor.blue))));
+
+        pixelPainter_.putPixel(px, py, blendedColor);
+    }
+};
+
+
+// Anti-aliased polygon painter (analytic coverage, see AntiAliasedPolygonPainterForSink)
+class AntiAliasedPolygonPainterForPixels : public PolygonPainter {
+public:
+    AntiAliasedPolygonPainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter) {}
+
+    AntiAliasedPolygonPainterForPixels(PixelPainter &pixelPainter, const Point &canvasSize)
+            : painter_(pixelPainter, canvasSize) {}
+
+    virtual void drawFull(const std::vector<Point> &points, const RgbColor &color, FillRule rule = NON_ZERO) {
+        painter_.drawFull(points, color, rule);
+    }
+
+    virtual void drawFull(const std::vector<std::vector<Point>> &contours, const RgbColor &color,
+                          FillRule rule = NON_ZERO) {
+        painter_.drawFull(contours, color, rule);
+    }
+
+    virtual void drawFull(const std::vector<std::vector<PointF>> &contours, const RgbColor &color,
+                          FillRule rule = NON_ZERO) {
+        painter_.drawFull(contours, color, rule);
+    }
+
+    // outline through centers of pixels of vertices, one pixel wide
+    virtual void drawEmpty(const std::vector<Point> &points, const RgbColor &color) {
+        for (size_t i = 0, count = points.size(); i < count; ++i) {
+            const Point &p1 = points[i];
+            const Point &p2 = points[(i + 1) % count];
+            drawLine(PointF(static_cast<float>(p1.x) + 0.5f, static_cast<float>(p1.y) + 0.5f),
+                     PointF(static_cast<float>(p2.x) + 0.5f, static_cast<float>(p2.y) + 0.5f), 1.0f, color);
         }
     }
+
+    void drawLine(const PointF &p1, const PointF &p2, float width, const RgbColor &color) {
+        painter_.drawLine(p1, p2, width, color);
+    }
+
+private:
+    AntiAliasedPolygonPainterForSink<PixelPainter> painter_;
+};
+
+// Anti-aliased circles and their parts (see AntiAliasedCirclePainterForSink). Integer center is the center of
+// pixel and circle of radius r covers about the same pixels as with CirclePainterForPixels.
+class AntiAliasedCirclePainterForPixels : public CirclePainter {
+public:
+    AntiAliasedCirclePainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter) {}
+
+    AntiAliasedCirclePainterForPixels(PixelPainter &pixelPainter, const Point &canvasSize)
+            : painter_(pixelPainter, canvasSize) {}
+
+    virtual void drawFull(unsigned int x, unsigned int y, unsigned int r, const RgbColor &color) {
+        painter_.drawFull(pixelCenter(x, y), static_cast<float>(r) + 0.5f, color);
+    }
+
+    // ring one pixel wide
+    virtual void drawEmpty(unsigned int x0, unsigned int y0, unsigned int r, const RgbColor &color) {
+        painter_.drawRing(pixelCenter(x0, y0), static_cast<float>(r) + 0.5f, static_cast<float>(r) - 0.5f, color);
+    }
+
+    virtual void drawFullWithBorder(unsigned int x, unsigned int y, unsigned int r, unsigned int borderWidth,
+                                    const RgbColor &fillColor, const RgbColor &borderColor) {
+        if (borderWidth >= r) {
+            drawFull(x, y, r, borderColor);
+            return;
+        }
+        float innerR = static_cast<float>(r - borderWidth) + 0.5f;
+        painter_.drawFull(pixelCenter(x, y), innerR, fillColor);
+        painter_.drawRing(pixelCenter(x, y), static_cast<float>(r) + 0.5f, innerR, borderColor);
+    }
+
+    void drawFull(const PointF &center, float r, const RgbColor &color) {
+        painter_.drawFull(center, r, color);
+    }
+
+    void drawEllipse(const PointF &center, float rx, float ry, const RgbColor &color) {
+        painter_.drawEllipse(center, rx, ry, color);
+    }
+
+    void drawRing(const PointF &center, float outerR, float innerR, const RgbColor &color) {
+        painter_.drawRing(center, outerR, innerR, color);
+    }
+
+    void drawArc(const PointF &center, float outerR, float innerR, double startAngle, double endAngle,
+                 const RgbColor &color) {
+        painter_.drawArc(center, outerR, innerR, startAngle, endAngle, color);
+    }
+
+    void drawPie(const PointF &center, float r, double startAngle, double endAngle, const RgbColor &color) {
+        painter_.drawPie(center, r, startAngle, endAngle, color);
+    }
+
+private:
+    static PointF pixelCenter(unsigned int x, unsigned int y) {
+        return PointF(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f);
+    }
+
+    AntiAliasedCirclePainterForSink<PixelPainter> painter_;
 };
 
 #endif // __UIMG_ANTIALIASED_PAINTER_FOR_PIXELS_H__
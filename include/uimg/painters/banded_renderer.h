@@ -0,0 +1,121 @@
+#ifndef __UIMG_BANDED_RENDERER_H__
+#define __UIMG_BANDED_RENDERER_H__
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/pixels/pixel_painter.h"
+#include "uimg/images/image_view.h"
+#include "uimg/images/pixel_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/display_list_painter.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/filters/filter_for_pixels.h"
+
+// Renders image one horizontal band at a time and passes each finished band to a stream writer (encoder),
+// so memory use is O(band height) instead of O(image height): only two band buffers are allocated,
+// one is encoded on a separate thread while the next band is rendered into the other.
+//
+// Drawing is given either as recorded DisplayList (commands are binned into bands once, each band replays
+// only commands which touch it), or as a callback which is called once per band with a painter clipped to
+// that band. Both use canvas coordinates and produce the same pixels as drawing on a whole image.
+class BandedRenderer {
+public:
+    using DrawFunction = std::function<void(PixelPainter &painter)>;
+
+    BandedRenderer(unsigned int width, unsigned int height, unsigned int bandHeight = 64,
+                   const RgbColor &background = RgbColor::make_rgb(0, 0, 0))
+            : width_(width), height_(height), bandHeight_(std::max(1u, std::min(bandHeight, std::max(1u, height)))),
+              background_(background) {}
+
+    unsigned int bandHeight() const {
+        return bandHeight_;
+    }
+
+    unsigned int bandCount() const {
+        return (height_ + bandHeight_ - 1) / bandHeight_;
+    }
+
+    // draws recorded commands band by band and writes bands to writer
+    void render(const DisplayList &list, PixelImageStreamWriter &writer) {
+        std::vector<std::vector<size_t>> bins(bandCount());
+        int bandHeight = static_cast<int>(bandHeight_);
+
+        for (size_t i = 0, epos = list.size(); i < epos; ++i) {
+            const RectInclusive &bounds = list.command(i).bounds;
+            int y1 = std::max(0, bounds.y1);
+            int y2 = std::min(static_cast<int>(height_) - 1, bounds.y2);
+            if (y1 > y2 || bounds.x2 < 0 || bounds.x1 >= static_cast<int>(width_))
+                continue;
+            for (int band = y1 / bandHeight, eband = y2 / bandHeight; band <= eband; ++band)
+                bins[static_cast<size_t>(band)].push_back(i);
+        }
+
+        renderBands([&list, &bins](PixelPainter &painter, unsigned int band) {
+            for (size_t index : bins[band])
+                list.replay(index, painter);
+        }, writer);
+    }
+
+    // calls draw function for each band and writes bands to writer
+    void render(const DrawFunction &draw, PixelImageStreamWriter &writer) {
+        renderBands([&draw](PixelPainter &painter, unsigned int) {
+            draw(painter);
+        }, writer);
+    }
+
+private:
+    template<typename PaintBand>
+    void renderBands(PaintBand paintBand, PixelImageStreamWriter &writer) {
+        writer.beginImage(width_, height_);
+
+        RgbImage buffers[2] = {RgbImage(width_, bandHeight_), RgbImage(width_, bandHeight_)};
+        std::unique_ptr<ImageView> views[2];
+        std::future<void> encoding;
+
+        for (unsigned int band = 0, count = bandCount(); band < count; ++band) {
+            unsigned int top = band * bandHeight_;
+            unsigned int rows = std::min(bandHeight_, height_ - top);
+            size_t slot = band % 2;
+
+            // buffer of this band was used two bands ago - its encoding finished when previous band was submitted
+            views[slot].reset(new ImageView(buffers[slot], Point(0, 0),
+                                            Point(static_cast<int>(width_), static_cast<int>(rows))));
+            BackgroundPainterForRgbImage(*views[slot]).paint(background_);
+
+            RectInclusive bandRect;
+            bandRect.x1 = 0;
+            bandRect.y1 = static_cast<int>(top);
+            bandRect.x2 = static_cast<int>(width_) - 1;
+            bandRect.y2 = static_cast<int>(top + rows) - 1;
+
+            PixelPainterForRgbImage bandPainter(*views[slot]);
+            OffsetFilter toBand(bandPainter, Point(0, -static_cast<int>(top)));
+            ClipFilter clip(toBand, bandRect);
+            paintBand(clip, band);
+
+            if (encoding.valid())
+                encoding.get();
+            const ImageView &finished = *views[slot];
+            encoding = std::async(std::launch::async, [&writer, &finished]() {
+                writer.writeRows(finished);
+            });
+        }
+
+        if (encoding.valid())
+            encoding.get();
+
+        writer.endImage();
+    }
+
+    unsigned int width_;
+    unsigned int height_;
+    unsigned int bandHeight_;
+    RgbColor background_;
+};
+
+#endif
@@ -0,0 +1,488 @@
+#ifndef __UIMG_DISPLAY_LIST_PAINTER_H__
+#define __UIMG_DISPLAY_LIST_PAINTER_H__
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/pixels/pixel_painter.h"
+#include "uimg/painters/painter_base.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/filters/filter_for_pixels.h"
+#include "uimg/text/text_painter.h"
+#include "uimg/utils/thread_pool.h"
+#include "uimg/utils/cast.h"
+
+// Display list mode: primitives are recorded instead of being drawn immediately.
+// On flush recorded commands are binned into screen tiles and tiles are rasterized in parallel.
+// Each tile replays its commands in recording order through ClipFilter, with the same painters
+// as sequential drawing (*PainterForPixels), so the output is identical to the sequential path.
+
+// list of recorded drawing commands
+class DisplayList {
+public:
+    // creates text painter drawing on a given pixel painter, used to replay text commands
+    using TextPainterFactory = std::function<std::unique_ptr<uimg::TextPainter>(PixelPainter &)>;
+
+    enum class CommandType {
+        Line,
+        RectFull,
+        RectEmpty,
+        CircleFull,
+        CircleEmpty,
+        CircleFullWithBorder,
+        EllipseFull,
+        EllipseEmpty,
+        TriangleFull,
+        TriangleEmpty,
+        Text
+    };
+
+    struct Command {
+        CommandType type;
+        int params[6];
+        RgbColor color;
+        RgbColor color2;
+        RectInclusive bounds; // all pixels painted by command are inside of bounds
+        size_t textIndex;     // index in text table, only for text commands
+    };
+
+    void addLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        RectInclusive bounds = makeBounds(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), 1);
+        int overshoot = lineOvershoot(toInt(x1), toInt(y1), toInt(x2), toInt(y2));
+        bounds.y1 -= overshoot;
+        bounds.y2 += overshoot;
+        add(CommandType::Line, {toInt(x1), toInt(y1), toInt(x2), toInt(y2)}, color, bounds);
+    }
+
+    void addRect(bool filled, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2,
+                 const RgbColor &color) {
+        add(filled ? CommandType::RectFull : CommandType::RectEmpty, {toInt(x1), toInt(y1), toInt(x2), toInt(y2)},
+            color, makeBounds(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), 1));
+    }
+
+    void addCircle(bool filled, unsigned int x, unsigned int y, unsigned int r, const RgbColor &color) {
+        add(filled ? CommandType::CircleFull : CommandType::CircleEmpty, {toInt(x), toInt(y), toInt(r)}, color,
+            makeCenteredBounds(x, y, r, r));
+    }
+
+    void addCircleWithBorder(unsigned int x, unsigned int y, unsigned int r, unsigned int borderWidth,
+                             const RgbColor &fillColor, const RgbColor &borderColor) {
+        add(CommandType::CircleFullWithBorder, {toInt(x), toInt(y), toInt(r), toInt(borderWidth)}, fillColor,
+            makeCenteredBounds(x, y, r, r), borderColor);
+    }
+
+    void addEllipse(bool filled, unsigned int x, unsigned int y, unsigned int rx, unsigned int ry,
+                    const RgbColor &color) {
+        add(filled ? CommandType::EllipseFull : CommandType::EllipseEmpty, {toInt(x), toInt(y), toInt(rx), toInt(ry)},
+            color, makeCenteredBounds(x, y, rx, ry));
+    }
+
+    void addTriangle(bool filled, const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) {
+        RectInclusive bounds;
+        bounds.x1 = std::min(p1.x, std::min(p2.x, p3.x)) - 1;
+        bounds.y1 = std::min(p1.y, std::min(p2.y, p3.y)) - 1;
+        bounds.x2 = std::max(p1.x, std::max(p2.x, p3.x)) + 1;
+        bounds.y2 = std::max(p1.y, std::max(p2.y, p3.y)) + 1;
+        if (!filled) {
+            int overshoot = std::max(lineOvershoot(p1.x, p1.y, p2.x, p2.y),
+                                     std::max(lineOvershoot(p2.x, p2.y, p3.x, p3.y), lineOvershoot(p3.x, p3.y, p1.x, p1.y)));
+            bounds.y1 -= overshoot;
+            bounds.y2 += overshoot;
+        }
+        add(filled ? CommandType::TriangleFull : CommandType::TriangleEmpty,
+            {p1.x, p1.y, p2.x, p2.y, p3.x, p3.y}, color, bounds);
+    }
+
+    // bounds are measured by text painter (TextPainter::textBounds), an empty rectangle paints nothing
+    void addText(unsigned int x, unsigned int y, const std::string &text, const RgbColor &color,
+                 const RectInclusive &bounds, const std::shared_ptr<TextPainterFactory> &factory) {
+        add(CommandType::Text, {toInt(x), toInt(y)}, color, bounds);
+        commands_.back().textIndex = texts_.size();
+        texts_.push_back(TextEntry{text, factory});
+    }
+
+    size_t size() const {
+        return commands_.size();
+    }
+
+    bool empty() const {
+        return commands_.empty();
+    }
+
+    void clear() {
+        commands_.clear();
+        texts_.clear();
+    }
+
+    const Command &command(size_t index) const {
+        return commands_[index];
+    }
+
+    // draws command on given pixel painter
+    void replay(size_t index, PixelPainter &painter) const {
+        const Command &cmd = commands_[index];
+        const int *p = cmd.params;
+
+        switch (cmd.type) {
+            case CommandType::Line:
+                LinePainterForPixels(painter).drawLine(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), toUInt(p[3]), cmd.color);
+                break;
+            case CommandType::RectFull:
+                RectPainterForPixels(painter).drawFull(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), toUInt(p[3]), cmd.color);
+                break;
+            case CommandType::RectEmpty:
+                RectPainterForPixels(painter).drawEmpty(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), toUInt(p[3]), cmd.color);
+                break;
+            case CommandType::CircleFull:
+                CirclePainterForPixels(painter).drawFull(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), cmd.color);
+                break;
+            case CommandType::CircleEmpty:
+                CirclePainterForPixels(painter).drawEmpty(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), cmd.color);
+                break;
+            case CommandType::CircleFullWithBorder:
+                CirclePainterForPixels(painter).drawFullWithBorder(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), toUInt(p[3]),
+                                                                   cmd.color, cmd.color2);
+                break;
+            case CommandType::EllipseFull:
+                EllipsePainterForPixels(painter).drawFull(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), toUInt(p[3]), cmd.color);
+                break;
+            case CommandType::EllipseEmpty:
+                EllipsePainterForPixels(painter).drawEmpty(toUInt(p[0]), toUInt(p[1]), toUInt(p[2]), toUInt(p[3]), cmd.color);
+                break;
+            case CommandType::TriangleFull:
+                TrianglePainterForPixels(painter).drawFull(Point(p[0], p[1]), Point(p[2], p[3]), Point(p[4], p[5]), cmd.color);
+                break;
+            case CommandType::TriangleEmpty:
+                TrianglePainterForPixels(painter).drawEmpty(Point(p[0], p[1]), Point(p[2], p[3]), Point(p[4], p[5]), cmd.color);
+                break;
+            case CommandType::Text: {
+                const TextEntry &entry = texts_[cmd.textIndex];
+                std::unique_ptr<uimg::TextPainter> textPainter = (*entry.factory)(painter);
+                textPainter->drawText(toUInt(p[0]), toUInt(p[1]), entry.text, cmd.color);
+                break;
+            }
+        }
+    }
+
+private:
+    struct TextEntry {
+        std::string text;
+        std::shared_ptr<TextPainterFactory> factory;
+    };
+
+    void add(CommandType type, std::initializer_list<int> params, const RgbColor &color, const RectInclusive &bounds,
+             const RgbColor &color2 = RgbColor()) {
+        Command cmd;
+        cmd.type = type;
+        std::fill(cmd.params, cmd.params + 6, 0);
+        std::copy(params.begin(), params.end(), cmd.params);
+        cmd.color = color;
+        cmd.color2 = color2;
+        cmd.bounds = bounds;
+        cmd.textIndex = 0;
+        commands_.push_back(cmd);
+    }
+
+    static RectInclusive makeBounds(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, int margin) {
+        RectInclusive bounds;
+        bounds.x1 = toInt(x1) - margin;
+        bounds.y1 = toInt(y1) - margin;
+        bounds.x2 = toInt(x2) + margin;
+        bounds.y2 = toInt(y2) + margin;
+        return bounds;
+    }
+
+    static RectInclusive makeCenteredBounds(unsigned int x, unsigned int y, unsigned int rx, unsigned int ry) {
+        RectInclusive bounds;
+        bounds.x1 = toInt(x) - toInt(rx) - 1;
+        bounds.y1 = toInt(y) - toInt(ry) - 1;
+        bounds.x2 = toInt(x) + toInt(rx) + 1;
+        bounds.y2 = toInt(y) + toInt(ry) + 1;
+        return bounds;
+    }
+
+    // line painter can step past end row by up to dy / dx pixels (steep lines)
+    static int lineOvershoot(int x1, int y1, int x2, int y2) {
+        int dx = std::abs(x2 - x1);
+        int dy = std::abs(y2 - y1);
+        return (dx > 0) ? dy / dx + 1 : 0;
+    }
+
+    static int toInt(unsigned int value) {
+        return static_cast<int>(value);
+    }
+
+    static unsigned int toUInt(int value) {
+        return static_cast<unsigned int>(value);
+    }
+
+    std::vector<Command> commands_;
+    std::vector<TextEntry> texts_;
+};
+
+// Rasterizes display list in parallel: commands are binned into tiles of tileSize x tileSize pixels,
+// each tile is one thread pool task which replays its commands clipped to the tile.
+// Target painter has to accept concurrent writes to different pixels (true for RgbImage painters).
+class TiledRasterizer {
+public:
+    TiledRasterizer(ThreadPool &pool, unsigned int tileSize = 64) : pool_(pool), tileSize_(std::max(1u, tileSize)) {}
+
+    unsigned int tileSize() const {
+        return tileSize_;
+    }
+
+    // paints all commands from list on target, pixels outside of canvas are not painted
+    void rasterize(const DisplayList &list, PixelPainter &target, const Point &canvasSize) {
+        if (list.empty() || canvasSize.x <= 0 || canvasSize.y <= 0)
+            return;
+
+        int tileSize = static_cast<int>(tileSize_);
+        int tilesX = (canvasSize.x + tileSize - 1) / tileSize;
+        int tilesY = (canvasSize.y + tileSize - 1) / tileSize;
+
+        // bins keep command indices in recording order
+        std::vector<std::vector<size_t>> bins(static_cast<size_t>(tilesX) * static_cast<size_t>(tilesY));
+
+        for (size_t i = 0, epos = list.size(); i < epos; ++i) {
+            const RectInclusive &bounds = list.command(i).bounds;
+            int x1 = std::max(0, bounds.x1);
+            int y1 = std::max(0, bounds.y1);
+            int x2 = std::min(canvasSize.x - 1, bounds.x2);
+            int y2 = std::min(canvasSize.y - 1, bounds.y2);
+            if (x1 > x2 || y1 > y2)
+                continue;
+
+            for (int ty = y1 / tileSize, ety = y2 / tileSize; ty <= ety; ++ty)
+                for (int tx = x1 / tileSize, etx = x2 / tileSize; tx <= etx; ++tx)
+                    bins[static_cast<size_t>(ty * tilesX + tx)].push_back(i);
+        }
+
+        for (int ty = 0; ty < tilesY; ++ty) {
+            for (int tx = 0; tx < tilesX; ++tx) {
+                const std::vector<size_t> &bin = bins[static_cast<size_t>(ty * tilesX + tx)];
+                if (bin.empty())
+                    continue;
+
+                RectInclusive tileRect;
+                tileRect.x1 = tx * tileSize;
+                tileRect.y1 = ty * tileSize;
+                tileRect.x2 = std::min(canvasSize.x, tileRect.x1 + tileSize) - 1;
+                tileRect.y2 = std::min(canvasSize.y, tileRect.y1 + tileSize) - 1;
+
+                pool_.submit([&list, &target, &bin, tileRect]() {
+                    ClipFilter clip(target, tileRect);
+                    for (size_t index : bin)
+                        list.replay(index, clip);
+                });
+            }
+        }
+
+        pool_.wait();
+    }
+
+private:
+    ThreadPool &pool_;
+    unsigned int tileSize_;
+};
+
+class RecordingLinePainter : public LinePainter {
+public:
+    RecordingLinePainter(DisplayList &list) : list_(list) {}
+
+    virtual void drawLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        list_.addLine(x1, y1, x2, y2, color);
+    }
+
+private:
+    DisplayList &list_;
+};
+
+class RecordingRectPainter : public RectPainter {
+public:
+    RecordingRectPainter(DisplayList &list) : list_(list) {}
+
+    virtual void drawFull(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        list_.addRect(true, x1, y1, x2, y2, color);
+    }
+
+    virtual void drawEmpty(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        list_.addRect(false, x1, y1, x2, y2, color);
+    }
+
+private:
+    DisplayList &list_;
+};
+
+class RecordingCirclePainter : public CirclePainter {
+public:
+    RecordingCirclePainter(DisplayList &list) : list_(list) {}
+
+    virtual void drawFull(unsigned int x, unsigned int y, unsigned int r, const RgbColor &color) {
+        list_.addCircle(true, x, y, r, color);
+    }
+
+    virtual void drawEmpty(unsigned int x, unsigned int y, unsigned int r, const RgbColor &color) {
+        list_.addCircle(false, x, y, r, color);
+    }
+
+    virtual void drawFullWithBorder(unsigned int x, unsigned int y, unsigned int r, unsigned int borderWidth,
+                                    const RgbColor &fillColor, const RgbColor &borderColor) {
+        list_.addCircleWithBorder(x, y, r, borderWidth, fillColor, borderColor);
+    }
+
+private:
+    DisplayList &list_;
+};
+
+class RecordingEllipsePainter : public EllipsePainter {
+public:
+    RecordingEllipsePainter(DisplayList &list) : list_(list) {}
+
+    virtual void drawFull(unsigned int x, unsigned int y, unsigned int rx, unsigned int ry, const RgbColor &color) {
+        list_.addEllipse(true, x, y, rx, ry, color);
+    }
+
+    virtual void drawEmpty(unsigned int x, unsigned int y, unsigned int rx, unsigned int ry, const RgbColor &color) {
+        list_.addEllipse(false, x, y, rx, ry, color);
+    }
+
+private:
+    DisplayList &list_;
+};
+
+class RecordingTrianglePainter : public TrianglePainter {
+public:
+    RecordingTrianglePainter(DisplayList &list) : list_(list) {}
+
+    virtual void drawFull(const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) {
+        list_.addTriangle(true, p1, p2, p3, color);
+    }
+
+    virtual void drawEmpty(const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) {
+        list_.addTriangle(false, p1, p2, p3, color);
+    }
+
+private:
+    DisplayList &list_;
+};
+
+// Records text drawing. Measuring is forwarded to measurePainter (which is never used for drawing),
+// text is drawn on flush with painters created by factory.
+class RecordingTextPainter : public uimg::TextPainter {
+public:
+    RecordingTextPainter(DisplayList &list, uimg::TextPainter &measurePainter,
+                         const DisplayList::TextPainterFactory &factory)
+            : list_(list), measurePainter_(measurePainter),
+              factory_(std::make_shared<DisplayList::TextPainterFactory>(factory)) {}
+
+    void drawText(unsigned int x, unsigned int y, const std::string &text, const RgbColor &color) override {
+        list_.addText(x, y, text, color, measurePainter_.textBounds(x, y, text), factory_);
+    }
+
+    void drawGlyph(unsigned int x, unsigned int y, uimg::text_char_code_t charCode, const RgbColor &color) override {
+        std::string text(1, static_cast<char>(charCode));
+        drawText(x, y, text, color);
+    }
+
+    void drawText(unsigned int x, unsigned int y, uimg::TextSource &src, const RgbColor &color) override {
+        std::string text;
+        while (src.hasNext())
+            text.push_back(static_cast<char>(src.getNext()));
+        drawText(x, y, text, color);
+    }
+
+    unsigned int textWidth(const std::string &text) override {
+        return measurePainter_.textWidth(text);
+    }
+
+    Point textSize(const std::string &text) override {
+        return measurePainter_.textSize(text);
+    }
+
+    RectInclusive textBounds(unsigned int x, unsigned int y, const std::string &text) override {
+        return measurePainter_.textBounds(x, y, text);
+    }
+
+    unsigned int glyphWidth(uimg::text_char_code_t charCode) override {
+        return measurePainter_.glyphWidth(charCode);
+    }
+
+    unsigned int glyphHeight(uimg::text_char_code_t charCode) override {
+        return measurePainter_.glyphHeight(charCode);
+    }
+
+    Point glyphSize(uimg::text_char_code_t charCode) override {
+        return measurePainter_.glyphSize(charCode);
+    }
+
+    unsigned int textWidth(uimg::TextSource &src) override {
+        return measurePainter_.textWidth(src);
+    }
+
+    Point textSize(uimg::TextSource &src) override {
+        return measurePainter_.textSize(src);
+    }
+
+private:
+    DisplayList &list_;
+    uimg::TextPainter &measurePainter_;
+    std::shared_ptr<DisplayList::TextPainterFactory> factory_;
+};
+
+// Display list mode for a pixel painter: exposes recording painters, flush() rasterizes
+// everything recorded so far on target painter, using tiles processed by thread pool.
+class DisplayListPainter {
+public:
+    DisplayListPainter(PixelPainter &target, const Point &canvasSize, ThreadPool &pool, unsigned int tileSize = 64)
+            : target_(target), canvasSize_(canvasSize), rasterizer_(pool, tileSize),
+              linePainter_(list_), rectPainter_(list_), circlePainter_(list_), ellipsePainter_(list_),
+              trianglePainter_(list_) {}
+
+    LinePainter &linePainter() {
+        return linePainter_;
+    }
+
+    RectPainter &rectPainter() {
+        return rectPainter_;
+    }
+
+    CirclePainter &circlePainter() {
+        return circlePainter_;
+    }
+
+    EllipsePainter &ellipsePainter() {
+        return ellipsePainter_;
+    }
+
+    TrianglePainter &trianglePainter() {
+        return trianglePainter_;
+    }
+
+    DisplayList &displayList() {
+        return list_;
+    }
+
+    // draws recorded commands and clears the list
+    void flush() {
+        rasterizer_.rasterize(list_, target_, canvasSize_);
+        list_.clear();
+    }
+
+private:
+    PixelPainter &target_;
+    Point canvasSize_;
+    DisplayList list_;
+    TiledRasterizer rasterizer_;
+    RecordingLinePainter linePainter_;
+    RecordingRectPainter rectPainter_;
+    RecordingCirclePainter circlePainter_;
+    RecordingEllipsePainter ellipsePainter_;
+    RecordingTrianglePainter trianglePainter_;
+};
+
+#endif
@@ -68,6 +68,30 @@ public:
     virtual void drawEmpty(const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) = 0;
 };
 
+// Fills arbitrary polygons: any number of contours, which can be concave and self-intersecting.
+// Pixel (x, y) is the square [x, x + 1) x [y, y + 1) and is filled when its center lies inside the polygon, so
+// integer vertices are pixel corners and adjacent polygons sharing an edge do not overlap.
+class PolygonPainter {
+public:
+    enum FillRule {
+        EVEN_ODD, // inside if ray from point crosses odd number of edges
+        NON_ZERO  // inside if contours wind around point non-zero times
+    };
+
+    virtual ~PolygonPainter() {}
+
+    virtual void drawFull(const std::vector<Point> &points, const RgbColor &color, FillRule rule = NON_ZERO) = 0;
+
+    virtual void drawFull(const std::vector<std::vector<Point>> &contours, const RgbColor &color,
+                          FillRule rule = NON_ZERO) = 0;
+
+    virtual void drawFull(const std::vector<std::vector<PointF>> &contours, const RgbColor &color,
+                          FillRule rule = NON_ZERO) = 0;
+
+    // outline of closed contour
+    virtual void drawEmpty(const std::vector<Point> &points, const RgbColor &color) = 0;
+};
+
 class FloodFillPainter {
 public:
     virtual ~FloodFillPainter() {}
@@ -9,82 +9,31 @@
 #include "uimg/utils/math_utils.h"
 #include "uimg/utils/cubic_spline_utils.h"
 #include "uimg/painters/painter_base.h"
+#include "uimg/painters/painter_for_sink.h"
 #include "uimg/utils/cast.h"
 
 using LineDashPattern = std::vector<unsigned int>;
 
 class LinePainterForPixels : public LinePainter {
 public:
-    LinePainterForPixels(PixelPainter &pixelPainter) : pixelPainter_(&pixelPainter) {}
+    LinePainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter) {}
 
     // uses Bresenham's line algorithm
     virtual void drawLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
-        if (x1 > x2) {
-            drawLine(x2, y2, x1, y1, color);
-            return;
-        } else if (x1 == x2) {
-            drawVerticalLine(x1, y1, y2, color);
-            return;
-        } else if (y1 == y2) {
-            drawHorizontalLine(x1, x2, y1, color);
-            return;
-        }
-
-        using real = float;
-        real deltax = static_cast<real>(x2) - static_cast<real>(x1);
-        real deltay = static_cast<real>(y2) - static_cast<real>(y1);
-        real error = 0.0f;
-        real deltaerr = static_cast<real>(fabs(deltay / deltax));
-
-        int y = static_cast<int>(y1);
-        int x = static_cast<int>(x1);
-
-        int ye = static_cast<int>(y2);
-        int xe = static_cast<int>(x2);
-
-        clipBySize(xe, ye);
-
-        int sign = (ye - static_cast<int>(y1) > 0) ? 1 : -1;
-
-        for (; x <= xe; ++x) {
-            pixelPainter_->putPixel(UNSIGNED_CAST(unsigned int, x), UNSIGNED_CAST(unsigned int, y), color);
-            error += deltaerr;
-            while (error >= 0.5f) {
-                pixelPainter_->putPixel(UNSIGNED_CAST(unsigned int, x), UNSIGNED_CAST(unsigned int, y), color);
-                y += sign;
-                error -= 1.0f;
-            }
-        }
+        painter_.drawLine(x1, y1, x2, y2, color);
     }
 
 protected:
     virtual void drawVerticalLine(unsigned int x, unsigned int y1, unsigned int y2, const RgbColor &color) {
-        if (y1 > y2) {
-            drawVerticalLine(x, y2, y1, color);
-            return;
-        }
-
-        for (unsigned yi = y1; yi <= y2; ++yi)
-            pixelPainter_->putPixel(x, yi, color);
+        painter_.drawVerticalLine(x, y1, y2, color);
     }
 
     virtual void drawHorizontalLine(unsigned int x1, unsigned int x2, unsigned int y, const RgbColor &color) {
-        if (x1 > x2) {
-            drawHorizontalLine(x2, x1, y, color);
-            return;
-        }
-
-        for (unsigned xi = x1; xi <= x2; ++xi)
-            pixelPainter_->putPixel(xi, y, color);
-    }
-
-    virtual void clipBySize(int &x, int &y) {
-        x = std::max(0, x);
-        y = std::max(0, y);
+        painter_.drawHorizontalLine(x1, x2, y, color);
     }
 
 private:
-    PixelPainter *pixelPainter_;
+    LinePainterForSink<PixelPainter> painter_;
 };
 
 // uses dash pattern specified in pixels
@@ -236,22 +185,17 @@ private:
 
 class RectPainterForPixels : public RectPainter {
 public:
-    RectPainterForPixels(PixelPainter &pixelPainter) : pixelPainter_(&pixelPainter), linePainter_(pixelPainter),
+    RectPainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter), linePainter_(pixelPainter),
                                                        usedLinePainter_(linePainter_) {}
 
-    RectPainterForPixels(PixelPainter &pixelPainter, LinePainter &linePainter) : pixelPainter_(&pixelPainter),
+    RectPainterForPixels(PixelPainter &pixelPainter, LinePainter &linePainter) : painter_(pixelPainter),
                                                                                  linePainter_(pixelPainter),
                                                                                  usedLinePainter_(linePainter) {}
 
     virtual ~RectPainterForPixels() {}
 
     virtual void drawFull(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
-        if (x2 < x1 || y2 < y1)
-            drawFull(x2, y2, x1, y1, color);
-
-        for (unsigned int yi = y1; yi <= y2; ++yi)
-            for (unsigned int xi = x1; xi <= x2; ++xi)
-                pixelPainter_->putPixel(xi, yi, color);
+        painter_.drawFull(x1, y1, x2, y2, color);
     }
 
     virtual void drawEmpty(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
@@ -262,69 +206,49 @@ public:
     }
 
 private:
-    PixelPainter *pixelPainter_;
+    RectPainterForSink<PixelPainter> painter_;
     LinePainterForPixels linePainter_;
     LinePainter &usedLinePainter_;
 };
 
 class CirclePainterForPixels : public CirclePainter {
 public:
-    CirclePainterForPixels(PixelPainter &pixelPainter) : pixelPainter_(pixelPainter) {}
+    CirclePainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter) {}
 
-    // naive algorithm
+    // fills all pixels with xi^2 + yi^2 <= r^2, one span per row
     virtual void drawFull(unsigned int x, unsigned int y, unsigned int r, const RgbColor &color) {
-        int ir = static_cast<int>(r);
-        int r2 = static_cast<int>(r * r);
-        for (int yi = -ir; yi <= ir; yi++) {
-            int yi2 = yi * yi;
-            int yc = r2 - yi2;
-            for (int xi = -ir; xi <= ir; xi++)
-                if (xi * xi <= yc) {
-                    auto px = static_cast<int>(x) + xi;
-                    auto py = static_cast<int>(y) + yi;
-                    if (px < 0 || py < 0)
-                        continue; // skip negative coordinates
-
-                    pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, px), UNSIGNED_CAST(unsigned int, py), color);
-                }
-        }
+        painter_.drawFull(x, y, r, color);
     }
 
     // Midpoint circle algorithm
     virtual void drawEmpty(unsigned int x0, unsigned int y0, unsigned int r, const RgbColor &color) {
-        int x = static_cast<int>(r);
-        int y = 0;
-        int decisionOver2 = 1 - x;
-
-        while (y <= x) {
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, x + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, y + static_cast<int>(y0)), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, y + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, x + static_cast<int>(y0)), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, -x + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, y + static_cast<int>(y0)), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, -y + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, x + static_cast<int>(y0)), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, -x + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, -y + static_cast<int>(y0)), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, -y + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, -x + static_cast<int>(y0)), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, x + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, -y + static_cast<int>(y0)), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, y + static_cast<int>(x0)), UNSIGNED_CAST(unsigned int, -x + static_cast<int>(y0)), color);
-            y++;
-
-            if (decisionOver2 <= 0) {
-                decisionOver2 += 2 * y + 1;
-            } else {
-                x--;
-                decisionOver2 += 2 * (y - x) + 1;
-            }
-        }
+        painter_.drawEmpty(x0, y0, r, color);
     }
 
+    // border is a ring around the fill, every pixel is painted once
     virtual void drawFullWithBorder(unsigned int x, unsigned int y, unsigned int r, unsigned int borderWidth,
                                     const RgbColor &fillColor, const RgbColor &borderColor) {
-        drawFull(x, y, r, borderColor);
-        if (borderWidth < r)
-            drawFull(x, y, r - borderWidth, fillColor);
+        painter_.drawFullWithBorder(x, y, r, borderWidth, fillColor, borderColor);
+    }
+
+    // fills pixels with innerR^2 < xi^2 + yi^2 <= outerR^2
+    void drawRing(unsigned int x, unsigned int y, unsigned int outerR, unsigned int innerR, const RgbColor &color) {
+        painter_.drawRing(x, y, outerR, innerR, color);
+    }
+
+    // part of ring between angles (radians, clockwise on screen from positive x axis), see CirclePainterForSink
+    void drawArc(unsigned int x, unsigned int y, unsigned int outerR, unsigned int innerR, double startAngle,
+                 double endAngle, const RgbColor &color) {
+        painter_.drawArc(x, y, outerR, innerR, startAngle, endAngle, color);
+    }
+
+    void drawPie(unsigned int x, unsigned int y, unsigned int r, double startAngle, double endAngle,
+                 const RgbColor &color) {
+        painter_.drawPie(x, y, r, startAngle, endAngle, color);
     }
 
 private:
-    PixelPainter &pixelPainter_;
+    CirclePainterForSink<PixelPainter> painter_;
 };
 
 class ThickLinePainterForPixels : public LinePainter {
@@ -528,65 +452,20 @@ protected:
 
 class EllipsePainterForPixels : public EllipsePainter {
 public:
-    EllipsePainterForPixels(PixelPainter &pixelPainter) : pixelPainter_(pixelPainter) {}
+    EllipsePainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter) {}
 
-    // naive algorithm
+    // fills all pixels with ry^2 * xi^2 + rx^2 * yi^2 <= rx^2 * ry^2, one span per row
     virtual void drawFull(unsigned int x, unsigned int y, unsigned int rx, unsigned int ry, const RgbColor &color) {
-        int irx = static_cast<int>(rx);
-        int iry = static_cast<int>(ry);
-        long int irx2 = irx * irx;
-        long int iry2 = iry * iry;
-        long int irxy2 = irx2 * iry2;
-
-        for (int yi = -iry; yi <= iry; yi++) {
-            int yi2 = yi * yi;
-            long int yc = irxy2 - yi2 * irx2;
-            for (int xi = -irx; xi <= irx; xi++)
-                if (iry2 * xi * xi <= yc)
-                    pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x) + xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y) + yi), color);
-        }
+        painter_.drawFull(x, y, rx, ry, color);
     }
 
     // Bresenham's ellipse drawing algorithm
     virtual void drawEmpty(unsigned int x0, unsigned int y0, unsigned int rx, unsigned int ry, const RgbColor &color) {
-        int a2 = static_cast<int>(rx * rx);
-        int b2 = static_cast<int>(ry * ry);
-        int fa2 = 4 * a2, fb2 = 4 * b2;
-        int xi, yi, sigma;
-
-        /* first half */
-        for (xi = 0, yi = static_cast<int>(ry), sigma = 2 * b2 + a2 * (1 - 2 * static_cast<int>(ry)); b2 * xi <= a2 * yi; xi++) {
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) + xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) + yi), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) - xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) + yi), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) + xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) - yi), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) - xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) - yi), color);
-
-            if (sigma >= 0) {
-                sigma += fa2 * (1 - yi);
-                yi--;
-            }
-
-            sigma += b2 * ((4 * xi) + 6);
-        }
-
-        /* second half */
-        for (xi = static_cast<int>(rx), yi = 0, sigma = 2 * a2 + b2 * (1 - 2 * static_cast<int>(rx)); a2 * yi <= b2 * xi; yi++) {
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) + xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) + yi), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) - xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) + yi), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) + xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) - yi), color);
-            pixelPainter_.putPixel(UNSIGNED_CAST(unsigned int, static_cast<int>(x0) - xi), UNSIGNED_CAST(unsigned int, static_cast<int>(y0) - yi), color);
-
-            if (sigma >= 0) {
-                sigma += fb2 * (1 - xi);
-                xi--;
-            }
-
-            sigma += a2 * ((4 * yi) + 6);
-        }
+        painter_.drawEmpty(x0, y0, rx, ry, color);
     }
 
 private:
-    PixelPainter &pixelPainter_;
+    EllipsePainterForSink<PixelPainter> painter_;
 };
 
 class BSplinePainterForPixels : public BSplinePainter {
@@ -722,8 +601,7 @@ public:
 
     virtual void paint(const RgbColor &color) {
         for (unsigned int y = 0, eposy = UNSIGNED_CAST(unsigned int, canvasSize_.y); y < eposy; ++y)
-            for (unsigned int x = 0, eposx = UNSIGNED_CAST(unsigned int, canvasSize_.x); x < eposx; ++x)
-                pixelPainter_->putPixel(x, y, color);
+            pixelPainter_->fillSpan(0, y, UNSIGNED_CAST(unsigned int, canvasSize_.x), color);
     }
 
 private:
@@ -733,64 +611,16 @@ private:
 
 class TrianglePainterForPixels : public TrianglePainter {
 public:
-    TrianglePainterForPixels(PixelPainter &pixelPainter) : pixelPainter_(&pixelPainter), linePainter_(pixelPainter),
+    TrianglePainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter), linePainter_(pixelPainter),
                                                            usedLinePainter_(linePainter_) {}
 
-    TrianglePainterForPixels(PixelPainter &pixelPainter, LinePainter &linePainter) : pixelPainter_(&pixelPainter),
+    TrianglePainterForPixels(PixelPainter &pixelPainter, LinePainter &linePainter) : painter_(pixelPainter),
                                                                                      linePainter_(pixelPainter),
                                                                                      usedLinePainter_(linePainter) {}
 
-    // algorithm from: http://forum.devmaster.net/t/advanced-rasterization/6145
-    // requires points to be sorted counter-clockwise order
+    // half-space rasterization in 8x8 blocks (see TriangleRasterizer), points can be in any order
     virtual void drawFull(const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) {
-        using pixpos = int;
-        pixpos x1 = p1.x;
-        pixpos x2 = p2.x;
-        pixpos x3 = p3.x;
-
-        pixpos y1 = p1.y;
-        pixpos y2 = p2.y;
-        pixpos y3 = p3.y;
-
-        int minx = static_cast<int>(std::min(x1, std::min(x2, x3)));
-        int maxx = static_cast<int>(std::max(x1, std::max(x2, x3)));
-        int miny = static_cast<int>(std::min(y1, std::min(y2, y3)));
-        int maxy = static_cast<int>(std::max(y1, std::max(y2, y3)));
-
-        pixpos dx12 = x1 - x2;
-        pixpos dx23 = x2 - x3;
-        pixpos dx31 = x3 - x1;
-
-        pixpos dy12 = y1 - y2;
-        pixpos dy23 = y2 - y3;
-        pixpos dy31 = y3 - y1;
-
-        pixpos dx12i = dx12 * (miny - y1);
-        pixpos dx23i = dx23 * (miny - y2);
-        pixpos dx31i = dx31 * (miny - y3);
-
-        for (int y = miny; y <= maxy; y++) {
-            pixpos da12i = -dy12 * (minx - x1) + dx12i;
-            pixpos da23i = -dy23 * (minx - x2) + dx23i;
-            pixpos da31i = -dy31 * (minx - x3) + dx31i;
-
-            for (int x = minx; x <= maxx; x++) {
-                if (da12i >= 0 &&
-                    da23i >= 0 &&
-                    da31i >= 0) {
-                    pixelPainter_->putPixel(UNSIGNED_CAST(unsigned int, x), UNSIGNED_CAST(unsigned int, y), color);
-                }
-
-                da12i -= dy12;
-                da23i -= dy23;
-                da31i -= dy31;
-            } // for x
-
-            dx12i += dx12;
-            dx23i += dx23;
-            dx31i += dx31;
-        } // for y
-
+        painter_.drawFull(p1, p2, p3, color);
     }
 
     virtual void drawEmpty(const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) {
@@ -800,25 +630,94 @@ public:
     }
 
 private:
-    PixelPainter *pixelPainter_;
+    TrianglePainterForSink<PixelPainter> painter_;
     LinePainterForPixels linePainter_;
     LinePainter &usedLinePainter_;
 };
 
+// Triangles and indexed triangle meshes with flat or per-vertex colors, see TriangleMeshPainterForSink
+class TriangleMeshPainterForPixels {
+public:
+    TriangleMeshPainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter) {}
+
+    TriangleMeshPainterForPixels(PixelPainter &pixelPainter, const Point &canvasSize)
+            : painter_(pixelPainter, canvasSize) {}
+
+    void drawTriangle(const PointF &p1, const PointF &p2, const PointF &p3, const RgbColor &color) {
+        painter_.drawTriangle(p1, p2, p3, color);
+    }
+
+    void drawTriangle(const PointF &p1, const PointF &p2, const PointF &p3, const RgbColor &color1,
+                      const RgbColor &color2, const RgbColor &color3) {
+        painter_.drawTriangle(p1, p2, p3, color1, color2, color3);
+    }
+
+    void drawMesh(const std::vector<PointF> &vertices, const std::vector<unsigned int> &indices, const RgbColor &color) {
+        painter_.drawMesh(vertices, indices, color);
+    }
+
+    void drawMesh(const std::vector<PointF> &vertices, const std::vector<RgbColor> &colors,
+                  const std::vector<unsigned int> &indices) {
+        painter_.drawMesh(vertices, colors, indices);
+    }
+
+private:
+    TriangleMeshPainterForSink<PixelPainter> painter_;
+};
+
+class PolygonPainterForPixels : public PolygonPainter {
+public:
+    PolygonPainterForPixels(PixelPainter &pixelPainter) : painter_(pixelPainter) {}
+
+    PolygonPainterForPixels(PixelPainter &pixelPainter, const Point &canvasSize) : painter_(pixelPainter, canvasSize) {}
+
+    virtual void drawFull(const std::vector<Point> &points, const RgbColor &color, FillRule rule = NON_ZERO) {
+        painter_.drawFull(points, color, rule);
+    }
+
+    virtual void drawFull(const std::vector<std::vector<Point>> &contours, const RgbColor &color,
+                          FillRule rule = NON_ZERO) {
+        painter_.drawFull(contours, color, rule);
+    }
+
+    virtual void drawFull(const std::vector<std::vector<PointF>> &contours, const RgbColor &color,
+                          FillRule rule = NON_ZERO) {
+        painter_.drawFull(contours, color, rule);
+    }
+
+    virtual void drawEmpty(const std::vector<Point> &points, const RgbColor &color) {
+        painter_.drawEmpty(points, color);
+    }
+
+private:
+    PolygonPainterForSink<PixelPainter> painter_;
+};
+
+// Thick lines and polylines with joins, caps and dashes, every polyline is filled once as outline polygon
+// (see Stroker). Much less work than ThickLinePainterForPixels, which stamps a circle at many points of every line.
+class StrokePainterForPixels : public LinePainter {
+public:
+    StrokePainterForPixels(PixelPainter &pixelPainter, const StrokeStyle &style, bool antiAliased = false)
+            : painter_(pixelPainter, style, antiAliased) {}
+
+    StrokePainterForPixels(PixelPainter &pixelPainter, const Point &canvasSize, const StrokeStyle &style,
+                           bool antiAliased = false) : painter_(pixelPainter, canvasSize, style, antiAliased) {}
+
+    // line between centers of pixels
+    virtual void drawLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        painter_.drawLine(PointF(static_cast<float>(x1) + 0.5f, static_cast<float>(y1) + 0.5f),
+                          PointF(static_cast<float>(x2) + 0.5f, static_cast<float>(y2) + 0.5f), color);
+    }
+
+    void drawPolyline(const std::vector<PointF> &points, const RgbColor &color, bool closed = false) {
+        painter_.drawPolyline(points, color, closed);
+    }
+
+private:
+    StrokePainterForSink<PixelPainter> painter_;
+};
+
 class FloodFillPainterForPixels : public FloodFillPainter {
-    struct PixelStatus {
-        int x;
-        int y;
-        char checkMask;
-    };
-
-    enum {
-        CheckUp = 1,
-        CheckDown = 2,
-        CheckLeft = 4,
-        CheckRight = 8,
-        CheckAll = CheckUp + CheckDown + CheckLeft + CheckRight
-    };
 public:
     FloodFillPainterForPixels(PixelPainter &pixelPainter, const Point &canvasSize) : pixelPainter_(&pixelPainter),
                                                                                      canvasSize_(canvasSize) {}
@@ -831,71 +730,62 @@ public:
     }
 
 protected:
-    // 4-directions non-recursive flood fill
+    // 4-directions non-recursive scanline flood fill - each found run is painted as a single span
     void fillFromPixel(int x, int y, const RgbColor &newColor, const RgbColor &initialColor) {
-        std::vector<PixelStatus> pixels;
-        RgbColor c;
+        if (newColor == initialColor)
+            return;
 
-        PixelStatus s;
-        PixelStatus s1;
-        s.x = x;
-        s.y = y;
-        s.checkMask = calcCheckMask(x, y);
+        if (x < 0 || y < 0 || x >= canvasSize_.x || y >= canvasSize_.y)
+            return;
 
-        pixels.push_back(s);
+        std::vector<Point> seeds;
+        seeds.push_back(Point(x, y));
 
-        while (!pixels.empty()) {
-            s = pixels.back();
-            pixels.pop_back();
+        while (!seeds.empty()) {
+            Point s = seeds.back();
+            seeds.pop_back();
 
-            pixelPainter_->getPixel(UNSIGNED_CAST(unsigned int, s.x), UNSIGNED_CAST(unsigned int, s.y), c);
+            if (!hasColor(s.x, s.y, initialColor))
+                continue;
 
-            if (c == initialColor) {
-                pixelPainter_->putPixel(UNSIGNED_CAST(unsigned int, s.x), UNSIGNED_CAST(unsigned int, s.y), newColor);
+            int left = s.x;
+            while (left > 0 && hasColor(left - 1, s.y, initialColor))
+                --left;
 
-                if (((s.checkMask & CheckLeft) != 0) && (s.x >= 0)) {
-                    s1.x = s.x - 1;
-                    s1.y = s.y;
-                    s1.checkMask = calcCheckMask(s1.x, s1.y) & s.checkMask;
-                    pixels.push_back(s1);
-                }
+            int right = s.x;
+            while (right + 1 < canvasSize_.x && hasColor(right + 1, s.y, initialColor))
+                ++right;
 
-                if (((s.checkMask & CheckRight) != 0) && (s.x + 1 < canvasSize_.x)) {
-                    s1.x = s.x + 1;
-                    s1.y = s.y;
-                    s1.checkMask = calcCheckMask(s1.x, s1.y) & s.checkMask;
-                    pixels.push_back(s1);
-                }
+            pixelPainter_->fillSpan(UNSIGNED_CAST(unsigned int, left), UNSIGNED_CAST(unsigned int, s.y),
+                                    UNSIGNED_CAST(unsigned int, right - left + 1), newColor);
 
-                if (((s.checkMask & CheckUp) != 0) && (s.y >= 0)) {
-                    s1.x = s.x;
-                    s1.y = s.y - 1;
-                    s1.checkMask = calcCheckMask(s1.x, s1.y) & s.checkMask;
-                    pixels.push_back(s1);
-                }
+            if (s.y > 0)
+                addSeeds(left, right, s.y - 1, initialColor, seeds);
+
+            if (s.y + 1 < canvasSize_.y)
+                addSeeds(left, right, s.y + 1, initialColor, seeds);
+        }
+    }
 
-                if (((s.checkMask & CheckDown) != 0) && (s.y + 1 < canvasSize_.y)) {
-                    s1.x = s.x;
-                    s1.y = s.y + 1;
-                    s1.checkMask = calcCheckMask(s1.x, s1.y) & s.checkMask;
-                    pixels.push_back(s1);
+    // adds one seed for each run of matching pixels in row y between left and right
+    void addSeeds(int left, int right, int y, const RgbColor &initialColor, std::vector<Point> &seeds) {
+        bool inRun = false;
+        for (int x = left; x <= right; ++x) {
+            if (hasColor(x, y, initialColor)) {
+                if (!inRun) {
+                    seeds.push_back(Point(x, y));
+                    inRun = true;
                 }
+            } else {
+                inRun = false;
             }
         }
-
     }
 
-    char calcCheckMask(int x, int y) {
-        char checkMask = 0;
-        if (x > 0)
-            checkMask += CheckLeft;
-        if (x + 1 < canvasSize_.x)
-            checkMask += CheckRight;
-        if (y > 0)
-            checkMask += CheckUp;
-        if (y + 1 < canvasSize_.y)
-            checkMask += CheckDown;
-        return checkMask;
+    bool hasColor(int x, int y, const RgbColor &color) {
+        RgbColor c;
+        pixelPainter_->getPixel(UNSIGNED_CAST(unsigned int, x), UNSIGNED_CAST(unsigned int, y), c);
+        return c == color;
     }
 
 private:
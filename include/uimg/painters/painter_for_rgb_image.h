@@ -2,9 +2,11 @@
 #define __UIMG_PAINTER_4_RGB_IMG_H__
 
 #include <cstring>
+#include <algorithm>
 
 #include "uimg/painters/painter_base.h"
 #include "uimg/painters/painter_for_pixels.h"
+#include "uimg/painters/painter_for_sink.h"
 #include "uimg/images/rgb_image.h"
 #include "uimg/utils/cast.h"
 
@@ -25,182 +27,209 @@ private:
     PixelImageBase &target_;
 };
 
-// class which paints pixels on RGB image
-class PixelPainterForRgbImage : public PixelPainter {
+// Non-virtual pixel sink writing directly to memory of RGB image (RgbImage or ImageView).
+// Used as a template argument of *PainterForSink painters, so drawing loops can be fully inlined.
+// Pixels outside of image are skipped.
+class RgbImagePixelSink {
 public:
-    PixelPainterForRgbImage(RgbImage &image) : image_(image) {}
+    RgbImagePixelSink(RgbImageBase &image) : data_(image.row(0)), stride_(image.stride()), width_(image.width()),
+                                             height_(image.height()) {}
 
-    virtual void putPixel(unsigned int x, unsigned int y, const RgbColor &color) {
-        size_t offset = 3 * (y * image_.width() + x);
-        if (offset >= image_.dataSize())
-            return;
+    unsigned int width() const {
+        return width_;
+    }
 
-        unsigned char *dataPtr = static_cast<unsigned char *>(image_.data()) + offset;
-        *(dataPtr++) = color.red;
-        *(dataPtr++) = color.green;
-        *(dataPtr++) = color.blue;
+    unsigned int height() const {
+        return height_;
     }
 
-    virtual void getPixel(unsigned int x, unsigned int y, RgbColor &output) {
-        size_t offset = 3 * (y * image_.width() + x);
+    void putPixel(unsigned int x, unsigned int y, const RgbColor &color) {
+        if (x >= width_ || y >= height_)
+            return;
 
-        if (offset >= image_.dataSize()) {
+        unsigned char *dataPtr = pixelPtr(x, y);
+        dataPtr[0] = color.red;
+        dataPtr[1] = color.green;
+        dataPtr[2] = color.blue;
+    }
+
+    void getPixel(unsigned int x, unsigned int y, RgbColor &output) const {
+        if (x >= width_ || y >= height_) {
             output.red = output.green = output.blue = 0;
             return;
         }
 
-        unsigned char *dataPtr = static_cast<unsigned char *>(image_.data()) + offset;
-        output.red = *(dataPtr++);
-        output.green = *(dataPtr++);
-        output.blue = *(dataPtr++);
+        const unsigned char *dataPtr = pixelPtr(x, y);
+        output.red = dataPtr[0];
+        output.green = dataPtr[1];
+        output.blue = dataPtr[2];
     }
 
-private:
-    RgbImage &image_;
-};
+    void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        unsigned int count = clipSpan(x, y, length);
+        if (count == 0)
+            return;
 
-class LinePainterForRgbImage : public LinePainterForPixels {
-    using inherited = LinePainterForPixels;
-public:
-    LinePainterForRgbImage(RgbImage &image) : LinePainterForPixels(pixelPainter_), image_(image),
-                                              pixelPainter_(image) {}
+        unsigned char *dataPtr = pixelPtr(x, y);
 
-    virtual void drawLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
-        return inherited::drawLine(x1, y1, x2, y2, color);
+        for (unsigned int i = 0; i < count; ++i) {
+            *(dataPtr++) = color.red;
+            *(dataPtr++) = color.green;
+            *(dataPtr++) = color.blue;
+        }
     }
 
-protected:
-    virtual void drawVerticalLine(unsigned int x, unsigned int y1, unsigned int y2, const RgbColor &color) {
-        if (x >= image_.width())
+    void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        unsigned int count = clipSpan(x, y, length);
+        if (count == 0)
             return;
 
-        if (y1 > y2) {
-            drawVerticalLine(x, y2, y1, color);
-            return;
+        unsigned char *dataPtr = pixelPtr(x, y);
+
+        for (unsigned int i = 0; i < count; ++i) {
+            *(dataPtr++) = colors[i].red;
+            *(dataPtr++) = colors[i].green;
+            *(dataPtr++) = colors[i].blue;
         }
+    }
 
-        unsigned int y1c = std::min(std::min(y1, y2), image_.height() - 1);
-        unsigned int y2c = std::min(std::max(y1, y2), image_.height() - 1);
+    // integer blending: dst = (src * c + dst * (255 - c)) / 255, rounded
+    void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                   const unsigned char *coverage) {
+        unsigned int count = clipSpan(x, y, length);
+        if (count == 0)
+            return;
 
-        size_t offset = 3 * (y1c * image_.width() + x);
-        unsigned char *dataPtr = static_cast<unsigned char *>(image_.data()) + offset;
-        unsigned int step = 3 * image_.width() - 2;
+        unsigned char *dataPtr = pixelPtr(x, y);
 
-        for (unsigned int y = y1c; y <= y2c; ++y) {
-            *(dataPtr++) = color.red;
-            *(dataPtr++) = color.green;
-            *dataPtr = color.blue;
-            dataPtr += step;
+        for (unsigned int i = 0; i < count; ++i, dataPtr += 3) {
+            unsigned int c = coverage[i];
+            if (c == 0)
+                continue;
+            unsigned int ic = 255 - c;
+            dataPtr[0] = static_cast<unsigned char>((color.red * c + dataPtr[0] * ic + 127) / 255);
+            dataPtr[1] = static_cast<unsigned char>((color.green * c + dataPtr[1] * ic + 127) / 255);
+            dataPtr[2] = static_cast<unsigned char>((color.blue * c + dataPtr[2] * ic + 127) / 255);
         }
     }
 
-    virtual void drawHorizontalLine(unsigned int x1, unsigned int x2, unsigned int y, const RgbColor &color) {
-        if (y >= image_.height())
-            return;
+private:
+    // returns number of pixels of span which are inside of image
+    unsigned int clipSpan(unsigned int x, unsigned int y, unsigned int length) const {
+        if (x >= width_ || y >= height_)
+            return 0;
+        return std::min(length, width_ - x);
+    }
 
-        if (x1 > x2) {
-            drawHorizontalLine(x2, x1, y, color);
-            return;
-        }
+    unsigned char *pixelPtr(unsigned int x, unsigned int y) const {
+        return data_ + static_cast<size_t>(y) * stride_ + static_cast<size_t>(x) * RgbImageBase::BYTES_PER_PIXEL;
+    }
 
-        int x1c = static_cast<int>(std::min(x1, image_.width() - 1));
-        int x2c = static_cast<int>(std::min(x2, image_.width() - 1));
+    unsigned char *data_;
+    size_t stride_;
+    unsigned int width_;
+    unsigned int height_;
+};
 
-        size_t offset = 3 * (y * image_.width() + UNSIGNED_CAST(unsigned int, x1c));
-        unsigned char *dataPtr = static_cast<unsigned char *>(image_.data()) + offset;
+// class which paints pixels on RGB image
+class PixelPainterForRgbImage : public PixelPainter {
+public:
+    PixelPainterForRgbImage(RgbImageBase &image) : sink_(image) {}
 
-        for (int x = x1c; x <= x2c; ++x) {
-            *(dataPtr++) = color.red;
-            *(dataPtr++) = color.green;
-            *(dataPtr++) = color.blue;
-        }
+    virtual void putPixel(unsigned int x, unsigned int y, const RgbColor &color) {
+        sink_.putPixel(x, y, color);
+    }
+
+    virtual void getPixel(unsigned int x, unsigned int y, RgbColor &output) {
+        sink_.getPixel(x, y, output);
+    }
+
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        sink_.fillSpan(x, y, length, color);
+    }
+
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        sink_.copySpan(x, y, length, colors);
     }
 
-    virtual void clipBySize(int &x, int &y) {
-        Point size = image_.getSize();
-        x = std::max(0, std::min(x, size.x - 1));
-        y = std::max(0, std::min(y, size.y - 1));
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        sink_.blendSpan(x, y, length, color, coverage);
     }
 
 private:
-    RgbImage &image_;
-    PixelPainterForRgbImage pixelPainter_;
+    RgbImagePixelSink sink_;
 };
 
-class RectPainterForRgbImage : public RectPainter {
+// line painter with statically dispatched pixel writes, end points are clipped to image size
+class LinePainterForRgbImage : public LinePainterForPixels {
 public:
-    RectPainterForRgbImage(RgbImage &image) : image_(image), pixelPainter_(image), linePainter_(image) {}
-
-    virtual void
-    drawFull(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
-        if (x1 > x2) {
-            drawFull(x2, y2, x1, y1, color);
-            return;
-        }
+    LinePainterForRgbImage(RgbImageBase &image) : LinePainterForPixels(pixelPainter_), pixelPainter_(image),
+                                              sink_(image), painter_(sink_, image.getSize()) {}
 
-        unsigned int ymin = std::min(y1, y2);
-        unsigned int ymax = std::max(y1, y2);
-
-        int x1c = static_cast<int>(std::min(x1, image_.width() - 1));
-        int x2c = static_cast<int>(std::min(x2, image_.width() - 1));
+    virtual void drawLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        painter_.drawLine(x1, y1, x2, y2, color);
+    }
 
-        size_t lnOffset = 3 * (ymin * image_.width() + UNSIGNED_CAST(unsigned int, x1c));
-        size_t lnStep = 3 * image_.width();
+protected:
+    virtual void drawVerticalLine(unsigned int x, unsigned int y1, unsigned int y2, const RgbColor &color) {
+        painter_.drawVerticalLine(x, y1, y2, color);
+    }
 
-        unsigned char *lnPtr = static_cast<unsigned char *>(image_.data()) + lnOffset;
-        unsigned char *pixelPtr;
+    virtual void drawHorizontalLine(unsigned int x1, unsigned int x2, unsigned int y, const RgbColor &color) {
+        painter_.drawHorizontalLine(x1, x2, y, color);
+    }
 
-        for (unsigned int y = ymin; y <= ymax; ++y) {
-            pixelPtr = lnPtr;
+private:
+    PixelPainterForRgbImage pixelPainter_;
+    RgbImagePixelSink sink_;
+    LinePainterForSink<RgbImagePixelSink> painter_;
+};
 
-            for (int x = x1c; x <= x2c; ++x) {
-                *(pixelPtr++) = color.red;
-                *(pixelPtr++) = color.green;
-                *(pixelPtr++) = color.blue;
-            }
+class RectPainterForRgbImage : public RectPainter {
+public:
+    RectPainterForRgbImage(RgbImageBase &image) : sink_(image), painter_(sink_, image.getSize()) {}
 
-            lnPtr += lnStep;
-        }
+    virtual void
+    drawFull(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        painter_.drawFull(x1, y1, x2, y2, color);
     }
 
     virtual void
     drawEmpty(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
-        linePainter_.drawLine(x1, y1, x2, y1, color);
-        linePainter_.drawLine(x1, y2, x2, y2, color);
-        linePainter_.drawLine(x1, y1, x1, y2, color);
-        linePainter_.drawLine(x2, y1, x2, y2, color);
+        painter_.drawEmpty(x1, y1, x2, y2, color);
     }
 
 private:
-    RgbImage &image_;
-    PixelPainterForRgbImage pixelPainter_;
-    LinePainterForRgbImage linePainter_;
+    RgbImagePixelSink sink_;
+    RectPainterForSink<RgbImagePixelSink> painter_;
 };
 
-
 class BackgroundPainterForRgbImage : public BackgroundPainter {
 public:
-    BackgroundPainterForRgbImage(RgbImage &image) : image_(&image) {}
+    BackgroundPainterForRgbImage(RgbImageBase &image) : image_(&image) {}
 
     virtual ~BackgroundPainterForRgbImage() {}
 
     virtual void paint(const RgbColor &color) {
-        unsigned char colorBytes[3];
-        colorBytes[0] = color.red;
-        colorBytes[1] = color.green;
-        colorBytes[2] = color.blue;
-        unsigned char *data = static_cast<unsigned char *>(image_->data());
-        size_t dataSize = image_->dataSize();
-        unsigned int offset = 0;
-        while (offset < dataSize) {
-            memcpy(data, colorBytes, sizeof(colorBytes));
-            data += sizeof(colorBytes);
-            offset += sizeof(colorBytes);
+        size_t rowSize = image_->rowSize();
+        if (rowSize == 0)
+            return;
+
+        // first row is filled pixel by pixel, following rows are copies of it
+        unsigned char *firstRow = image_->row(0);
+        for (size_t offset = 0; offset < rowSize; offset += RgbImageBase::BYTES_PER_PIXEL) {
+            firstRow[offset] = color.red;
+            firstRow[offset + 1] = color.green;
+            firstRow[offset + 2] = color.blue;
         }
+
+        for (unsigned int y = 1, eposy = image_->height(); y < eposy; ++y)
+            memcpy(image_->row(y), firstRow, rowSize);
     }
 
 private:
-    RgbImage *image_;
+    RgbImageBase *image_;
 };
 
 #endif
@@ -0,0 +1,104 @@
+#ifndef __UIMG_PAINTER_4_RGBA_IMG_H__
+#define __UIMG_PAINTER_4_RGBA_IMG_H__
+
+#include <algorithm>
+#include <cmath>
+
+#include "uimg/pixels/pixel_painter.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/utils/color_utils.h"
+
+// Pixel painter for RgbaImage layers.
+// Plain (RgbColor) writes are opaque, writes with alpha and blendSpan composite source over existing
+// pixel using integer arithmetic on premultiplied values, so translucent overlays can be painted
+// into a transparent layer and later composited onto an RGB image with RgbaCompositor.
+class PixelPainterForRgbaImage : public PixelPainter {
+public:
+    PixelPainterForRgbaImage(RgbaImage &image) : image_(image), width_(image.width()), height_(image.height()) {}
+
+    virtual void putPixel(unsigned int x, unsigned int y, const RgbColor &color) {
+        if (x >= width_ || y >= height_)
+            return;
+        storeOpaque(pixelPtr(x, y), color);
+    }
+
+    // returns color without alpha (unpremultiplied)
+    virtual void getPixel(unsigned int x, unsigned int y, RgbColor &output) {
+        output = image_.getPixel(Point(static_cast<int>(x), static_cast<int>(y)));
+    }
+
+    virtual void putPixel(unsigned int x, unsigned int y, const RgbColor &color, float alpha) {
+        float clamped = std::min(1.0f, std::max(0.0f, alpha));
+        blendPixel(x, y, color, static_cast<unsigned int>(std::lround(clamped * 255.0f)));
+    }
+
+    virtual void putPixel(unsigned int x, unsigned int y, const RgbaColor &color) {
+        RgbColor c;
+        c.red = color.red;
+        c.green = color.green;
+        c.blue = color.blue;
+        blendPixel(x, y, c, color.alpha);
+    }
+
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        unsigned int count = clipSpan(x, y, length);
+        unsigned char *dataPtr = count ? pixelPtr(x, y) : nullptr;
+        for (unsigned int i = 0; i < count; ++i, dataPtr += RgbaImage::BYTES_PER_PIXEL)
+            storeOpaque(dataPtr, color);
+    }
+
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        unsigned int count = clipSpan(x, y, length);
+        unsigned char *dataPtr = count ? pixelPtr(x, y) : nullptr;
+        for (unsigned int i = 0; i < count; ++i, dataPtr += RgbaImage::BYTES_PER_PIXEL)
+            storeOpaque(dataPtr, colors[i]);
+    }
+
+    // coverage is used as source alpha: dst = color * c + dst * (255 - c) for all four channels
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        unsigned int count = clipSpan(x, y, length);
+        unsigned char *dataPtr = count ? pixelPtr(x, y) : nullptr;
+        for (unsigned int i = 0; i < count; ++i, dataPtr += RgbaImage::BYTES_PER_PIXEL)
+            blendOver(dataPtr, color, coverage[i]);
+    }
+
+private:
+    void blendPixel(unsigned int x, unsigned int y, const RgbColor &color, unsigned int alpha) {
+        if (x >= width_ || y >= height_)
+            return;
+        blendOver(pixelPtr(x, y), color, alpha);
+    }
+
+    static void storeOpaque(unsigned char *dataPtr, const RgbColor &color) {
+        dataPtr[0] = color.red;
+        dataPtr[1] = color.green;
+        dataPtr[2] = color.blue;
+        dataPtr[3] = 255;
+    }
+
+    static void blendOver(unsigned char *dataPtr, const RgbColor &color, unsigned int alpha) {
+        unsigned int inv = 255 - alpha;
+        dataPtr[0] = static_cast<unsigned char>(color_utils::mul_div_255(color.red, alpha) + color_utils::mul_div_255(dataPtr[0], inv));
+        dataPtr[1] = static_cast<unsigned char>(color_utils::mul_div_255(color.green, alpha) + color_utils::mul_div_255(dataPtr[1], inv));
+        dataPtr[2] = static_cast<unsigned char>(color_utils::mul_div_255(color.blue, alpha) + color_utils::mul_div_255(dataPtr[2], inv));
+        dataPtr[3] = static_cast<unsigned char>(alpha + color_utils::mul_div_255(dataPtr[3], inv));
+    }
+
+    // returns number of pixels of span which are inside of image
+    unsigned int clipSpan(unsigned int x, unsigned int y, unsigned int length) const {
+        if (x >= width_ || y >= height_)
+            return 0;
+        return std::min(length, width_ - x);
+    }
+
+    unsigned char *pixelPtr(unsigned int x, unsigned int y) {
+        return image_.row(y) + static_cast<size_t>(x) * RgbaImage::BYTES_PER_PIXEL;
+    }
+
+    RgbaImage &image_;
+    unsigned int width_;
+    unsigned int height_;
+};
+
+#endif
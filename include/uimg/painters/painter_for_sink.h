@@ -0,0 +1,1166 @@
+#ifndef __UIMG_PAINTER_FOR_SINK_H__
+#define __UIMG_PAINTER_FOR_SINK_H__
+
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "uimg/base/structs.h"
+#include "uimg/painters/painter_base.h"
+#include "uimg/painters/stroker.h"
+#include "uimg/painters/triangle_rasterizer.h"
+#include "uimg/utils/math_utils.h"
+#include "uimg/utils/cast.h"
+
+// Statically dispatched painters.
+// Each painter is parameterized by pixel sink type, which needs to provide (non-virtual calls are preferred):
+//   void putPixel(unsigned int x, unsigned int y, const RgbColor &color);
+//   void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color);
+// With a concrete sink (e.g. RgbImagePixelSink) rasterization loops are inlined down to memory writes.
+// PixelPainter is a valid sink too - this is how *PainterForPixels classes use these templates.
+
+// Utility class for span operations
+class SpanUtils {
+public:
+    // fills pixels x1..x2 (inclusive) of row y, part with negative coordinates is skipped
+    template<typename PixelSink>
+    static void fillClippedSpan(PixelSink &sink, int x1, int y, int x2, const RgbColor &color) {
+        if (y < 0 || x2 < 0 || x2 < x1)
+            return;
+        x1 = std::max(0, x1);
+        sink.fillSpan(UNSIGNED_CAST(unsigned int, x1), UNSIGNED_CAST(unsigned int, y),
+                      UNSIGNED_CAST(unsigned int, x2 - x1 + 1), color);
+    }
+};
+
+template<typename PixelSink>
+class LinePainterForSink {
+public:
+    LinePainterForSink(PixelSink &sink) : sink_(sink), clipMax_(INT_MAX, INT_MAX) {}
+
+    // line end points are clipped to canvas of a given size
+    LinePainterForSink(PixelSink &sink, const Point &canvasSize) : sink_(sink),
+                                                                  clipMax_(canvasSize.x - 1, canvasSize.y - 1) {}
+
+    // uses Bresenham's line algorithm
+    void drawLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        if (x1 > x2) {
+            drawLine(x2, y2, x1, y1, color);
+            return;
+        } else if (x1 == x2) {
+            drawVerticalLine(x1, y1, y2, color);
+            return;
+        } else if (y1 == y2) {
+            drawHorizontalLine(x1, x2, y1, color);
+            return;
+        }
+
+        using real = float;
+        real deltax = static_cast<real>(x2) - static_cast<real>(x1);
+        real deltay = static_cast<real>(y2) - static_cast<real>(y1);
+        real error = 0.0f;
+        real deltaerr = static_cast<real>(fabs(deltay / deltax));
+
+        int y = static_cast<int>(y1);
+        int x = static_cast<int>(x1);
+
+        int ye = static_cast<int>(y2);
+        int xe = static_cast<int>(x2);
+
+        clipBySize(xe, ye);
+
+        int sign = (ye - static_cast<int>(y1) > 0) ? 1 : -1;
+
+        for (; x <= xe; ++x) {
+            putPixel(x, y, color);
+            error += deltaerr;
+            while (error >= 0.5f) {
+                putPixel(x, y, color);
+                y += sign;
+                error -= 1.0f;
+            }
+        }
+    }
+
+    void drawVerticalLine(unsigned int x, unsigned int y1, unsigned int y2, const RgbColor &color) {
+        if (y1 > y2)
+            std::swap(y1, y2);
+
+        if (x > static_cast<unsigned int>(clipMax_.x) || y1 > static_cast<unsigned int>(clipMax_.y))
+            return;
+
+        y2 = std::min(y2, static_cast<unsigned int>(clipMax_.y));
+
+        for (unsigned yi = y1; yi <= y2; ++yi)
+            sink_.putPixel(x, yi, color);
+    }
+
+    void drawHorizontalLine(unsigned int x1, unsigned int x2, unsigned int y, const RgbColor &color) {
+        if (x1 > x2)
+            std::swap(x1, x2);
+
+        sink_.fillSpan(x1, y, x2 - x1 + 1, color);
+    }
+
+protected:
+    void clipBySize(int &x, int &y) const {
+        x = std::max(0, std::min(x, clipMax_.x));
+        y = std::max(0, std::min(y, clipMax_.y));
+    }
+
+private:
+    // y can step outside of canvas at the end of line, such pixels are skipped
+    void putPixel(int x, int y, const RgbColor &color) {
+        if (y >= 0)
+            sink_.putPixel(static_cast<unsigned int>(x), static_cast<unsigned int>(y), color);
+    }
+
+    PixelSink &sink_;
+    Point clipMax_;
+};
+
+template<typename PixelSink>
+class RectPainterForSink {
+public:
+    RectPainterForSink(PixelSink &sink) : sink_(sink), linePainter_(sink) {}
+
+    RectPainterForSink(PixelSink &sink, const Point &canvasSize) : sink_(sink), linePainter_(sink, canvasSize) {}
+
+    void drawFull(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        if (x2 < x1)
+            std::swap(x1, x2);
+        if (y2 < y1)
+            std::swap(y1, y2);
+
+        for (unsigned int yi = y1; yi <= y2; ++yi)
+            sink_.fillSpan(x1, yi, x2 - x1 + 1, color);
+    }
+
+    void drawEmpty(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const RgbColor &color) {
+        linePainter_.drawLine(x1, y1, x2, y1, color);
+        linePainter_.drawLine(x1, y2, x2, y2, color);
+        linePainter_.drawLine(x1, y1, x1, y2, color);
+        linePainter_.drawLine(x2, y1, x2, y2, color);
+    }
+
+private:
+    PixelSink &sink_;
+    LinePainterForSink<PixelSink> linePainter_;
+};
+
+// Filled shapes are emitted as spans, extents of rows are updated incrementally from row to row (from the center
+// outwards, both halves at once). Pixel (x + dx, y + dy) belongs to circle of radius r when dx^2 + dy^2 <= r^2.
+// Angles of arcs and pie slices are in radians, measured from positive x axis towards positive y (clockwise on
+// screen); slice covers directions in [startAngle, endAngle), so adjacent slices of a pie do not overlap.
+template<typename PixelSink>
+class CirclePainterForSink {
+public:
+    CirclePainterForSink(PixelSink &sink) : sink_(sink) {}
+
+    // fills all pixels with xi^2 + yi^2 <= r^2, one span per row
+    void drawFull(unsigned int x, unsigned int y, unsigned int r, const RgbColor &color) {
+        fillRows(static_cast<int>(x), static_cast<int>(y), static_cast<int>(r), -1, nullptr, color);
+    }
+
+    // fills pixels with innerR^2 < xi^2 + yi^2 <= outerR^2, at most two spans per row
+    void drawRing(unsigned int x, unsigned int y, unsigned int outerR, unsigned int innerR, const RgbColor &color) {
+        fillRows(static_cast<int>(x), static_cast<int>(y), static_cast<int>(outerR), static_cast<int>(innerR), nullptr,
+                 color);
+    }
+
+    // part of ring (see drawRing) between startAngle and endAngle
+    void drawArc(unsigned int x, unsigned int y, unsigned int outerR, unsigned int innerR, double startAngle,
+                 double endAngle, const RgbColor &color) {
+        fillSector(static_cast<int>(x), static_cast<int>(y), static_cast<int>(outerR), static_cast<int>(innerR),
+                   startAngle, endAngle, color);
+    }
+
+    // pie slice of circle (see drawFull) between startAngle and endAngle
+    void drawPie(unsigned int x, unsigned int y, unsigned int r, double startAngle, double endAngle,
+                 const RgbColor &color) {
+        fillSector(static_cast<int>(x), static_cast<int>(y), static_cast<int>(r), -1, startAngle, endAngle, color);
+    }
+
+    // Midpoint circle algorithm
+    void drawEmpty(unsigned int x0, unsigned int y0, unsigned int r, const RgbColor &color) {
+        int x = static_cast<int>(r);
+        int y = 0;
+        int decisionOver2 = 1 - x;
+        int cx = static_cast<int>(x0);
+        int cy = static_cast<int>(y0);
+
+        while (y <= x) {
+            putPixel(x + cx, y + cy, color);
+            putPixel(y + cx, x + cy, color);
+            putPixel(-x + cx, y + cy, color);
+            putPixel(-y + cx, x + cy, color);
+            putPixel(-x + cx, -y + cy, color);
+            putPixel(-y + cx, -x + cy, color);
+            putPixel(x + cx, -y + cy, color);
+            putPixel(y + cx, -x + cy, color);
+            y++;
+
+            if (decisionOver2 <= 0) {
+                decisionOver2 += 2 * y + 1;
+            } else {
+                x--;
+                decisionOver2 += 2 * (y - x) + 1;
+            }
+        }
+    }
+
+    // border is a ring around the fill, so every pixel is painted once
+    void drawFullWithBorder(unsigned int x, unsigned int y, unsigned int r, unsigned int borderWidth,
+                            const RgbColor &fillColor, const RgbColor &borderColor) {
+        if (borderWidth >= r) {
+            drawFull(x, y, r, borderColor);
+            return;
+        }
+        drawRing(x, y, r, r - borderWidth, borderColor);
+        drawFull(x, y, r - borderWidth, fillColor);
+    }
+
+private:
+    static constexpr double PI = 3.14159265358979323846;
+
+    // directions in [start, end) - cos and sin of both angles, wide when sector is larger than half of circle
+    struct Sector {
+        double startCos, startSin;
+        double endCos, endSin;
+        bool wide;
+    };
+
+    void fillSector(int cx, int cy, int outerR, int innerR, double startAngle, double endAngle, const RgbColor &color) {
+        double sweep = endAngle - startAngle;
+        if (!(sweep > 0.0))
+            return;
+        if (sweep >= 2.0 * PI) {
+            fillRows(cx, cy, outerR, innerR, nullptr, color);
+            return;
+        }
+        // same angle modulo full turn gives the same boundary, e.g. end of last slice at 2 pi and start of first at 0
+        double start = std::fmod(startAngle, 2.0 * PI), end = std::fmod(endAngle, 2.0 * PI);
+        start += start < 0.0 ? 2.0 * PI : 0.0;
+        end += end < 0.0 ? 2.0 * PI : 0.0;
+        Sector sector = {direction(std::cos(start)), direction(std::sin(start)), direction(std::cos(end)),
+                         direction(std::sin(end)), sweep > PI};
+        fillRows(cx, cy, outerR, innerR, &sector, color);
+    }
+
+    // fills pixels of disc of outerR without disc of innerR (none if negative), limited to sector if given
+    void fillRows(int cx, int cy, int outerR, int innerR, const Sector *sector, const RgbColor &color) {
+        long long outer2 = static_cast<long long>(outerR) * outerR;
+        long long inner2 = static_cast<long long>(innerR) * innerR;
+        int outerX = outerR, innerX = innerR;
+        for (int dy = 0; dy <= outerR; ++dy) {
+            long long dy2 = static_cast<long long>(dy) * dy;
+            while (outerX >= 0 && static_cast<long long>(outerX) * outerX + dy2 > outer2)
+                --outerX;
+            while (innerX >= 0 && static_cast<long long>(innerX) * innerX + dy2 > inner2)
+                --innerX;
+
+            for (int side = 0; side < (dy == 0 ? 1 : 2); ++side) {
+                int rowDy = side == 0 ? dy : -dy;
+                if (cy + rowDy < 0)
+                    continue;
+                if (innerX < 0) {
+                    fillRowSpan(cx, cy + rowDy, rowDy, -outerX, outerX, sector, color);
+                } else {
+                    fillRowSpan(cx, cy + rowDy, rowDy, -outerX, -innerX - 1, sector, color);
+                    fillRowSpan(cx, cy + rowDy, rowDy, innerX + 1, outerX, sector, color);
+                }
+            }
+        }
+    }
+
+    // fills pixels cx + dx of row py for dx in [first, last], which lie in sector (if given)
+    void fillRowSpan(int cx, int py, int dy, int first, int last, const Sector *sector, const RgbColor &color) {
+        if (first > last)
+            return;
+        if (!sector) {
+            SpanUtils::fillClippedSpan(sink_, cx + first, py, cx + last, color);
+            return;
+        }
+
+        // narrow sector is intersection of half turns from start and to end, wide one is complement of the narrow one
+        // between end and start; within a row every half turn is one run of pixels
+        int a1, b1, a2, b2;
+        halfTurnSpan(sector->startCos, sector->startSin, dy, first, last, !sector->wide, a1, b1);
+        halfTurnSpan(sector->endCos, sector->endSin, dy, first, last, sector->wide, a2, b2);
+        int a = std::max(a1, a2), b = std::min(b1, b2);
+        if (!sector->wide) {
+            if (a <= b)
+                SpanUtils::fillClippedSpan(sink_, cx + a, py, cx + b, color);
+        } else if (a > b) {
+            SpanUtils::fillClippedSpan(sink_, cx + first, py, cx + last, color);
+        } else {
+            if (first < a)
+                SpanUtils::fillClippedSpan(sink_, cx + first, py, cx + a - 1, color);
+            if (b < last)
+                SpanUtils::fillClippedSpan(sink_, cx + b + 1, py, cx + last, color);
+        }
+    }
+
+    // rounds cos or sin of boundary angle to multiple of 2^-32, so angles differing only by rounding errors (e.g. 3 pi / 2
+    // and -pi / 2 + 2 pi) give the same boundary and directions along axes and diagonals are exact
+    static double direction(double value) {
+        const double scale = 4294967296.0;
+        return std::round(value * scale) / scale;
+    }
+
+    // whether direction of (dx, dy) lies in half turn [angle, angle + pi); center counts as direction 0
+    static bool inHalfTurn(double c, double s, int dx, int dy) {
+        if (dx == 0 && dy == 0)
+            dx = 1;
+        double cross = c * dy - s * dx;
+        if (cross != 0.0)
+            return cross > 0.0;
+        return c * dx + s * dy > 0.0;
+    }
+
+    // run [runFirst, runLast] of dx in [first, last] of row dy where inHalfTurn() equals inside (empty if first > last);
+    // inHalfTurn() is true for dx before some bound in the row (prefix) or from it (suffix)
+    static void halfTurnSpan(double c, double s, int dy, int first, int last, bool inside, int &runFirst,
+                             int &runLast) {
+        bool prefix = s > 0.0 || (s == 0.0 && c < 0.0);
+        int bound; // prefix: first dx outside, suffix: first dx inside
+        if (s == 0.0 && dy != 0) {
+            bound = inHalfTurn(c, s, first, dy) == prefix ? last + 1 : first;
+        } else {
+            double estimate = s != 0.0 ? std::ceil(c * dy / s) : 0.0;
+            bound = static_cast<int>(std::max(static_cast<double>(first), std::min(static_cast<double>(last) + 1.0, estimate)));
+            while (bound > first && inHalfTurn(c, s, bound - 1, dy) != prefix)
+                --bound;
+            while (bound <= last && inHalfTurn(c, s, bound, dy) == prefix)
+                ++bound;
+        }
+        // prefix: [first, bound) is inside; suffix: [bound, last] is inside
+        if (inside == prefix) {
+            runFirst = first;
+            runLast = bound - 1;
+        } else {
+            runFirst = bound;
+            runLast = last;
+        }
+    }
+
+    void putPixel(int x, int y, const RgbColor &color) {
+        sink_.putPixel(UNSIGNED_CAST(unsigned int, x), UNSIGNED_CAST(unsigned int, y), color);
+    }
+
+    PixelSink &sink_;
+};
+
+template<typename PixelSink>
+class EllipsePainterForSink {
+public:
+    EllipsePainterForSink(PixelSink &sink) : sink_(sink) {}
+
+    // fills all pixels with ry^2 * xi^2 + rx^2 * yi^2 <= rx^2 * ry^2, one span per row
+    void drawFull(unsigned int x, unsigned int y, unsigned int rx, unsigned int ry, const RgbColor &color) {
+        int cx = static_cast<int>(x), cy = static_cast<int>(y);
+        long long rx2 = static_cast<long long>(rx) * rx;
+        long long ry2 = static_cast<long long>(ry) * ry;
+        int xm = static_cast<int>(rx);
+        // extent shrinks from center row outwards
+        for (int yi = 0; yi <= static_cast<int>(ry); ++yi) {
+            long long yc = rx2 * ry2 - static_cast<long long>(yi) * yi * rx2;
+            while (xm > 0 && static_cast<long long>(xm) * xm * ry2 > yc)
+                --xm;
+            if (cy + yi >= 0)
+                SpanUtils::fillClippedSpan(sink_, cx - xm, cy + yi, cx + xm, color);
+            if (yi > 0 && cy - yi >= 0)
+                SpanUtils::fillClippedSpan(sink_, cx - xm, cy - yi, cx + xm, color);
+        }
+    }
+
+    // Bresenham's ellipse drawing algorithm
+    void drawEmpty(unsigned int x0, unsigned int y0, unsigned int rx, unsigned int ry, const RgbColor &color) {
+        int a2 = static_cast<int>(rx * rx);
+        int b2 = static_cast<int>(ry * ry);
+        int fa2 = 4 * a2, fb2 = 4 * b2;
+        int cx = static_cast<int>(x0);
+        int cy = static_cast<int>(y0);
+        int xi, yi, sigma;
+
+        /* first half */
+        for (xi = 0, yi = static_cast<int>(ry), sigma = 2 * b2 + a2 * (1 - 2 * static_cast<int>(ry)); b2 * xi <= a2 * yi; xi++) {
+            putQuadPixels(cx, cy, xi, yi, color);
+
+            if (sigma >= 0) {
+                sigma += fa2 * (1 - yi);
+                yi--;
+            }
+
+            sigma += b2 * ((4 * xi) + 6);
+        }
+
+        /* second half */
+        for (xi = static_cast<int>(rx), yi = 0, sigma = 2 * a2 + b2 * (1 - 2 * static_cast<int>(rx)); a2 * yi <= b2 * xi; yi++) {
+            putQuadPixels(cx, cy, xi, yi, color);
+
+            if (sigma >= 0) {
+                sigma += fb2 * (1 - xi);
+                xi--;
+            }
+
+            sigma += a2 * ((4 * yi) + 6);
+        }
+    }
+
+private:
+    // puts pixel mirrored to all four quadrants
+    void putQuadPixels(int cx, int cy, int xi, int yi, const RgbColor &color) {
+        sink_.putPixel(UNSIGNED_CAST(unsigned int, cx + xi), UNSIGNED_CAST(unsigned int, cy + yi), color);
+        sink_.putPixel(UNSIGNED_CAST(unsigned int, cx - xi), UNSIGNED_CAST(unsigned int, cy + yi), color);
+        sink_.putPixel(UNSIGNED_CAST(unsigned int, cx + xi), UNSIGNED_CAST(unsigned int, cy - yi), color);
+        sink_.putPixel(UNSIGNED_CAST(unsigned int, cx - xi), UNSIGNED_CAST(unsigned int, cy - yi), color);
+    }
+
+    PixelSink &sink_;
+};
+
+template<typename PixelSink>
+class TrianglePainterForSink {
+public:
+    TrianglePainterForSink(PixelSink &sink) : sink_(sink), linePainter_(sink),
+                                              rasterizer_(TriangleRasterizer::PIXEL_CORNERS_INCLUSIVE) {}
+
+    TrianglePainterForSink(PixelSink &sink, const Point &canvasSize) : sink_(sink), linePainter_(sink, canvasSize),
+                                                                       rasterizer_(TriangleRasterizer::PIXEL_CORNERS_INCLUSIVE,
+                                                                                   canvasSize) {}
+
+    // fills pixels (x, y) lying inside of triangle or on its edges, in any vertex order (see TriangleRasterizer)
+    void drawFull(const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) {
+        rasterizer_.rasterize(TriangleRasterizer::toFixed(p1), TriangleRasterizer::toFixed(p2),
+                              TriangleRasterizer::toFixed(p3), [this, &color](int y, int x1, int x2) {
+                    SpanUtils::fillClippedSpan(sink_, x1, y, x2, color);
+                });
+    }
+
+    void drawEmpty(const Point &p1, const Point &p2, const Point &p3, const RgbColor &color) {
+        linePainter_.drawLine(UNSIGNED_CAST(unsigned int, p1.x), UNSIGNED_CAST(unsigned int, p1.y), UNSIGNED_CAST(unsigned int, p2.x), UNSIGNED_CAST(unsigned int, p2.y), color);
+        linePainter_.drawLine(UNSIGNED_CAST(unsigned int, p2.x), UNSIGNED_CAST(unsigned int, p2.y), UNSIGNED_CAST(unsigned int, p3.x), UNSIGNED_CAST(unsigned int, p3.y), color);
+        linePainter_.drawLine(UNSIGNED_CAST(unsigned int, p3.x), UNSIGNED_CAST(unsigned int, p3.y), UNSIGNED_CAST(unsigned int, p1.x), UNSIGNED_CAST(unsigned int, p1.y), color);
+    }
+
+private:
+    PixelSink &sink_;
+    LinePainterForSink<PixelSink> linePainter_;
+    TriangleRasterizer rasterizer_;
+};
+
+// Fills triangles and indexed triangle meshes with TriangleRasterizer (pixel centers, top-left rule), so
+// triangles of a mesh sharing an edge paint every pixel once, without gaps. Colors are flat or interpolated
+// linearly from per-vertex colors (Gouraud shading). Flat triangles are painted with fillSpan(), interpolated
+// ones with copySpan() - sink needs copySpan(x, y, length, colors) for them (see RgbImagePixelSink / PixelPainter).
+// Vertices of a mesh are converted to fixed point once per call, however many triangles share them.
+template<typename PixelSink>
+class TriangleMeshPainterForSink {
+public:
+    TriangleMeshPainterForSink(PixelSink &sink) : sink_(sink), rasterizer_(TriangleRasterizer::PIXEL_CENTERS) {}
+
+    // pixels outside of canvas of a given size are skipped
+    TriangleMeshPainterForSink(PixelSink &sink, const Point &canvasSize)
+            : sink_(sink), rasterizer_(TriangleRasterizer::PIXEL_CENTERS, canvasSize) {}
+
+    void drawTriangle(const PointF &p1, const PointF &p2, const PointF &p3, const RgbColor &color) {
+        fillFlat(TriangleRasterizer::toFixed(p1), TriangleRasterizer::toFixed(p2), TriangleRasterizer::toFixed(p3), color);
+    }
+
+    void drawTriangle(const PointF &p1, const PointF &p2, const PointF &p3, const RgbColor &color1,
+                      const RgbColor &color2, const RgbColor &color3) {
+        fillShaded(TriangleRasterizer::toFixed(p1), TriangleRasterizer::toFixed(p2), TriangleRasterizer::toFixed(p3),
+                   color1, color2, color3);
+    }
+
+    // triangle i has vertices vertices[indices[3 * i]], vertices[indices[3 * i + 1]] and vertices[indices[3 * i + 2]]
+    void drawMesh(const std::vector<PointF> &vertices, const std::vector<unsigned int> &indices, const RgbColor &color) {
+        prepareMesh(vertices, indices);
+        for (size_t i = 0; i < indices.size(); i += 3)
+            fillFlat(fixed_[indices[i]], fixed_[indices[i + 1]], fixed_[indices[i + 2]], color);
+    }
+
+    // colors are given per vertex and interpolated over triangles
+    void drawMesh(const std::vector<PointF> &vertices, const std::vector<RgbColor> &colors,
+                  const std::vector<unsigned int> &indices) {
+        if (colors.size() != vertices.size())
+            throw std::invalid_argument("TriangleMeshPainter: number of colors differs from number of vertices");
+        prepareMesh(vertices, indices);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            unsigned int i1 = indices[i], i2 = indices[i + 1], i3 = indices[i + 2];
+            fillShaded(fixed_[i1], fixed_[i2], fixed_[i3], colors[i1], colors[i2], colors[i3]);
+        }
+    }
+
+private:
+    using Vertex = TriangleRasterizer::Vertex;
+
+    void prepareMesh(const std::vector<PointF> &vertices, const std::vector<unsigned int> &indices) {
+        if (indices.size() % 3 != 0)
+            throw std::invalid_argument("TriangleMeshPainter: number of indices is not a multiple of 3");
+        for (unsigned int index : indices)
+            if (index >= vertices.size())
+                throw std::out_of_range("TriangleMeshPainter: vertex index out of range");
+
+        fixed_.clear();
+        fixed_.reserve(vertices.size());
+        for (const PointF &vertex : vertices)
+            fixed_.push_back(TriangleRasterizer::toFixed(vertex));
+    }
+
+    void fillFlat(const Vertex &v1, const Vertex &v2, const Vertex &v3, const RgbColor &color) {
+        rasterizer_.rasterize(v1, v2, v3, [this, &color](int y, int x1, int x2) {
+            sink_.fillSpan(UNSIGNED_CAST(unsigned int, x1), UNSIGNED_CAST(unsigned int, y),
+                           UNSIGNED_CAST(unsigned int, x2 - x1 + 1), color);
+        });
+    }
+
+    void fillShaded(const Vertex &v1, const Vertex &v2, const Vertex &v3, const RgbColor &color1,
+                    const RgbColor &color2, const RgbColor &color3) {
+        if (color1 == color2 && color1 == color3) {
+            fillFlat(v1, v2, v3, color1);
+            return;
+        }
+
+        // every channel is a plane value(x, y) = base + dx * x + dy * y over samples of pixels
+        double scale = 1.0 / (1 << TriangleRasterizer::SUBPIXEL_BITS);
+        double x1 = static_cast<double>(v1.x) * scale, y1 = static_cast<double>(v1.y) * scale;
+        double ux = static_cast<double>(v2.x) * scale - x1, uy = static_cast<double>(v2.y) * scale - y1;
+        double wx = static_cast<double>(v3.x) * scale - x1, wy = static_cast<double>(v3.y) * scale - y1;
+        double determinant = ux * wy - uy * wx;
+        if (determinant == 0.0)
+            return;
+        double sample = static_cast<double>(rasterizer_.sampleOffset()) * scale;
+        const unsigned char channels[3][3] = {{color1.red, color2.red, color3.red},
+                                              {color1.green, color2.green, color3.green},
+                                              {color1.blue, color2.blue, color3.blue}};
+        float base[3], dx[3], dy[3];
+        for (int k = 0; k < 3; ++k) {
+            double du = channels[k][1] - channels[k][0], dw = channels[k][2] - channels[k][0];
+            double gx = (du * wy - dw * uy) / determinant, gy = (dw * ux - du * wx) / determinant;
+            // value at sample of pixel (0, 0)
+            base[k] = static_cast<float>(channels[k][0] + gx * (sample - x1) + gy * (sample - y1));
+            dx[k] = static_cast<float>(gx);
+            dy[k] = static_cast<float>(gy);
+        }
+
+        rasterizer_.rasterize(v1, v2, v3, [&](int y, int first, int last) {
+            size_t length = static_cast<size_t>(last - first + 1);
+            colors_.resize(length);
+            float rowStart[3];
+            for (int k = 0; k < 3; ++k)
+                rowStart[k] = base[k] + dy[k] * static_cast<float>(y) + dx[k] * static_cast<float>(first);
+            for (size_t i = 0; i < length; ++i) {
+                float offset = static_cast<float>(i);
+                colors_[i] = RgbColor{channelValue(rowStart[0] + dx[0] * offset),
+                                      channelValue(rowStart[1] + dx[1] * offset),
+                                      channelValue(rowStart[2] + dx[2] * offset)};
+            }
+            sink_.copySpan(UNSIGNED_CAST(unsigned int, first), UNSIGNED_CAST(unsigned int, y),
+                           static_cast<unsigned int>(length), colors_.data());
+        });
+    }
+
+    // samples at triangle edges may extrapolate slightly past vertex colors
+    static unsigned char channelValue(float value) {
+        return static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, value)) + 0.5f);
+    }
+
+    PixelSink &sink_;
+    TriangleRasterizer rasterizer_;
+    std::vector<Vertex> fixed_;
+    std::vector<RgbColor> colors_;
+};
+
+
+// Scanline polygon filler with active edge table.
+// Edges are sorted by first row they cross; for every row the active edges (those crossing the row's pixel centers)
+// are updated, sorted by x and walked left to right with even-odd or non-zero winding rule, and every inside
+// interval is emitted as one span. Cost is proportional to number of edges and rows, not to bounding box area.
+// Works for any number of contours (holes, overlapping and self-intersecting contours); contours are closed
+// implicitly. Pixel coverage follows PolygonPainter: pixel is filled when its center is inside.
+template<typename PixelSink>
+class PolygonPainterForSink {
+public:
+    using FillRule = PolygonPainter::FillRule;
+
+    PolygonPainterForSink(PixelSink &sink) : sink_(sink), linePainter_(sink), clipMax_(INT_MAX, INT_MAX) {}
+
+    // rows and columns outside of canvas of a given size are skipped
+    PolygonPainterForSink(PixelSink &sink, const Point &canvasSize) : sink_(sink), linePainter_(sink, canvasSize),
+                                                                      clipMax_(canvasSize.x - 1, canvasSize.y - 1) {}
+
+    template<typename PointType>
+    void drawFull(const std::vector<PointType> &points, const RgbColor &color, FillRule rule = PolygonPainter::NON_ZERO) {
+        edges_.clear();
+        addContour(points);
+        fillEdges(color, rule);
+    }
+
+    template<typename PointType>
+    void drawFull(const std::vector<std::vector<PointType>> &contours, const RgbColor &color,
+                  FillRule rule = PolygonPainter::NON_ZERO) {
+        edges_.clear();
+        for (const std::vector<PointType> &contour : contours)
+            addContour(contour);
+        fillEdges(color, rule);
+    }
+
+    void drawEmpty(const std::vector<Point> &points, const RgbColor &color) {
+        for (size_t i = 0, count = points.size(); i < count; ++i) {
+            const Point &p1 = points[i];
+            const Point &p2 = points[(i + 1) % count];
+            linePainter_.drawLine(UNSIGNED_CAST(unsigned int, p1.x), UNSIGNED_CAST(unsigned int, p1.y),
+                                  UNSIGNED_CAST(unsigned int, p2.x), UNSIGNED_CAST(unsigned int, p2.y), color);
+        }
+    }
+
+    // Calls spanFunction(x1, y, x2) for every inside run of pixels x1..x2 (inclusive) of polygon given by contours,
+    // runs are clipped to canvas (and to non-negative coordinates); rows are visited from top to bottom.
+    template<typename PointType, typename SpanFunction>
+    void scan(const std::vector<std::vector<PointType>> &contours, FillRule rule, SpanFunction spanFunction) {
+        edges_.clear();
+        for (const std::vector<PointType> &contour : contours)
+            addContour(contour);
+        scanEdges(rule, spanFunction);
+    }
+
+private:
+    struct Edge {
+        int firstRow;  // first row whose pixel center is crossed
+        int lastRow;   // last such row (inclusive)
+        double x0;     // x at y0
+        double y0;
+        double slope;  // dx / dy
+        int winding;   // +1 for downward edge, -1 for upward one
+        double x;      // x at center of current row
+    };
+
+    template<typename PointType>
+    void addContour(const std::vector<PointType> &points) {
+        for (size_t i = 0, count = points.size(); i < count; ++i)
+            addEdge(points[i], points[(i + 1) % count]);
+    }
+
+    template<typename PointType>
+    void addEdge(const PointType &from, const PointType &to) {
+        double x1 = static_cast<double>(from.x), y1 = static_cast<double>(from.y);
+        double x2 = static_cast<double>(to.x), y2 = static_cast<double>(to.y);
+        int winding = 1;
+        if (y2 < y1) {
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+            winding = -1;
+        }
+        // edge covers centers y + 0.5 in [y1, y2)
+        double first = std::ceil(y1 - 0.5);
+        double last = std::ceil(y2 - 0.5) - 1;
+        if (last < first || last < 0 || first > static_cast<double>(clipMax_.y))
+            return;
+
+        Edge edge;
+        edge.firstRow = static_cast<int>(std::max(first, 0.0));
+        edge.lastRow = static_cast<int>(std::min(last, static_cast<double>(clipMax_.y)));
+        edge.x0 = x1;
+        edge.y0 = y1;
+        edge.slope = (x2 - x1) / (y2 - y1);
+        edge.winding = winding;
+        edge.x = 0;
+        edges_.push_back(edge);
+    }
+
+    void fillEdges(const RgbColor &color, FillRule rule) {
+        scanEdges(rule, [this, &color](int x1, int y, int x2) { sink_.fillSpan(
+                UNSIGNED_CAST(unsigned int, x1), UNSIGNED_CAST(unsigned int, y), UNSIGNED_CAST(unsigned int, x2 - x1 + 1), color); });
+    }
+
+    template<typename SpanFunction>
+    void scanEdges(FillRule rule, SpanFunction spanFunction) {
+        if (edges_.empty())
+            return;
+        std::sort(edges_.begin(), edges_.end(), [](const Edge &a, const Edge &b) { return a.firstRow < b.firstRow; });
+
+        active_.clear();
+        size_t nextEdge = 0;
+        int y = edges_[0].firstRow;
+        while (nextEdge < edges_.size() || !active_.empty()) {
+            if (active_.empty())
+                y = std::max(y, edges_[nextEdge].firstRow);
+            while (nextEdge < edges_.size() && edges_[nextEdge].firstRow == y)
+                active_.push_back(&edges_[nextEdge++]);
+
+            double center = y + 0.5;
+            for (Edge *edge : active_)
+                edge->x = edge->x0 + (center - edge->y0) * edge->slope;
+            // insertion sort - order changes little between rows
+            for (size_t i = 1; i < active_.size(); ++i) {
+                Edge *edge = active_[i];
+                size_t j = i;
+                for (; j > 0 && active_[j - 1]->x > edge->x; --j)
+                    active_[j] = active_[j - 1];
+                active_[j] = edge;
+            }
+
+            emitRow(y, rule, spanFunction);
+
+            active_.erase(std::remove_if(active_.begin(), active_.end(), [y](const Edge *edge) {
+                return edge->lastRow <= y;
+            }), active_.end());
+            ++y;
+        }
+    }
+
+    // walks crossings of row y, adjacent inside intervals are joined into one span
+    template<typename SpanFunction>
+    void emitRow(int y, FillRule rule, SpanFunction &spanFunction) {
+        int winding = 0;
+        int spanStart = 0, spanEnd = -1;
+        bool hasSpan = false;
+        for (size_t i = 0; i + 1 < active_.size(); ++i) {
+            winding += rule == PolygonPainter::NON_ZERO ? active_[i]->winding : 1;
+            bool inside = rule == PolygonPainter::NON_ZERO ? winding != 0 : (winding & 1) != 0;
+            if (!inside)
+                continue;
+
+            // pixels with centers in [x1, x2)
+            double x1 = std::ceil(active_[i]->x - 0.5);
+            double x2 = std::ceil(active_[i + 1]->x - 0.5) - 1;
+            x1 = std::max(x1, 0.0);
+            x2 = std::min(x2, static_cast<double>(clipMax_.x));
+            if (x2 < x1)
+                continue;
+
+            int start = static_cast<int>(x1), end = static_cast<int>(x2);
+            if (hasSpan && start <= spanEnd + 1) {
+                spanEnd = std::max(spanEnd, end);
+                continue;
+            }
+            if (hasSpan)
+                spanFunction(spanStart, y, spanEnd);
+            spanStart = start;
+            spanEnd = end;
+            hasSpan = true;
+        }
+        if (hasSpan)
+            spanFunction(spanStart, y, spanEnd);
+    }
+
+    PixelSink &sink_;
+    LinePainterForSink<PixelSink> linePainter_;
+    Point clipMax_;
+    std::vector<Edge> edges_;
+    std::vector<Edge *> active_;
+};
+
+
+// Anti-aliased polygon filler with analytic coverage (signed area accumulation, as in libart / font-rs).
+// Every edge deposits, for each row it crosses, the signed area it covers into cells of a one-row accumulation
+// buffer; a prefix sum over the row turns these deposits into exact coverage of each pixel by the polygon.
+// Fully covered runs are painted with fillSpan, partially covered ones with blendSpan (coverage 0-255), so
+// quality equals very high supersampling at roughly the cost of the aliased fill and without supersample buffer.
+// Non-zero rule clamps absolute winding to one, even-odd folds it (overlapping contours are not exact at their
+// antialiased boundaries). Geometry follows PolygonPainter: pixel (x, y) is the square [x, x + 1) x [y, y + 1).
+// Sink needs fillSpan() and blendSpan() (see RgbImagePixelSink / PixelPainter).
+template<typename PixelSink>
+class AntiAliasedPolygonPainterForSink {
+public:
+    using FillRule = PolygonPainter::FillRule;
+
+    AntiAliasedPolygonPainterForSink(PixelSink &sink) : sink_(sink), clipMax_(INT_MAX, INT_MAX) {}
+
+    // pixels outside of canvas of a given size are skipped
+    AntiAliasedPolygonPainterForSink(PixelSink &sink, const Point &canvasSize)
+            : sink_(sink), clipMax_(canvasSize.x - 1, canvasSize.y - 1) {}
+
+    template<typename PointType>
+    void drawFull(const std::vector<PointType> &points, const RgbColor &color, FillRule rule = PolygonPainter::NON_ZERO) {
+        beginPath();
+        addContour(points);
+        fillPath(color, rule);
+    }
+
+    template<typename PointType>
+    void drawFull(const std::vector<std::vector<PointType>> &contours, const RgbColor &color,
+                  FillRule rule = PolygonPainter::NON_ZERO) {
+        beginPath();
+        for (const std::vector<PointType> &contour : contours)
+            addContour(contour);
+        fillPath(color, rule);
+    }
+
+    // line of given width with butt ends, filled as a quad
+    void drawLine(const PointF &p1, const PointF &p2, float width, const RgbColor &color) {
+        float dx = p2.x - p1.x, dy = p2.y - p1.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length <= 0.0f)
+            return;
+        float nx = -dy / length * width * 0.5f, ny = dx / length * width * 0.5f;
+        std::vector<PointF> quad = {PointF(p1.x + nx, p1.y + ny), PointF(p2.x + nx, p2.y + ny),
+                                    PointF(p2.x - nx, p2.y - ny), PointF(p1.x - nx, p1.y - ny)};
+        drawFull(quad, color);
+    }
+
+private:
+    // run of pixels waiting to be painted
+    struct Run {
+        enum Kind {
+            NONE,
+            FILL,
+            BLEND
+        };
+
+        int kind = NONE;
+        size_t start = 0;
+        size_t end = 0;
+    };
+
+    // part of edge inside of canvas columns, y1 < y2
+    struct Edge {
+        float x1, y1, x2, y2;
+        float slope;     // dx / dy
+        float direction; // +1 for downward edge, -1 for upward one
+    };
+
+    void beginPath() {
+        edges_.clear();
+        maxX_ = 0.0f;
+    }
+
+    template<typename PointType>
+    void addContour(const std::vector<PointType> &points) {
+        for (size_t i = 0, count = points.size(); i < count; ++i) {
+            const PointType &from = points[i];
+            const PointType &to = points[(i + 1) % count];
+            addEdge(static_cast<float>(from.x), static_cast<float>(from.y), static_cast<float>(to.x),
+                    static_cast<float>(to.y));
+        }
+    }
+
+    void addEdge(float x1, float y1, float x2, float y2) {
+        if (y1 == y2 || (y1 < 0.0f && y2 < 0.0f) || std::isnan(x1) || std::isnan(x2))
+            return;
+        maxX_ = std::max(maxX_, std::max(x1, x2));
+
+        // parts of edge left of canvas (or right of it) are moved onto its border, where they still change winding
+        // of all pixels to the right; edge is split where it crosses the border, so its covered area stays exact
+        float right = static_cast<float>(clipMax_.x) + 1.0f;
+        float splits[4] = {0.0f, 1.0f, 1.0f, 1.0f};
+        size_t count = 1;
+        if (x1 != x2) {
+            for (float border : {0.0f, right}) {
+                float t = (border - x1) / (x2 - x1);
+                if (t > 0.0f && t < 1.0f)
+                    splits[count++] = t;
+            }
+        }
+        splits[count++] = 1.0f;
+        if (count == 4 && splits[1] > splits[2])
+            std::swap(splits[1], splits[2]);
+
+        for (size_t i = 0; i + 1 < count; ++i) {
+            float ya = y1 + (y2 - y1) * splits[i], yb = y1 + (y2 - y1) * splits[i + 1];
+            float xa = std::min(std::max(x1 + (x2 - x1) * splits[i], 0.0f), right);
+            float xb = std::min(std::max(x1 + (x2 - x1) * splits[i + 1], 0.0f), right);
+            if (ya == yb)
+                continue;
+            Edge edge;
+            edge.direction = ya < yb ? 1.0f : -1.0f;
+            if (yb < ya) {
+                std::swap(xa, xb);
+                std::swap(ya, yb);
+            }
+            edge.x1 = xa;
+            edge.y1 = ya;
+            edge.x2 = xb;
+            edge.y2 = yb;
+            edge.slope = (xb - xa) / (yb - ya);
+            edges_.push_back(edge);
+        }
+    }
+
+    void fillPath(const RgbColor &color, FillRule rule) {
+        if (edges_.empty() || maxX_ < 0.0f)
+            return;
+        std::sort(edges_.begin(), edges_.end(), [](const Edge &a, const Edge &b) { return a.y1 < b.y1; });
+
+        // columns 0..width-1 are painted, two more cells take deposits of edges on the right border
+        int width = static_cast<int>(std::min(static_cast<float>(clipMax_.x) + 1.0f, std::ceil(maxX_) + 1.0f));
+        if (width <= 0)
+            return;
+        accumulation_.assign(static_cast<size_t>(width) + 2, 0.0f);
+        coverage_.resize(static_cast<size_t>(width));
+
+        active_.clear();
+        size_t nextEdge = 0;
+        int y = std::max(0, static_cast<int>(std::floor(edges_[0].y1)));
+        while ((nextEdge < edges_.size() || !active_.empty()) && y <= clipMax_.y) {
+            if (active_.empty())
+                y = std::max(y, static_cast<int>(std::floor(edges_[nextEdge].y1)));
+            float rowBottom = static_cast<float>(y) + 1.0f;
+            while (nextEdge < edges_.size() && edges_[nextEdge].y1 < rowBottom)
+                active_.push_back(&edges_[nextEdge++]);
+
+            for (const Edge *edge : active_)
+                depositRow(*edge, static_cast<float>(y));
+            if (!touched_.empty())
+                resolveRow(y, width, color, rule);
+
+            active_.erase(std::remove_if(active_.begin(), active_.end(), [rowBottom](const Edge *edge) {
+                return edge->y2 <= rowBottom;
+            }), active_.end());
+            ++y;
+        }
+    }
+
+    // adds signed area covered by part of edge inside of row y to accumulation cells
+    void depositRow(const Edge &edge, float y) {
+        float ya = std::max(edge.y1, y), yb = std::min(edge.y2, y + 1.0f);
+        if (yb <= ya)
+            return;
+        // edge end points are within [0, width], but x interpolated along edge can step out of it by rounding errors
+        float limit = static_cast<float>(accumulation_.size() - 2);
+        float xa = std::min(std::max(edge.x1 + (ya - edge.y1) * edge.slope, 0.0f), limit);
+        float xb = std::min(std::max(edge.x1 + (yb - edge.y1) * edge.slope, 0.0f), limit);
+        float d = (yb - ya) * edge.direction;
+
+        float x0 = std::min(xa, xb), x1 = std::max(xa, xb);
+        float x0floor = std::floor(x0);
+        float x1ceil = std::ceil(x1);
+        size_t x0i = static_cast<size_t>(x0floor);
+        size_t x1i = static_cast<size_t>(x1ceil);
+        float *cells = accumulation_.data();
+
+        if (x1i <= x0i + 1) {
+            // within one pixel: area right of edge is split between this cell and the next one
+            float xmf = 0.5f * (xa + xb) - x0floor;
+            cells[x0i] += d - d * xmf;
+            cells[x0i + 1] += d * xmf;
+            x1i = x0i + 1;
+        } else {
+            float s = 1.0f / (x1 - x0);
+            float x0f = x0 - x0floor;
+            float a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+            float x1f = x1 - x1ceil + 1.0f;
+            float am = 0.5f * s * x1f * x1f;
+            cells[x0i] += d * a0;
+            if (x1i == x0i + 2) {
+                cells[x0i + 1] += d * (1.0f - a0 - am);
+            } else {
+                float a1 = s * (1.5f - x0f);
+                cells[x0i + 1] += d * (a1 - a0);
+                for (size_t xi = x0i + 2; xi < x1i - 1; ++xi)
+                    cells[xi] += d * s;
+                float a2 = a1 + static_cast<float>(x1i - x0i - 3) * s;
+                cells[x1i - 1] += d * (1.0f - a2 - am);
+            }
+            cells[x1i] += d * am;
+        }
+        touched_.push_back(std::make_pair(x0i, x1i));
+    }
+
+    // Prefix sum of touched cells gives coverage. Cells between touched ranges (e.g. between left and right edge)
+    // have no deposits and keep coverage constant, so they are handled as one run without visiting them.
+    // Fully covered runs are filled, partially covered pixels are blended. Touched cells are cleared for next row.
+    void resolveRow(int y, int width, const RgbColor &color, FillRule rule) {
+        std::sort(touched_.begin(), touched_.end());
+        const float *cells = accumulation_.data();
+        size_t end = static_cast<size_t>(width);
+        pending_ = Run();
+        float sum = 0.0f;
+
+        size_t x = touched_.front().first;
+        for (size_t i = 0; i < touched_.size() && x < end; ++i) {
+            size_t first = std::max(x, touched_[i].first);
+            if (first > x)
+                emitRun(y, x, std::min(first, end), coverageValue(sum, rule), color);
+            size_t last = std::min(touched_[i].second + 1, end);
+            for (x = first; x < last; ++x) {
+                sum += cells[x];
+                emitRun(y, x, x + 1, coverageValue(sum, rule), color);
+            }
+            x = std::max(x, first);
+        }
+        emitRun(y, end, end, 0, color);
+
+        for (const std::pair<size_t, size_t> &range : touched_)
+            std::fill(accumulation_.begin() + static_cast<std::ptrdiff_t>(range.first),
+                      accumulation_.begin() + static_cast<std::ptrdiff_t>(range.second + 1), 0.0f);
+        touched_.clear();
+    }
+
+    // pixels x..next-1 of row y have equal coverage; joins them with previous run of the same kind
+    void emitRun(int y, size_t x, size_t next, unsigned char value, const RgbColor &color) {
+        int kind = value == 255 ? Run::FILL : (value == 0 ? Run::NONE : Run::BLEND);
+        if (kind == Run::BLEND)
+            std::fill(coverage_.begin() + static_cast<std::ptrdiff_t>(x),
+                      coverage_.begin() + static_cast<std::ptrdiff_t>(next), value);
+        if (kind == pending_.kind && pending_.end == x) {
+            pending_.end = next;
+            return;
+        }
+
+        unsigned int row = static_cast<unsigned int>(y);
+        unsigned int start = static_cast<unsigned int>(pending_.start);
+        unsigned int length = static_cast<unsigned int>(pending_.end - pending_.start);
+        if (pending_.kind == Run::FILL)
+            sink_.fillSpan(start, row, length, color);
+        else if (pending_.kind == Run::BLEND)
+            sink_.blendSpan(start, row, length, color, coverage_.data() + pending_.start);
+        pending_.kind = kind;
+        pending_.start = x;
+        pending_.end = next;
+    }
+
+    // accumulated winding to coverage 0-255
+    static unsigned char coverageValue(float winding, FillRule rule) {
+        float value = std::fabs(winding);
+        if (rule == PolygonPainter::EVEN_ODD) {
+            value = std::fmod(value, 2.0f);
+            value = value > 1.0f ? 2.0f - value : value;
+        } else {
+            value = std::min(value, 1.0f);
+        }
+        return static_cast<unsigned char>(value * 255.0f + 0.5f);
+    }
+
+    PixelSink &sink_;
+    Point clipMax_;
+    std::vector<Edge> edges_;
+    std::vector<const Edge *> active_;
+    std::vector<float> accumulation_;
+    std::vector<unsigned char> coverage_;
+    std::vector<std::pair<size_t, size_t>> touched_; // ranges of cells with deposits in current row (inclusive)
+    Run pending_;
+    float maxX_ = 0.0f;
+};
+
+// Anti-aliased circles, ellipses, rings, arcs and pie slices with sub-pixel centers and radii. Shapes are turned into
+// polygons (chords deviate from curves by at most 0.05 pixel) and filled by AntiAliasedPolygonPainterForSink, so rows
+// inside are emitted as spans and only pixels on the edges are blended. Angles are the same as in CirclePainterForSink.
+template<typename PixelSink>
+class AntiAliasedCirclePainterForSink {
+public:
+    AntiAliasedCirclePainterForSink(PixelSink &sink) : painter_(sink) {}
+
+    // pixels outside of canvas of a given size are skipped
+    AntiAliasedCirclePainterForSink(PixelSink &sink, const Point &canvasSize) : painter_(sink, canvasSize) {}
+
+    void drawFull(const PointF &center, float r, const RgbColor &color) {
+        drawEllipse(center, r, r, color);
+    }
+
+    void drawEllipse(const PointF &center, float rx, float ry, const RgbColor &color) {
+        beginContours(1);
+        addArc(center, rx, ry, 0.0, 2.0 * PI, contours_[0]);
+        painter_.drawFull(contours_, color);
+    }
+
+    void drawRing(const PointF &center, float outerR, float innerR, const RgbColor &color) {
+        if (innerR <= 0.0f) {
+            drawFull(center, outerR, color);
+            return;
+        }
+        // inner circle goes the other way round, so it is a hole with non-zero rule
+        beginContours(2);
+        addArc(center, outerR, outerR, 0.0, 2.0 * PI, contours_[0]);
+        addArc(center, innerR, innerR, 2.0 * PI, 0.0, contours_[1]);
+        painter_.drawFull(contours_, color);
+    }
+
+    // part of ring between startAngle and endAngle
+    void drawArc(const PointF &center, float outerR, float innerR, double startAngle, double endAngle,
+                 const RgbColor &color) {
+        if (!(endAngle > startAngle))
+            return;
+        if (endAngle - startAngle >= 2.0 * PI) {
+            drawRing(center, outerR, innerR, color);
+            return;
+        }
+        beginContours(1);
+        addArc(center, outerR, outerR, startAngle, endAngle, contours_[0]);
+        if (innerR > 0.0f)
+            addArc(center, innerR, innerR, endAngle, startAngle, contours_[0]);
+        else
+            contours_[0].push_back(center);
+        painter_.drawFull(contours_, color);
+    }
+
+    void drawPie(const PointF &center, float r, double startAngle, double endAngle, const RgbColor &color) {
+        drawArc(center, r, 0.0f, startAngle, endAngle, color);
+    }
+
+private:
+    static constexpr double PI = 3.14159265358979323846;
+    static constexpr double TOLERANCE = 0.05;
+
+    // clears contours, keeping their memory
+    void beginContours(size_t count) {
+        contours_.resize(count);
+        for (std::vector<PointF> &contour : contours_)
+            contour.clear();
+    }
+
+    // points of elliptic arc from start to end angle, both included; vertices are moved slightly outwards, so that
+    // every triangle fan segment has the same area as the sector of ellipse it replaces
+    static void addArc(const PointF &center, float rx, float ry, double start, double end, std::vector<PointF> &points) {
+        double radius = std::max(rx, ry);
+        double maxStep = radius > TOLERANCE ? 2.0 * std::acos(1.0 - TOLERANCE / radius) : PI / 2.0;
+        int steps = std::max(1, static_cast<int>(std::ceil(std::fabs(end - start) / maxStep)));
+        double step = std::fabs(end - start) / steps;
+        double scale = step > 0.0 ? std::sqrt(step / std::sin(step)) : 1.0;
+        for (int i = 0; i <= steps; ++i) {
+            double angle = start + (end - start) * i / steps;
+            points.push_back(PointF(center.x + static_cast<float>(scale * rx * std::cos(angle)),
+                                    center.y + static_cast<float>(scale * ry * std::sin(angle))));
+        }
+    }
+
+    AntiAliasedPolygonPainterForSink<PixelSink> painter_;
+    std::vector<std::vector<PointF>> contours_;
+};
+
+// Strokes polylines with Stroker and fills the whole outline once - with PolygonPainterForSink, or with
+// AntiAliasedPolygonPainterForSink when antiAliased is set. Sink needs fillSpan() and blendSpan().
+template<typename PixelSink>
+class StrokePainterForSink {
+public:
+    StrokePainterForSink(PixelSink &sink, const StrokeStyle &style, bool antiAliased = false)
+            : stroker_(style), antiAliased_(antiAliased), polygonPainter_(sink), antiAliasedPainter_(sink) {}
+
+    // pixels outside of canvas of a given size are skipped
+    StrokePainterForSink(PixelSink &sink, const Point &canvasSize, const StrokeStyle &style, bool antiAliased = false)
+            : stroker_(style), antiAliased_(antiAliased), polygonPainter_(sink, canvasSize),
+              antiAliasedPainter_(sink, canvasSize) {}
+
+    void drawPolyline(const std::vector<PointF> &points, const RgbColor &color, bool closed = false) {
+        outline_.clear();
+        stroker_.stroke(points, closed, outline_);
+        if (outline_.empty())
+            return;
+        if (antiAliased_)
+            antiAliasedPainter_.drawFull(outline_, color, PolygonPainter::NON_ZERO);
+        else
+            polygonPainter_.drawFull(outline_, color, PolygonPainter::NON_ZERO);
+    }
+
+    void drawLine(const PointF &p1, const PointF &p2, const RgbColor &color) {
+        drawPolyline({p1, p2}, color);
+    }
+
+    const StrokeStyle &style() const {
+        return stroker_.style();
+    }
+
+private:
+    Stroker stroker_;
+    bool antiAliased_;
+    PolygonPainterForSink<PixelSink> polygonPainter_;
+    AntiAliasedPolygonPainterForSink<PixelSink> antiAliasedPainter_;
+    std::vector<std::vector<PointF>> outline_;
+};
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef __UIMG_STROKER_H__
+#define __UIMG_STROKER_H__
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "uimg/base/structs.h"
+
+struct StrokeStyle {
+    enum LineJoin {
+        MITER_JOIN, // sharp corner, bevel when longer than miterLimit * width
+        ROUND_JOIN,
+        BEVEL_JOIN
+    };
+
+    enum LineCap {
+        BUTT_CAP,   // ends exactly at end points
+        ROUND_CAP,
+        SQUARE_CAP  // extends half of width past end points
+    };
+
+    float width = 1.0f;
+    LineJoin join = MITER_JOIN;
+    LineCap cap = BUTT_CAP;
+    float miterLimit = 4.0f;
+    std::vector<float> dashes; // lengths of dashes and gaps (alternating, in pixels), empty for solid line
+    float dashOffset = 0.0f;   // distance into dash pattern at the start of polyline
+};
+
+// Turns polyline into outline contours of its stroke, which are filled in one pass with non-zero rule
+// (see PolygonPainter), so a polyline costs one scanline fill instead of painting every segment separately.
+// For open polyline the outline is a single contour: offset of the left side with joins, end cap, offset of the right
+// side backwards and start cap. Inner sides of joins go through the vertex, so the contour overlaps itself there but
+// winds around every covered point in the same direction - non-zero rule fills exactly union of segments, caps and
+// joins. Dashed polylines are split at dash boundaries first and every dash is stroked as an open polyline.
+class Stroker {
+public:
+    explicit Stroker(const StrokeStyle &style) : style_(style) {
+        float total = 0.0f;
+        for (float length : style.dashes) {
+            if (length < 0.0f)
+                throw std::invalid_argument("Stroker: dash length can't be negative");
+            total += length;
+        }
+        if (!style.dashes.empty() && total <= 0.0f)
+            throw std::invalid_argument("Stroker: dash pattern has zero length");
+    }
+
+    const StrokeStyle &style() const {
+        return style_;
+    }
+
+    // appends outline contours of stroke of polyline to contours
+    void stroke(const std::vector<PointF> &points, bool closed, std::vector<std::vector<PointF>> &contours) const {
+        if (style_.width <= 0.0f)
+            return;
+        if (style_.dashes.empty()) {
+            strokeSolid(points, closed, contours);
+            return;
+        }
+
+        std::vector<std::vector<PointF>> pieces;
+        dash(points, closed, style_.dashes, style_.dashOffset, pieces);
+        for (const std::vector<PointF> &piece : pieces)
+            strokeSolid(piece, false, contours);
+    }
+
+    // splits polyline into dashes (open polylines), pattern alternates lengths of dashes and gaps;
+    // zero length dashes give single-point pieces (dots for round and square caps)
+    static void dash(const std::vector<PointF> &points, bool closed, const std::vector<float> &pattern, float offset,
+                     std::vector<std::vector<PointF>> &dashes) {
+        float total = 0.0f;
+        for (float length : pattern)
+            total += length;
+        if (points.empty() || !(total > 0.0f))
+            return;
+
+        size_t index = 0;
+        float phase = std::fmod(offset, total);
+        if (phase < 0.0f)
+            phase += total;
+        // zero length dash at the very start is kept
+        while (phase > pattern[index] || (phase == pattern[index] && pattern[index] > 0.0f)) {
+            phase -= pattern[index];
+            index = (index + 1) % pattern.size();
+        }
+        float remaining = pattern[index] - phase;
+        bool on = index % 2 == 0;
+
+        std::vector<PointF> current;
+        if (on)
+            current.push_back(points[0]);
+
+        size_t segments = closed ? points.size() : points.size() - 1;
+        for (size_t i = 0; i < segments; ++i) {
+            const PointF &a = points[i];
+            const PointF &b = points[(i + 1) % points.size()];
+            float length = distance(a, b);
+            float position = 0.0f;
+            while (length - position > remaining) {
+                position += remaining;
+                float t = position / length;
+                // split point ends current dash or starts the next one
+                current.push_back(PointF(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t));
+                if (on) {
+                    dashes.push_back(current);
+                    current.clear();
+                }
+                on = !on;
+                index = (index + 1) % pattern.size();
+                remaining = pattern[index];
+            }
+            remaining -= length - position;
+            if (on)
+                current.push_back(b);
+        }
+        if (on && !current.empty())
+            dashes.push_back(current);
+    }
+
+private:
+    void strokeSolid(const std::vector<PointF> &points, bool closed, std::vector<std::vector<PointF>> &contours) const {
+        std::vector<PointF> path;
+        path.reserve(points.size());
+        for (const PointF &point : points)
+            if (path.empty() || distance(path.back(), point) > EPSILON)
+                path.push_back(point);
+        if (closed && path.size() > 2 && distance(path.front(), path.back()) <= EPSILON)
+            path.pop_back();
+        if (path.empty())
+            return;
+
+        float halfWidth = style_.width * 0.5f;
+        if (path.size() == 1) {
+            addDot(path[0], halfWidth, contours);
+            return;
+        }
+
+        size_t count = path.size();
+        if (closed && count > 2) {
+            contours.emplace_back();
+            for (size_t i = 0; i < count; ++i)
+                addJoin(path[(i + count - 1) % count], path[i], path[(i + 1) % count], halfWidth, contours.back());
+            contours.emplace_back();
+            for (size_t i = count; i-- > 0;)
+                addJoin(path[(i + 1) % count], path[i], path[(i + count - 1) % count], halfWidth, contours.back());
+            return;
+        }
+
+        contours.emplace_back();
+        std::vector<PointF> &outline = contours.back();
+        addSide(path, false, halfWidth, outline);
+        addCap(path[count - 2], path[count - 1], halfWidth, outline);
+        addSide(path, true, halfWidth, outline);
+        addCap(path[1], path[0], halfWidth, outline);
+    }
+
+    // left offset of polyline (in given direction) with joins, from first to last point
+    void addSide(const std::vector<PointF> &path, bool backwards, float halfWidth, std::vector<PointF> &outline) const {
+        size_t count = path.size();
+        auto at = [&path, count, backwards](size_t i) -> const PointF & {
+            return path[backwards ? count - 1 - i : i];
+        };
+
+        PointF normal = unitNormal(at(0), at(1));
+        outline.push_back(offset(at(0), normal, halfWidth));
+        for (size_t i = 1; i + 1 < count; ++i)
+            addJoin(at(i - 1), at(i), at(i + 1), halfWidth, outline);
+        normal = unitNormal(at(count - 2), at(count - 1));
+        outline.push_back(offset(at(count - 1), normal, halfWidth));
+    }
+
+    // left side of join at vertex between segments previous -> vertex and vertex -> next
+    void addJoin(const PointF &previous, const PointF &vertex, const PointF &next, float halfWidth,
+                 std::vector<PointF> &outline) const {
+        PointF n0 = unitNormal(previous, vertex);
+        PointF n1 = unitNormal(vertex, next);
+        float cross = n0.x * n1.y - n0.y * n1.x;
+        float dot = n0.x * n1.x + n0.y * n1.y;
+
+        outline.push_back(offset(vertex, n0, halfWidth));
+        if (cross > 0.0f) {
+            // inner side: through vertex, area between offsets is covered by both segments
+            outline.push_back(vertex);
+        } else if (style_.join == StrokeStyle::ROUND_JOIN) {
+            float sweep = std::atan2(cross, dot);
+            if (sweep > 0.0f)
+                sweep -= 2.0f * PI;
+            addArc(vertex, n0, halfWidth, sweep, outline);
+        } else if (style_.join == StrokeStyle::MITER_JOIN && 1.0f + dot > 2.0f / (style_.miterLimit * style_.miterLimit)) {
+            // miter length / width = 1 / cos(angle between normals / 2)
+            float scale = halfWidth / (1.0f + dot);
+            outline.push_back(PointF(vertex.x + (n0.x + n1.x) * scale, vertex.y + (n0.y + n1.y) * scale));
+        }
+        outline.push_back(offset(vertex, n1, halfWidth));
+    }
+
+    // cap at end point of segment from -> to, between its left and right offsets
+    void addCap(const PointF &from, const PointF &to, float halfWidth, std::vector<PointF> &outline) const {
+        PointF normal = unitNormal(from, to);
+        if (style_.cap == StrokeStyle::ROUND_CAP) {
+            addArc(to, normal, halfWidth, -PI, outline);
+        } else if (style_.cap == StrokeStyle::SQUARE_CAP) {
+            // direction is normal rotated by -90 degrees
+            PointF extension(normal.y * halfWidth, -normal.x * halfWidth);
+            outline.push_back(PointF(to.x + (normal.x * halfWidth + extension.x), to.y + (normal.y * halfWidth + extension.y)));
+            outline.push_back(PointF(to.x - (normal.x * halfWidth - extension.x), to.y - (normal.y * halfWidth - extension.y)));
+        }
+    }
+
+    // stroke of zero length: circle or square for round and square caps, nothing for butt cap
+    void addDot(const PointF &center, float halfWidth, std::vector<std::vector<PointF>> &contours) const {
+        if (style_.cap == StrokeStyle::ROUND_CAP) {
+            contours.emplace_back();
+            contours.back().push_back(PointF(center.x, center.y + halfWidth));
+            addArc(center, PointF(0.0f, 1.0f), halfWidth, -2.0f * PI, contours.back());
+        } else if (style_.cap == StrokeStyle::SQUARE_CAP) {
+            contours.push_back({PointF(center.x - halfWidth, center.y - halfWidth),
+                                PointF(center.x + halfWidth, center.y - halfWidth),
+                                PointF(center.x + halfWidth, center.y + halfWidth),
+                                PointF(center.x - halfWidth, center.y + halfWidth)});
+        }
+    }
+
+    // points of arc around center starting at center + radius * from (exclusive) and turning by sweep (exclusive end),
+    // segments deviate from circle by at most ARC_TOLERANCE pixels
+    static void addArc(const PointF &center, const PointF &from, float radius, float sweep, std::vector<PointF> &outline) {
+        float maxStep = radius > ARC_TOLERANCE ? 2.0f * std::acos(1.0f - ARC_TOLERANCE / radius) : PI / 2.0f;
+        int steps = static_cast<int>(std::ceil(std::fabs(sweep) / maxStep));
+        for (int i = 1; i < steps; ++i) {
+            float angle = sweep * static_cast<float>(i) / static_cast<float>(steps);
+            float c = std::cos(angle), s = std::sin(angle);
+            outline.push_back(PointF(center.x + (from.x * c - from.y * s) * radius,
+                                     center.y + (from.x * s + from.y * c) * radius));
+        }
+    }
+
+    static PointF unitNormal(const PointF &from, const PointF &to) {
+        float dx = to.x - from.x, dy = to.y - from.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        return PointF(-dy / length, dx / length);
+    }
+
+    static PointF offset(const PointF &point, const PointF &normal, float distance) {
+        return PointF(point.x + normal.x * distance, point.y + normal.y * distance);
+    }
+
+    static float distance(const PointF &a, const PointF &b) {
+        return std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+    }
+
+    static constexpr float PI = 3.14159265358979f;
+    static constexpr float EPSILON = 1e-4f;
+    static constexpr float ARC_TOLERANCE = 0.05f;
+
+    StrokeStyle style_;
+};
+
+#endif
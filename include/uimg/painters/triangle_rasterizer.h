@@ -0,0 +1,240 @@
+#ifndef __UIMG_TRIANGLE_RASTERIZER_H__
+#define __UIMG_TRIANGLE_RASTERIZER_H__
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "uimg/base/structs.h"
+
+// Half-space triangle rasterizer.
+// Triangle is intersection of three half-planes, each given by edge function E(x, y) = A * x + B * y + C which is
+// non-negative inside. Bounding box is walked in 8x8 pixel blocks: edge functions are evaluated at the block corners
+// only, so a block outside of any edge is skipped and a block inside all edges is accepted whole; only blocks crossed
+// by an edge are tested pixel by pixel, 8 pixels of a row at once (fixed length loops which compilers vectorize).
+// Every row of blocks is walked only between the leftmost and rightmost point of the triangle within that row, so
+// cost is proportional to the covered area plus the perimeter and thin slivers do not pay for their bounding box.
+// Triangle is convex, so every row is a single run - it is passed to emit(y, x1, x2) (inclusive).
+// Vertices are snapped to 1/256 of pixel and edge functions are exact 64-bit integers, vertex order does not matter.
+class TriangleRasterizer {
+public:
+    enum SampleRule {
+        // pixel (x, y) is square [x, x + 1) x [y, y + 1) filled when its center is inside (as in PolygonPainter);
+        // samples on an edge belong to the triangle only for top and left edges, so triangles sharing an edge
+        // cover every pixel along it exactly once
+        PIXEL_CENTERS,
+        // pixel (x, y) is point (x, y), points on edges belong to the triangle (TrianglePainter::drawFull)
+        PIXEL_CORNERS_INCLUSIVE
+    };
+
+    static const int SUBPIXEL_BITS = 8;
+    static const int BLOCK_SIZE = 8;
+
+    // vertex in fixed point, 1/256 of pixel
+    struct Vertex {
+        long long x;
+        long long y;
+    };
+
+    // coordinates are expected within +-2^22 pixels, so that edge functions fit into 64 bits
+    static Vertex toFixed(const PointF &point) {
+        const double scale = static_cast<double>(1 << SUBPIXEL_BITS);
+        return Vertex{std::llround(static_cast<double>(point.x) * scale), std::llround(static_cast<double>(point.y) * scale)};
+    }
+
+    static Vertex toFixed(const Point &point) {
+        return Vertex{static_cast<long long>(point.x) * (1 << SUBPIXEL_BITS),
+                      static_cast<long long>(point.y) * (1 << SUBPIXEL_BITS)};
+    }
+
+    explicit TriangleRasterizer(SampleRule rule = PIXEL_CENTERS) : rule_(rule), clipMax_(INT_MAX - BLOCK_SIZE, INT_MAX - BLOCK_SIZE) {}
+
+    // pixels outside of canvas of a given size are skipped
+    TriangleRasterizer(SampleRule rule, const Point &canvasSize) : rule_(rule),
+                                                                   clipMax_(canvasSize.x - 1, canvasSize.y - 1) {}
+
+    // position of sample of pixel (0, 0) in fixed point
+    long long sampleOffset() const {
+        return rule_ == PIXEL_CENTERS ? (1 << (SUBPIXEL_BITS - 1)) : 0;
+    }
+
+    template<typename EmitFunc>
+    void rasterize(const Vertex &a, const Vertex &b, const Vertex &c, EmitFunc emit) const {
+        long long area = cross(a, b, c);
+        if (area == 0 && rule_ == PIXEL_CENTERS)
+            return;
+        // orient so that edge functions are non-negative inside
+        const Vertex &v1 = area < 0 ? c : b;
+        const Vertex &v2 = area < 0 ? b : c;
+
+        Edge edges[3] = {makeEdge(a, v1), makeEdge(v1, v2), makeEdge(v2, a)};
+
+        long long offset = sampleOffset();
+        int minX = std::max(0, firstSample(std::min(a.x, std::min(b.x, c.x)) - offset));
+        int minY = std::max(0, firstSample(std::min(a.y, std::min(b.y, c.y)) - offset));
+        int maxX = std::min(clipMax_.x, lastSample(std::max(a.x, std::max(b.x, c.x)) - offset));
+        int maxY = std::min(clipMax_.y, lastSample(std::max(a.y, std::max(b.y, c.y)) - offset));
+        if (minX > maxX || minY > maxY)
+            return;
+
+        const long long step = 1LL << SUBPIXEL_BITS;
+        const long long last = BLOCK_SIZE - 1;
+        int runFirst[BLOCK_SIZE], runLast[BLOCK_SIZE];
+        const Vertex vertices[3] = {a, b, c};
+        for (int blockY = minY - minY % BLOCK_SIZE; blockY <= maxY; blockY += BLOCK_SIZE) {
+            long long top = std::max(minY, blockY) * step + offset;
+            long long bottom = std::min(maxY, blockY + BLOCK_SIZE - 1) * step + offset;
+            long long stripMinX, stripMaxX;
+            if (!stripExtent(vertices, top, bottom, stripMinX, stripMaxX))
+                continue;
+            // extent is rounded, one pixel of margin keeps it a superset of covered samples
+            int rowMinX = std::max(minX, firstSample(stripMinX - offset - step));
+            int rowMaxX = std::min(maxX, lastSample(stripMaxX - offset + step));
+            if (rowMinX > rowMaxX)
+                continue;
+            int blockMinX = rowMinX - rowMinX % BLOCK_SIZE;
+            for (int i = 0; i < BLOCK_SIZE; ++i) {
+                runFirst[i] = INT_MAX;
+                runLast[i] = INT_MIN;
+            }
+
+            for (int blockX = blockMinX; blockX <= rowMaxX; blockX += BLOCK_SIZE) {
+                long long sampleX = blockX * step + offset, sampleY = blockY * step + offset;
+                long long origin[3];
+                bool rejected = false, accepted = true;
+                for (int i = 0; i < 3; ++i) {
+                    const Edge &edge = edges[i];
+                    origin[i] = edge.a * sampleX + edge.b * sampleY + edge.c;
+                    // extreme values over the block are at its corners
+                    long long dx = edge.a * step * last, dy = edge.b * step * last;
+                    long long highest = origin[i] + std::max(0LL, dx) + std::max(0LL, dy);
+                    long long lowest = origin[i] + std::min(0LL, dx) + std::min(0LL, dy);
+                    rejected = rejected || highest < 0;
+                    accepted = accepted && lowest >= 0;
+                }
+                if (rejected)
+                    continue;
+
+                int rowFrom = std::max(minY, blockY) - blockY, rowTo = std::min(maxY, blockY + BLOCK_SIZE - 1) - blockY;
+                if (accepted) {
+                    for (int row = rowFrom; row <= rowTo; ++row) {
+                        runFirst[row] = std::min(runFirst[row], blockX);
+                        runLast[row] = blockX + BLOCK_SIZE - 1;
+                    }
+                    continue;
+                }
+
+                for (int row = rowFrom; row <= rowTo; ++row) {
+                    long long e0 = origin[0] + edges[0].b * step * row;
+                    long long e1 = origin[1] + edges[1].b * step * row;
+                    long long e2 = origin[2] + edges[2].b * step * row;
+                    long long s0 = edges[0].a * step, s1 = edges[1].a * step, s2 = edges[2].a * step;
+                    // sign bit of OR of the three edge functions is set when the sample is outside of any edge
+                    bool inside[BLOCK_SIZE];
+                    for (int lane = 0; lane < BLOCK_SIZE; ++lane)
+                        inside[lane] = ((e0 + s0 * lane) | (e1 + s1 * lane) | (e2 + s2 * lane)) >= 0;
+
+                    int first = BLOCK_SIZE, lastInside = -1;
+                    for (int lane = 0; lane < BLOCK_SIZE; ++lane) {
+                        if (inside[lane]) {
+                            first = std::min(first, lane);
+                            lastInside = lane;
+                        }
+                    }
+                    if (lastInside >= 0) {
+                        runFirst[row] = std::min(runFirst[row], blockX + first);
+                        runLast[row] = std::max(runLast[row], blockX + lastInside);
+                    }
+                }
+            }
+
+            for (int row = 0; row < BLOCK_SIZE; ++row) {
+                int x1 = std::max(runFirst[row], minX), x2 = std::min(runLast[row], maxX);
+                if (x1 <= x2)
+                    emit(blockY + row, x1, x2);
+            }
+        }
+    }
+
+private:
+    // E(x, y) = a * x + b * y + c, for fixed point x, y
+    struct Edge {
+        long long a;
+        long long b;
+        long long c;
+    };
+
+    // x extent of triangle between horizontal lines top and bottom (fixed point): vertices within the strip and
+    // crossings of edges with its borders; false when triangle does not reach into the strip
+    static bool stripExtent(const Vertex (&vertices)[3], long long top, long long bottom, long long &minX,
+                            long long &maxX) {
+        double low = 0.0, high = 0.0;
+        bool found = false;
+        auto include = [&low, &high, &found](double x) {
+            low = found ? std::min(low, x) : x;
+            high = found ? std::max(high, x) : x;
+            found = true;
+        };
+        for (int i = 0; i < 3; ++i) {
+            const Vertex &from = vertices[i];
+            const Vertex &to = vertices[(i + 1) % 3];
+            if (from.y >= top && from.y <= bottom)
+                include(static_cast<double>(from.x));
+            for (long long border : {top, bottom}) {
+                if ((from.y < border && to.y > border) || (from.y > border && to.y < border)) {
+                    double t = static_cast<double>(border - from.y) / static_cast<double>(to.y - from.y);
+                    include(static_cast<double>(from.x) + t * static_cast<double>(to.x - from.x));
+                }
+            }
+        }
+        // triangle covering the whole strip without vertices or crossings inside is impossible: it would need an
+        // edge crossing a border
+        if (!found)
+            return false;
+        minX = static_cast<long long>(std::floor(low));
+        maxX = static_cast<long long>(std::ceil(high));
+        return true;
+    }
+
+    static long long cross(const Vertex &a, const Vertex &b, const Vertex &c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+
+    // edge from -> to of triangle oriented so that inside is on positive side
+    Edge makeEdge(const Vertex &from, const Vertex &to) const {
+        Edge edge;
+        edge.a = -(to.y - from.y);
+        edge.b = to.x - from.x;
+        edge.c = -(edge.a * from.x + edge.b * from.y);
+        // inside increases to the right (left edge) or downwards along horizontal edge (top edge);
+        // samples exactly on other edges are moved outside
+        bool topLeft = edge.a > 0 || (edge.a == 0 && edge.b > 0);
+        if (rule_ == PIXEL_CENTERS && !topLeft)
+            edge.c -= 1;
+        return edge;
+    }
+
+    // first pixel with sample at or after fixed point coordinate (relative to sample of pixel 0)
+    static int firstSample(long long coordinate) {
+        return clampToInt(-floorDiv(-coordinate, 1LL << SUBPIXEL_BITS));
+    }
+
+    // last pixel with sample at or before fixed point coordinate (relative to sample of pixel 0)
+    static int lastSample(long long coordinate) {
+        return clampToInt(floorDiv(coordinate, 1LL << SUBPIXEL_BITS));
+    }
+
+    static long long floorDiv(long long value, long long divisor) {
+        long long quotient = value / divisor;
+        return quotient * divisor > value ? quotient - 1 : quotient;
+    }
+
+    static int clampToInt(long long value) {
+        return static_cast<int>(std::max(static_cast<long long>(INT_MIN), std::min(static_cast<long long>(INT_MAX - BLOCK_SIZE), value)));
+    }
+
+    SampleRule rule_;
+    Point clipMax_;
+};
+
+#endif
@@ -35,6 +35,35 @@ public:
         c1.blue = color.blue;
         putPixel(x, y, c1, static_cast<float>(color.alpha) / 255.0f);
     }
+
+    // Span operations: paint a horizontal run of `length` pixels starting at (x, y).
+    // Default implementations fall back to per-pixel calls, painters with direct access
+    // to pixel memory (and filters which can translate whole runs) should override them.
+
+    // fills run with a single color
+    virtual void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        for (unsigned int i = 0; i < length; ++i)
+            putPixel(x + i, y, color);
+    }
+
+    // copies `length` colors to run
+    virtual void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        for (unsigned int i = 0; i < length; ++i)
+            putPixel(x + i, y, colors[i]);
+    }
+
+    // blends color into run, coverage[i] is opacity (0-255) used for i-th pixel
+    virtual void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color,
+                           const unsigned char *coverage) {
+        for (unsigned int i = 0; i < length; ++i) {
+            if (coverage[i] == 0)
+                continue;
+            if (coverage[i] == 255)
+                putPixel(x + i, y, color);
+            else
+                putPixel(x + i, y, color, static_cast<float>(coverage[i]) / 255.0f);
+        }
+    }
 };
 
 #endif //UIMG_PIXEL_PAINTER_H
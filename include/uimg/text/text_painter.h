@@ -43,6 +43,22 @@ public:
      */
     virtual Point textSize(const std::string &text) = 0;
 
+    /**
+     * @brief Calculate rectangle of pixels painted by drawText
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param text Text to measure
+     * @return Rectangle containing every pixel drawText(x, y, text, color) can paint, empty (x2 < x1) for none
+     *
+     * Default is an estimate from textSize: text starts at x and goes up to its height above and below y.
+     */
+    virtual RectInclusive textBounds(unsigned int x, unsigned int y, const std::string &text) {
+        Point size = textSize(text);
+        int left = static_cast<int>(x);
+        int base = static_cast<int>(y);
+        return RectInclusive::make_rect(left - 1, base - size.y - 1, left + size.x + 1, base + size.y + 1);
+    }
+
     /**
      * @brief Draw a single glyph
      * @param x X coordinate
@@ -0,0 +1,224 @@
+#ifndef __UIMG_CHECKSUM_H__
+#define __UIMG_CHECKSUM_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// CRC-32 (ISO 3309 / ITU-T V.42, polynomial 0xEDB88320) as used by PNG and gzip.
+// update() can be called repeatedly on consecutive parts of data, starting with crc = 0.
+class Crc32 {
+public:
+    static uint32_t compute(const unsigned char *data, size_t size) {
+        return update(0, data, size);
+    }
+
+    static uint32_t update(uint32_t crc, const unsigned char *data, size_t size) {
+        const uint32_t *table = getTable();
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+        return ~crc;
+    }
+
+private:
+    static const uint32_t *getTable() {
+        static const Table table;
+        return table.values;
+    }
+
+    struct Table {
+        Table() {
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                values[n] = c;
+            }
+        }
+
+        uint32_t values[256];
+    };
+};
+
+// Adler-32 checksum as used by zlib streams.
+// update() can be called repeatedly on consecutive parts of data, starting with adler = 1.
+// combine() joins checksums of two adjacent parts computed independently.
+class Adler32 {
+public:
+    static constexpr uint32_t MOD = 65521;
+
+    static uint32_t compute(const unsigned char *data, size_t size) {
+        return update(1, data, size);
+    }
+
+    static uint32_t update(uint32_t adler, const unsigned char *data, size_t size) {
+        // largest n such that 255n(n+1)/2 + (n+1)(MOD-1) fits in 32 bits
+        const size_t NMAX = 5552;
+
+        uint32_t a = adler & 0xFFFFu;
+        uint32_t b = adler >> 16;
+        while (size > 0) {
+            size_t n = size < NMAX ? size : NMAX;
+            size -= n;
+            for (size_t i = 0; i < n; ++i) {
+                a += data[i];
+                b += a;
+            }
+            data += n;
+            a %= MOD;
+            b %= MOD;
+        }
+        return (b << 16) | a;
+    }
+
+    // checksum of A followed by B, where secondSize is length of B
+    static uint32_t combine(uint32_t adlerA, uint32_t adlerB, size_t secondSize) {
+        uint32_t rem = static_cast<uint32_t>(secondSize % MOD);
+        uint32_t a1 = adlerA & 0xFFFFu;
+        uint32_t b1 = adlerA >> 16;
+        uint32_t a2 = adlerB & 0xFFFFu;
+        uint32_t b2 = adlerB >> 16;
+
+        uint32_t a = (a1 + a2 + MOD - 1) % MOD;
+        uint32_t b = static_cast<uint32_t>((static_cast<uint64_t>(rem) * a1 + b1 + b2 + MOD - rem) % MOD);
+        return (b << 16) | a;
+    }
+};
+
+
+// xxHash64 (XXH64) non-cryptographic hash, for detecting changed image content.
+// Input is consumed in 32-byte stripes by four independent 64-bit lanes, which keeps the main loop free of
+// dependencies between lanes. Can be used at once (compute) or incrementally on consecutive parts of data
+// (update, then digest), e.g. on row segments of an image tile.
+class XxHash64 {
+public:
+    explicit XxHash64(uint64_t seed = 0) {
+        reset(seed);
+    }
+
+    static uint64_t compute(const unsigned char *data, size_t size, uint64_t seed = 0) {
+        XxHash64 hash(seed);
+        hash.update(data, size);
+        return hash.digest();
+    }
+
+    void reset(uint64_t seed = 0) {
+        lanes_[0] = seed + PRIME1 + PRIME2;
+        lanes_[1] = seed + PRIME2;
+        lanes_[2] = seed;
+        lanes_[3] = seed - PRIME1;
+        seed_ = seed;
+        totalSize_ = 0;
+        bufferedSize_ = 0;
+    }
+
+    void update(const unsigned char *data, size_t size) {
+        totalSize_ += size;
+        if (bufferedSize_ > 0) {
+            size_t count = std::min(size, STRIPE_SIZE - bufferedSize_);
+            memcpy(buffer_ + bufferedSize_, data, count);
+            bufferedSize_ += count;
+            data += count;
+            size -= count;
+            if (bufferedSize_ < STRIPE_SIZE)
+                return;
+            consumeStripes(buffer_, STRIPE_SIZE);
+            bufferedSize_ = 0;
+        }
+        size_t whole = size / STRIPE_SIZE * STRIPE_SIZE;
+        consumeStripes(data, whole);
+        memcpy(buffer_, data + whole, size - whole);
+        bufferedSize_ = size - whole;
+    }
+
+    uint64_t digest() const {
+        uint64_t hash;
+        if (totalSize_ >= STRIPE_SIZE) {
+            hash = rotl(lanes_[0], 1) + rotl(lanes_[1], 7) + rotl(lanes_[2], 12) + rotl(lanes_[3], 18);
+            for (size_t i = 0; i < 4; ++i)
+                hash = (hash ^ round(0, lanes_[i])) * PRIME1 + PRIME4;
+        } else {
+            hash = seed_ + PRIME5;
+        }
+        hash += totalSize_;
+
+        const unsigned char *data = buffer_;
+        size_t size = bufferedSize_;
+        for (; size >= 8; data += 8, size -= 8)
+            hash = rotl(hash ^ round(0, read64(data)), 27) * PRIME1 + PRIME4;
+        if (size >= 4) {
+            hash = rotl(hash ^ (read32(data) * PRIME1), 23) * PRIME2 + PRIME3;
+            data += 4;
+            size -= 4;
+        }
+        for (; size > 0; ++data, --size)
+            hash = rotl(hash ^ (*data * PRIME5), 11) * PRIME1;
+
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+    static constexpr size_t STRIPE_SIZE = 32;
+
+    static uint64_t rotl(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static uint64_t round(uint64_t lane, uint64_t input) {
+        return rotl(lane + input * PRIME2, 31) * PRIME1;
+    }
+
+    // little endian loads, independent of host byte order
+    static uint64_t read64(const unsigned char *data) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+#else
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+            value = (value << 8) | data[i];
+        return value;
+#endif
+    }
+
+    static uint64_t read32(const unsigned char *data) {
+        return static_cast<uint64_t>(data[0]) | static_cast<uint64_t>(data[1]) << 8 |
+               static_cast<uint64_t>(data[2]) << 16 | static_cast<uint64_t>(data[3]) << 24;
+    }
+
+    // size is a multiple of STRIPE_SIZE
+    void consumeStripes(const unsigned char *data, size_t size) {
+        uint64_t lane0 = lanes_[0], lane1 = lanes_[1], lane2 = lanes_[2], lane3 = lanes_[3];
+        for (size_t offset = 0; offset < size; offset += STRIPE_SIZE) {
+            lane0 = round(lane0, read64(data + offset));
+            lane1 = round(lane1, read64(data + offset + 8));
+            lane2 = round(lane2, read64(data + offset + 16));
+            lane3 = round(lane3, read64(data + offset + 24));
+        }
+        lanes_[0] = lane0;
+        lanes_[1] = lane1;
+        lanes_[2] = lane2;
+        lanes_[3] = lane3;
+    }
+
+    uint64_t lanes_[4];
+    uint64_t seed_;
+    uint64_t totalSize_;
+    unsigned char buffer_[STRIPE_SIZE];
+    size_t bufferedSize_;
+};
+
+#endif
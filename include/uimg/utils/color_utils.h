@@ -1,6 +1,7 @@
 #ifndef __UIMG_COLOR_UTILS_H__
 #define __UIMG_COLOR_UTILS_H__
 
+#include <algorithm>
 #include <cmath>
 
 #include "uimg/base/structs.h"
@@ -21,6 +22,47 @@ public:
         return result;
     }
 
+    // returns a * b / 255 rounded to nearest, exact for a, b in range 0-255 (integer only)
+    static unsigned int mul_div_255(unsigned int a, unsigned int b) {
+        unsigned int t = a * b + 128;
+        return (t + (t >> 8)) >> 8;
+    }
+
+    // converts color with straight alpha to premultiplied form (color components scaled by alpha)
+    static RgbaColor premultiply(const RgbaColor &color) {
+        RgbaColor result;
+        result.red = static_cast<unsigned char>(mul_div_255(color.red, color.alpha));
+        result.green = static_cast<unsigned char>(mul_div_255(color.green, color.alpha));
+        result.blue = static_cast<unsigned char>(mul_div_255(color.blue, color.alpha));
+        result.alpha = color.alpha;
+        return result;
+    }
+
+    // converts premultiplied color back to straight alpha, fully transparent color is returned as black
+    static RgbaColor unpremultiply(const RgbaColor &color) {
+        RgbaColor result;
+        if (color.alpha == 0) {
+            result.clear();
+            return result;
+        }
+        unsigned int alpha = color.alpha;
+        unsigned int half = alpha / 2;
+        result.red = static_cast<unsigned char>(std::min(255u, (color.red * 255u + half) / alpha));
+        result.green = static_cast<unsigned char>(std::min(255u, (color.green * 255u + half) / alpha));
+        result.blue = static_cast<unsigned char>(std::min(255u, (color.blue * 255u + half) / alpha));
+        result.alpha = color.alpha;
+        return result;
+    }
+
+    // luma (ITU-R BT.601 weights) of RGB color in integer arithmetic, 0..255
+    static unsigned char luminance(unsigned int red, unsigned int green, unsigned int blue) {
+        return static_cast<unsigned char>((77u * red + 150u * green + 29u * blue + 128u) >> 8);
+    }
+
+    static unsigned char luminance(const RgbColor &color) {
+        return luminance(color.red, color.green, color.blue);
+    }
+
 };
 
 #endif
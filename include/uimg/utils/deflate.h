@@ -0,0 +1,551 @@
+#ifndef __UIMG_DEFLATE_H__
+#define __UIMG_DEFLATE_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Collects bits LSB-first into bytes, as required by deflate (RFC 1951).
+class DeflateBitWriter {
+public:
+    explicit DeflateBitWriter(std::vector<unsigned char> &output) : output_(output), buffer_(0), count_(0) {}
+
+    void putBits(uint32_t bits, unsigned int count) {
+        buffer_ |= static_cast<uint64_t>(bits) << count_;
+        count_ += count;
+        while (count_ >= 8) {
+            output_.push_back(static_cast<unsigned char>(buffer_ & 0xFFu));
+            buffer_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    // pads current byte with zero bits
+    void alignToByte() {
+        if (count_ > 0)
+            putBits(0, 8 - count_);
+    }
+
+    void putBytes(const unsigned char *data, size_t size) {
+        output_.insert(output_.end(), data, data + size);
+    }
+
+private:
+    std::vector<unsigned char> &output_;
+    uint64_t buffer_;
+    unsigned int count_;
+};
+
+// Deflate (RFC 1951) compressor: LZ77 with hash chains and one-step lazy matching, each block is coded with
+// dynamic Huffman codes, fixed codes or stored - whichever is shortest.
+//
+// compress() encodes one part of a stream. Up to WINDOW_SIZE bytes of data preceding the part can be given
+// as dictionary, matches may reference it. Parts which are not final end with a sync flush (empty stored
+// block), so their output is byte-aligned and outputs of consecutive parts can be simply concatenated.
+// Parts of one stream can therefore be compressed independently, in parallel.
+// Encoder keeps no state between calls, one instance can be used by many threads.
+class DeflateEncoder {
+public:
+    static constexpr size_t WINDOW_SIZE = 32768;
+    static constexpr unsigned int MIN_MATCH = 3;
+    static constexpr unsigned int MAX_MATCH = 258;
+
+    // maxChainLength: number of earlier positions checked for each match (speed / ratio trade-off)
+    explicit DeflateEncoder(unsigned int maxChainLength = 32, size_t blockSymbols = 1 << 15)
+            : maxChainLength_(std::max(1u, maxChainLength)), blockSymbols_(std::max<size_t>(1, blockSymbols)) {}
+
+    // appends compressed `data` to output
+    void compress(const unsigned char *dictionary, size_t dictionarySize, const unsigned char *data, size_t size,
+                  bool final, std::vector<unsigned char> &output) const {
+        dictionarySize = std::min(dictionarySize, WINDOW_SIZE);
+        std::vector<unsigned char> window;
+        window.reserve(dictionarySize + size);
+        if (dictionarySize > 0)
+            window.insert(window.end(), dictionary, dictionary + dictionarySize);
+        window.insert(window.end(), data, data + size);
+
+        DeflateBitWriter bits(output);
+        Matcher matcher(window, maxChainLength_);
+        for (size_t i = 0; i < dictionarySize; ++i)
+            matcher.insert(i);
+
+        std::vector<Symbol> symbols;
+        symbols.reserve(blockSymbols_);
+
+        size_t pos = dictionarySize;
+        size_t end = window.size();
+        size_t blockStart = pos;
+        while (pos < end) {
+            Match match = matcher.find(pos);
+            matcher.insert(pos);
+
+            if (match.length >= MIN_MATCH && match.length < LAZY_LIMIT && pos + 1 < end) {
+                Match next = matcher.find(pos + 1);
+                if (next.length > match.length) {
+                    symbols.push_back(Symbol(window[pos], 0));
+                    ++pos;
+                    matcher.insert(pos);
+                    match = next;
+                }
+            }
+
+            if (match.length >= MIN_MATCH) {
+                symbols.push_back(Symbol(static_cast<uint16_t>(match.length), static_cast<uint16_t>(match.distance)));
+                for (size_t i = pos + 1, epos = pos + match.length; i < epos; ++i)
+                    matcher.insert(i);
+                pos += match.length;
+            } else {
+                symbols.push_back(Symbol(window[pos], 0));
+                ++pos;
+            }
+
+            if (symbols.size() >= blockSymbols_ && pos < end) {
+                writeBlock(bits, symbols, window.data() + blockStart, pos - blockStart, false);
+                symbols.clear();
+                blockStart = pos;
+            }
+        }
+
+        writeBlock(bits, symbols, window.data() + blockStart, end - blockStart, final);
+        if (!final) {
+            // sync flush: empty stored block
+            bits.putBits(0, 3);
+            bits.alignToByte();
+            static const unsigned char EMPTY_STORED[] = {0x00, 0x00, 0xFF, 0xFF};
+            bits.putBytes(EMPTY_STORED, sizeof(EMPTY_STORED));
+        }
+        bits.alignToByte();
+    }
+
+    // compresses whole stream at once
+    void compress(const unsigned char *data, size_t size, std::vector<unsigned char> &output) const {
+        compress(nullptr, 0, data, size, true, output);
+    }
+
+private:
+    static constexpr unsigned int LAZY_LIMIT = 32;
+    static constexpr unsigned int NICE_LENGTH = 128;
+    static constexpr unsigned int HASH_BITS = 15;
+    static constexpr unsigned int LITERAL_CODES = 286;
+    static constexpr unsigned int DISTANCE_CODES = 30;
+    static constexpr unsigned int LENGTH_CODES = 19;
+    static constexpr unsigned int END_OF_BLOCK = 256;
+    static constexpr unsigned int MAX_BITS = 15;
+    static constexpr unsigned int MAX_LENGTH_BITS = 7;
+    static constexpr size_t MAX_STORED = 65535;
+
+    // literal (distance == 0) or match
+    struct Symbol {
+        Symbol(uint16_t aLitLen, uint16_t aDistance) : litLen(aLitLen), distance(aDistance) {}
+
+        uint16_t litLen;
+        uint16_t distance;
+    };
+
+    struct Match {
+        unsigned int length = 0;
+        unsigned int distance = 0;
+    };
+
+    // hash chains over window
+    class Matcher {
+    public:
+        Matcher(const std::vector<unsigned char> &window, unsigned int maxChainLength)
+                : data_(window.data()), size_(window.size()), maxChainLength_(maxChainLength),
+                  head_(size_t(1) << HASH_BITS, -1), prev_(window.size(), -1) {}
+
+        void insert(size_t pos) {
+            if (pos + MIN_MATCH > size_)
+                return;
+            uint32_t h = hash(pos);
+            prev_[pos] = head_[h];
+            head_[h] = static_cast<int32_t>(pos);
+        }
+
+        // longest match for pos among already inserted positions
+        Match find(size_t pos) const {
+            Match best;
+            size_t maxLength = std::min<size_t>(MAX_MATCH, size_ - pos);
+            if (maxLength < MIN_MATCH)
+                return best;
+
+            size_t limit = pos > WINDOW_SIZE ? pos - WINDOW_SIZE : 0;
+            const unsigned char *current = data_ + pos;
+            size_t bestLength = MIN_MATCH - 1;
+            unsigned int chain = maxChainLength_;
+            for (int32_t candidate = head_[hash(pos)];
+                 candidate >= 0 && static_cast<size_t>(candidate) >= limit && chain > 0;
+                 candidate = prev_[static_cast<size_t>(candidate)], --chain) {
+                const unsigned char *earlier = data_ + candidate;
+                if (earlier[bestLength] != current[bestLength] || earlier[0] != current[0])
+                    continue;
+
+                size_t length = 0;
+                while (length < maxLength && earlier[length] == current[length])
+                    ++length;
+
+                if (length > bestLength) {
+                    bestLength = length;
+                    best.length = static_cast<unsigned int>(length);
+                    best.distance = static_cast<unsigned int>(pos - static_cast<size_t>(candidate));
+                    if (length >= maxLength || length >= NICE_LENGTH)
+                        break;
+                }
+            }
+            return best;
+        }
+
+    private:
+        uint32_t hash(size_t pos) const {
+            uint32_t key = static_cast<uint32_t>(data_[pos]) | (static_cast<uint32_t>(data_[pos + 1]) << 8) |
+                           (static_cast<uint32_t>(data_[pos + 2]) << 16);
+            return (key * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        const unsigned char *data_;
+        size_t size_;
+        unsigned int maxChainLength_;
+        std::vector<int32_t> head_;
+        std::vector<int32_t> prev_;
+    };
+
+    struct Code {
+        uint16_t bits = 0; // bit-reversed, ready for DeflateBitWriter
+        uint8_t length = 0;
+    };
+
+    // symbol, extra bits count and extra bits value of match length
+    static void lengthSymbol(unsigned int length, unsigned int &symbol, unsigned int &extraBits, unsigned int &extra) {
+        unsigned int value = length - MIN_MATCH;
+        if (length == MAX_MATCH) {
+            symbol = 285;
+            extraBits = extra = 0;
+        } else if (value < 8) {
+            symbol = 257 + value;
+            extraBits = extra = 0;
+        } else {
+            unsigned int top = highestBit(value);
+            unsigned int bucket = (value >> (top - 2)) & 3u;
+            symbol = 257 + 4 * (top - 1) + bucket;
+            extraBits = top - 2;
+            extra = value - ((4u | bucket) << extraBits);
+        }
+    }
+
+    static void distanceSymbol(unsigned int distance, unsigned int &symbol, unsigned int &extraBits,
+                               unsigned int &extra) {
+        unsigned int value = distance - 1;
+        if (value < 4) {
+            symbol = value;
+            extraBits = extra = 0;
+        } else {
+            unsigned int top = highestBit(value);
+            unsigned int bucket = (value >> (top - 1)) & 1u;
+            symbol = 2 * top + bucket;
+            extraBits = top - 1;
+            extra = value - ((2u | bucket) << extraBits);
+        }
+    }
+
+    static unsigned int highestBit(unsigned int value) {
+        unsigned int result = 0;
+        while (value >>= 1)
+            ++result;
+        return result;
+    }
+
+    static uint16_t reverseBits(unsigned int code, unsigned int length) {
+        unsigned int result = 0;
+        for (unsigned int i = 0; i < length; ++i, code >>= 1)
+            result = (result << 1) | (code & 1u);
+        return static_cast<uint16_t>(result);
+    }
+
+    // Huffman code lengths limited to maxBits; at least two symbols get a code, so the code is always complete
+    static void buildLengths(std::vector<uint32_t> freqs, unsigned int maxBits, std::vector<uint8_t> &lengths) {
+        size_t count = freqs.size();
+        lengths.assign(count, 0);
+
+        size_t used = 0;
+        for (size_t i = 0; i < count && used < 2; ++i)
+            used += freqs[i] > 0 ? 1u : 0u;
+        for (size_t i = 0; i < count && used < 2; ++i) {
+            if (freqs[i] == 0) {
+                freqs[i] = 1;
+                ++used;
+            }
+        }
+
+        for (;;) {
+            typedef std::pair<uint64_t, size_t> Entry;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+            std::vector<size_t> parent;
+            for (size_t i = 0; i < count; ++i) {
+                if (freqs[i] > 0) {
+                    queue.push(Entry(freqs[i], parent.size()));
+                    parent.push_back(0);
+                }
+            }
+
+            // nodes are numbered: leaves first (in symbol order), then inner nodes in creation order
+            while (queue.size() > 1) {
+                Entry a = queue.top();
+                queue.pop();
+                Entry b = queue.top();
+                queue.pop();
+                size_t node = parent.size();
+                parent.push_back(node);
+                parent[a.second] = node;
+                parent[b.second] = node;
+                queue.push(Entry(a.first + b.first, node));
+            }
+
+            // parent of inner node always has higher index, so depths are resolved from root down
+            size_t nodeCount = parent.size();
+            std::vector<unsigned int> depth(nodeCount, 0);
+            for (size_t node = nodeCount - 1; node-- > 0;)
+                depth[node] = depth[parent[node]] + 1;
+
+            unsigned int maxDepth = 0;
+            for (size_t i = 0, leaf = 0; i < count; ++i) {
+                if (freqs[i] > 0) {
+                    lengths[i] = static_cast<uint8_t>(depth[leaf++]);
+                    maxDepth = std::max(maxDepth, static_cast<unsigned int>(lengths[i]));
+                }
+            }
+            if (maxDepth <= maxBits)
+                return;
+
+            // flatten distribution and try again
+            for (uint32_t &freq : freqs)
+                freq = freq > 0 ? (freq + 1) / 2 : 0;
+        }
+    }
+
+    // canonical codes (RFC 1951, 3.2.2)
+    static void buildCodes(const std::vector<uint8_t> &lengths, std::vector<Code> &codes) {
+        unsigned int lengthCount[MAX_BITS + 1] = {0};
+        for (uint8_t length : lengths)
+            ++lengthCount[length];
+        lengthCount[0] = 0;
+
+        unsigned int nextCode[MAX_BITS + 1] = {0};
+        unsigned int code = 0;
+        for (unsigned int bits = 1; bits <= MAX_BITS; ++bits) {
+            code = (code + lengthCount[bits - 1]) << 1;
+            nextCode[bits] = code;
+        }
+
+        codes.assign(lengths.size(), Code());
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            if (lengths[i] > 0) {
+                codes[i].length = lengths[i];
+                codes[i].bits = reverseBits(nextCode[lengths[i]]++, lengths[i]);
+            }
+        }
+    }
+
+    static void fixedLengths(std::vector<uint8_t> &literalLengths, std::vector<uint8_t> &distanceLengths) {
+        literalLengths.assign(288, 8);
+        std::fill(literalLengths.begin() + 144, literalLengths.begin() + 256, 9);
+        std::fill(literalLengths.begin() + 256, literalLengths.begin() + 280, 7);
+        distanceLengths.assign(DISTANCE_CODES, 5);
+    }
+
+    // code length sequence of dynamic block header, run-length coded with symbols 16, 17, 18
+    struct LengthRun {
+        LengthRun(unsigned int aSymbol, unsigned int anExtra) : symbol(aSymbol), extra(anExtra) {}
+
+        unsigned int symbol;
+        unsigned int extra;
+    };
+
+    static void encodeLengths(const std::vector<uint8_t> &lengths, std::vector<LengthRun> &runs) {
+        runs.clear();
+        for (size_t i = 0, count = lengths.size(); i < count;) {
+            uint8_t value = lengths[i];
+            size_t run = 1;
+            while (i + run < count && lengths[i + run] == value)
+                ++run;
+
+            if (value == 0 && run >= 3) {
+                size_t taken = std::min<size_t>(run, 138);
+                runs.push_back(taken >= 11 ? LengthRun(18, static_cast<unsigned int>(taken - 11))
+                                           : LengthRun(17, static_cast<unsigned int>(taken - 3)));
+                i += taken;
+            } else if (value != 0 && run >= 4) {
+                // value itself, then repeats of it
+                runs.push_back(LengthRun(value, 0));
+                ++i;
+                for (size_t rest = run - 1; rest >= 3;) {
+                    size_t taken = std::min<size_t>(rest, 6);
+                    runs.push_back(LengthRun(16, static_cast<unsigned int>(taken - 3)));
+                    rest -= taken;
+                    i += taken;
+                }
+            } else {
+                runs.push_back(LengthRun(value, 0));
+                ++i;
+            }
+        }
+    }
+
+    static unsigned int runExtraBits(unsigned int symbol) {
+        return symbol == 16 ? 2 : (symbol == 17 ? 3 : (symbol == 18 ? 7 : 0));
+    }
+
+    // cost in bits of coding symbols with given code lengths (without block header)
+    static uint64_t symbolsCost(const std::vector<uint32_t> &literalFreqs, const std::vector<uint32_t> &distanceFreqs,
+                                const std::vector<uint8_t> &literalLengths, const std::vector<uint8_t> &distanceLengths) {
+        uint64_t cost = 0;
+        for (unsigned int i = 0; i < LITERAL_CODES; ++i) {
+            unsigned int extraBits = i >= 265 && i < 285 ? (i - 261) / 4 : 0;
+            cost += static_cast<uint64_t>(literalFreqs[i]) * (literalLengths[i] + extraBits);
+        }
+        for (unsigned int i = 0; i < DISTANCE_CODES; ++i) {
+            unsigned int extraBits = i >= 4 ? i / 2 - 1 : 0;
+            cost += static_cast<uint64_t>(distanceFreqs[i]) * (distanceLengths[i] + extraBits);
+        }
+        return cost;
+    }
+
+    void writeBlock(DeflateBitWriter &bits, const std::vector<Symbol> &symbols, const unsigned char *raw,
+                    size_t rawSize, bool final) const {
+        std::vector<uint32_t> literalFreqs(LITERAL_CODES, 0);
+        std::vector<uint32_t> distanceFreqs(DISTANCE_CODES, 0);
+        unsigned int symbol, extraBits, extra;
+        for (const Symbol &item : symbols) {
+            if (item.distance == 0) {
+                ++literalFreqs[item.litLen];
+            } else {
+                lengthSymbol(item.litLen, symbol, extraBits, extra);
+                ++literalFreqs[symbol];
+                distanceSymbol(item.distance, symbol, extraBits, extra);
+                ++distanceFreqs[symbol];
+            }
+        }
+        literalFreqs[END_OF_BLOCK] = 1;
+
+        // dynamic codes
+        std::vector<uint8_t> literalLengths, distanceLengths;
+        buildLengths(literalFreqs, MAX_BITS, literalLengths);
+        buildLengths(distanceFreqs, MAX_BITS, distanceLengths);
+
+        unsigned int literalCount = LITERAL_CODES;
+        while (literalCount > 257 && literalLengths[literalCount - 1] == 0)
+            --literalCount;
+        unsigned int distanceCount = DISTANCE_CODES;
+        while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0)
+            --distanceCount;
+
+        std::vector<uint8_t> allLengths(literalLengths.begin(), literalLengths.begin() + literalCount);
+        allLengths.insert(allLengths.end(), distanceLengths.begin(), distanceLengths.begin() + distanceCount);
+        std::vector<LengthRun> runs;
+        encodeLengths(allLengths, runs);
+
+        std::vector<uint32_t> runFreqs(LENGTH_CODES, 0);
+        for (const LengthRun &run : runs)
+            ++runFreqs[run.symbol];
+        std::vector<uint8_t> runLengths;
+        buildLengths(runFreqs, MAX_LENGTH_BITS, runLengths);
+
+        static const unsigned char RUN_ORDER[LENGTH_CODES] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2,
+                                                              14, 1, 15};
+        unsigned int runCodeCount = LENGTH_CODES;
+        while (runCodeCount > 4 && runLengths[RUN_ORDER[runCodeCount - 1]] == 0)
+            --runCodeCount;
+
+        uint64_t dynamicCost = 3 + 14 + 3 * runCodeCount;
+        for (const LengthRun &run : runs)
+            dynamicCost += runLengths[run.symbol] + runExtraBits(run.symbol);
+        dynamicCost += symbolsCost(literalFreqs, distanceFreqs, literalLengths, distanceLengths);
+
+        // fixed codes
+        std::vector<uint8_t> fixedLiteralLengths, fixedDistanceLengths;
+        fixedLengths(fixedLiteralLengths, fixedDistanceLengths);
+        uint64_t fixedCost = 3 + symbolsCost(literalFreqs, distanceFreqs, fixedLiteralLengths, fixedDistanceLengths);
+
+        // stored: header padded to byte boundary (at most), LEN and NLEN per each 64 kB
+        size_t storedBlocks = std::max<size_t>(1, (rawSize + MAX_STORED - 1) / MAX_STORED);
+        uint64_t storedCost = storedBlocks * (3 + 7 + 32) + static_cast<uint64_t>(rawSize) * 8;
+
+        if (storedCost < dynamicCost && storedCost < fixedCost) {
+            writeStored(bits, raw, rawSize, final);
+            return;
+        }
+
+        std::vector<Code> literalCodes, distanceCodes;
+        if (dynamicCost < fixedCost) {
+            bits.putBits(final ? 1u : 0u, 1);
+            bits.putBits(2, 2);
+            bits.putBits(literalCount - 257, 5);
+            bits.putBits(distanceCount - 1, 5);
+            bits.putBits(runCodeCount - 4, 4);
+            for (unsigned int i = 0; i < runCodeCount; ++i)
+                bits.putBits(runLengths[RUN_ORDER[i]], 3);
+
+            std::vector<Code> runCodes;
+            buildCodes(runLengths, runCodes);
+            for (const LengthRun &run : runs) {
+                bits.putBits(runCodes[run.symbol].bits, runCodes[run.symbol].length);
+                if (runExtraBits(run.symbol) > 0)
+                    bits.putBits(run.extra, runExtraBits(run.symbol));
+            }
+
+            buildCodes(literalLengths, literalCodes);
+            buildCodes(distanceLengths, distanceCodes);
+        } else {
+            bits.putBits(final ? 1u : 0u, 1);
+            bits.putBits(1, 2);
+            buildCodes(fixedLiteralLengths, literalCodes);
+            buildCodes(fixedDistanceLengths, distanceCodes);
+        }
+
+        writeSymbols(bits, symbols, literalCodes, distanceCodes);
+    }
+
+    static void writeSymbols(DeflateBitWriter &bits, const std::vector<Symbol> &symbols,
+                             const std::vector<Code> &literalCodes, const std::vector<Code> &distanceCodes) {
+        unsigned int symbol, extraBits, extra;
+        for (const Symbol &item : symbols) {
+            if (item.distance == 0) {
+                bits.putBits(literalCodes[item.litLen].bits, literalCodes[item.litLen].length);
+                continue;
+            }
+
+            lengthSymbol(item.litLen, symbol, extraBits, extra);
+            bits.putBits(literalCodes[symbol].bits, literalCodes[symbol].length);
+            if (extraBits > 0)
+                bits.putBits(extra, extraBits);
+
+            distanceSymbol(item.distance, symbol, extraBits, extra);
+            bits.putBits(distanceCodes[symbol].bits, distanceCodes[symbol].length);
+            if (extraBits > 0)
+                bits.putBits(extra, extraBits);
+        }
+        bits.putBits(literalCodes[END_OF_BLOCK].bits, literalCodes[END_OF_BLOCK].length);
+    }
+
+    static void writeStored(DeflateBitWriter &bits, const unsigned char *raw, size_t rawSize, bool final) {
+        do {
+            size_t part = std::min(rawSize, MAX_STORED);
+            rawSize -= part;
+            bits.putBits(final && rawSize == 0 ? 1u : 0u, 1);
+            bits.putBits(0, 2);
+            bits.alignToByte();
+            bits.putBits(static_cast<uint32_t>(part), 16);
+            bits.putBits(static_cast<uint32_t>(~part & 0xFFFFu), 16);
+            bits.putBytes(raw, part);
+            raw += part;
+        } while (rawSize > 0);
+    }
+
+    unsigned int maxChainLength_;
+    size_t blockSymbols_;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef __UIMG_MAPPED_FILE_H__
+#define __UIMG_MAPPED_FILE_H__
+
+#include "uimg/base/platform.h"
+
+#if UIMG_HAS_POSIX
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Whole file mapped into memory (POSIX mmap).
+// READ_ONLY maps existing file, READ_WRITE maps existing file shared, so changes are written back to it.
+// CREATE creates new file (or truncates existing one) of `size` bytes filled with zeros and maps it
+// like READ_WRITE. Throws std::runtime_error if file cannot be opened or mapped.
+class MappedFile {
+public:
+    enum Mode {
+        READ_ONLY,
+        READ_WRITE,
+        CREATE
+    };
+
+    explicit MappedFile(const std::string &path, Mode mode = READ_ONLY, size_t size = 0)
+            : data_(nullptr), size_(0), fd_(-1), mode_(mode) {
+        int flags = mode == READ_ONLY ? O_RDONLY : (mode == READ_WRITE ? O_RDWR : (O_RDWR | O_CREAT | O_TRUNC));
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ < 0)
+            throw std::runtime_error("MappedFile: cannot open file: " + path);
+
+        if (mode == CREATE) {
+            if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+                ::close(fd_);
+                throw std::runtime_error("MappedFile: cannot resize file: " + path);
+            }
+            size_ = size;
+        } else {
+            struct stat info;
+            if (::fstat(fd_, &info) != 0) {
+                ::close(fd_);
+                throw std::runtime_error("MappedFile: cannot read file size: " + path);
+            }
+            size_ = static_cast<size_t>(info.st_size);
+        }
+
+        if (size_ == 0)
+            return;
+
+        int protection = mode == READ_ONLY ? PROT_READ : (PROT_READ | PROT_WRITE);
+        void *mapped = ::mmap(nullptr, size_, protection, MAP_SHARED, fd_, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("MappedFile: cannot map file: " + path);
+        }
+        data_ = static_cast<unsigned char *>(mapped);
+    }
+
+    ~MappedFile() {
+        if (data_)
+            ::munmap(data_, size_);
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const unsigned char *data() const {
+        return data_;
+    }
+
+    // writable only in READ_WRITE and CREATE modes
+    unsigned char *data() {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    Mode mode() const {
+        return mode_;
+    }
+
+    // hints kernel about expected access pattern of given range (e.g. MADV_SEQUENTIAL, MADV_WILLNEED)
+    void advise(size_t offset, size_t length, int advice) const {
+        size_t start, alignedLength;
+        if (pageRange(offset, length, start, alignedLength))
+            ::madvise(data_ + start, alignedLength, advice);
+    }
+
+    // flushes changes of whole writable mapping to file
+    void sync() {
+        sync(0, size_);
+    }
+
+    // flushes changes of given range to file
+    void sync(size_t offset, size_t length) {
+        size_t start, alignedLength;
+        if (mode_ == READ_ONLY || !pageRange(offset, length, start, alignedLength))
+            return;
+        if (::msync(data_ + start, alignedLength, MS_SYNC) != 0)
+            throw std::runtime_error("MappedFile: sync failed");
+    }
+
+private:
+    // extends range to start at page boundary (required by madvise / msync) and clips it to mapping
+    bool pageRange(size_t offset, size_t length, size_t &start, size_t &alignedLength) const {
+        if (!data_ || offset >= size_ || length == 0)
+            return false;
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        start = offset / page * page;
+        alignedLength = std::min(length + (offset - start), size_ - start);
+        return true;
+    }
+
+    unsigned char *data_;
+    size_t size_;
+    int fd_;
+    Mode mode_;
+};
+
+#endif
+
+#endif
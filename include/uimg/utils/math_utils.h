@@ -37,6 +37,19 @@ public:
         return static_cast<T>(fracPart);
     }
 
+    // integer square root: largest r for which r * r <= a
+    template<typename T>
+    static T isqrt(T a) {
+        if (a <= 0)
+            return 0;
+        T r = static_cast<T>(std::sqrt(static_cast<double>(a)));
+        while (r * r > a)
+            --r;
+        while ((r + 1) * (r + 1) <= a)
+            ++r;
+        return r;
+    }
+
     template<typename T>
     static int sgn(T val) {
         return (T(0) < val) - (val < T(0));
@@ -0,0 +1,136 @@
+#ifndef __UIMG_THREAD_POOL_H__
+#define __UIMG_THREAD_POOL_H__
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool.
+// Each worker owns a task queue, submitted tasks are distributed between queues in round-robin order.
+// Worker takes tasks from the front of its own queue and, when it is empty, steals from the back of other queues.
+// Queues and counters are guarded by one mutex, so queued_ is always the number of tasks in queues and a worker
+// sleeps on the condition variable exactly when there is nothing to take. Tasks are coarse (tiles, charts, bands),
+// so one lock costs little.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount = 0 means one thread per hardware core
+    explicit ThreadPool(unsigned int threadCount = 0) {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        queues_.resize(threadCount);
+
+        for (unsigned int i = 0; i < threadCount; ++i)
+            workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // waits for queued tasks and stops workers
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            stopping_ = true;
+        }
+        taskAvailable_.notify_all();
+        for (auto &worker : workers_)
+            worker.join();
+    }
+
+    unsigned int threadCount() const {
+        return static_cast<unsigned int>(workers_.size());
+    }
+
+    void submit(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            queues_[nextQueue_++ % queues_.size()].push_back(std::move(task));
+            ++queued_;
+            ++pending_;
+        }
+        taskAvailable_.notify_one();
+    }
+
+    // blocks until all submitted tasks are finished, rethrows first exception thrown by a task
+    void wait() {
+        std::unique_lock<std::mutex> lock(stateMutex_);
+        allDone_.wait(lock, [this] { return pending_ == 0; });
+        if (firstError_) {
+            std::exception_ptr error = firstError_;
+            firstError_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    // takes task from own queue or steals one from other workers, called with stateMutex_ locked and queued_ > 0
+    Task popTask(unsigned int index) {
+        Task task;
+        std::deque<Task> &own = queues_[index];
+        if (!own.empty()) {
+            task = std::move(own.front());
+            own.pop_front();
+        } else {
+            for (size_t i = 1, count = queues_.size(); i < count; ++i) {
+                std::deque<Task> &victim = queues_[(index + i) % count];
+                if (!victim.empty()) {
+                    task = std::move(victim.back());
+                    victim.pop_back();
+                    break;
+                }
+            }
+        }
+        --queued_;
+        return task;
+    }
+
+    void workerLoop(unsigned int index) {
+        std::unique_lock<std::mutex> lock(stateMutex_);
+        for (;;) {
+            taskAvailable_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            // queued tasks are finished before stopping
+            if (queued_ == 0)
+                return;
+
+            Task task = popTask(index);
+            lock.unlock();
+            std::exception_ptr error = runTask(task);
+            lock.lock();
+
+            if (error && !firstError_)
+                firstError_ = error;
+            if (--pending_ == 0)
+                allDone_.notify_all();
+        }
+    }
+
+    static std::exception_ptr runTask(Task &task) {
+        try {
+            task();
+        } catch (...) {
+            return std::current_exception();
+        }
+        return nullptr;
+    }
+
+    std::vector<std::deque<Task>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex stateMutex_; // guards queues and everything below
+    std::condition_variable taskAvailable_;
+    std::condition_variable allDone_;
+    size_t queued_ = 0;  // tasks waiting in queues
+    size_t pending_ = 0; // tasks submitted and not finished yet
+    size_t nextQueue_ = 0;
+    bool stopping_ = false;
+    std::exception_ptr firstError_;
+};
+
+#endif
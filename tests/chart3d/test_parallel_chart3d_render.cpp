@@ -0,0 +1,99 @@
+#include "utest/utest.h"
+#include "dlog/dlog.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+// demo headers expect the colors of demo_painter_base.h
+#include "samples/demo_painter_base.h"
+#include "chart3d/chart3d_renderer.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+/**
+ * @file test_parallel_chart3d_render.cpp
+ * @brief Tests for rendering 3D charts in parallel while they log (meant to be run also under -DUIMG_SANITIZE=thread)
+ */
+
+namespace {
+
+// 2x2 grid of charts with different functions in a 400x300 image
+std::vector<Chart3D_Z_FXY> makeCharts() {
+    std::vector<Chart3D_Z_FXY> charts;
+    for (int i = 0; i < 4; ++i) {
+        Chart3D_Z_FXY chart;
+        chart.setSize(200, 150);
+        chart.setOffset((i % 2) * 200, (i / 2) * 150);
+        chart.setChartIndex(i);
+        chart.setRange(-3.0f, 3.0f, -3.0f, 3.0f);
+        float frequency = 1.0f + static_cast<float>(i) * 0.5f;
+        chart.setFunction([frequency](float x, float y) { return std::sin(frequency * x) * std::cos(y); });
+        charts.push_back(chart);
+    }
+    return charts;
+}
+
+// logger writing to buffer only, with debug messages enabled
+void setUpLogger() {
+    auto logger = dlog::Logger::getInstance();
+    logger->setLevel(dlog::LogLevel::DEBUG);
+    logger->setConsoleEnabled(false);
+    logger->setBufferEnabled(true);
+    logger->setBufferLimit(100000);
+    logger->clearBuffer();
+}
+
+size_t countMessages(const std::string &text) {
+    size_t count = 0;
+    for (const auto &entry : dlog::Logger::getInstance()->getBufferEntries())
+        if (entry.message.find(text) != std::string::npos)
+            ++count;
+    return count;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(ParallelChart3D_MatchesSequentialRender) {
+    setUpLogger();
+    std::vector<Chart3D_Z_FXY> charts = makeCharts();
+
+    RgbImage parallel(400, 300);
+    Chart3DRenderer(parallel).render(charts);
+
+    RgbImage sequential(400, 300);
+    Chart3DRenderer renderer(sequential);
+    for (const auto &chart : charts)
+        renderer.render(chart);
+
+    bool same = true, painted = false;
+    for (int y = 0; y < 300; ++y)
+        for (int x = 0; x < 400; ++x) {
+            same = same && parallel.getPixel(x, y) == sequential.getPixel(x, y);
+            painted = painted || !(parallel.getPixel(x, y) == RgbColor{0, 0, 0});
+        }
+    UTEST_ASSERT_TRUE(painted);
+    UTEST_ASSERT_TRUE(same);
+}
+
+UTEST_FUNC_DEF(ParallelChart3D_LogsEveryChart) {
+    setUpLogger();
+    RgbImage image(800, 600);
+    Chart3DRenderer(image).renderCharts(4);
+
+    auto logger = dlog::Logger::getInstance();
+    UTEST_ASSERT_EQUALS(countMessages("painted successfully"), 4u);
+    UTEST_ASSERT_EQUALS(countMessages("--- Rendering single chart"), 4u);
+    UTEST_ASSERT_EQUALS(logger->getBufferCount(), logger->getBufferEntries().size());
+
+    logger->setLevel(dlog::LogLevel::INFO);
+    logger->clearBuffer();
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(ParallelChart3D_MatchesSequentialRender);
+    UTEST_FUNC(ParallelChart3D_LogsEveryChart);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,102 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/charts/chart_renderer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/**
+ * @file test_chart_renderer.cpp
+ * @brief Tests for rendering charts with decorations outside of chart rectangles
+ */
+
+using namespace uimg::charts;
+
+namespace {
+
+const char *FONT_PATH = "/tmp/uimg_test_chart_renderer.bdf";
+
+// font of printable ASCII characters, every glyph is a filled 5x7 box with 1 pixel descent
+void writeBoxFont(const std::string &path) {
+    std::ofstream out(path);
+    out << "STARTFONT 2.1\nFONT box\nSIZE 8 75 75\nFONTBOUNDINGBOX 5 7 0 -1\nCHARS 95\n";
+    for (int ch = 32; ch < 127; ++ch) {
+        out << "STARTCHAR c" << ch << "\nENCODING " << ch << "\nSWIDTH 600 0\nDWIDTH 6 0\nBBX 5 7 0 -1\nBITMAP\n";
+        for (int row = 0; row < 7; ++row)
+            out << (ch == 32 ? "00" : "F8") << "\n";
+        out << "ENDCHAR\n";
+    }
+    out << "ENDFONT\n";
+}
+
+Chart makeChart(const std::string &title, int marginLeft) {
+    ChartStyle style;
+    style.marginLeft = marginLeft;
+    style.legendWidth = 30;
+    Chart chart(title, AxisConfig::create(0, 10, "x"), AxisConfig::create(-100, 100, "y"), style);
+    Series &series = chart.createSeries("line", RgbColor{255, 0, 0});
+    series.addPoint(0, -100);
+    series.addPoint(10, 100);
+    return chart;
+}
+
+bool columnsPainted(const RgbImage &image, int x1, int x2, const RgbColor &color) {
+    for (int y = 0; y < static_cast<int>(image.getSize().y); ++y)
+        for (int x = x1; x <= x2; ++x)
+            if (image.getPixel(x, y) == color)
+                return true;
+    return false;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(ChartRenderer_TickLabelsOutsideOfChartRect) {
+    writeBoxFont(FONT_PATH);
+    ChartRenderer renderer(400, 200, FONT_PATH);
+    // y tick labels ("-100.0" is 36 pixels wide) end 25 pixels left of the plot, outside of the second chart
+    renderer.addChart(makeChart("a", 80), ChartLayout::create(0, 0, 139, 199));
+    renderer.addChart(makeChart("b", 10), ChartLayout::create(160, 0, 399, 199));
+    renderer.render();
+
+    const RgbImage &image = renderer.getImage();
+    UTEST_ASSERT_TRUE(columnsPainted(image, 140, 159, RgbColor{0, 0, 0}));
+    // series are clipped to chart rectangle
+    UTEST_ASSERT_FALSE(columnsPainted(image, 140, 159, RgbColor{255, 0, 0}));
+    UTEST_ASSERT_TRUE(columnsPainted(image, 170, 399, RgbColor{255, 0, 0}));
+    std::remove(FONT_PATH);
+}
+
+UTEST_FUNC_DEF(ChartRenderer_ParallelMatchesSeparateRenders) {
+    writeBoxFont(FONT_PATH);
+    // disjoint charts are rendered in parallel, overlapping ones sequentially; both paint the same
+    ChartRenderer parallel(400, 200, FONT_PATH);
+    parallel.addChart(makeChart("a", 80), ChartLayout::create(0, 0, 199, 199));
+    parallel.addChart(makeChart("b", 80), ChartLayout::create(200, 0, 399, 199));
+    parallel.render();
+
+    ChartRenderer single(400, 200, FONT_PATH);
+    single.addChart(makeChart("a", 80), ChartLayout::create(0, 0, 199, 199));
+    single.render();
+    ChartRenderer other(400, 200, FONT_PATH);
+    other.addChart(makeChart("b", 80), ChartLayout::create(200, 0, 399, 199));
+    other.render();
+
+    bool same = true;
+    for (int y = 0; y < 200; ++y)
+        for (int x = 0; x < 400; ++x)
+            same = same && parallel.getImage().getPixel(x, y) ==
+                           (x < 200 ? single.getImage().getPixel(x, y) : other.getImage().getPixel(x, y));
+    UTEST_ASSERT_TRUE(same);
+    std::remove(FONT_PATH);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(ChartRenderer_TickLabelsOutsideOfChartRect);
+    UTEST_FUNC(ChartRenderer_ParallelMatchesSeparateRenders);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,153 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/async_image_writer.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file test_async_image_writer.cpp
+ * @brief Tests for writing images on a background thread with AsyncImageWriter
+ */
+
+namespace {
+
+void fillImage(PixelImageBase &image, int seed) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x * 10 + seed, y * 20, seed * 3));
+}
+
+std::string toPpm(PixelImageBase &image) {
+    std::ostringstream output;
+    PpmImageWriter writer(output);
+    writer.writeImage(image);
+    return output.str();
+}
+
+std::string readFile(const std::string &path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(AsyncWriter_WritesInSubmissionOrder) {
+    std::mutex mutex;
+    std::vector<int> written;
+    std::vector<std::future<void>> results;
+    {
+        AsyncImageWriter writer(2);
+        for (int i = 0; i < 10; ++i) {
+            RgbImage image(4, 3);
+            fillImage(image, i);
+            results.push_back(writer.write(std::move(image), [i, &mutex, &written](PixelImageBase &output) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                std::lock_guard<std::mutex> lock(mutex);
+                written.push_back(output.getPixel(Point(0, 0)).red == i ? i : -1);
+            }));
+        }
+        writer.wait();
+        UTEST_ASSERT_EQUALS(writer.pending(), 0u);
+    }
+
+    UTEST_ASSERT_EQUALS(written.size(), 10u);
+    bool ordered = true;
+    for (int i = 0; i < 10; ++i)
+        ordered = ordered && written[static_cast<size_t>(i)] == i;
+    UTEST_ASSERT_TRUE(ordered);
+    for (auto &result : results)
+        result.get();
+}
+
+UTEST_FUNC_DEF(AsyncWriter_SnapshotIsIndependentOfSource) {
+    RgbaImage image(5, 4);
+    fillImage(image, 7);
+    std::string expected = toPpm(image);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::string written;
+    AsyncImageWriter writer;
+    std::future<void> result = writer.write(image, [&released, &written](PixelImageBase &output) {
+        released.wait();
+        written = toPpm(output);
+    });
+
+    // source is modified while its snapshot waits for output
+    fillImage(image, 100);
+    release.set_value();
+    result.get();
+    UTEST_ASSERT_TRUE(written == expected);
+}
+
+UTEST_FUNC_DEF(AsyncWriter_ErrorIsReportedByFuture) {
+    AsyncImageWriter writer;
+    std::future<void> failed = writer.write(RgbImage(2, 2), [](PixelImageBase &) {
+        throw std::runtime_error("disk full");
+    });
+    bool ran = false;
+    std::future<void> next = writer.write(RgbImage(2, 2), [&ran](PixelImageBase &) { ran = true; });
+
+    bool thrown = false;
+    try {
+        failed.get();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+    next.get();
+    UTEST_ASSERT_TRUE(ran);
+}
+
+UTEST_FUNC_DEF(AsyncWriter_WritesFiles) {
+    std::string ppmPath = "/tmp/uimg_test_async.ppm";
+    std::string pngPath = "/tmp/uimg_test_async.png";
+    RgbImage image(6, 5);
+    fillImage(image, 3);
+    std::string expected = toPpm(image);
+
+    AsyncImageWriter writer;
+    std::future<void> ppm = writer.writeFile(image, ppmPath);
+    std::future<void> png = writer.writeFile(std::move(image), pngPath);
+    std::future<void> invalid = writer.writeFile(RgbImage(1, 1), "/nonexistent/dir/image.ppm");
+    ppm.get();
+    png.get();
+
+    UTEST_ASSERT_TRUE(readFile(ppmPath) == expected);
+    UTEST_ASSERT_TRUE(readFile(pngPath).compare(0, 4, "\x89PNG") == 0);
+
+    bool thrown = false;
+    try {
+        invalid.get();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    std::remove(ppmPath.c_str());
+    std::remove(pngPath.c_str());
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(AsyncWriter_WritesInSubmissionOrder);
+    UTEST_FUNC(AsyncWriter_SnapshotIsIndependentOfSource);
+    UTEST_FUNC(AsyncWriter_ErrorIsReportedByFuture);
+    UTEST_FUNC(AsyncWriter_WritesFiles);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,133 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/dirty_tile_tracker.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/utils/checksum.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @file test_dirty_tile_tracker.cpp
+ * @brief Tests for XxHash64 and detection of changed image tiles
+ */
+
+namespace {
+
+uint64_t hashOf(const std::string &text) {
+    return XxHash64::compute(reinterpret_cast<const unsigned char *>(text.data()), text.size());
+}
+
+void fillPattern(PixelImageBase &image) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x * 3, y * 5, x + y));
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(XxHash64_ReferenceValues) {
+    UTEST_ASSERT_EQUALS(hashOf(""), 0xEF46DB3751D8E999ull);
+    UTEST_ASSERT_EQUALS(hashOf("a"), 0xD24EC4F1A98C6E5Bull);
+    UTEST_ASSERT_EQUALS(hashOf("abc"), 0x44BC2CF5AD770999ull);
+    UTEST_ASSERT_EQUALS(hashOf("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ull);
+}
+
+UTEST_FUNC_DEF(XxHash64_IncrementalEqualsWhole) {
+    std::vector<unsigned char> data(1000);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(i * 7 + i / 13);
+
+    const size_t steps[] = {1, 5, 31, 33, 64, 100, 3};
+    XxHash64 hash(42);
+    for (size_t offset = 0, step = 0; offset < data.size(); ++step) {
+        size_t size = std::min(steps[step % 7], data.size() - offset);
+        hash.update(data.data() + offset, size);
+        offset += size;
+    }
+    UTEST_ASSERT_EQUALS(hash.digest(), XxHash64::compute(data.data(), data.size(), 42));
+    UTEST_ASSERT_TRUE(XxHash64::compute(data.data(), data.size(), 42) != XxHash64::compute(data.data(), data.size()));
+}
+
+UTEST_FUNC_DEF(Tracker_ReportsOnlyChangedTiles) {
+    RgbImage image(150, 70);
+    fillPattern(image);
+    DirtyTileTracker tracker(64);
+
+    UTEST_ASSERT_EQUALS(tracker.update(image).size(), 6u);
+    UTEST_ASSERT_EQUALS(tracker.columns(), 3u);
+    UTEST_ASSERT_EQUALS(tracker.rows(), 2u);
+    UTEST_ASSERT_TRUE(tracker.update(image).empty());
+    RectInclusive bounds;
+    UTEST_ASSERT_FALSE(tracker.changedBounds(bounds));
+
+    // one pixel in bottom right edge tile, one in top left tile
+    image.setPixel(Point(149, 69), RgbColor::make_rgb(1, 2, 3));
+    image.setPixel(Point(10, 63), RgbColor::make_rgb(1, 2, 3));
+    const std::vector<DirtyTileTracker::Tile> &changed = tracker.update(image);
+    UTEST_ASSERT_EQUALS(changed.size(), 2u);
+    UTEST_ASSERT_EQUALS(changed[0].column, 0u);
+    UTEST_ASSERT_EQUALS(changed[0].row, 0u);
+    UTEST_ASSERT_EQUALS(changed[1].column, 2u);
+    UTEST_ASSERT_EQUALS(changed[1].row, 1u);
+    UTEST_ASSERT_EQUALS(changed[1].bounds.x1, 128);
+    UTEST_ASSERT_EQUALS(changed[1].bounds.x2, 149);
+    UTEST_ASSERT_EQUALS(changed[1].bounds.y2, 69);
+
+    UTEST_ASSERT_TRUE(tracker.changedBounds(bounds));
+    UTEST_ASSERT_EQUALS(bounds.x1, 0);
+    UTEST_ASSERT_EQUALS(bounds.y1, 0);
+    UTEST_ASSERT_EQUALS(bounds.x2, 149);
+    UTEST_ASSERT_EQUALS(bounds.y2, 69);
+}
+
+UTEST_FUNC_DEF(Tracker_SizeChangeAndResetReportAllTiles) {
+    RgbImage image(64, 64);
+    DirtyTileTracker tracker(32);
+    tracker.update(image);
+    UTEST_ASSERT_TRUE(tracker.update(image).empty());
+
+    tracker.reset();
+    UTEST_ASSERT_EQUALS(tracker.update(image).size(), 4u);
+
+    RgbImage larger(65, 64);
+    UTEST_ASSERT_EQUALS(tracker.update(larger).size(), 6u);
+}
+
+UTEST_FUNC_DEF(Tracker_HashesIndependentOfLayoutAndThreads) {
+    RgbImage image(200, 130);
+    RgbImage strided(200, 130, 700);
+    RgbaImage rgba(200, 130);
+    fillPattern(image);
+    fillPattern(strided);
+    fillPattern(rgba);
+
+    DirtyTileTracker single(48);
+    DirtyTileTracker threaded(48, 4);
+    DirtyTileTracker other(48);
+    single.update(image);
+    threaded.update(strided);
+    other.update(rgba);
+
+    bool same = true;
+    for (unsigned int row = 0; row < single.rows(); ++row)
+        for (unsigned int column = 0; column < single.columns(); ++column)
+            same = same && single.tileHash(column, row) == threaded.tileHash(column, row) &&
+                   single.tileHash(column, row) == other.tileHash(column, row);
+    UTEST_ASSERT_TRUE(same);
+    UTEST_ASSERT_TRUE(single.tileHash(0, 0) != single.tileHash(1, 0));
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(XxHash64_ReferenceValues);
+    UTEST_FUNC(XxHash64_IncrementalEqualsWhole);
+    UTEST_FUNC(Tracker_ReportsOnlyChangedTiles);
+    UTEST_FUNC(Tracker_SizeChangeAndResetReportAllTiles);
+    UTEST_FUNC(Tracker_HashesIndependentOfLayoutAndThreads);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,341 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/gif_image.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @file test_gif_image.cpp
+ * @brief Tests for median cut quantizer, palette mapper, LZW encoder and animated GIF writer
+ */
+
+namespace {
+
+// minimal GIF decoder: composes frames (disposal "leave in place") into RGB canvas
+class GifDecoder {
+public:
+    explicit GifDecoder(const std::string &data) : data_(data) {}
+
+    bool decode() {
+        if (data_.compare(0, 6, "GIF89a") != 0)
+            return false;
+        pos_ = 6;
+        width_ = readUint16();
+        height_ = readUint16();
+        unsigned int flags = readByte();
+        pos_ += 2;
+        unsigned int tableSize = 2u << (flags & 7);
+        for (unsigned int i = 0; i < tableSize * 3; ++i)
+            palette_.push_back(readByte());
+        canvas_.assign(static_cast<size_t>(width_) * height_, 0);
+
+        while (pos_ < data_.size()) {
+            unsigned int type = readByte();
+            if (type == 0x3B)
+                return true;
+            if (type == 0x21) {
+                unsigned int label = readByte();
+                if (label == 0xFF)
+                    ++loopBlocks;
+                if (label == 0xF9) {
+                    pos_ += 2;
+                    delays.push_back(readUint16());
+                    pos_ -= 4;
+                }
+                skipSubBlocks();
+            } else if (type == 0x2C) {
+                unsigned int left = readUint16(), top = readUint16(), w = readUint16(), h = readUint16();
+                readByte();
+                std::vector<unsigned char> indices;
+                if (!decodeLzw(indices) || indices.size() != static_cast<size_t>(w) * h)
+                    return false;
+                for (unsigned int y = 0; y < h; ++y)
+                    for (unsigned int x = 0; x < w; ++x)
+                        canvas_[(top + y) * width_ + left + x] = indices[y * w + x];
+                frames.push_back(canvas_);
+                rects.push_back({left, top, w, h});
+            } else {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    RgbColor color(size_t frame, unsigned int x, unsigned int y) const {
+        unsigned int index = frames[frame][y * width_ + x];
+        return RgbColor::make_rgb(static_cast<int>(palette_[index * 3]), static_cast<int>(palette_[index * 3 + 1]),
+                                  static_cast<int>(palette_[index * 3 + 2]));
+    }
+
+    unsigned int width_ = 0, height_ = 0;
+    std::vector<std::vector<unsigned char>> frames;
+    std::vector<std::vector<unsigned int>> rects;
+    std::vector<unsigned int> delays;
+    int loopBlocks = 0;
+
+private:
+    unsigned int readByte() {
+        return static_cast<unsigned char>(data_[pos_++]);
+    }
+
+    unsigned int readUint16() {
+        unsigned int low = readByte();
+        return low | (readByte() << 8);
+    }
+
+    void skipSubBlocks() {
+        for (unsigned int size = readByte(); size != 0; size = readByte())
+            pos_ += size;
+    }
+
+    bool decodeLzw(std::vector<unsigned char> &output) {
+        unsigned int minCodeSize = readByte();
+        std::string bytes;
+        for (unsigned int size = readByte(); size != 0; size = readByte()) {
+            bytes += data_.substr(pos_, size);
+            pos_ += size;
+        }
+
+        unsigned int clearCode = 1u << minCodeSize, codeSize = minCodeSize + 1, next = clearCode + 2;
+        std::vector<std::vector<unsigned char>> table;
+        auto reset = [&] {
+            table.clear();
+            for (unsigned int i = 0; i < clearCode + 2; ++i)
+                table.push_back(std::vector<unsigned char>(1, static_cast<unsigned char>(i)));
+            codeSize = minCodeSize + 1;
+            next = clearCode + 2;
+        };
+        reset();
+
+        size_t bit = 0;
+        int previous = -1;
+        while (bit + codeSize <= bytes.size() * 8) {
+            unsigned int code = 0;
+            for (unsigned int i = 0; i < codeSize; ++i, ++bit)
+                code |= ((static_cast<unsigned char>(bytes[bit / 8]) >> (bit % 8)) & 1u) << i;
+            if (code == clearCode) {
+                reset();
+                previous = -1;
+                continue;
+            }
+            if (code == clearCode + 1)
+                return true;
+
+            std::vector<unsigned char> entry;
+            if (code < next)
+                entry = table[code];
+            else if (code == next && previous >= 0)
+                entry = table[static_cast<size_t>(previous)], entry.push_back(table[static_cast<size_t>(previous)][0]);
+            else
+                return false;
+            output.insert(output.end(), entry.begin(), entry.end());
+
+            if (previous >= 0 && next < 4096) {
+                std::vector<unsigned char> added = table[static_cast<size_t>(previous)];
+                added.push_back(entry[0]);
+                table.push_back(added);
+                if (++next == (1u << codeSize) && codeSize < 12)
+                    ++codeSize;
+            }
+            previous = static_cast<int>(code);
+        }
+        return false;
+    }
+
+    std::string data_;
+    size_t pos_ = 0;
+    std::vector<unsigned int> palette_;
+    std::vector<unsigned char> canvas_;
+};
+
+void drawChartFrame(RgbImage &image, int frame) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(255, 255, 255));
+    for (int x = 0; x < static_cast<int>(image.width()); ++x)
+        image.setPixel(Point(x, 40), RgbColor::make_rgb(0, 0, 0));
+    // moving bar
+    for (int y = 10; y < 30; ++y)
+        for (int x = 5 + frame * 3; x < 15 + frame * 3; ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(30, 120, 200));
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Lzw_RoundTripsLongData) {
+    // enough data to fill the code table several times
+    std::vector<unsigned char> indices;
+    unsigned int seed = 7;
+    for (int i = 0; i < 200000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        indices.push_back(static_cast<unsigned char>(i % 1000 < 500 ? (seed >> 16) % 16 : static_cast<unsigned int>(i / 40) % 16));
+    }
+
+    std::vector<unsigned char> encoded;
+    GifLzwEncoder().encode(indices.data(), indices.size(), 4, encoded);
+
+    // one frame of 400 x 500 pixels with 16 color table
+    std::vector<unsigned char> data = {'G', 'I', 'F', '8', '9', 'a', 0x90, 0x01, 0xF4, 0x01, 0xF3, 0, 0};
+    data.resize(data.size() + 16 * 3);
+    data.insert(data.end(), {0x2C, 0, 0, 0, 0, 0x90, 0x01, 0xF4, 0x01, 0, 4});
+    data.insert(data.end(), encoded.begin(), encoded.end());
+    data.push_back(0x3B);
+
+    GifDecoder decoder(std::string(data.begin(), data.end()));
+    UTEST_ASSERT_TRUE(decoder.decode());
+    UTEST_ASSERT_EQUALS(decoder.frames.size(), 1u);
+    UTEST_ASSERT_TRUE(decoder.frames[0] == indices);
+}
+
+UTEST_FUNC_DEF(Quantizer_KeepsExactColorsOfCharts) {
+    RgbImage image(64, 64);
+    drawChartFrame(image, 0);
+    bool exact = false;
+    std::vector<RgbColor> palette = MedianCutQuantizer::buildPalette(image, 256, &exact);
+    UTEST_ASSERT_TRUE(exact);
+    UTEST_ASSERT_EQUALS(palette.size(), 3u);
+}
+
+UTEST_FUNC_DEF(Quantizer_ReducesGradientToPalette) {
+    RgbImage image(256, 64);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 256; ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x, y * 4, 255 - x));
+
+    bool exact = true;
+    std::vector<RgbColor> palette = MedianCutQuantizer::buildPalette(image, 16, &exact);
+    UTEST_ASSERT_FALSE(exact);
+    UTEST_ASSERT_EQUALS(palette.size(), 16u);
+
+    // every pixel has a palette color near it
+    PaletteMapper mapper(palette);
+    int worst = 0;
+    for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 256; ++x) {
+            RgbColor color = palette[mapper.map(static_cast<unsigned char>(x), static_cast<unsigned char>(y * 4),
+                                                static_cast<unsigned char>(255 - x))];
+            worst = std::max(worst, std::abs(color.red - x) + std::abs(color.green - y * 4) + std::abs(color.blue - 255 + x));
+        }
+    }
+    UTEST_ASSERT_TRUE(worst < 160);
+}
+
+UTEST_FUNC_DEF(GifWriter_SingleFrameIsLossless) {
+    RgbImage image(50, 45);
+    drawChartFrame(image, 2);
+    std::ostringstream output;
+    {
+        GifImageWriter writer(output, 10, -1);
+        writer.writeImage(image);
+    }
+
+    GifDecoder decoder(output.str());
+    UTEST_ASSERT_TRUE(decoder.decode());
+    UTEST_ASSERT_EQUALS(decoder.frames.size(), 1u);
+    UTEST_ASSERT_EQUALS(decoder.loopBlocks, 0);
+    bool same = true;
+    for (unsigned int y = 0; y < 45; ++y)
+        for (unsigned int x = 0; x < 50; ++x)
+            same = same && decoder.color(0, x, y) == image.getPixel(Point(static_cast<int>(x), static_cast<int>(y)));
+    UTEST_ASSERT_TRUE(same);
+}
+
+UTEST_FUNC_DEF(GifWriter_AnimationEncodesChangedRectangles) {
+    std::ostringstream output;
+    RgbImage image(80, 50);
+    {
+        GifImageWriter writer(output, 5);
+        for (int frame = 0; frame < 10; ++frame) {
+            drawChartFrame(image, frame);
+            writer.writeImage(image);
+        }
+        drawChartFrame(image, 9);
+        writer.writeFrame(image, 100);
+        UTEST_ASSERT_EQUALS(writer.frameCount(), 11u);
+    }
+
+    GifDecoder decoder(output.str());
+    UTEST_ASSERT_TRUE(decoder.decode());
+    UTEST_ASSERT_EQUALS(decoder.frames.size(), 11u);
+    UTEST_ASSERT_EQUALS(decoder.loopBlocks, 1);
+    UTEST_ASSERT_EQUALS(decoder.delays[0], 5u);
+    UTEST_ASSERT_EQUALS(decoder.delays[10], 100u);
+
+    // bar moves by 3 pixels: changed rectangle covers old and new position only
+    std::vector<unsigned int> rect = {5 + 3 * 4, 10, 13, 20};
+    UTEST_ASSERT_TRUE(decoder.rects[5] == rect);
+    // nothing changed in the last frame
+    UTEST_ASSERT_EQUALS(decoder.rects[10][2] * decoder.rects[10][3], 1u);
+
+    bool same = true;
+    for (int frame = 0; frame < 10; ++frame) {
+        drawChartFrame(image, frame);
+        for (unsigned int y = 0; y < 50; ++y)
+            for (unsigned int x = 0; x < 80; ++x)
+                same = same && decoder.color(static_cast<size_t>(frame), x, y) ==
+                               image.getPixel(Point(static_cast<int>(x), static_cast<int>(y)));
+    }
+    UTEST_ASSERT_TRUE(same);
+}
+
+UTEST_FUNC_DEF(GifWriter_DitheredGradientUsesFixedPalette) {
+    RgbImage image(128, 32);
+    for (int y = 0; y < 32; ++y)
+        for (int x = 0; x < 128; ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x * 2, x * 2, x * 2));
+
+    std::vector<RgbColor> palette;
+    for (int i = 0; i < 4; ++i)
+        palette.push_back(RgbColor::make_rgb(i * 85, i * 85, i * 85));
+
+    std::ostringstream output;
+    {
+        GifImageWriter writer(output, 10, 0, true);
+        writer.setPalette(palette);
+        writer.writeImage(image);
+    }
+
+    GifDecoder decoder(output.str());
+    UTEST_ASSERT_TRUE(decoder.decode());
+    // dithering mixes neighbouring palette levels, average of a block stays close to source
+    int sum = 0;
+    for (unsigned int y = 0; y < 8; ++y)
+        for (unsigned int x = 40; x < 48; ++x)
+            sum += decoder.color(0, x, y).red;
+    int average = sum / 64;
+    UTEST_ASSERT_TRUE(average > 87 - 12 && average < 87 + 12);
+}
+
+UTEST_FUNC_DEF(GifWriter_RejectsOtherFrameSize) {
+    std::ostringstream output;
+    GifImageWriter writer(output);
+    RgbImage first(10, 10), second(12, 10);
+    writer.writeImage(first);
+    bool thrown = false;
+    try {
+        writer.writeImage(second);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Lzw_RoundTripsLongData);
+    UTEST_FUNC(Quantizer_KeepsExactColorsOfCharts);
+    UTEST_FUNC(Quantizer_ReducesGradientToPalette);
+    UTEST_FUNC(GifWriter_SingleFrameIsLossless);
+    UTEST_FUNC(GifWriter_AnimationEncodesChangedRectangles);
+    UTEST_FUNC(GifWriter_DitheredGradientUsesFixedPalette);
+    UTEST_FUNC(GifWriter_RejectsOtherFrameSize);
+
+    UTEST_EPILOG();
+}
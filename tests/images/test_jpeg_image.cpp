@@ -0,0 +1,384 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/image_view.h"
+#include "uimg/images/jpeg_image.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @file test_jpeg_image.cpp
+ * @brief Tests for baseline JPEG writer: DCT, decodability, restart strips and determinism
+ */
+
+namespace {
+
+// minimal baseline JPEG decoder (Huffman, restart intervals, any sampling factors, naive IDCT)
+class JpegDecoder {
+public:
+    explicit JpegDecoder(const std::string &data) : data_(data) {}
+
+    bool decode() {
+        if (byteAt(0) != 0xFF || byteAt(1) != 0xD8)
+            return false;
+        size_t pos = 2;
+        while (pos + 4 <= data_.size()) {
+            if (byteAt(pos) != 0xFF)
+                return false;
+            unsigned int marker = byteAt(pos + 1);
+            size_t length = (byteAt(pos + 2) << 8) | byteAt(pos + 3);
+            size_t segment = pos + 4, end = pos + 2 + length;
+            if (marker == 0xDB) {
+                for (size_t p = segment; p < end; p += 65)
+                    for (unsigned int i = 0; i < 64; ++i)
+                        quant_[byteAt(p) & 3][JpegFormat::ZIGZAG[i]] = byteAt(p + 1 + i);
+            } else if (marker == 0xC0) {
+                height = (byteAt(segment + 1) << 8) | byteAt(segment + 2);
+                width = (byteAt(segment + 3) << 8) | byteAt(segment + 4);
+                for (unsigned int c = 0; c < byteAt(segment + 5); ++c) {
+                    Component component;
+                    component.h = byteAt(segment + 7 + c * 3) >> 4;
+                    component.v = byteAt(segment + 7 + c * 3) & 15;
+                    component.quant = byteAt(segment + 8 + c * 3);
+                    components_.push_back(component);
+                }
+            } else if (marker == 0xC4) {
+                for (size_t p = segment; p < end;) {
+                    Huffman &table = huffman_[byteAt(p) >> 4][byteAt(p) & 3];
+                    unsigned int count = 0;
+                    for (unsigned int i = 0; i < 16; ++i)
+                        count += table.bits[i] = byteAt(p + 1 + i);
+                    table.values.clear();
+                    for (unsigned int i = 0; i < count; ++i)
+                        table.values.push_back(byteAt(p + 17 + i));
+                    p += 17 + count;
+                }
+            } else if (marker == 0xDD) {
+                restartInterval = (byteAt(segment) << 8) | byteAt(segment + 1);
+            } else if (marker == 0xDA) {
+                for (unsigned int c = 0; c < byteAt(segment); ++c) {
+                    components_[c].dcTable = byteAt(segment + 2 + c * 2) >> 4;
+                    components_[c].acTable = byteAt(segment + 2 + c * 2) & 15;
+                }
+                return decodeScan(end);
+            } else if (marker != 0xE0) {
+                return false;
+            }
+            pos = end;
+        }
+        return false;
+    }
+
+    RgbColor pixel(unsigned int x, unsigned int y) const {
+        return rgb_[y * width + x];
+    }
+
+    unsigned int width = 0, height = 0, restartInterval = 0, restartMarkers = 0;
+
+private:
+    struct Component {
+        unsigned int h = 1, v = 1, quant = 0, dcTable = 0, acTable = 0;
+        int predictor = 0;
+        std::vector<double> plane;
+        size_t stride = 0;
+    };
+
+    struct Huffman {
+        unsigned int bits[16];
+        std::vector<unsigned int> values;
+    };
+
+    unsigned int byteAt(size_t pos) const {
+        return static_cast<unsigned char>(data_[pos]);
+    }
+
+    unsigned int readBit() {
+        if (bitPos_ >= segment_.size() * 8)
+            return 1;
+        unsigned int bit = (static_cast<unsigned char>(segment_[bitPos_ / 8]) >> (7 - bitPos_ % 8)) & 1u;
+        ++bitPos_;
+        return bit;
+    }
+
+    int receive(unsigned int size) {
+        int value = 0;
+        for (unsigned int i = 0; i < size; ++i)
+            value = (value << 1) | static_cast<int>(readBit());
+        return size > 0 && value < (1 << (size - 1)) ? value - (1 << size) + 1 : value;
+    }
+
+    unsigned int decodeSymbol(const Huffman &table) {
+        int code = 0, first = 0;
+        size_t index = 0;
+        for (unsigned int length = 0; length < 16; ++length) {
+            code = (code << 1) | static_cast<int>(readBit());
+            int count = static_cast<int>(table.bits[length]);
+            if (code - first < count)
+                return table.values[index + static_cast<size_t>(code - first)];
+            index += static_cast<size_t>(count);
+            first = (first + count) << 1;
+        }
+        return 0;
+    }
+
+    // splits entropy coded data on restart markers and removes stuffing
+    std::vector<std::string> segments(size_t pos) {
+        std::vector<std::string> result(1);
+        while (pos < data_.size()) {
+            unsigned int byte = byteAt(pos++);
+            if (byte != 0xFF) {
+                result.back().push_back(static_cast<char>(byte));
+                continue;
+            }
+            unsigned int next = byteAt(pos++);
+            if (next == 0x00) {
+                result.back().push_back(static_cast<char>(0xFF));
+            } else if (next >= 0xD0 && next <= 0xD7) {
+                if (next - 0xD0 != restartMarkers % 8)
+                    return std::vector<std::string>();
+                ++restartMarkers;
+                result.push_back(std::string());
+            } else {
+                break;
+            }
+        }
+        return result;
+    }
+
+    bool decodeScan(size_t pos) {
+        unsigned int hMax = 1, vMax = 1;
+        for (const Component &c : components_) {
+            hMax = std::max(hMax, c.h);
+            vMax = std::max(vMax, c.v);
+        }
+        unsigned int mcusX = (width + 8 * hMax - 1) / (8 * hMax), mcusY = (height + 8 * vMax - 1) / (8 * vMax);
+        for (Component &c : components_) {
+            c.stride = mcusX * c.h * 8;
+            c.plane.assign(c.stride * mcusY * c.v * 8, 0.0);
+        }
+
+        std::vector<std::string> parts = segments(pos);
+        unsigned int mcuCount = mcusX * mcusY, perSegment = restartInterval ? restartInterval : mcuCount;
+        if (parts.size() != (mcuCount + perSegment - 1) / perSegment)
+            return false;
+
+        for (unsigned int mcu = 0; mcu < mcuCount; ++mcu) {
+            if (mcu % perSegment == 0) {
+                segment_ = parts[mcu / perSegment];
+                bitPos_ = 0;
+                for (Component &c : components_)
+                    c.predictor = 0;
+            }
+            unsigned int mx = mcu % mcusX, my = mcu / mcusX;
+            for (Component &c : components_)
+                for (unsigned int by = 0; by < c.v; ++by)
+                    for (unsigned int bx = 0; bx < c.h; ++bx)
+                        decodeBlock(c, (mx * c.h + bx) * 8, (my * c.v + by) * 8);
+        }
+
+        rgb_.resize(static_cast<size_t>(width) * height);
+        for (unsigned int y = 0; y < height; ++y) {
+            for (unsigned int x = 0; x < width; ++x) {
+                double yuv[3];
+                for (size_t i = 0; i < 3; ++i) {
+                    const Component &c = components_[i];
+                    yuv[i] = c.plane[(y * c.v / vMax) * c.stride + x * c.h / hMax];
+                }
+                rgb_[y * width + x] = RgbColor::make_rgb(clamp(yuv[0] + 1.402 * (yuv[2] - 128)),
+                                                         clamp(yuv[0] - 0.344136 * (yuv[1] - 128) - 0.714136 * (yuv[2] - 128)),
+                                                         clamp(yuv[0] + 1.772 * (yuv[1] - 128)));
+            }
+        }
+        return true;
+    }
+
+    static int clamp(double value) {
+        return static_cast<int>(std::min(255.0, std::max(0.0, std::floor(value + 0.5))));
+    }
+
+    void decodeBlock(Component &c, size_t left, size_t top) {
+        double coefficients[64] = {0};
+        c.predictor += receive(decodeSymbol(huffman_[0][c.dcTable]));
+        coefficients[0] = c.predictor * static_cast<int>(quant_[c.quant][0]);
+        for (unsigned int k = 1; k < 64;) {
+            unsigned int symbol = decodeSymbol(huffman_[1][c.acTable]);
+            unsigned int run = symbol >> 4, size = symbol & 15;
+            if (size == 0) {
+                if (run != 15)
+                    break;
+                k += 16;
+                continue;
+            }
+            k += run;
+            if (k > 63)
+                break;
+            unsigned int natural = JpegFormat::ZIGZAG[k++];
+            coefficients[natural] = receive(size) * static_cast<int>(quant_[c.quant][natural]);
+        }
+
+        const double pi = 3.14159265358979323846;
+        for (unsigned int y = 0; y < 8; ++y) {
+            for (unsigned int x = 0; x < 8; ++x) {
+                double sum = 0;
+                for (unsigned int v = 0; v < 8; ++v)
+                    for (unsigned int u = 0; u < 8; ++u)
+                        sum += (u ? 1.0 : std::sqrt(0.5)) * (v ? 1.0 : std::sqrt(0.5)) * coefficients[v * 8 + u] *
+                               std::cos((2 * x + 1) * u * pi / 16) * std::cos((2 * y + 1) * v * pi / 16);
+                c.plane[(top + y) * c.stride + left + x] = sum / 4 + 128;
+            }
+        }
+    }
+
+    std::string data_;
+    unsigned int quant_[4][64] = {};
+    Huffman huffman_[2][4];
+    std::vector<Component> components_;
+    std::string segment_;
+    size_t bitPos_ = 0;
+    std::vector<RgbColor> rgb_;
+};
+
+void fillSmooth(RgbImage &image) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x * 255 / static_cast<int>(image.width()),
+                                                           y * 255 / static_cast<int>(image.height()),
+                                                           static_cast<int>(128 + 100 * std::sin(x * 0.05 + y * 0.03))));
+}
+
+std::string encode(RgbImage &image, unsigned int quality = 90, bool subsampling = true, unsigned int threads = 1) {
+    std::ostringstream output;
+    JpegImageWriter(output, quality, subsampling, threads).writeImage(image);
+    return output.str();
+}
+
+// mean absolute error of all channels
+double meanError(const RgbImage &image, const JpegDecoder &decoder) {
+    double sum = 0;
+    for (unsigned int y = 0; y < image.height(); ++y)
+        for (unsigned int x = 0; x < image.width(); ++x) {
+            RgbColor a = image.getPixel(Point(static_cast<int>(x), static_cast<int>(y))), b = decoder.pixel(x, y);
+            sum += std::abs(a.red - b.red) + std::abs(a.green - b.green) + std::abs(a.blue - b.blue);
+        }
+    return sum / (3.0 * image.width() * image.height());
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Dct_MatchesReference) {
+    int32_t block[64];
+    double source[64];
+    for (int i = 0; i < 64; ++i)
+        block[i] = static_cast<int32_t>(source[i] = ((i * 37) % 255) - 128);
+    JpegFormat::forwardDct(block);
+
+    const double pi = 3.14159265358979323846;
+    double worst = 0;
+    for (int v = 0; v < 8; ++v)
+        for (int u = 0; u < 8; ++u) {
+            double sum = 0;
+            for (int y = 0; y < 8; ++y)
+                for (int x = 0; x < 8; ++x)
+                    sum += source[y * 8 + x] * std::cos((2 * x + 1) * u * pi / 16) * std::cos((2 * y + 1) * v * pi / 16);
+            sum *= (u ? 1.0 : std::sqrt(0.5)) * (v ? 1.0 : std::sqrt(0.5)) / 4;
+            double scaled = block[u * 8 + v] / (JpegFormat::OUTPUT_SCALE * JpegFormat::AAN_SCALE[u] * JpegFormat::AAN_SCALE[v]);
+            worst = std::max(worst, std::abs(scaled - sum));
+        }
+    // fixed point rounding stays well below one quantization step
+    UTEST_ASSERT_TRUE(worst < 0.5);
+}
+
+UTEST_FUNC_DEF(Writer_SubsampledImageDecodes) {
+    RgbImage image(100, 70);
+    fillSmooth(image);
+    JpegDecoder decoder(encode(image));
+    UTEST_ASSERT_TRUE(decoder.decode());
+    UTEST_ASSERT_EQUALS(decoder.width, 100u);
+    UTEST_ASSERT_EQUALS(decoder.height, 70u);
+    // one strip of 16 rows per restart interval
+    UTEST_ASSERT_EQUALS(decoder.restartInterval, 7u);
+    UTEST_ASSERT_EQUALS(decoder.restartMarkers, 4u);
+    UTEST_ASSERT_TRUE(meanError(image, decoder) < 3.0);
+}
+
+UTEST_FUNC_DEF(Writer_FullChromaOddSizeDecodes) {
+    RgbImage image(37, 23);
+    fillSmooth(image);
+    image.setPixel(Point(36, 22), RgbColor::make_rgb(255, 0, 0));
+    JpegDecoder decoder(encode(image, 95, false));
+    UTEST_ASSERT_TRUE(decoder.decode());
+    UTEST_ASSERT_EQUALS(decoder.restartMarkers, 2u);
+    UTEST_ASSERT_TRUE(meanError(image, decoder) < 2.0);
+    UTEST_ASSERT_TRUE(decoder.pixel(36, 22).red > 150);
+}
+
+UTEST_FUNC_DEF(Writer_NoiseWithStuffedBytesDecodes) {
+    RgbImage image(64, 48);
+    unsigned int seed = 11;
+    for (int y = 0; y < 48; ++y)
+        for (int x = 0; x < 64; ++x) {
+            seed = seed * 1103515245u + 12345u;
+            image.setPixel(Point(x, y), RgbColor::make_rgb(static_cast<int>(seed >> 24), static_cast<int>((seed >> 16) & 0xFF), 255));
+        }
+    std::string data = encode(image, 100, false);
+    UTEST_ASSERT_TRUE(data.find(std::string("\xFF\x00", 2)) != std::string::npos);
+    JpegDecoder decoder(data);
+    UTEST_ASSERT_TRUE(decoder.decode());
+    UTEST_ASSERT_TRUE(meanError(image, decoder) < 4.0);
+}
+
+UTEST_FUNC_DEF(Writer_OutputIndependentOfThreadsAndBands) {
+    RgbImage image(300, 150);
+    fillSmooth(image);
+    std::string reference = encode(image, 85, true, 1);
+    UTEST_ASSERT_TRUE(encode(image, 85, true, 4) == reference);
+
+    std::ostringstream banded;
+    JpegImageWriter writer(banded, 85, true, 3);
+    writer.beginImage(300, 150);
+    for (int top = 0; top < 150; top += 25)
+        writer.writeRows(ImageView(image, Point(0, top), Point(300, 25)));
+    writer.endImage();
+    UTEST_ASSERT_TRUE(banded.str() == reference);
+}
+
+UTEST_FUNC_DEF(Writer_QualityControlsSize) {
+    RgbImage image(128, 128);
+    fillSmooth(image);
+    UTEST_ASSERT_TRUE(encode(image, 30).size() < encode(image, 95).size());
+
+    UTEST_ASSERT_TRUE(encode(image, 85).size() * 10 < 128u * 128 * 3);
+}
+
+UTEST_FUNC_DEF(Writer_RejectsIncompleteImage) {
+    std::ostringstream output;
+    JpegImageWriter writer(output, 85, true, 1);
+    RgbImage image(16, 8);
+    writer.beginImage(16, 16);
+    writer.writeRows(image);
+    bool thrown = false;
+    try {
+        writer.endImage();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Dct_MatchesReference);
+    UTEST_FUNC(Writer_SubsampledImageDecodes);
+    UTEST_FUNC(Writer_FullChromaOddSizeDecodes);
+    UTEST_FUNC(Writer_NoiseWithStuffedBytesDecodes);
+    UTEST_FUNC(Writer_OutputIndependentOfThreadsAndBands);
+    UTEST_FUNC(Writer_QualityControlsSize);
+    UTEST_FUNC(Writer_RejectsIncompleteImage);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,287 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/images/gray_image.h"
+#include "uimg/images/mask_image.h"
+#include "uimg/images/image_view.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/filters/filter_for_pixels.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+/**
+ * @file test_netpbm_image.cpp
+ * @brief Tests for grayscale and mask containers and for PGM / PBM / PAM writers and Netpbm loader
+ */
+
+namespace {
+
+// non-seekable input, like a pipe
+class NonSeekableBuf : public std::stringbuf {
+public:
+    explicit NonSeekableBuf(const std::string &data) : std::stringbuf(data) {}
+
+protected:
+    virtual pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) {
+        return pos_type(off_type(-1));
+    }
+};
+
+void fillGray(GrayImage &image) {
+    for (unsigned int y = 0; y < image.height(); ++y)
+        for (unsigned int x = 0; x < image.width(); ++x)
+            image.row(y)[x] = static_cast<uint8_t>(x * 5 + y * 3);
+}
+
+void fillMask(MaskImage &image) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.set(Point(x, y), (x * x + y * y) % 7 < 3);
+}
+
+template<typename Image>
+PixelImageBase *loadFrom(const std::string &data, NetpbmImageLoader::Header *header = nullptr) {
+    std::istringstream input(data);
+    NetpbmImageLoader loader(input);
+    PixelImageBase *result = loader.loadImage();
+    if (header)
+        *header = loader.header();
+    return dynamic_cast<Image *>(result) ? result : nullptr;
+}
+
+bool samePixels(const PixelImageBase &a, const PixelImageBase &b) {
+    if (a.width() != b.width() || a.height() != b.height())
+        return false;
+    for (int y = 0; y < static_cast<int>(a.height()); ++y)
+        for (int x = 0; x < static_cast<int>(a.width()); ++x)
+            if (a.getPixel(Point(x, y)) != b.getPixel(Point(x, y)))
+                return false;
+    return true;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(GrayImage_StoresLuminance) {
+    GrayImage image(10, 4);
+    image.setPixel(Point(1, 1), RgbColor::make_rgb(255, 255, 255));
+    image.setPixel(Point(2, 1), RgbColor::make_rgb(255, 0, 0));
+    UTEST_ASSERT_EQUALS(static_cast<int>(image.value(Point(1, 1))), 255);
+    UTEST_ASSERT_EQUALS(static_cast<int>(image.value(Point(2, 1))), 77);
+    UTEST_ASSERT_TRUE(image.getPixel(Point(2, 1)) == RgbColor::make_rgb(77, 77, 77));
+    UTEST_ASSERT_EQUALS(static_cast<int>(image.value(Point(-1, 0))), 0);
+
+    GrayImage16 wide(3, 3);
+    wide.setPixel(Point(0, 0), RgbColor::make_rgb(255, 255, 255));
+    wide.setValue(Point(1, 0), 0x1234);
+    UTEST_ASSERT_EQUALS(static_cast<int>(wide.value(Point(0, 0))), 65535);
+    UTEST_ASSERT_EQUALS(static_cast<int>(wide.getPixel(Point(1, 0)).red), 0x12);
+}
+
+UTEST_FUNC_DEF(MaskImage_PacksBits) {
+    MaskImage mask(19, 3);
+    UTEST_ASSERT_EQUALS(mask.stride(), 3u);
+    mask.set(Point(0, 0), true);
+    mask.set(Point(9, 0), true);
+    mask.setPixel(Point(18, 2), RgbColor::make_rgb(10, 10, 10));
+    mask.setPixel(Point(17, 2), RgbColor::make_rgb(250, 250, 250));
+
+    UTEST_ASSERT_EQUALS(static_cast<int>(mask.row(0)[0]), 0x80);
+    UTEST_ASSERT_EQUALS(static_cast<int>(mask.row(0)[1]), 0x40);
+    UTEST_ASSERT_TRUE(mask.get(Point(18, 2)));
+    UTEST_ASSERT_FALSE(mask.get(Point(17, 2)));
+    UTEST_ASSERT_EQUALS(mask.count(), 3u);
+    UTEST_ASSERT_TRUE(mask.getPixel(Point(9, 0)) == RgbColor::make_rgb(0, 0, 0));
+
+    // mask as source of mask filter: only pixels with set bits are painted
+    RgbImage image(19, 3);
+    PixelPainterForRgbImage painter(image);
+    MaskEqFilter filter(painter, mask, RgbColor::make_rgb(0, 0, 0));
+    for (unsigned int x = 0; x < 19; ++x)
+        filter.putPixel(x, 0, RgbColor::make_rgb(255, 0, 0));
+    UTEST_ASSERT_TRUE(image.getPixel(Point(9, 0)) == RgbColor::make_rgb(255, 0, 0));
+    UTEST_ASSERT_TRUE(image.getPixel(Point(8, 0)) == RgbColor::make_rgb(0, 0, 0));
+}
+
+UTEST_FUNC_DEF(Pgm_RoundTrip8And16Bit) {
+    GrayImage gray(37, 11);
+    fillGray(gray);
+    std::ostringstream output;
+    PgmImageWriter(output).writeImage(gray);
+    UTEST_ASSERT_EQUALS(output.str().size(), std::string("P5\n37 11\n255\n").size() + 37 * 11);
+
+    std::unique_ptr<PixelImageBase> loaded(loadFrom<GrayImage>(output.str()));
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+    UTEST_ASSERT_TRUE(samePixels(gray, *loaded));
+
+    GrayImage16 wide(20, 5);
+    for (int y = 0; y < 5; ++y)
+        for (int x = 0; x < 20; ++x)
+            wide.setValue(Point(x, y), static_cast<uint16_t>(x * 3000 + y * 7));
+    std::ostringstream wideOutput;
+    PgmImageWriter(wideOutput).writeImage(wide);
+
+    NetpbmImageLoader::Header header;
+    std::unique_ptr<PixelImageBase> wideLoaded(loadFrom<GrayImage16>(wideOutput.str(), &header));
+    UTEST_ASSERT_TRUE(wideLoaded.get() != nullptr);
+    UTEST_ASSERT_EQUALS(header.maxValue, 65535u);
+    GrayImage16 &result = static_cast<GrayImage16 &>(*wideLoaded);
+    UTEST_ASSERT_EQUALS(static_cast<int>(result.value(Point(19, 4))), 19 * 3000 + 4 * 7);
+    UTEST_ASSERT_EQUALS(static_cast<int>(result.value(Point(1, 0))), 3000);
+}
+
+UTEST_FUNC_DEF(Pgm_FromRgbImageUsesLuminance) {
+    RgbImage image(4, 1);
+    image.setPixel(Point(0, 0), RgbColor::make_rgb(0, 255, 0));
+    std::ostringstream output;
+    PgmImageWriter(output).writeImage(image);
+
+    std::unique_ptr<PixelImageBase> loaded(loadFrom<GrayImage>(output.str()));
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+    UTEST_ASSERT_EQUALS(static_cast<int>(static_cast<GrayImage &>(*loaded).value(Point(0, 0))), 149);
+}
+
+UTEST_FUNC_DEF(Pbm_RoundTripIsBitPacked) {
+    MaskImage mask(45, 13);
+    fillMask(mask);
+    std::ostringstream output;
+    PbmImageWriter(output).writeImage(mask);
+    UTEST_ASSERT_EQUALS(output.str().size(), std::string("P4\n45 13\n").size() + 6 * 13);
+
+    std::unique_ptr<PixelImageBase> loaded(loadFrom<MaskImage>(output.str()));
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+    UTEST_ASSERT_TRUE(samePixels(mask, *loaded));
+
+    // any image can be written as PBM, dark pixels become set bits
+    std::ostringstream converted;
+    RgbImage rgb(45, 13);
+    for (int y = 0; y < 13; ++y)
+        for (int x = 0; x < 45; ++x)
+            rgb.setPixel(Point(x, y), mask.getPixel(Point(x, y)));
+    PbmImageWriter(converted).writeImage(rgb);
+    UTEST_ASSERT_TRUE(converted.str() == output.str());
+}
+
+UTEST_FUNC_DEF(Pam_RoundTripKeepsAlpha) {
+    RgbaImage image(16, 6);
+    for (int y = 0; y < 6; ++y)
+        for (int x = 0; x < 16; ++x)
+            image.setPixelRgba(Point(x, y), RgbaColor{static_cast<unsigned char>(x * 16), 80, static_cast<unsigned char>(y * 40),
+                                                      static_cast<unsigned char>(x * 17)});
+    std::ostringstream output;
+    PamImageWriter(output).writeImage(image);
+    UTEST_ASSERT_TRUE(output.str().find("TUPLTYPE RGB_ALPHA\n") != std::string::npos);
+
+    NetpbmImageLoader::Header header;
+    std::unique_ptr<PixelImageBase> loaded(loadFrom<RgbaImage>(output.str(), &header));
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+    UTEST_ASSERT_EQUALS(header.depth, 4u);
+
+    bool same = true;
+    RgbaImage &result = static_cast<RgbaImage &>(*loaded);
+    for (int y = 0; y < 6; ++y)
+        for (int x = 0; x < 16; ++x)
+            same = same && !(result.getPremultipliedPixel(Point(x, y)) != image.getPremultipliedPixel(Point(x, y)));
+    UTEST_ASSERT_TRUE(same);
+
+    // RGB images are written without alpha
+    RgbImage rgb(5, 2);
+    rgb.setPixel(Point(4, 1), RgbColor::make_rgb(1, 2, 3));
+    std::ostringstream rgbOutput;
+    PamImageWriter(rgbOutput).writeImage(rgb);
+    std::unique_ptr<PixelImageBase> rgbLoaded(loadFrom<RgbImage>(rgbOutput.str()));
+    UTEST_ASSERT_TRUE(rgbLoaded.get() != nullptr);
+    UTEST_ASSERT_TRUE(samePixels(rgb, *rgbLoaded));
+}
+
+UTEST_FUNC_DEF(Loader_ReadsPartsOfAllFormats) {
+    GrayImage gray(40, 30);
+    fillGray(gray);
+    MaskImage mask(40, 30);
+    fillMask(mask);
+
+    std::ostringstream pgm, pbm, ppm;
+    PgmImageWriter(pgm).writeImage(gray);
+    PbmImageWriter(pbm).writeImage(mask);
+    RgbImage rgb(40, 30);
+    for (int y = 0; y < 30; ++y)
+        for (int x = 0; x < 40; ++x)
+            rgb.setPixel(Point(x, y), RgbColor::make_rgb(x * 6, y * 8, x + y));
+    PpmImageWriter(ppm).writeImage(rgb);
+
+    struct Case {
+        std::string data;
+        const PixelImageBase *source;
+    } cases[] = {{pgm.str(), &gray}, {pbm.str(), &mask}, {ppm.str(), &rgb}};
+
+    Rect part;
+    part.topLeft(Point(3, 7)).size(Point(21, 9));
+    for (const Case &item : cases) {
+        for (int seekable = 0; seekable < 2; ++seekable) {
+            NonSeekableBuf buffer(item.data);
+            std::istream pipe(&buffer);
+            std::istringstream stream(item.data);
+            NetpbmImageLoader loader(seekable ? static_cast<std::istream &>(stream) : pipe);
+
+            RgbImage target(30, 20);
+            UTEST_ASSERT_TRUE(loader.loadImagePartInto(target, part, Point(2, 1)));
+
+            bool same = true;
+            for (int y = 0; y < 9; ++y)
+                for (int x = 0; x < 21; ++x)
+                    same = same && target.getPixel(Point(x + 2, y + 1)) == item.source->getPixel(Point(x + 3, y + 7));
+            same = same && target.getPixel(Point(1, 1)) == RgbColor::make_rgb(0, 0, 0);
+            UTEST_ASSERT_TRUE(same);
+        }
+    }
+}
+
+UTEST_FUNC_DEF(Loader_ParsesCommentsAndRescales) {
+    std::string data = "P5\n# comment\n3 # width\n1\n15\n";
+    data += std::string("\x00\x0F\x07", 3);
+    std::unique_ptr<PixelImageBase> loaded(loadFrom<GrayImage>(data));
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+    GrayImage &gray = static_cast<GrayImage &>(*loaded);
+    UTEST_ASSERT_EQUALS(static_cast<int>(gray.value(Point(1, 0))), 255);
+    UTEST_ASSERT_EQUALS(static_cast<int>(gray.value(Point(2, 0))), 119);
+
+    std::unique_ptr<PixelImageBase> invalid(loadFrom<GrayImage>("P3\n1 1\n255\n0 0 0\n"));
+    UTEST_ASSERT_TRUE(invalid.get() == nullptr);
+}
+
+UTEST_FUNC_DEF(StreamWriters_EqualWholeImageWrite) {
+    GrayImage gray(23, 17);
+    fillGray(gray);
+    RgbImage rgb(23, 17);
+    for (int y = 0; y < 17; ++y)
+        for (int x = 0; x < 23; ++x)
+            rgb.setPixel(Point(x, y), gray.getPixel(Point(x, y)));
+
+    std::ostringstream whole, banded;
+    PgmImageWriter(whole).writeImage(gray);
+    PgmImageWriter writer(banded);
+    writer.beginImage(23, 17);
+    writer.writeRows(ImageView(rgb, Point(0, 0), Point(23, 10)));
+    writer.writeRows(ImageView(rgb, Point(0, 10), Point(23, 7)));
+    writer.endImage();
+    UTEST_ASSERT_TRUE(banded.str() == whole.str());
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(GrayImage_StoresLuminance);
+    UTEST_FUNC(MaskImage_PacksBits);
+    UTEST_FUNC(Pgm_RoundTrip8And16Bit);
+    UTEST_FUNC(Pgm_FromRgbImageUsesLuminance);
+    UTEST_FUNC(Pbm_RoundTripIsBitPacked);
+    UTEST_FUNC(Pam_RoundTripKeepsAlpha);
+    UTEST_FUNC(Loader_ReadsPartsOfAllFormats);
+    UTEST_FUNC(Loader_ParsesCommentsAndRescales);
+    UTEST_FUNC(StreamWriters_EqualWholeImageWrite);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,463 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/image_view.h"
+#include "uimg/images/png_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/utils/checksum.h"
+#include "uimg/utils/deflate.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @file test_png_image.cpp
+ * @brief Tests for checksums, deflate encoder and PNG writer (output is decoded with a minimal inflater)
+ */
+
+namespace {
+
+typedef std::vector<unsigned char> Bytes;
+
+// Minimal deflate decoder (RFC 1951) used to verify encoder output, throws std::runtime_error on invalid data.
+class Inflater {
+public:
+    static Bytes inflate(const unsigned char *data, size_t size) {
+        Inflater inflater(data, size);
+        Bytes output;
+        bool last;
+        do {
+            last = inflater.bits(1) != 0;
+            unsigned int type = inflater.bits(2);
+            if (type == 0)
+                inflater.stored(output);
+            else if (type == 1)
+                inflater.fixed(output);
+            else if (type == 2)
+                inflater.dynamic(output);
+            else
+                throw std::runtime_error("invalid block type");
+        } while (!last);
+        return output;
+    }
+
+private:
+    struct Huffman {
+        std::vector<unsigned int> counts;
+        std::vector<unsigned int> symbols;
+    };
+
+    Inflater(const unsigned char *data, size_t size) : data_(data), size_(size), pos_(0), bitBuffer_(0), bitCount_(0) {}
+
+    unsigned int bits(unsigned int count) {
+        while (bitCount_ < count) {
+            if (pos_ >= size_)
+                throw std::runtime_error("unexpected end of data");
+            bitBuffer_ |= static_cast<uint32_t>(data_[pos_++]) << bitCount_;
+            bitCount_ += 8;
+        }
+        unsigned int value = bitBuffer_ & ((1u << count) - 1u);
+        bitBuffer_ >>= count;
+        bitCount_ -= count;
+        return value;
+    }
+
+    static Huffman build(const unsigned char *lengths, size_t count) {
+        Huffman result;
+        result.counts.assign(16, 0);
+        for (size_t i = 0; i < count; ++i)
+            ++result.counts[lengths[i]];
+        std::vector<unsigned int> offsets(16, 0);
+        for (size_t length = 1; length < 15; ++length)
+            offsets[length + 1] = offsets[length] + result.counts[length];
+        result.symbols.assign(count, 0);
+        for (size_t i = 0; i < count; ++i)
+            if (lengths[i] != 0)
+                result.symbols[offsets[lengths[i]]++] = static_cast<unsigned int>(i);
+        return result;
+    }
+
+    unsigned int decode(const Huffman &huffman) {
+        int code = 0, first = 0, index = 0;
+        for (size_t length = 1; length <= 15; ++length) {
+            code |= static_cast<int>(bits(1));
+            int count = static_cast<int>(huffman.counts[length]);
+            if (code - count < first)
+                return huffman.symbols[static_cast<size_t>(index + (code - first))];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        throw std::runtime_error("invalid Huffman code");
+    }
+
+    void stored(Bytes &output) {
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+        if (pos_ + 4 > size_)
+            throw std::runtime_error("unexpected end of data");
+        unsigned int length = data_[pos_] | (static_cast<unsigned int>(data_[pos_ + 1]) << 8);
+        unsigned int check = data_[pos_ + 2] | (static_cast<unsigned int>(data_[pos_ + 3]) << 8);
+        pos_ += 4;
+        if ((length ^ 0xFFFFu) != check || pos_ + length > size_)
+            throw std::runtime_error("invalid stored block");
+        output.insert(output.end(), data_ + pos_, data_ + pos_ + length);
+        pos_ += length;
+    }
+
+    void fixed(Bytes &output) {
+        unsigned char lengths[288 + 30];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        memset(lengths + 288, 5, 30);
+        codes(build(lengths, 288), build(lengths + 288, 30), output);
+    }
+
+    void dynamic(Bytes &output) {
+        static const unsigned char ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        unsigned int literalCount = bits(5) + 257;
+        unsigned int distanceCount = bits(5) + 1;
+        unsigned int codeCount = bits(4) + 4;
+
+        unsigned char codeLengths[19] = {0};
+        for (unsigned int i = 0; i < codeCount; ++i)
+            codeLengths[ORDER[i]] = static_cast<unsigned char>(bits(3));
+        Huffman lengthCode = build(codeLengths, 19);
+
+        std::vector<unsigned char> lengths;
+        while (lengths.size() < literalCount + distanceCount) {
+            unsigned int symbol = decode(lengthCode);
+            if (symbol < 16) {
+                lengths.push_back(static_cast<unsigned char>(symbol));
+            } else if (symbol == 16) {
+                if (lengths.empty())
+                    throw std::runtime_error("repeat without previous length");
+                lengths.insert(lengths.end(), 3 + bits(2), lengths.back());
+            } else {
+                lengths.insert(lengths.end(), symbol == 17 ? 3 + bits(3) : 11 + bits(7), 0);
+            }
+        }
+        if (lengths.size() != literalCount + distanceCount)
+            throw std::runtime_error("too many code lengths");
+
+        codes(build(lengths.data(), literalCount), build(lengths.data() + literalCount, distanceCount), output);
+    }
+
+    void codes(const Huffman &literals, const Huffman &distances, Bytes &output) {
+        static const unsigned int LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43,
+                                                     51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const unsigned int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4,
+                                                      4, 4, 4, 5, 5, 5, 5, 0};
+        static const unsigned int DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257,
+                                                       385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289,
+                                                       16385, 24577};
+        static const unsigned int DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9,
+                                                        9, 10, 10, 11, 11, 12, 12, 13, 13};
+        for (;;) {
+            unsigned int symbol = decode(literals);
+            if (symbol < 256) {
+                output.push_back(static_cast<unsigned char>(symbol));
+            } else if (symbol == 256) {
+                return;
+            } else {
+                symbol -= 257;
+                if (symbol >= 29)
+                    throw std::runtime_error("invalid length symbol");
+                unsigned int length = LENGTH_BASE[symbol] + bits(LENGTH_EXTRA[symbol]);
+                unsigned int distanceSymbol = decode(distances);
+                if (distanceSymbol >= 30)
+                    throw std::runtime_error("invalid distance symbol");
+                size_t distance = DISTANCE_BASE[distanceSymbol] + bits(DISTANCE_EXTRA[distanceSymbol]);
+                if (distance > output.size())
+                    throw std::runtime_error("distance too far back");
+                for (unsigned int i = 0; i < length; ++i)
+                    output.push_back(output[output.size() - distance]);
+            }
+        }
+    }
+
+    const unsigned char *data_;
+    size_t size_;
+    size_t pos_;
+    uint32_t bitBuffer_;
+    unsigned int bitCount_;
+};
+
+uint32_t readUint32(const unsigned char *data) {
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+// decodes PNG produced by PngImageWriter (8-bit RGB) into packed RGB rows, checks chunk CRCs and zlib checksum
+Bytes decodePng(const std::string &png, unsigned int &width, unsigned int &height) {
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(png.data());
+    static const unsigned char SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (png.size() < 8 || memcmp(data, SIGNATURE, 8) != 0)
+        throw std::runtime_error("invalid signature");
+
+    Bytes zlib;
+    bool ended = false;
+    for (size_t pos = 8; pos < png.size();) {
+        uint32_t length = readUint32(data + pos);
+        const unsigned char *type = data + pos + 4;
+        const unsigned char *content = type + 4;
+        if (readUint32(content + length) != Crc32::compute(type, length + 4))
+            throw std::runtime_error("invalid chunk CRC");
+        if (memcmp(type, "IHDR", 4) == 0) {
+            width = readUint32(content);
+            height = readUint32(content + 4);
+            if (content[8] != 8 || content[9] != 2)
+                throw std::runtime_error("unexpected pixel format");
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            zlib.insert(zlib.end(), content, content + length);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            ended = true;
+        }
+        pos += 12 + length;
+    }
+    if (!ended || zlib.size() < 6 || ((zlib[0] << 8) | zlib[1]) % 31 != 0)
+        throw std::runtime_error("invalid zlib stream");
+
+    Bytes filtered = Inflater::inflate(zlib.data() + 2, zlib.size() - 6);
+    if (readUint32(zlib.data() + zlib.size() - 4) != Adler32::compute(filtered.data(), filtered.size()))
+        throw std::runtime_error("invalid Adler-32");
+
+    size_t rowSize = static_cast<size_t>(width) * 3;
+    if (filtered.size() != (rowSize + 1) * height)
+        throw std::runtime_error("invalid image data size");
+
+    Bytes pixels(rowSize * height);
+    for (size_t y = 0; y < height; ++y) {
+        unsigned char filter = filtered[y * (rowSize + 1)];
+        const unsigned char *source = filtered.data() + y * (rowSize + 1) + 1;
+        unsigned char *row = pixels.data() + y * rowSize;
+        const unsigned char *previous = y > 0 ? row - rowSize : nullptr;
+        for (size_t i = 0; i < rowSize; ++i) {
+            int left = i >= 3 ? row[i - 3] : 0;
+            int up = previous ? previous[i] : 0;
+            int upLeft = previous && i >= 3 ? previous[i - 3] : 0;
+            int predicted = 0;
+            if (filter == 1) {
+                predicted = left;
+            } else if (filter == 2) {
+                predicted = up;
+            } else if (filter == 3) {
+                predicted = (left + up) / 2;
+            } else if (filter == 4) {
+                int estimate = left + up - upLeft;
+                int distLeft = abs(estimate - left), distUp = abs(estimate - up), distUpLeft = abs(estimate - upLeft);
+                predicted = distLeft <= distUp && distLeft <= distUpLeft ? left : (distUp <= distUpLeft ? up : upLeft);
+            } else if (filter != 0) {
+                throw std::runtime_error("invalid filter type");
+            }
+            row[i] = static_cast<unsigned char>(source[i] + predicted);
+        }
+    }
+    return pixels;
+}
+
+Bytes imagePixels(const PixelImageBase &image) {
+    size_t rowSize = static_cast<size_t>(image.width()) * 3;
+    Bytes result(rowSize * image.height());
+    for (unsigned int y = 0; y < image.height(); ++y) {
+        const unsigned char *row = image.readRow(y, result.data() + y * rowSize);
+        memmove(result.data() + y * rowSize, row, rowSize);
+    }
+    return result;
+}
+
+// flat colored areas with noisy stripe, similar to chart content
+void fillChart(RgbImage &image) {
+    BackgroundPainterForRgbImage(image).paint(RgbColor::make_rgb(255, 255, 255));
+    unsigned int seed = 7;
+    for (unsigned int y = 0; y < image.height(); ++y) {
+        for (unsigned int x = 0; x < image.width(); ++x) {
+            Point pos(static_cast<int>(x), static_cast<int>(y));
+            if (x % 40 < 25 && y > image.height() / 2)
+                image.setPixel(pos, RgbColor::make_rgb(70, 130, 180));
+            if (y % 50 == 0 || x % 50 == 0)
+                image.setPixel(pos, RgbColor::make_rgb(200, 200, 200));
+            if (y >= 10 && y < 14) {
+                seed = seed * 1103515245u + 12345u;
+                image.setPixel(pos, RgbColor::make_rgb(static_cast<int>(seed >> 24), static_cast<int>((seed >> 16) & 0xFF),
+                                                       static_cast<int>((seed >> 8) & 0xFF)));
+            }
+        }
+    }
+}
+
+std::string writePng(PixelImageBase &image, unsigned int threads, size_t chunkSize) {
+    std::ostringstream stream;
+    PngImageWriter writer(stream, threads, chunkSize);
+    writer.writeImage(image);
+    return stream.str();
+}
+
+Bytes deflateRoundTrip(const Bytes &input, size_t parts) {
+    DeflateEncoder encoder(16, 1000);
+    Bytes compressed;
+    size_t partSize = input.size() / parts + 1;
+    for (size_t start = 0; start < input.size() || start == 0; start += partSize) {
+        size_t size = std::min(partSize, input.size() - start);
+        size_t dictionary = std::min(start, DeflateEncoder::WINDOW_SIZE);
+        encoder.compress(input.data() + start - dictionary, dictionary, input.data() + start, size,
+                         start + size >= input.size(), compressed);
+        if (input.empty())
+            break;
+    }
+    return Inflater::inflate(compressed.data(), compressed.size());
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Checksums_KnownValues) {
+    const char *text = "123456789";
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(text);
+    UTEST_ASSERT_EQUALS(Crc32::compute(data, 9), 0xCBF43926u);
+    UTEST_ASSERT_EQUALS(Crc32::update(Crc32::compute(data, 4), data + 4, 5), 0xCBF43926u);
+
+    const unsigned char *wiki = reinterpret_cast<const unsigned char *>("Wikipedia");
+    UTEST_ASSERT_EQUALS(Adler32::compute(wiki, 9), 0x11E60398u);
+    UTEST_ASSERT_EQUALS(Adler32::combine(Adler32::compute(wiki, 3), Adler32::compute(wiki + 3, 6), 6), 0x11E60398u);
+
+    Bytes large(100000, 0xFF);
+    UTEST_ASSERT_EQUALS(Adler32::combine(Adler32::compute(large.data(), 70000), Adler32::compute(large.data(), 30000), 30000),
+                        Adler32::compute(large.data(), large.size()));
+}
+
+UTEST_FUNC_DEF(Deflate_RoundTrip) {
+    Bytes empty;
+    UTEST_ASSERT_TRUE(deflateRoundTrip(empty, 1) == empty);
+
+    Bytes text;
+    const char *phrase = "the quick brown fox jumps over the lazy dog; ";
+    for (int i = 0; i < 2000; ++i)
+        text.insert(text.end(), phrase, phrase + strlen(phrase) - static_cast<size_t>(i % 7));
+
+    Bytes noise(70000);
+    unsigned int seed = 1;
+    for (unsigned char &value : noise) {
+        seed = seed * 1103515245u + 12345u;
+        value = static_cast<unsigned char>(seed >> 24);
+    }
+
+    Bytes runs(200000, 0);
+    for (size_t i = 0; i < runs.size(); ++i)
+        runs[i] = static_cast<unsigned char>((i / 1000) % 3 == 0 ? 0 : i % 5);
+
+    const Bytes *inputs[] = {&text, &noise, &runs};
+    for (const Bytes *input : inputs) {
+        UTEST_ASSERT_TRUE(deflateRoundTrip(*input, 1) == *input);
+        UTEST_ASSERT_TRUE(deflateRoundTrip(*input, 5) == *input);
+    }
+
+    // repetitive data has to be compressed well, noise must not grow much (stored blocks)
+    Bytes compressed;
+    DeflateEncoder().compress(runs.data(), runs.size(), compressed);
+    UTEST_ASSERT_TRUE(compressed.size() < runs.size() / 50);
+    compressed.clear();
+    DeflateEncoder().compress(noise.data(), noise.size(), compressed);
+    UTEST_ASSERT_TRUE(compressed.size() < noise.size() + 64);
+}
+
+UTEST_FUNC_DEF(PngWriter_DecodesToSameImage) {
+    unsigned int sizes[][2] = {{1, 1}, {3, 2}, {97, 61}, {640, 200}};
+    for (auto &size : sizes) {
+        RgbImage image(size[0], size[1]);
+        fillChart(image);
+
+        unsigned int width = 0, height = 0;
+        Bytes pixels = decodePng(writePng(image, 3, 1000), width, height);
+        UTEST_ASSERT_EQUALS(width, size[0]);
+        UTEST_ASSERT_EQUALS(height, size[1]);
+        UTEST_ASSERT_TRUE(pixels == imagePixels(image));
+    }
+}
+
+UTEST_FUNC_DEF(PngWriter_OutputIndependentOfThreadsAndBands) {
+    RgbImage image(300, 170);
+    fillChart(image);
+
+    std::string expected = writePng(image, 1, 4096);
+    UTEST_ASSERT_TRUE(writePng(image, 4, 4096) == expected);
+
+    std::ostringstream stream;
+    PngImageWriter writer(stream, 2, 4096);
+    writer.beginImage(300, 170);
+    for (int top = 0; top < 170; top += 33)
+        writer.writeRows(ImageView(image, Point(0, top), Point(300, std::min(33, 170 - top))));
+    writer.endImage();
+    UTEST_ASSERT_TRUE(stream.str() == expected);
+}
+
+UTEST_FUNC_DEF(PngWriter_FlatImageIsSmall) {
+    RgbImage image(800, 600);
+    fillChart(image);
+
+    std::ostringstream ppm;
+    PpmImageWriter(ppm).writeImage(image);
+    std::string png = writePng(image, 0, PngImageWriter::DEFAULT_CHUNK_SIZE);
+    UTEST_ASSERT_TRUE(png.size() * 10 < ppm.str().size());
+}
+
+UTEST_FUNC_DEF(PngWriter_InvalidUseThrows) {
+    std::ostringstream stream;
+    PngImageWriter writer(stream, 1);
+
+    bool thrown = false;
+    try {
+        writer.beginImage(0, 10);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    RgbImage band(10, 4);
+    writer.beginImage(10, 6);
+    writer.writeRows(band);
+    thrown = false;
+    try {
+        writer.endImage();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    thrown = false;
+    try {
+        writer.writeRows(band);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(PngWriter_FileNameDetection) {
+    UTEST_ASSERT_TRUE(PngImageWriter::isPngFileName("chart.png"));
+    UTEST_ASSERT_TRUE(PngImageWriter::isPngFileName("/tmp/CHART.PNG"));
+    UTEST_ASSERT_FALSE(PngImageWriter::isPngFileName("chart.ppm"));
+    UTEST_ASSERT_FALSE(PngImageWriter::isPngFileName("png"));
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Checksums_KnownValues);
+    UTEST_FUNC(Deflate_RoundTrip);
+    UTEST_FUNC(PngWriter_DecodesToSameImage);
+    UTEST_FUNC(PngWriter_OutputIndependentOfThreadsAndBands);
+    UTEST_FUNC(PngWriter_FlatImageIsSmall);
+    UTEST_FUNC(PngWriter_InvalidUseThrows);
+    UTEST_FUNC(PngWriter_FileNameDetection);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,376 @@
+#include "utest/utest.h"
+#include "uimg/base/platform.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/images/image_view.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/images/mapped_ppm_image.h"
+#include "uimg/images/mapped_rgb_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @file test_ppm_image.cpp
+ * @brief Tests for PPM writers (row-based stream writer, file descriptor writer) loaders (region reads, mapped files) and memory-mapped images
+ */
+
+namespace {
+
+RgbColor patternColor(int x, int y) {
+    return RgbColor::make_rgb(x * 7, y * 3, x + y);
+}
+
+void fillPattern(PixelImageBase &image) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), patternColor(x, y));
+}
+
+std::string writeToString(PixelImageBase &image) {
+    std::ostringstream stream;
+    PpmImageWriter writer(stream);
+    writer.writeImage(image);
+    return stream.str();
+}
+
+std::string readFile(const std::string &path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+std::string tempPath(const char *name) {
+    return std::string("/tmp/uimg_test_") + name + ".ppm";
+}
+
+// string buffer which refuses to seek, like a pipe
+class NonSeekableBuf : public std::stringbuf {
+public:
+    explicit NonSeekableBuf(const std::string &data) : std::stringbuf(data) {}
+
+protected:
+    virtual pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) {
+        return pos_type(off_type(-1));
+    }
+
+    virtual pos_type seekpos(pos_type, std::ios_base::openmode) {
+        return pos_type(off_type(-1));
+    }
+};
+
+// checks that `image` contains pattern of source rectangle (sx, sy, w, h) at (dx, dy), other pixels are black
+bool hasPatternPart(const PixelImageBase &image, int sx, int sy, int w, int h, int dx, int dy) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x) {
+            bool inside = x >= dx && x < dx + w && y >= dy && y < dy + h;
+            RgbColor expected = inside ? patternColor(x - dx + sx, y - dy + sy) : RgbColor::make_rgb(0, 0, 0);
+            if (image.getPixel(Point(x, y)) != expected)
+                return false;
+        }
+    return true;
+}
+
+Rect makePart(int x, int y, int w, int h) {
+    Rect part;
+    part.topLeft(Point(x, y)).size(Point(w, h));
+    return part;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Writer_GenericImageMatchesRgbImage) {
+    RgbImage rgb(21, 9);
+    RgbaImage rgba(21, 9);
+    fillPattern(rgb);
+    fillPattern(rgba);
+
+    std::string expected = writeToString(rgb);
+    UTEST_ASSERT_EQUALS(expected.size(), std::string("P6\n21 9\n255\n").size() + 21u * 9u * 3u);
+    UTEST_ASSERT_TRUE(writeToString(rgba) == expected);
+
+    ImageView view(rgb);
+    UTEST_ASSERT_TRUE(writeToString(view) == expected);
+}
+
+UTEST_FUNC_DEF(Writer_ImageLargerThanBlock) {
+    // 700 * 3 * 600 bytes - more than one block
+    RgbImage image(700, 600);
+    fillPattern(image);
+    UTEST_ASSERT_TRUE(image.rowSize() * image.height() > PpmImageWriter::BLOCK_SIZE);
+
+    std::istringstream input(writeToString(image));
+    PpmImageLoaderForRgbImage loader(input);
+    std::unique_ptr<PixelImageBase> loaded(loader.loadImage());
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+
+    bool same = true;
+    for (int y = 0; y < 600 && same; ++y)
+        for (int x = 0; x < 700 && same; ++x)
+            same = loaded->getPixel(Point(x, y)) == patternColor(x, y);
+    UTEST_ASSERT_TRUE(same);
+}
+
+UTEST_FUNC_DEF(Writer_ReusedForSeveralImages) {
+    RgbImage small(2, 2);
+    RgbImage wide(30, 3);
+    fillPattern(small);
+    fillPattern(wide);
+
+    std::ostringstream stream;
+    PpmImageWriter writer(stream);
+    writer.writeImage(wide);
+    writer.writeImage(small);
+
+    UTEST_ASSERT_TRUE(stream.str() == writeToString(wide) + writeToString(small));
+}
+
+UTEST_FUNC_DEF(Loader_ReadsBytesAbove127) {
+    RgbImage source(40, 3);
+    fillPattern(source);
+    std::istringstream input(writeToString(source));
+
+    RgbaImage output(40, 3);
+    PpmImageLoader loader(input);
+    UTEST_ASSERT_TRUE(loader.loadImageInto(output));
+    UTEST_ASSERT_TRUE(output.getPixel(Point(39, 2)) == patternColor(39, 2));
+    UTEST_ASSERT_TRUE(hasPatternPart(output, 0, 0, 40, 3, 0, 0));
+}
+
+UTEST_FUNC_DEF(Loader_PartIsPlacedAtOffset) {
+    RgbImage source(30, 20);
+    fillPattern(source);
+    std::string ppm = writeToString(source);
+
+    // seekable stream
+    std::istringstream input(ppm);
+    RgbImage output(12, 10);
+    PpmImageLoader loader(input);
+    UTEST_ASSERT_TRUE(loader.loadImagePartInto(output, makePart(5, 7, 6, 4), Point(2, 3)));
+    UTEST_ASSERT_TRUE(hasPatternPart(output, 5, 7, 6, 4, 2, 3));
+
+    // the same from a stream which can only be read forward
+    NonSeekableBuf buffer(ppm);
+    std::istream pipe(&buffer);
+    RgbImage pipeOutput(12, 10);
+    PpmImageLoader pipeLoader(pipe);
+    UTEST_ASSERT_TRUE(pipeLoader.loadImagePartInto(pipeOutput, makePart(5, 7, 6, 4), Point(2, 3)));
+    UTEST_ASSERT_TRUE(hasPatternPart(pipeOutput, 5, 7, 6, 4, 2, 3));
+}
+
+UTEST_FUNC_DEF(Loader_PartIsClipped) {
+    RgbImage source(30, 20);
+    fillPattern(source);
+    std::string ppm = writeToString(source);
+
+    // part reaches outside of source (right, bottom) and of output (negative offset)
+    std::istringstream input(ppm);
+    RgbImage output(8, 8);
+    PpmImageLoader loader(input);
+    UTEST_ASSERT_TRUE(loader.loadImagePartInto(output, makePart(25, 15, 10, 10), Point(-2, -1)));
+    UTEST_ASSERT_TRUE(hasPatternPart(output, 27, 16, 3, 4, 0, 0));
+
+    // part fully outside of output: nothing is read, nothing fails
+    std::istringstream input2(ppm);
+    RgbImage untouched(8, 8);
+    PpmImageLoader loader2(input2);
+    UTEST_ASSERT_TRUE(loader2.loadImagePartInto(untouched, makePart(0, 0, 5, 5), Point(8, 0)));
+    UTEST_ASSERT_TRUE(hasPatternPart(untouched, 0, 0, 0, 0, 0, 0));
+}
+
+UTEST_FUNC_DEF(Loader_TruncatedDataFails) {
+    RgbImage source(10, 10);
+    std::string ppm = writeToString(source);
+    std::istringstream input(ppm.substr(0, ppm.size() - 5));
+
+    RgbImage output(10, 10);
+    PpmImageLoader loader(input);
+    UTEST_ASSERT_FALSE(loader.loadImageInto(output));
+}
+
+#if UIMG_HAS_POSIX
+UTEST_FUNC_DEF(FdWriter_MatchesStreamWriter) {
+    RgbImage strided(33, 17, 200);
+    RgbaImage rgba(33, 17);
+    fillPattern(strided);
+    fillPattern(rgba);
+    ImageView window(strided, Point(3, 2), Point(10, 10));
+
+    std::string path = tempPath("fd_writer");
+
+    PpmImageFdWriter::writeToFile(path, strided);
+    UTEST_ASSERT_TRUE(readFile(path) == writeToString(strided));
+
+    PpmImageFdWriter::writeToFile(path, rgba);
+    UTEST_ASSERT_TRUE(readFile(path) == writeToString(rgba));
+
+    PpmImageFdWriter::writeToFile(path, window);
+    UTEST_ASSERT_TRUE(readFile(path) == writeToString(window));
+
+    std::remove(path.c_str());
+}
+
+UTEST_FUNC_DEF(FdWriter_ManyRowsInSeveralBatches) {
+    // more rows than fit into one writev call
+    RgbaImage image(3, 2500);
+    fillPattern(image);
+
+    std::string path = tempPath("fd_batches");
+    PpmImageFdWriter::writeToFile(path, image);
+    UTEST_ASSERT_TRUE(readFile(path) == writeToString(image));
+    std::remove(path.c_str());
+}
+
+UTEST_FUNC_DEF(FdWriter_InvalidPathThrows) {
+    RgbImage image(2, 2);
+    bool thrown = false;
+    try {
+        PpmImageFdWriter::writeToFile("/nonexistent-dir/image.ppm", image);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(MappedImage_ReadsPixelsAndParts) {
+    RgbImage source(50, 30);
+    fillPattern(source);
+    std::string path = tempPath("mapped");
+    PpmImageFdWriter::writeToFile(path, source);
+
+    {
+        MappedPpmImage mapped(path);
+        UTEST_ASSERT_EQUALS(mapped.width(), 50u);
+        UTEST_ASSERT_EQUALS(mapped.height(), 30u);
+        UTEST_ASSERT_TRUE(mapped.getPixel(Point(49, 29)) == patternColor(49, 29));
+        UTEST_ASSERT_TRUE(mapped.getPixel(Point(50, 0)) == RgbColor::make_rgb(0, 0, 0));
+        UTEST_ASSERT_EQUALS(static_cast<size_t>(mapped.row(1) - mapped.row(0)), 150u);
+
+        RgbImage tile(10, 10);
+        mapped.copyPartInto(tile, makePart(20, 12, 8, 8), Point(1, 2));
+        UTEST_ASSERT_TRUE(hasPatternPart(tile, 20, 12, 8, 8, 1, 2));
+    }
+
+    std::remove(path.c_str());
+}
+
+UTEST_FUNC_DEF(MappedImage_HeaderWithComments) {
+    std::string path = tempPath("mapped_comment");
+    {
+        std::ofstream output(path, std::ios::binary);
+        output << "P6\n# created by test\n2 1\n255\n";
+        output.write("\x01\x02\x03\xfa\xfb\xfc", 6);
+    }
+
+    MappedPpmImage mapped(path);
+    UTEST_ASSERT_EQUALS(mapped.width(), 2u);
+    UTEST_ASSERT_EQUALS(mapped.height(), 1u);
+    UTEST_ASSERT_TRUE(mapped.getPixel(Point(1, 0)) == RgbColor::make_rgb(250, 251, 252));
+
+    std::remove(path.c_str());
+}
+
+UTEST_FUNC_DEF(MappedImage_InvalidFileThrows) {
+    std::string path = tempPath("mapped_invalid");
+    {
+        std::ofstream output(path, std::ios::binary);
+        output << "P6\n4 4\n255\n";
+        output.write("\x01\x02\x03", 3);
+    }
+
+    bool thrown = false;
+    try {
+        MappedPpmImage mapped(path);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    std::remove(path.c_str());
+}
+
+UTEST_FUNC_DEF(MappedRgbImage_FileIsValidPpm) {
+    RgbColor red = RgbColor::make_rgb(255, 0, 0);
+    RgbColor green = RgbColor::make_rgb(0, 200, 0);
+
+    RgbImage expected(40, 30);
+    RectPainterForRgbImage(expected).drawFull(3, 4, 30, 20, red);
+    LinePainterForRgbImage(expected).drawLine(0, 29, 39, 0, green);
+
+    std::string path = tempPath("mapped_rgb");
+    {
+        MappedRgbImage mapped(path, 40, 30);
+        UTEST_ASSERT_TRUE(mapped.isContiguous());
+        UTEST_ASSERT_TRUE(mapped.getPixel(Point(39, 29)) == RgbColor::make_rgb(0, 0, 0));
+
+        mapped.adviseRows(0, 29, MADV_SEQUENTIAL);
+        RectPainterForRgbImage(mapped).drawFull(3, 4, 30, 20, red);
+        LinePainterForRgbImage(mapped).drawLine(0, 29, 39, 0, green);
+
+        // writer reads rows straight from mapping
+        UTEST_ASSERT_TRUE(writeToString(mapped) == writeToString(expected));
+    }
+
+    UTEST_ASSERT_TRUE(readFile(path) == writeToString(expected));
+    std::remove(path.c_str());
+}
+
+UTEST_FUNC_DEF(MappedRgbImage_ReopenExistingFile) {
+    RgbImage source(20, 10);
+    fillPattern(source);
+    std::string path = tempPath("mapped_reopen");
+    PpmImageFdWriter::writeToFile(path, source);
+
+    {
+        MappedRgbImage mapped(path);
+        UTEST_ASSERT_EQUALS(mapped.width(), 20u);
+        UTEST_ASSERT_EQUALS(mapped.height(), 10u);
+        UTEST_ASSERT_TRUE(mapped.getPixel(Point(19, 9)) == patternColor(19, 9));
+
+        mapped.setPixel(Point(5, 5), RgbColor::make_rgb(1, 2, 3));
+        mapped.releaseRows(0, 9);
+        UTEST_ASSERT_TRUE(mapped.getPixel(Point(5, 5)) == RgbColor::make_rgb(1, 2, 3));
+    }
+
+    MappedPpmImage check(path);
+    UTEST_ASSERT_TRUE(check.getPixel(Point(5, 5)) == RgbColor::make_rgb(1, 2, 3));
+    UTEST_ASSERT_TRUE(check.getPixel(Point(6, 5)) == patternColor(6, 5));
+
+    // re-creating file clears it
+    {
+        MappedRgbImage cleared(path, 20, 10);
+        UTEST_ASSERT_TRUE(cleared.getPixel(Point(6, 5)) == RgbColor::make_rgb(0, 0, 0));
+    }
+
+    std::remove(path.c_str());
+}
+#endif
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Writer_GenericImageMatchesRgbImage);
+    UTEST_FUNC(Writer_ImageLargerThanBlock);
+    UTEST_FUNC(Writer_ReusedForSeveralImages);
+    UTEST_FUNC(Loader_ReadsBytesAbove127);
+    UTEST_FUNC(Loader_PartIsPlacedAtOffset);
+    UTEST_FUNC(Loader_PartIsClipped);
+    UTEST_FUNC(Loader_TruncatedDataFails);
+#if UIMG_HAS_POSIX
+    UTEST_FUNC(FdWriter_MatchesStreamWriter);
+    UTEST_FUNC(FdWriter_ManyRowsInSeveralBatches);
+    UTEST_FUNC(FdWriter_InvalidPathThrows);
+    UTEST_FUNC(MappedImage_ReadsPixelsAndParts);
+    UTEST_FUNC(MappedImage_HeaderWithComments);
+    UTEST_FUNC(MappedImage_InvalidFileThrows);
+    UTEST_FUNC(MappedRgbImage_FileIsValidPpm);
+    UTEST_FUNC(MappedRgbImage_ReopenExistingFile);
+#endif
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,192 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/images/image_view.h"
+#include "uimg/images/qoi_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+/**
+ * @file test_qoi_image.cpp
+ * @brief Tests for QOI writer, row decoder and loader
+ */
+
+namespace {
+
+// flat areas, gradients and noise - exercises all QOI operations
+void fillPattern(PixelImageBase &image) {
+    unsigned int seed = 3;
+    for (int y = 0; y < static_cast<int>(image.height()); ++y) {
+        for (int x = 0; x < static_cast<int>(image.width()); ++x) {
+            seed = seed * 1103515245u + 12345u;
+            RgbColor color;
+            if (y % 10 < 3)
+                color = RgbColor::make_rgb(static_cast<int>(seed >> 24), static_cast<int>((seed >> 16) & 0xFF), x);
+            else if (y % 10 < 6)
+                color = RgbColor::make_rgb(x, x + y, y + static_cast<int>(seed >> 30));
+            else
+                color = RgbColor::make_rgb((x / 16) * 40, 100, 200);
+            image.setPixel(Point(x, y), color);
+        }
+    }
+}
+
+std::string writeToString(PixelImageBase &image) {
+    std::ostringstream stream;
+    QoiImageWriter writer(stream);
+    writer.writeImage(image);
+    return stream.str();
+}
+
+bool samePixels(const PixelImageBase &a, const PixelImageBase &b) {
+    if (a.width() != b.width() || a.height() != b.height())
+        return false;
+    for (int y = 0; y < static_cast<int>(a.height()); ++y)
+        for (int x = 0; x < static_cast<int>(a.width()); ++x)
+            if (a.getPixel(Point(x, y)) != b.getPixel(Point(x, y)))
+                return false;
+    return true;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(RgbImage_RoundTrip) {
+    unsigned int sizes[][2] = {{1, 1}, {5, 3}, {131, 47}, {300, 100}};
+    for (auto &size : sizes) {
+        RgbImage image(size[0], size[1]);
+        fillPattern(image);
+
+        std::istringstream input(writeToString(image));
+        QoiImageLoader loader(input);
+        std::unique_ptr<PixelImageBase> loaded(loader.loadImage());
+        UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+        UTEST_ASSERT_TRUE(samePixels(image, *loaded));
+    }
+}
+
+UTEST_FUNC_DEF(RgbaImage_RoundTripKeepsAlpha) {
+    RgbaImage image(64, 20);
+    for (int y = 0; y < 20; ++y)
+        for (int x = 0; x < 64; ++x)
+            image.setPixelRgba(Point(x, y), RgbaColor{static_cast<unsigned char>(x * 4), static_cast<unsigned char>(y * 12),
+                                                      200, static_cast<unsigned char>(x < 32 ? 255 : (x - 32) * 8)});
+
+    std::ostringstream output;
+    QoiImageWriter(output).writeImage(image);
+    UTEST_ASSERT_EQUALS(static_cast<int>(output.str()[12]), 4);
+
+    std::istringstream input(output.str());
+    std::unique_ptr<RgbaImage> loaded(QoiImageLoader(input).loadRgbaImage());
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+
+    bool same = true;
+    for (int y = 0; y < 20; ++y)
+        for (int x = 0; x < 64; ++x)
+            same = same && !(loaded->getPremultipliedPixel(Point(x, y)) != image.getPremultipliedPixel(Point(x, y)));
+    UTEST_ASSERT_TRUE(same);
+}
+
+UTEST_FUNC_DEF(StreamWriter_EqualsWholeImageWrite) {
+    RgbImage image(90, 70);
+    fillPattern(image);
+
+    std::ostringstream banded;
+    QoiImageWriter writer(banded);
+    writer.beginImage(90, 70);
+    for (int top = 0; top < 70; top += 16)
+        writer.writeRows(ImageView(image, Point(0, top), Point(90, std::min(16, 70 - top))));
+    writer.endImage();
+
+    UTEST_ASSERT_TRUE(banded.str() == writeToString(image));
+}
+
+UTEST_FUNC_DEF(LoadImagePart_DecodesOnlyNeededRows) {
+    RgbImage image(120, 80);
+    fillPattern(image);
+    std::string data = writeToString(image);
+
+    Rect part;
+    part.topLeft(Point(10, 5)).size(Point(30, 20));
+    RgbImage expected(40, 30);
+    for (int y = 0; y < 20; ++y)
+        for (int x = 0; x < 30; ++x)
+            expected.setPixel(Point(x + 4, y + 2), image.getPixel(Point(x + 10, y + 5)));
+
+    RgbImage target(40, 30);
+    std::istringstream input(data);
+    UTEST_ASSERT_TRUE(QoiImageLoader(input).loadImagePartInto(target, part, Point(4, 2)));
+    UTEST_ASSERT_TRUE(samePixels(target, expected));
+
+    // rows below the part are not needed, so truncated data is enough
+    std::istringstream truncated(data.substr(0, data.size() / 2));
+    RgbImage target2(40, 30);
+    UTEST_ASSERT_TRUE(QoiImageLoader(truncated).loadImagePartInto(target2, part, Point(4, 2)));
+    UTEST_ASSERT_TRUE(samePixels(target2, expected));
+
+    std::istringstream truncatedWhole(data.substr(0, data.size() / 2));
+    std::unique_ptr<PixelImageBase> failed(QoiImageLoader(truncatedWhole).loadImage());
+    UTEST_ASSERT_TRUE(failed.get() == nullptr);
+}
+
+UTEST_FUNC_DEF(RowDecoder_ReadsRowsInOrder) {
+    RgbImage image(33, 9);
+    fillPattern(image);
+    std::istringstream input(writeToString(image));
+
+    QoiRowDecoder decoder(input);
+    UTEST_ASSERT_TRUE(decoder.readHeader());
+    UTEST_ASSERT_EQUALS(decoder.width(), 33u);
+    UTEST_ASSERT_EQUALS(decoder.height(), 9u);
+    UTEST_ASSERT_EQUALS(decoder.channels(), 3u);
+
+    std::vector<unsigned char> row(33 * 4);
+    bool same = true;
+    for (unsigned int y = 0; y < 9; ++y) {
+        UTEST_ASSERT_TRUE(decoder.decodeRow(row.data(), 4));
+        for (int x = 0; x < 33; ++x) {
+            RgbColor color = image.getPixel(Point(x, static_cast<int>(y)));
+            const unsigned char *pixel = row.data() + x * 4;
+            same = same && pixel[0] == color.red && pixel[1] == color.green && pixel[2] == color.blue && pixel[3] == 255;
+        }
+    }
+    UTEST_ASSERT_TRUE(same);
+    UTEST_ASSERT_FALSE(decoder.decodeRow(row.data(), 4));
+}
+
+UTEST_FUNC_DEF(InvalidHeader_ReturnsNull) {
+    std::istringstream input("P6\n2 2\n255\n............");
+    QoiImageLoader loader(input);
+    std::unique_ptr<PixelImageBase> loaded(loader.loadImage());
+    UTEST_ASSERT_TRUE(loaded.get() == nullptr);
+}
+
+UTEST_FUNC_DEF(FlatImage_IsSmallerThanPpm) {
+    RgbImage image(400, 300);
+    BackgroundPainterForRgbImage(image).paint(RgbColor::make_rgb(255, 255, 255));
+    for (int y = 100; y < 200; ++y)
+        for (int x = 0; x < 400; ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x % 50 < 25 ? 70 : 255, 130, 180));
+
+    std::ostringstream ppm;
+    PpmImageWriter(ppm).writeImage(image);
+    UTEST_ASSERT_TRUE(writeToString(image).size() * 20 < ppm.str().size());
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(RgbImage_RoundTrip);
+    UTEST_FUNC(RgbaImage_RoundTripKeepsAlpha);
+    UTEST_FUNC(StreamWriter_EqualsWholeImageWrite);
+    UTEST_FUNC(LoadImagePart_DecodesOnlyNeededRows);
+    UTEST_FUNC(RowDecoder_ReadsRowsInOrder);
+    UTEST_FUNC(InvalidHeader_ReturnsNull);
+    UTEST_FUNC(FlatImage_IsSmallerThanPpm);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,237 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/image_view.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @file test_rgb_image.cpp
+ * @brief Tests for RgbImage memory layout (stride, alignment), image views and PPM input/output
+ */
+
+namespace {
+
+const RgbColor RED = {255, 0, 0};
+const RgbColor BLUE = {0, 0, 255};
+
+// fills image with a pattern which depends on pixel position
+void fillPattern(RgbImage &image) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x, y, x + y));
+}
+
+bool hasPattern(const PixelImageBase &image) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            if (image.getPixel(Point(x, y)) != RgbColor::make_rgb(x, y, x + y))
+                return false;
+    return true;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(DefaultStride_IsAligned) {
+    RgbImage image(13, 5);
+
+    UTEST_ASSERT_EQUALS(image.rowSize(), 39u);
+    UTEST_ASSERT_EQUALS(image.stride(), 64u);
+    UTEST_ASSERT_FALSE(image.isContiguous());
+    UTEST_ASSERT_EQUALS(image.dataSize(), 64u * 5u);
+
+    for (unsigned int y = 0; y < image.height(); ++y)
+        UTEST_ASSERT_EQUALS(reinterpret_cast<std::uintptr_t>(image.row(y)) % RgbImage::ROW_ALIGNMENT, 0u);
+}
+
+UTEST_FUNC_DEF(CustomStride) {
+    RgbImage packed(13, 5, 39);
+    UTEST_ASSERT_TRUE(packed.isContiguous());
+    UTEST_ASSERT_EQUALS(packed.dataSize(), 39u * 5u);
+
+    RgbImage wide(13, 5, 100);
+    UTEST_ASSERT_EQUALS(wide.row(2) - wide.row(0), 200);
+
+    bool thrown = false;
+    try {
+        RgbImage invalid(13, 5, 38);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(PixelAccess_UsesStride) {
+    RgbImage image(7, 3);
+    image.setPixel(Point(6, 1), RED);
+    image.setPixel(Point(7, 1), BLUE); // outside of image
+
+    UTEST_ASSERT_TRUE(image.getPixel(6, 1) == RED);
+    UTEST_ASSERT_EQUALS(image.row(1)[18], 255);
+    UTEST_ASSERT_TRUE(image.getPixel(0, 2) == RgbColor::make_rgb(0, 0, 0));
+}
+
+UTEST_FUNC_DEF(Painters_DoNotWriteIntoPadding) {
+    RgbImage image(10, 4);
+    PixelPainterForRgbImage painter(image);
+    BackgroundPainterForRgbImage background(image);
+
+    background.paint(BLUE);
+    painter.fillSpan(5, 1, 100, RED);
+
+    UTEST_ASSERT_TRUE(image.getPixel(9, 1) == RED);
+    UTEST_ASSERT_TRUE(image.getPixel(0, 2) == BLUE);
+    // padding after last pixel of row stays untouched
+    UTEST_ASSERT_EQUALS(image.row(1)[image.rowSize()], 0);
+    UTEST_ASSERT_EQUALS(image.row(3)[image.stride() - 1], 0);
+}
+
+UTEST_FUNC_DEF(PpmWriter_WritesRowsWithoutPadding) {
+    RgbImage image(13, 4);
+    fillPattern(image);
+
+    std::stringstream stream;
+    PpmWriterForRgbImage writer(stream);
+    writer.writeImage(image);
+
+    std::string content = stream.str();
+    std::string header = "P6\n13 4\n255\n";
+    UTEST_ASSERT_EQUALS(content.size(), header.size() + 13u * 4u * 3u);
+    UTEST_ASSERT_TRUE(content.compare(0, header.size(), header) == 0);
+
+    // generic writer produces the same output
+    std::stringstream genericStream;
+    PpmImageWriter genericWriter(genericStream);
+    genericWriter.writeImage(image);
+    UTEST_ASSERT_TRUE(genericStream.str() == content);
+}
+
+UTEST_FUNC_DEF(PpmLoader_ReadsIntoStridedImage) {
+    RgbImage image(13, 4, 39);
+    fillPattern(image);
+
+    std::stringstream stream;
+    PpmWriterForRgbImage writer(stream);
+    writer.writeImage(image);
+
+    PpmImageLoaderForRgbImage loader(stream);
+    std::unique_ptr<PixelImageBase> loaded(loader.loadImage());
+
+    UTEST_ASSERT_TRUE(loaded.get() != nullptr);
+    UTEST_ASSERT_EQUALS(loaded->width(), 13u);
+    UTEST_ASSERT_EQUALS(static_cast<RgbImage &>(*loaded).stride(), 64u);
+    UTEST_ASSERT_TRUE(hasPattern(*loaded));
+}
+
+UTEST_FUNC_DEF(ImageView_SharesMemoryWithParent) {
+    RgbImage image(20, 10);
+    ImageView view(image, Point(5, 3), Point(8, 4));
+
+    UTEST_ASSERT_EQUALS(view.width(), 8u);
+    UTEST_ASSERT_EQUALS(view.height(), 4u);
+    UTEST_ASSERT_EQUALS(view.stride(), image.stride());
+    UTEST_ASSERT_TRUE(view.row(0) == image.row(3) + 5 * RgbImage::BYTES_PER_PIXEL);
+
+    view.setPixel(Point(0, 0), RED);
+    image.setPixel(Point(12, 6), BLUE);
+
+    UTEST_ASSERT_TRUE(image.getPixel(5, 3) == RED);
+    UTEST_ASSERT_TRUE(view.getPixel(7, 3) == BLUE);
+    // pixels outside of view are not accessible through it
+    view.setPixel(Point(8, 0), RED);
+    UTEST_ASSERT_TRUE(image.getPixel(13, 3) == RgbColor::make_rgb(0, 0, 0));
+}
+
+UTEST_FUNC_DEF(ImageView_NestedAndClipped) {
+    RgbImage image(20, 10);
+    ImageView view(image, RectInclusive::make_rect(4, 2, 15, 9));
+    ImageView nested(view, Point(2, 1), Point(100, 100));
+
+    UTEST_ASSERT_EQUALS(view.width(), 12u);
+    UTEST_ASSERT_EQUALS(view.height(), 8u);
+    UTEST_ASSERT_EQUALS(nested.width(), 10u);
+    UTEST_ASSERT_EQUALS(nested.height(), 7u);
+    UTEST_ASSERT_EQUALS(nested.offset().x, 2);
+
+    nested.setPixel(Point(0, 0), RED);
+    UTEST_ASSERT_TRUE(image.getPixel(6, 3) == RED);
+
+    ImageView empty(image, Point(30, 0), Point(5, 5));
+    UTEST_ASSERT_EQUALS(empty.width(), 0u);
+    UTEST_ASSERT_EQUALS(empty.height(), 0u);
+
+    bool thrown = false;
+    try {
+        ImageView invalid(image, Point(-1, 0), Point(5, 5));
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(ImageView_PaintersStayInsideWindow) {
+    RgbImage image(30, 20);
+    BackgroundPainterForRgbImage(image).paint(BLUE);
+
+    ImageView view(image, Point(10, 5), Point(10, 10));
+    BackgroundPainterForRgbImage(view).paint(RED);
+
+    PixelPainterForRgbImage painter(view);
+    painter.fillSpan(0, 2, 1000, BLUE);
+    LinePainterForRgbImage linePainter(view);
+    linePainter.drawLine(0, 0, 50, 50, BLUE);
+
+    int redCount = 0;
+    for (int y = 0; y < 20; ++y)
+        for (int x = 0; x < 30; ++x) {
+            bool inside = x >= 10 && x < 20 && y >= 5 && y < 15;
+            RgbColor color = image.getPixel(x, y);
+            if (!inside) {
+                UTEST_ASSERT_TRUE(color == BLUE);
+            } else if (color == RED) {
+                redCount++;
+            }
+        }
+
+    // 10x10 window minus painted span (10 pixels) and diagonal (9 more pixels)
+    UTEST_ASSERT_EQUALS(redCount, 81);
+}
+
+UTEST_FUNC_DEF(ImageView_WritesAsPpm) {
+    RgbImage image(13, 4);
+    fillPattern(image);
+    ImageView view(image, Point(3, 1), Point(5, 2));
+
+    std::stringstream stream;
+    PpmWriterForRgbImage writer(stream);
+    writer.writeImage(view);
+
+    std::string content = stream.str();
+    std::string header = "P6\n5 2\n255\n";
+    UTEST_ASSERT_EQUALS(content.size(), header.size() + 5u * 2u * 3u);
+    // first pixel of view is pixel (3,1) of image
+    UTEST_ASSERT_EQUALS(static_cast<unsigned char>(content[header.size()]), 3);
+    UTEST_ASSERT_EQUALS(static_cast<unsigned char>(content[header.size() + 1]), 1);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(DefaultStride_IsAligned);
+    UTEST_FUNC(CustomStride);
+    UTEST_FUNC(PixelAccess_UsesStride);
+    UTEST_FUNC(Painters_DoNotWriteIntoPadding);
+    UTEST_FUNC(PpmWriter_WritesRowsWithoutPadding);
+    UTEST_FUNC(PpmLoader_ReadsIntoStridedImage);
+    UTEST_FUNC(ImageView_SharesMemoryWithParent);
+    UTEST_FUNC(ImageView_NestedAndClipped);
+    UTEST_FUNC(ImageView_PaintersStayInsideWindow);
+    UTEST_FUNC(ImageView_WritesAsPpm);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,201 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/rgba_image.h"
+#include "uimg/images/rgba_compositor.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_rgba_image.h"
+#include "uimg/utils/color_utils.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * @file test_rgba_image.cpp
+ * @brief Tests for premultiplied RgbaImage, integer Porter-Duff compositing and RGBA layer painter
+ */
+
+namespace {
+
+const RgbColor WHITE = {255, 255, 255};
+const RgbColor RED = {255, 0, 0};
+const RgbColor BLUE = {0, 0, 255};
+
+RgbaColor rgba(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    RgbaColor c;
+    c.red = r;
+    c.green = g;
+    c.blue = b;
+    c.alpha = a;
+    return c;
+}
+
+bool closeTo(unsigned int a, unsigned int b, unsigned int tolerance) {
+    return (a > b ? a - b : b - a) <= tolerance;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(MulDiv255_IsExact) {
+    for (unsigned int a = 0; a < 256; ++a)
+        for (unsigned int b = 0; b < 256; ++b) {
+            unsigned int expected = static_cast<unsigned int>(std::lround(a * b / 255.0));
+            if (color_utils::mul_div_255(a, b) != expected) {
+                UTEST_ASSERT_EQUALS(color_utils::mul_div_255(a, b), expected);
+            }
+        }
+}
+
+UTEST_FUNC_DEF(NewImage_IsTransparentAndAligned) {
+    RgbaImage image(7, 3);
+
+    UTEST_ASSERT_EQUALS(image.rowSize(), 28u);
+    UTEST_ASSERT_EQUALS(image.stride(), 64u);
+    for (unsigned int y = 0; y < image.height(); ++y)
+        UTEST_ASSERT_EQUALS(reinterpret_cast<std::uintptr_t>(image.row(y)) % RgbaImage::ROW_ALIGNMENT, 0u);
+
+    UTEST_ASSERT_TRUE(image.getPixelRgba(Point(6, 2)) == rgba(0, 0, 0, 0));
+}
+
+UTEST_FUNC_DEF(PixelAccess_StoresPremultiplied) {
+    RgbaImage image(4, 4);
+
+    image.setPixelRgba(Point(1, 1), rgba(200, 100, 50, 128));
+    UTEST_ASSERT_TRUE(image.getPremultipliedPixel(Point(1, 1)) == rgba(100, 50, 25, 128));
+
+    RgbaColor back = image.getPixelRgba(Point(1, 1));
+    UTEST_ASSERT_TRUE(closeTo(back.red, 200, 1));
+    UTEST_ASSERT_TRUE(closeTo(back.green, 100, 1));
+    UTEST_ASSERT_TRUE(closeTo(back.blue, 50, 1));
+    UTEST_ASSERT_EQUALS(back.alpha, 128);
+
+    image.setPixel(Point(2, 2), RED);
+    UTEST_ASSERT_TRUE(image.getPremultipliedPixel(Point(2, 2)) == rgba(255, 0, 0, 255));
+    UTEST_ASSERT_TRUE(image.getPixel(Point(2, 2)) == RED);
+
+    // outside of image: ignored on write, transparent on read
+    image.setPixelRgba(Point(4, 0), rgba(1, 2, 3, 4));
+    image.setPixelRgba(Point(-1, 0), rgba(1, 2, 3, 4));
+    UTEST_ASSERT_TRUE(image.getPremultipliedPixel(Point(0, 4)) == rgba(0, 0, 0, 0));
+}
+
+UTEST_FUNC_DEF(OverSpan_MatchesFormula) {
+    std::vector<unsigned char> dst = {0, 0, 200, 200, 10, 20, 30, 255};
+    std::vector<unsigned char> src = {100, 0, 0, 100, 0, 0, 0, 0};
+    RgbaCompositor::overSpan(dst.data(), src.data(), 2);
+
+    // first pixel: src + dst * (255 - 100) / 255
+    UTEST_ASSERT_EQUALS(dst[0], 100);
+    UTEST_ASSERT_EQUALS(dst[2], 122);
+    UTEST_ASSERT_EQUALS(dst[3], 222);
+    // second pixel: transparent source keeps destination
+    UTEST_ASSERT_EQUALS(dst[4], 10);
+    UTEST_ASSERT_EQUALS(dst[7], 255);
+}
+
+UTEST_FUNC_DEF(InOutSpans_UseDestinationAlpha) {
+    std::vector<unsigned char> src = {200, 100, 0, 200, 200, 100, 0, 200};
+    std::vector<unsigned char> inDst = {0, 0, 0, 255, 0, 0, 0, 0};
+    std::vector<unsigned char> outDst = inDst;
+
+    RgbaCompositor::inSpan(inDst.data(), src.data(), 2);
+    RgbaCompositor::outSpan(outDst.data(), src.data(), 2);
+
+    for (size_t i = 0; i < 4; ++i) {
+        UTEST_ASSERT_EQUALS(inDst[i], src[i]);
+        UTEST_ASSERT_EQUALS(inDst[4 + i], 0);
+        UTEST_ASSERT_EQUALS(outDst[i], 0);
+        UTEST_ASSERT_EQUALS(outDst[4 + i], src[4 + i]);
+    }
+}
+
+UTEST_FUNC_DEF(OverRgb_MatchesFloatAlphaPainter) {
+    // compositing a translucent layer gives the same result as float blending (within rounding)
+    RgbImage expected(16, 8);
+    RgbImage composited(16, 8);
+    BackgroundPainterForRgbImage(expected).paint(BLUE);
+    BackgroundPainterForRgbImage(composited).paint(BLUE);
+
+    RgbaImage layer(16, 8);
+    PixelPainterForRgbaImage layerPainter(layer);
+    PixelPainterForRgbImage rgbPainter(expected);
+    PixelPainter &directPainter = rgbPainter;
+    for (unsigned int y = 2; y < 6; ++y)
+        for (unsigned int x = 0; x < 16; ++x) {
+            float alpha = static_cast<float>(x) / 15.0f;
+            layerPainter.putPixel(x, y, RED, alpha);
+            directPainter.putPixel(x, y, RED, alpha);
+        }
+
+    RgbaCompositor::over(layer, composited);
+
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 16; ++x) {
+            RgbColor a = expected.getPixel(Point(x, y));
+            RgbColor b = composited.getPixel(Point(x, y));
+            UTEST_ASSERT_TRUE(closeTo(a.red, b.red, 1));
+            UTEST_ASSERT_TRUE(closeTo(a.green, b.green, 1));
+            UTEST_ASSERT_TRUE(closeTo(a.blue, b.blue, 1));
+        }
+}
+
+UTEST_FUNC_DEF(Over_ClipsLayerAtOffset) {
+    RgbImage target(6, 6);
+    BackgroundPainterForRgbImage(target).paint(WHITE);
+
+    RgbaImage layer(4, 4);
+    PixelPainterForRgbaImage(layer).fillSpan(0, 3, 4, RED);
+
+    RgbaCompositor::over(layer, target, Point(4, -1));
+
+    UTEST_ASSERT_TRUE(target.getPixel(Point(4, 2)) == RED);
+    UTEST_ASSERT_TRUE(target.getPixel(Point(5, 2)) == RED);
+    UTEST_ASSERT_TRUE(target.getPixel(Point(3, 2)) == WHITE);
+    UTEST_ASSERT_TRUE(target.getPixel(Point(4, 1)) == WHITE);
+
+    // fully outside: nothing happens
+    RgbaCompositor::over(layer, target, Point(-10, 0));
+    UTEST_ASSERT_TRUE(target.getPixel(Point(0, 3)) == WHITE);
+}
+
+UTEST_FUNC_DEF(OverLayers_EqualsSequentialOver) {
+    RgbaImage bottom(8, 4);
+    RgbaImage top(5, 3);
+    unsigned char coverage[8] = {0, 32, 64, 96, 128, 160, 192, 255};
+    PixelPainterForRgbaImage bottomPainter(bottom);
+    PixelPainterForRgbaImage topPainter(top);
+    for (unsigned int y = 0; y < 4; ++y) {
+        bottomPainter.blendSpan(0, y, 8, RED, coverage);
+        topPainter.blendSpan(0, y, 8, BLUE, coverage + 2);
+    }
+
+    RgbImage sequential(8, 4);
+    RgbImage onePass(8, 4);
+    BackgroundPainterForRgbImage(sequential).paint(WHITE);
+    BackgroundPainterForRgbImage(onePass).paint(WHITE);
+
+    RgbaCompositor::over(bottom, sequential);
+    RgbaCompositor::over(top, sequential);
+    RgbaCompositor::overLayers(onePass, {&bottom, &top});
+
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 8; ++x)
+            UTEST_ASSERT_TRUE(sequential.getPixel(Point(x, y)) == onePass.getPixel(Point(x, y)));
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(MulDiv255_IsExact);
+    UTEST_FUNC(NewImage_IsTransparentAndAligned);
+    UTEST_FUNC(PixelAccess_StoresPremultiplied);
+    UTEST_FUNC(OverSpan_MatchesFormula);
+    UTEST_FUNC(InOutSpans_UseDestinationAlpha);
+    UTEST_FUNC(OverRgb_MatchesFloatAlphaPainter);
+    UTEST_FUNC(Over_ClipsLayerAtOffset);
+    UTEST_FUNC(OverLayers_EqualsSequentialOver);
+
+    UTEST_EPILOG();
+}
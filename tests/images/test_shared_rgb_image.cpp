@@ -0,0 +1,201 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/shared_rgb_image.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @file test_shared_rgb_image.cpp
+ * @brief Tests for RGB image in POSIX shared memory and its seqlock frame handoff between processes
+ */
+
+namespace {
+
+std::string segmentName(const char *name) {
+    return std::string("/uimg_test_") + name + "_" + std::to_string(::getpid());
+}
+
+// every pixel of frame `frame` has the same color, so a torn read shows up as mixed colors
+void paintFrame(RgbImageBase &image, unsigned int frame) {
+    unsigned char value = static_cast<unsigned char>(frame);
+    for (unsigned int y = 0; y < image.height(); ++y)
+        memset(image.row(y), value, image.rowSize());
+}
+
+// frame number encoded in image, or -1 if pixels of different frames are mixed
+int frameOf(const RgbImageBase &image) {
+    unsigned char value = image.row(0)[0];
+    for (unsigned int y = 0; y < image.height(); ++y)
+        for (size_t i = 0; i < image.rowSize(); ++i)
+            if (image.row(y)[i] != value)
+                return -1;
+    return value;
+}
+
+// consumer process: reads frames until `frames` were published, returns exit code
+int runConsumer(const std::string &name, unsigned int frames) {
+    try {
+        SharedRgbImage image(name);
+        RgbImage copy(image.width(), image.height());
+        unsigned int reads = 0;
+        // until there is a successful read too: consumer can start after the last frame and, when it is slow,
+        // all its reads can overlap painting
+        while (image.frameCount() < frames || reads == 0) {
+            // in place read, checked by seqlock
+            uint64_t sequence = image.beginRead();
+            int frame = frameOf(image);
+            if (image.validateRead(sequence)) {
+                if (sequence > 0 && frame != static_cast<int>((sequence / 2) % 256))
+                    return 2;
+                ++reads;
+            }
+
+            uint64_t copied = image.copyFrame(copy);
+            if (copied > 0 && frameOf(copy) != static_cast<int>(copied % 256))
+                return 3;
+        }
+        return 0;
+    } catch (...) {
+        return 5;
+    }
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(SharedImage_OpenSharesPixelsAndHeader) {
+    std::string name = segmentName("open");
+    SharedRgbImage producer(name, 33, 7);
+    UTEST_ASSERT_EQUALS(producer.stride(), RgbImage::alignedStride(33));
+    UTEST_ASSERT_EQUALS(producer.frameCount(), 0u);
+
+    SharedRgbImage consumer(name);
+    UTEST_ASSERT_EQUALS(consumer.width(), 33u);
+    UTEST_ASSERT_EQUALS(consumer.height(), 7u);
+    UTEST_ASSERT_EQUALS(consumer.stride(), producer.stride());
+    // separate mappings of the same memory
+    UTEST_ASSERT_TRUE(consumer.row(0) != producer.row(0));
+
+    producer.beginFrame();
+    producer.setPixel(Point(32, 6), RgbColor::make_rgb(1, 2, 3));
+    UTEST_ASSERT_EQUALS(consumer.frameCount(), 0u);
+    producer.publishFrame();
+
+    UTEST_ASSERT_EQUALS(consumer.frameCount(), 1u);
+    uint64_t sequence = consumer.beginRead();
+    RgbColor color = consumer.getPixel(Point(32, 6));
+    UTEST_ASSERT_TRUE(consumer.validateRead(sequence));
+    UTEST_ASSERT_EQUALS(static_cast<int>(color.blue), 3);
+}
+
+UTEST_FUNC_DEF(SharedImage_ReadOverlappingFrameIsRejected) {
+    std::string name = segmentName("overlap");
+    SharedRgbImage producer(name, 4, 4);
+    SharedRgbImage consumer(name);
+
+    uint64_t sequence = consumer.beginRead();
+    producer.beginFrame();
+    UTEST_ASSERT_FALSE(consumer.validateRead(sequence));
+    producer.publishFrame();
+    UTEST_ASSERT_FALSE(consumer.validateRead(sequence));
+    UTEST_ASSERT_TRUE(consumer.validateRead(consumer.beginRead()));
+
+    bool thrown = false;
+    try {
+        producer.publishFrame();
+    } catch (const std::logic_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(SharedImage_InvalidSegmentsThrow) {
+    bool thrown = false;
+    try {
+        SharedRgbImage image(segmentName("missing"));
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    thrown = false;
+    try {
+        SharedRgbImage image("no_slash", 2, 2);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    // name is removed with its creator
+    std::string name = segmentName("unlinked");
+    { SharedRgbImage image(name, 2, 2); }
+    thrown = false;
+    try {
+        SharedRgbImage image(name);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(SharedImage_RecreateKeepsOldMappingValid) {
+    std::string name = segmentName("recreate");
+    SharedRgbImage first(name, 64, 64, false);
+    first.beginFrame();
+    paintFrame(first, 7);
+    first.publishFrame();
+    SharedRgbImage consumer(name);
+
+    // smaller segment of the same name; truncating the old one would make consumer reads fault
+    SharedRgbImage second(name, 4, 4);
+    UTEST_ASSERT_EQUALS(consumer.width(), 64u);
+    UTEST_ASSERT_EQUALS(frameOf(consumer), 7);
+    UTEST_ASSERT_EQUALS(consumer.frameCount(), 1u);
+
+    SharedRgbImage reopened(name);
+    UTEST_ASSERT_EQUALS(reopened.width(), 4u);
+    UTEST_ASSERT_EQUALS(reopened.frameCount(), 0u);
+}
+
+UTEST_FUNC_DEF(SharedImage_ConsumerProcessSeesOnlyCompleteFrames) {
+    const unsigned int frames = 300;
+    std::string name = segmentName("frames");
+    SharedRgbImage producer(name, 64, 48);
+
+    pid_t child = ::fork();
+    if (child == 0)
+        ::_exit(runConsumer(name, frames));
+    UTEST_ASSERT_TRUE(child > 0);
+
+    for (unsigned int frame = 1; frame <= frames; ++frame) {
+        producer.beginFrame();
+        paintFrame(producer, frame);
+        producer.publishFrame();
+        if (frame % 16 == 0)
+            ::usleep(200);
+    }
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    UTEST_ASSERT_TRUE(WIFEXITED(status));
+    UTEST_ASSERT_EQUALS(WEXITSTATUS(status), 0);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(SharedImage_OpenSharesPixelsAndHeader);
+    UTEST_FUNC(SharedImage_ReadOverlappingFrameIsRejected);
+    UTEST_FUNC(SharedImage_InvalidSegmentsThrow);
+    UTEST_FUNC(SharedImage_RecreateKeepsOldMappingValid);
+    UTEST_FUNC(SharedImage_ConsumerProcessSeesOnlyCompleteFrames);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,205 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/tile_pyramid.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+/**
+ * @file test_tile_pyramid.cpp
+ * @brief Tests for deep-zoom tile pyramid writer
+ */
+
+namespace {
+
+std::string tempDirectory(const char *name) {
+    std::string path = std::string("/tmp/uimg_test_pyramid_") + name + "_" + std::to_string(::getpid());
+    std::filesystem::remove_all(path);
+    return path;
+}
+
+std::string readFile(const std::string &path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+void fillPattern(RgbImage &image) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x * 7 + y, y * 5, (x ^ y) * 3));
+}
+
+// reference 2x downsampling of whole image
+RgbImage downsample(const RgbImage &image) {
+    RgbImage result((image.width() + 1) / 2, (image.height() + 1) / 2);
+    for (unsigned int y = 0; y < result.height(); ++y) {
+        unsigned int y1 = std::min(2 * y + 1, image.height() - 1);
+        TilePyramidWriter::downsampleRows(image.row(2 * y), image.row(y1), image.width(), result.row(y));
+    }
+    return result;
+}
+
+// true if tile file holds given part of image
+bool tileMatches(const std::string &path, const RgbImage &image, unsigned int x, unsigned int y, unsigned int tileSize) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+        return false;
+    PpmImageLoaderForRgbImage loader(input);
+    std::unique_ptr<PixelImageBase> tile(loader.loadImage());
+    if (!tile)
+        return false;
+    unsigned int width = std::min(tileSize, image.width() - x);
+    unsigned int height = std::min(tileSize, image.height() - y);
+    if (tile->width() != width || tile->height() != height)
+        return false;
+    RgbImage &rgb = static_cast<RgbImage &>(*tile);
+    for (unsigned int row = 0; row < height; ++row)
+        if (memcmp(rgb.row(row), image.row(y + row) + static_cast<size_t>(x) * 3, rgb.rowSize()) != 0)
+            return false;
+    return true;
+}
+
+// passes image to writer in bands of `bandHeight` rows
+void writeInBands(TilePyramidWriter &writer, const RgbImage &image, unsigned int bandHeight) {
+    writer.beginImage(image.width(), image.height());
+    for (unsigned int y = 0; y < image.height(); y += bandHeight) {
+        RgbImage band(image.width(), std::min(bandHeight, image.height() - y));
+        for (unsigned int row = 0; row < band.height(); ++row)
+            memcpy(band.row(row), image.row(y + row), band.rowSize());
+        writer.writeRows(band);
+    }
+    writer.endImage();
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Pyramid_LevelsMatchBoxDownsampling) {
+    std::string directory = tempDirectory("levels");
+    RgbImage image(150, 70);
+    fillPattern(image);
+
+    TilePyramidWriter writer(directory, 32, TilePyramidWriter::PPM, 3);
+    writeInBands(writer, image, 13);
+
+    // 150x70 -> 75x35 -> 38x18 -> 19x9
+    UTEST_ASSERT_EQUALS(writer.levelCount(), 4u);
+    UTEST_ASSERT_EQUALS(writer.levelSize(2).x, 38);
+    UTEST_ASSERT_EQUALS(writer.levelSize(3).y, 9);
+
+    RgbImage level = image;
+    bool matches = true;
+    size_t tiles = 0;
+    for (unsigned int index = 0; index < writer.levelCount(); ++index) {
+        for (unsigned int y = 0; y < level.height(); y += 32)
+            for (unsigned int x = 0; x < level.width(); x += 32, ++tiles)
+                matches = matches && tileMatches(directory + "/" + writer.tilePath(index, x / 32, y / 32), level, x, y, 32);
+        level = downsample(level);
+    }
+    UTEST_ASSERT_TRUE(matches);
+    // 5x3 + 3x2 + 2x1 + 1
+    UTEST_ASSERT_EQUALS(tiles, 24u);
+    UTEST_ASSERT_EQUALS(writer.tilesWritten(), tiles);
+    UTEST_ASSERT_EQUALS(writer.tilesSkipped(), 0u);
+
+    std::string manifest = readFile(directory + "/pyramid.txt");
+    UTEST_ASSERT_TRUE(manifest.find("size 150 70\ntile 32\nlevels 4\nformat ppm\n") != std::string::npos);
+    std::filesystem::remove_all(directory);
+}
+
+UTEST_FUNC_DEF(Pyramid_UniformTilesAreListedNotWritten) {
+    std::string directory = tempDirectory("uniform");
+    RgbImage image(64, 64);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x)
+            image.setPixel(Point(x, y), x < 32 ? RgbColor::make_rgb(255, 128, 0) : RgbColor::make_rgb(x, y, 0));
+
+    TilePyramidWriter writer(directory, 32, TilePyramidWriter::PNG);
+    writer.writeImage(image);
+
+    UTEST_ASSERT_EQUALS(writer.levelCount(), 2u);
+    UTEST_ASSERT_EQUALS(writer.tilesSkipped(), 2u);
+    UTEST_ASSERT_EQUALS(writer.tilesWritten(), 3u);
+    UTEST_ASSERT_FALSE(std::filesystem::exists(directory + "/0/0_1.png"));
+    UTEST_ASSERT_TRUE(readFile(directory + "/0/1_1.png").compare(0, 4, "\x89PNG") == 0);
+
+    std::string manifest = readFile(directory + "/pyramid.txt");
+    UTEST_ASSERT_TRUE(manifest.find("uniform 0 0 0 ff8000\nuniform 0 0 1 ff8000\n") != std::string::npos);
+    std::filesystem::remove_all(directory);
+}
+
+UTEST_FUNC_DEF(Pyramid_OutputIndependentOfBands) {
+    std::string first = tempDirectory("bands1");
+    std::string second = tempDirectory("bands2");
+    RgbImage image(90, 100);
+    fillPattern(image);
+
+    TilePyramidWriter writer1(first, 16, TilePyramidWriter::PPM, 1);
+    writeInBands(writer1, image, 1);
+    TilePyramidWriter writer2(second, 16, TilePyramidWriter::PPM, 4);
+    writeInBands(writer2, image, 100);
+
+    bool same = true;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(first)) {
+        if (!entry.is_regular_file())
+            continue;
+        std::string relative = entry.path().string().substr(first.size());
+        same = same && readFile(entry.path().string()) == readFile(second + relative);
+    }
+    UTEST_ASSERT_TRUE(same);
+    std::filesystem::remove_all(first);
+    std::filesystem::remove_all(second);
+}
+
+UTEST_FUNC_DEF(Pyramid_RejectsInvalidInput) {
+    bool thrown = false;
+    try {
+        TilePyramidWriter writer("/tmp", 15);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    std::string directory = tempDirectory("incomplete");
+    TilePyramidWriter writer(directory, 16, TilePyramidWriter::PPM);
+    writer.beginImage(20, 20);
+    RgbImage band(20, 10);
+    writer.writeRows(band);
+
+    thrown = false;
+    try {
+        writer.endImage();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    thrown = false;
+    try {
+        RgbImage tooMany(20, 11);
+        writer.writeRows(tooMany);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+    std::filesystem::remove_all(directory);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Pyramid_LevelsMatchBoxDownsampling);
+    UTEST_FUNC(Pyramid_UniformTilesAreListedNotWritten);
+    UTEST_FUNC(Pyramid_OutputIndependentOfBands);
+    UTEST_FUNC(Pyramid_RejectsInvalidInput);
+
+    UTEST_EPILOG();
+}
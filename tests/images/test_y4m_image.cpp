@@ -0,0 +1,216 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/y4m_image.h"
+#include "uimg/utils/bounded_queue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file test_y4m_image.cpp
+ * @brief Tests for RGB to YUV conversion, Y4M / raw RGB frame writer and bounded queue
+ */
+
+namespace {
+
+// accepts only `limit` bytes, then fails
+class LimitedBuf : public std::streambuf {
+public:
+    explicit LimitedBuf(size_t limit) : limit_(limit) {}
+
+protected:
+    virtual std::streamsize xsputn(const char *, std::streamsize count) {
+        size_t accepted = std::min(limit_, static_cast<size_t>(count));
+        limit_ -= accepted;
+        return static_cast<std::streamsize>(accepted);
+    }
+
+    virtual int_type overflow(int_type ch) {
+        if (limit_ == 0)
+            return traits_type::eof();
+        --limit_;
+        return traits_type::not_eof(ch);
+    }
+
+private:
+    size_t limit_;
+};
+
+void fillFrame(RgbImage &image, int frame) {
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            image.setPixel(Point(x, y), RgbColor::make_rgb(x * 20 + frame, y * 30, frame * 50));
+}
+
+std::vector<unsigned char> yuvOf(const RgbColor &color) {
+    RgbImage image(2, 2);
+    for (int y = 0; y < 2; ++y)
+        for (int x = 0; x < 2; ++x)
+            image.setPixel(Point(x, y), color);
+    std::vector<unsigned char> output(YuvConverter::frameSize420(2, 2));
+    std::vector<unsigned char> rowBuffer;
+    YuvConverter::toYuv420(image, output.data(), rowBuffer);
+    return output;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(YuvConverter_LimitedRangeValues) {
+    std::vector<unsigned char> white = yuvOf(RgbColor::make_rgb(255, 255, 255));
+    UTEST_ASSERT_EQUALS(static_cast<int>(white[0]), 235);
+    UTEST_ASSERT_EQUALS(static_cast<int>(white[4]), 128);
+    UTEST_ASSERT_EQUALS(static_cast<int>(white[5]), 128);
+
+    std::vector<unsigned char> black = yuvOf(RgbColor::make_rgb(0, 0, 0));
+    UTEST_ASSERT_EQUALS(static_cast<int>(black[3]), 16);
+    UTEST_ASSERT_EQUALS(static_cast<int>(black[4]), 128);
+
+    std::vector<unsigned char> red = yuvOf(RgbColor::make_rgb(255, 0, 0));
+    UTEST_ASSERT_EQUALS(static_cast<int>(red[0]), 82);
+    UTEST_ASSERT_EQUALS(static_cast<int>(red[4]), 90);
+    UTEST_ASSERT_EQUALS(static_cast<int>(red[5]), 240);
+}
+
+UTEST_FUNC_DEF(YuvConverter_OddSizeAveragesBlocks) {
+    RgbImage image(5, 3);
+    image.setPixel(Point(0, 0), RgbColor::make_rgb(255, 0, 0));
+    image.setPixel(Point(4, 2), RgbColor::make_rgb(255, 0, 0));
+    UTEST_ASSERT_EQUALS(YuvConverter::frameSize420(5, 3), static_cast<size_t>(15 + 2 * 3 * 2));
+
+    std::vector<unsigned char> output(YuvConverter::frameSize420(5, 3));
+    std::vector<unsigned char> rowBuffer;
+    YuvConverter::toYuv420(image, output.data(), rowBuffer);
+
+    const unsigned char *cr = output.data() + 15 + 6;
+    // quarter of red in first block, whole block of red in bottom right corner
+    UTEST_ASSERT_EQUALS(static_cast<int>(cr[0]), (112 * 255 + (128 << 10) + 512) >> 10);
+    UTEST_ASSERT_EQUALS(static_cast<int>(cr[5]), 240);
+    UTEST_ASSERT_EQUALS(static_cast<int>(cr[4]), 128);
+    UTEST_ASSERT_EQUALS(static_cast<int>(output[14]), 82);
+}
+
+UTEST_FUNC_DEF(Y4mFrameWriter_WritesHeaderAndFrames) {
+    std::ostringstream output;
+    {
+        Y4mFrameWriter writer(output, Y4mFrameWriter::Y4M, 30000, 1001);
+        RgbImage image(6, 4);
+        for (int frame = 0; frame < 5; ++frame) {
+            fillFrame(image, frame);
+            writer.writeImage(image);
+        }
+        UTEST_ASSERT_EQUALS(writer.frameCount(), 5u);
+        writer.finish();
+    }
+
+    std::string header = Y4mFrameWriter::formatHeader(6, 4, 30000, 1001);
+    UTEST_ASSERT_TRUE(output.str().compare(0, header.size(), header) == 0);
+    UTEST_ASSERT_TRUE(header.find("W6 H4 F30000:1001") != std::string::npos);
+    size_t frameSize = 6 + YuvConverter::frameSize420(6, 4);
+    UTEST_ASSERT_EQUALS(output.str().size(), header.size() + 5 * frameSize);
+
+    // frames are written in order
+    RgbImage image(6, 4);
+    fillFrame(image, 3);
+    std::vector<unsigned char> expected(YuvConverter::frameSize420(6, 4));
+    std::vector<unsigned char> rowBuffer;
+    YuvConverter::toYuv420(image, expected.data(), rowBuffer);
+    std::string third = output.str().substr(header.size() + 3 * frameSize, frameSize);
+    UTEST_ASSERT_TRUE(third.compare(0, 6, "FRAME\n") == 0);
+    UTEST_ASSERT_TRUE(memcmp(third.data() + 6, expected.data(), expected.size()) == 0);
+}
+
+UTEST_FUNC_DEF(Y4mFrameWriter_RawRgbFrames) {
+    std::ostringstream output;
+    RgbImage image(7, 3);
+    {
+        Y4mFrameWriter writer(output, Y4mFrameWriter::RAW_RGB, 25, 1, 1);
+        for (int frame = 0; frame < 4; ++frame) {
+            fillFrame(image, frame);
+            writer.writeImage(image);
+        }
+    }
+    UTEST_ASSERT_EQUALS(output.str().size(), 4u * 7 * 3 * 3);
+    std::string last = output.str().substr(3 * 63);
+    bool same = true;
+    for (int y = 0; y < 3; ++y)
+        same = same && memcmp(last.data() + y * 21, image.row(static_cast<unsigned int>(y)), 21) == 0;
+    UTEST_ASSERT_TRUE(same);
+}
+
+UTEST_FUNC_DEF(Y4mFrameWriter_RejectsOtherFrameSize) {
+    std::ostringstream output;
+    Y4mFrameWriter writer(output);
+    RgbImage first(8, 8), second(8, 6);
+    writer.writeImage(first);
+
+    bool thrown = false;
+    try {
+        writer.writeImage(second);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+    UTEST_ASSERT_EQUALS(writer.frameCount(), 1u);
+}
+
+UTEST_FUNC_DEF(Y4mFrameWriter_ReportsStreamError) {
+    LimitedBuf buffer(1000);
+    std::ostream output(&buffer);
+    Y4mFrameWriter writer(output, Y4mFrameWriter::RAW_RGB);
+    RgbImage image(20, 20);
+
+    bool thrown = false;
+    try {
+        for (int frame = 0; frame < 10; ++frame)
+            writer.writeImage(image);
+        writer.finish();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(BoundedQueue_KeepsOrderAndCloses) {
+    BoundedQueue<int> queue(2);
+    std::vector<int> received;
+    std::thread consumer([&queue, &received] {
+        int value;
+        while (queue.pop(value))
+            received.push_back(value);
+    });
+
+    for (int i = 0; i < 1000; ++i)
+        UTEST_ASSERT_TRUE(queue.push(i));
+    queue.close();
+    consumer.join();
+
+    UTEST_ASSERT_EQUALS(received.size(), 1000u);
+    bool ordered = true;
+    for (int i = 0; i < 1000; ++i)
+        ordered = ordered && received[static_cast<size_t>(i)] == i;
+    UTEST_ASSERT_TRUE(ordered);
+    UTEST_ASSERT_FALSE(queue.push(1));
+
+    int value = 0;
+    UTEST_ASSERT_FALSE(queue.tryPop(value));
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(YuvConverter_LimitedRangeValues);
+    UTEST_FUNC(YuvConverter_OddSizeAveragesBlocks);
+    UTEST_FUNC(Y4mFrameWriter_WritesHeaderAndFrames);
+    UTEST_FUNC(Y4mFrameWriter_RawRgbFrames);
+    UTEST_FUNC(Y4mFrameWriter_RejectsOtherFrameSize);
+    UTEST_FUNC(Y4mFrameWriter_ReportsStreamError);
+    UTEST_FUNC(BoundedQueue_KeepsOrderAndCloses);
+
+    UTEST_EPILOG();
+}
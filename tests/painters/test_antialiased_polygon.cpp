@@ -0,0 +1,285 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/antialiased_painter_for_pixels.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_sink.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * @file test_antialiased_polygon.cpp
+ * @brief Tests for anti-aliased polygon filling with analytic coverage
+ */
+
+namespace {
+
+const RgbColor WHITE = {255, 255, 255};
+const RgbColor BLACK = {0, 0, 0};
+
+// sink which sums coverage (0-255) painted into each pixel
+class CoverageSink {
+public:
+    CoverageSink(int width, int height) : width_(width), height_(height),
+                                          coverage_(static_cast<size_t>(width * height), 0) {}
+
+    void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &) {
+        for (unsigned int i = 0; i < length; ++i)
+            add(x + i, y, 255);
+    }
+
+    void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &,
+                   const unsigned char *coverage) {
+        for (unsigned int i = 0; i < length; ++i)
+            add(x + i, y, coverage[i]);
+    }
+
+    int at(int x, int y) const {
+        return coverage_[static_cast<size_t>(y * width_ + x)];
+    }
+
+    double area() const {
+        double total = 0;
+        for (int value : coverage_)
+            total += value / 255.0;
+        return total;
+    }
+
+    int outside() const {
+        return outside_;
+    }
+
+private:
+    void add(unsigned int x, unsigned int y, int value) {
+        if (static_cast<int>(x) >= width_ || static_cast<int>(y) >= height_) {
+            ++outside_;
+            return;
+        }
+        coverage_[y * static_cast<size_t>(width_) + x] += value;
+    }
+
+    int width_;
+    int height_;
+    std::vector<int> coverage_;
+    int outside_ = 0;
+};
+
+std::vector<PointF> circle(float cx, float cy, float r, int segments) {
+    std::vector<PointF> points;
+    for (int i = 0; i < segments; ++i) {
+        double angle = 2 * 3.14159265358979 * i / segments;
+        points.push_back(PointF(cx + r * static_cast<float>(std::cos(angle)), cy + r * static_cast<float>(std::sin(angle))));
+    }
+    return points;
+}
+
+double shoelaceArea(const std::vector<PointF> &points) {
+    double area = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const PointF &a = points[i];
+        const PointF &b = points[(i + 1) % points.size()];
+        area += static_cast<double>(a.x) * b.y - static_cast<double>(b.x) * a.y;
+    }
+    return std::fabs(area) / 2;
+}
+
+// coverage of pixel by triangle, from 32x32 samples
+int sampledCoverage(const std::vector<PointF> &t, int px, int py) {
+    int inside = 0;
+    for (int sy = 0; sy < 32; ++sy)
+        for (int sx = 0; sx < 32; ++sx) {
+            double x = px + (sx + 0.5) / 32, y = py + (sy + 0.5) / 32;
+            double d1 = (t[1].x - t[0].x) * (y - t[0].y) - (t[1].y - t[0].y) * (x - t[0].x);
+            double d2 = (t[2].x - t[1].x) * (y - t[1].y) - (t[2].y - t[1].y) * (x - t[1].x);
+            double d3 = (t[0].x - t[2].x) * (y - t[2].y) - (t[0].y - t[2].y) * (x - t[2].x);
+            bool negative = d1 < 0 || d2 < 0 || d3 < 0, positive = d1 > 0 || d2 > 0 || d3 > 0;
+            if (!(negative && positive))
+                ++inside;
+        }
+    return (inside * 255 + 512) / 1024;
+}
+
+// part of polygon between vertical lines x = left and x = right (Sutherland-Hodgman)
+std::vector<PointF> clipColumns(const std::vector<PointF> &points, float left, float right) {
+    std::vector<PointF> result = points;
+    for (int side = 0; side < 2; ++side) {
+        std::vector<PointF> input = result;
+        result.clear();
+        auto inside = [side, left, right](const PointF &p) { return side == 0 ? p.x >= left : p.x <= right; };
+        float border = side == 0 ? left : right;
+        for (size_t i = 0; i < input.size(); ++i) {
+            const PointF &a = input[i];
+            const PointF &b = input[(i + 1) % input.size()];
+            if (inside(a))
+                result.push_back(a);
+            if (inside(a) != inside(b)) {
+                float t = (border - a.x) / (b.x - a.x);
+                result.push_back(PointF(border, a.y + (b.y - a.y) * t));
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(AAPolygon_FractionalEdgesGivePartialCoverage) {
+    CoverageSink sink(5, 3);
+    AntiAliasedPolygonPainterForSink<CoverageSink> painter(sink);
+    std::vector<PointF> rect = {PointF(0.25f, 0.0f), PointF(2.75f, 0.0f), PointF(2.75f, 1.5f), PointF(0.25f, 1.5f)};
+    painter.drawFull(rect, WHITE);
+
+    UTEST_ASSERT_EQUALS(sink.at(0, 0), 191);
+    UTEST_ASSERT_EQUALS(sink.at(1, 0), 255);
+    UTEST_ASSERT_EQUALS(sink.at(2, 0), 191);
+    UTEST_ASSERT_EQUALS(sink.at(3, 0), 0);
+    UTEST_ASSERT_EQUALS(sink.at(1, 1), 128);
+    UTEST_ASSERT_EQUALS(sink.at(0, 1), 96);
+    UTEST_ASSERT_EQUALS(sink.at(1, 2), 0);
+}
+
+UTEST_FUNC_DEF(AAPolygon_CoverageMatchesAreaAndSampling) {
+    std::vector<PointF> disc = circle(30.3f, 25.7f, 20.0f, 200);
+    CoverageSink sink(64, 64);
+    AntiAliasedPolygonPainterForSink<CoverageSink> painter(sink);
+    painter.drawFull(disc, WHITE);
+    UTEST_ASSERT_TRUE(std::fabs(sink.area() - shoelaceArea(disc)) < 0.5);
+
+    std::vector<PointF> triangle = {PointF(2.3f, 1.7f), PointF(28.9f, 9.2f), PointF(8.4f, 27.6f)};
+    CoverageSink exact(32, 32);
+    AntiAliasedPolygonPainterForSink<CoverageSink>(exact).drawFull(triangle, WHITE);
+    int worst = 0;
+    for (int y = 0; y < 32; ++y)
+        for (int x = 0; x < 32; ++x)
+            worst = std::max(worst, std::abs(exact.at(x, y) - sampledCoverage(triangle, x, y)));
+    UTEST_ASSERT_TRUE(worst <= 6);
+}
+
+UTEST_FUNC_DEF(AAPolygon_SharedEdgeCoverageAddsUp) {
+    CoverageSink sink(20, 20);
+    AntiAliasedPolygonPainterForSink<CoverageSink> painter(sink);
+    std::vector<PointF> first = {PointF(2, 2), PointF(18, 2), PointF(2, 18)};
+    std::vector<PointF> second = {PointF(18, 2), PointF(18, 18), PointF(2, 18)};
+    painter.drawFull(first, WHITE);
+    painter.drawFull(second, WHITE);
+
+    bool seamless = true;
+    for (int y = 2; y < 18; ++y)
+        for (int x = 2; x < 18; ++x)
+            seamless = seamless && std::abs(sink.at(x, y) - 255) <= 1;
+    UTEST_ASSERT_TRUE(seamless);
+    UTEST_ASSERT_EQUALS(sink.at(1, 5), 0);
+}
+
+UTEST_FUNC_DEF(AAPolygon_FillRules) {
+    std::vector<std::vector<PointF>> rings = {circle(16, 16, 14, 64), circle(16, 16, 6, 64)};
+    CoverageSink evenOdd(32, 32), nonZero(32, 32);
+    AntiAliasedPolygonPainterForSink<CoverageSink>(evenOdd).drawFull(rings, WHITE, PolygonPainter::EVEN_ODD);
+    AntiAliasedPolygonPainterForSink<CoverageSink>(nonZero).drawFull(rings, WHITE, PolygonPainter::NON_ZERO);
+
+    UTEST_ASSERT_EQUALS(evenOdd.at(16, 16), 0);
+    UTEST_ASSERT_EQUALS(evenOdd.at(16, 5), 255);
+    UTEST_ASSERT_EQUALS(nonZero.at(16, 16), 255);
+    double expected = shoelaceArea(rings[0]) - shoelaceArea(rings[1]);
+    UTEST_ASSERT_TRUE(std::fabs(evenOdd.area() - expected) < 0.5);
+}
+
+UTEST_FUNC_DEF(AAPolygon_ClipsToCanvas) {
+    CoverageSink sink(10, 10);
+    AntiAliasedPolygonPainterForSink<CoverageSink> painter(sink, Point(10, 10));
+    // left part outside of canvas still covers pixels inside of it
+    std::vector<PointF> shape = {PointF(-30.0f, -7.0f), PointF(5.5f, -7.0f), PointF(5.5f, 5.5f), PointF(-30.0f, 5.5f)};
+    painter.drawFull(shape, WHITE);
+    UTEST_ASSERT_EQUALS(sink.at(0, 0), 255);
+    UTEST_ASSERT_EQUALS(sink.at(4, 4), 255);
+    UTEST_ASSERT_EQUALS(sink.at(5, 4), 128);
+    UTEST_ASSERT_EQUALS(sink.at(5, 5), 64);
+    UTEST_ASSERT_EQUALS(sink.at(6, 0), 0);
+
+    std::vector<PointF> large = {PointF(-5, -5), PointF(100, -3), PointF(90, 120)};
+    painter.drawFull(large, WHITE);
+    UTEST_ASSERT_EQUALS(sink.outside(), 0);
+    // right part outside of canvas
+    UTEST_ASSERT_EQUALS(sink.at(9, 9), 255);
+}
+
+UTEST_FUNC_DEF(AAPolygon_VerticesLeftAndRightOfCanvas) {
+    // slanted edges crossing the left border, rounding along them used to step before the first cell
+    std::vector<PointF> shape = {PointF(-0.375f, 1.25f), PointF(11.75f, 0.875f), PointF(21.25f, 1.0f),
+                                 PointF(30.25f, 4.5f), PointF(52.375f, 27.625f), PointF(18.125f, 31.875f),
+                                 PointF(10.625f, 29.375f)};
+    CoverageSink sink(60, 50);
+    AntiAliasedPolygonPainterForSink<CoverageSink>(sink, Point(60, 50)).drawFull(shape, WHITE, PolygonPainter::NON_ZERO);
+    UTEST_ASSERT_EQUALS(sink.outside(), 0);
+    UTEST_ASSERT_TRUE(std::fabs(sink.area() - shoelaceArea(clipColumns(shape, 0, 60))) < 0.5);
+    bool emptyRight = true;
+    for (int x = 32; x < 60; ++x)
+        emptyRight = emptyRight && sink.at(x, 1) == 0;
+    UTEST_ASSERT_TRUE(emptyRight);
+
+    // band crossing the whole canvas: vertical thickness 10 at every column
+    std::vector<PointF> band = {PointF(-13.3f, 10.1f), PointF(77.7f, 30.3f), PointF(77.7f, 40.3f), PointF(-13.3f, 20.1f)};
+    CoverageSink crossing(60, 50);
+    AntiAliasedPolygonPainterForSink<CoverageSink>(crossing, Point(60, 50)).drawFull(band, WHITE);
+    UTEST_ASSERT_EQUALS(crossing.outside(), 0);
+    UTEST_ASSERT_TRUE(std::fabs(crossing.area() - 600.0) < 0.5);
+    UTEST_ASSERT_EQUALS(crossing.at(0, 16), 255);
+    UTEST_ASSERT_EQUALS(crossing.at(59, 35), 255);
+
+    // random polygons reaching past both borders
+    unsigned int state = 3;
+    double worst = 0;
+    for (int k = 0; k < 200; ++k) {
+        std::vector<PointF> polygon;
+        for (int i = 0; i < 5; ++i) {
+            state = state * 1103515245u + 12345u;
+            float x = static_cast<float>((state >> 8) % 10000) / 100.0f - 20.0f;
+            state = state * 1103515245u + 12345u;
+            float y = static_cast<float>((state >> 8) % 4000) / 100.0f + 2.0f;
+            polygon.push_back(PointF(x, y));
+        }
+        // convex hull order is not needed for area of clipped simple polygon, use a star around its centroid
+        float cx = 0, cy = 0;
+        for (const PointF &point : polygon) {
+            cx += point.x / 5;
+            cy += point.y / 5;
+        }
+        std::sort(polygon.begin(), polygon.end(), [cx, cy](const PointF &a, const PointF &b) {
+            return std::atan2(a.y - cy, a.x - cx) < std::atan2(b.y - cy, b.x - cx);
+        });
+        CoverageSink random(60, 50);
+        AntiAliasedPolygonPainterForSink<CoverageSink>(random, Point(60, 50)).drawFull(polygon, WHITE);
+        UTEST_ASSERT_EQUALS(random.outside(), 0);
+        worst = std::max(worst, std::fabs(random.area() - shoelaceArea(clipColumns(polygon, 0, 60))));
+    }
+    UTEST_ASSERT_TRUE(worst < 0.5);
+}
+
+UTEST_FUNC_DEF(AAPolygon_BlendsIntoImage) {
+    RgbImage image(8, 4);
+    PixelPainterForRgbImage pixelPainter(image);
+    AntiAliasedPolygonPainterForPixels painter(pixelPainter, Point(8, 4));
+    std::vector<std::vector<PointF>> rect = {{PointF(1, 0), PointF(3.5f, 0), PointF(3.5f, 4), PointF(1, 4)}};
+    painter.drawFull(rect, WHITE);
+
+    UTEST_ASSERT_TRUE(image.getPixel(0, 1) == BLACK);
+    UTEST_ASSERT_TRUE(image.getPixel(2, 1) == WHITE);
+    UTEST_ASSERT_EQUALS(static_cast<int>(image.getPixel(3, 1).green), 128);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(AAPolygon_FractionalEdgesGivePartialCoverage);
+    UTEST_FUNC(AAPolygon_CoverageMatchesAreaAndSampling);
+    UTEST_FUNC(AAPolygon_SharedEdgeCoverageAddsUp);
+    UTEST_FUNC(AAPolygon_FillRules);
+    UTEST_FUNC(AAPolygon_ClipsToCanvas);
+    UTEST_FUNC(AAPolygon_VerticesLeftAndRightOfCanvas);
+    UTEST_FUNC(AAPolygon_BlendsIntoImage);
+
+    UTEST_EPILOG();
+}
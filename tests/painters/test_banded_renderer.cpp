@@ -0,0 +1,185 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/images/ppm_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/painters/display_list_painter.h"
+#include "uimg/painters/banded_renderer.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @file test_banded_renderer.cpp
+ * @brief Tests for banded rendering with streaming output
+ */
+
+namespace {
+
+const unsigned int CANVAS_WIDTH = 160;
+const unsigned int CANVAS_HEIGHT = 123;
+const RgbColor BACKGROUND = {240, 248, 255};
+
+unsigned int nextRandom(unsigned int &seed, unsigned int range) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) % range;
+}
+
+RgbColor randomColor(unsigned int &seed) {
+    return {static_cast<unsigned char>(nextRandom(seed, 256)), static_cast<unsigned char>(nextRandom(seed, 256)),
+            static_cast<unsigned char>(nextRandom(seed, 256))};
+}
+
+// draws pseudo-random scene on any set of painters, some shapes reach outside of canvas
+void drawScene(LinePainter &lines, RectPainter &rects, CirclePainter &circles) {
+    unsigned int seed = 4242;
+    for (int i = 0; i < 40; ++i) {
+        lines.drawLine(nextRandom(seed, CANVAS_WIDTH + 20), nextRandom(seed, CANVAS_HEIGHT + 20),
+                       nextRandom(seed, CANVAS_WIDTH), nextRandom(seed, CANVAS_HEIGHT), randomColor(seed));
+        unsigned int x = nextRandom(seed, CANVAS_WIDTH);
+        unsigned int y = nextRandom(seed, CANVAS_HEIGHT);
+        rects.drawFull(x, y, x + nextRandom(seed, 30), y + nextRandom(seed, 30), randomColor(seed));
+        // empty circles have to stay at non-negative coordinates
+        circles.drawEmpty(30 + nextRandom(seed, CANVAS_WIDTH - 30), 30 + nextRandom(seed, CANVAS_HEIGHT - 30),
+                          3 + nextRandom(seed, 25), randomColor(seed));
+    }
+}
+
+void drawSceneOn(PixelPainter &painter) {
+    LinePainterForPixels lines(painter);
+    RectPainterForPixels rects(painter);
+    CirclePainterForPixels circles(painter);
+    drawScene(lines, rects, circles);
+}
+
+// reference: whole image drawn directly, written as PPM
+std::string renderReference() {
+    RgbImage image(CANVAS_WIDTH, CANVAS_HEIGHT);
+    BackgroundPainterForRgbImage(image).paint(BACKGROUND);
+    PixelPainterForRgbImage painter(image);
+    drawSceneOn(painter);
+
+    std::ostringstream stream;
+    PpmImageWriter writer(stream);
+    writer.writeImage(image);
+    return stream.str();
+}
+
+// stream writer which records number of rows of every band
+class BandCountingWriter : public PixelImageStreamWriter {
+public:
+    virtual void beginImage(unsigned int width, unsigned int height) {
+        width_ = width;
+        height_ = height;
+    }
+
+    virtual void writeRows(const PixelImageBase &rows) {
+        if (rows.width() != width_)
+            throw std::runtime_error("band width differs from image width");
+        bands.push_back(rows.height());
+    }
+
+    virtual void endImage() {
+        finished = true;
+    }
+
+    std::vector<unsigned int> bands;
+    bool finished = false;
+
+private:
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+};
+
+} // namespace
+
+UTEST_FUNC_DEF(PpmStreamWriter_EqualsWholeImageWrite) {
+    RgbImage image(20, 9);
+    PixelPainterForRgbImage painter(image);
+    drawSceneOn(painter);
+
+    std::ostringstream whole;
+    PpmImageWriter(whole).writeImage(image);
+
+    std::ostringstream banded;
+    PpmImageWriter writer(banded);
+    writer.beginImage(20, 9);
+    writer.writeRows(ImageView(image, Point(0, 0), Point(20, 4)));
+    writer.writeRows(ImageView(image, Point(0, 4), Point(20, 5)));
+    writer.endImage();
+
+    UTEST_ASSERT_TRUE(banded.str() == whole.str());
+}
+
+UTEST_FUNC_DEF(DisplayList_MatchesDirectDrawing) {
+    std::string expected = renderReference();
+
+    DisplayList list;
+    RecordingLinePainter lines(list);
+    RecordingRectPainter rects(list);
+    RecordingCirclePainter circles(list);
+    drawScene(lines, rects, circles);
+
+    unsigned int bandHeights[] = {1, 7, 16, 64, CANVAS_HEIGHT, 1000};
+    for (unsigned int bandHeight : bandHeights) {
+        std::ostringstream stream;
+        PpmImageWriter writer(stream);
+        BandedRenderer(CANVAS_WIDTH, CANVAS_HEIGHT, bandHeight, BACKGROUND).render(list, writer);
+        UTEST_ASSERT_TRUE(stream.str() == expected);
+    }
+}
+
+UTEST_FUNC_DEF(DrawFunction_MatchesDirectDrawing) {
+    std::string expected = renderReference();
+
+    std::ostringstream stream;
+    PpmImageWriter writer(stream);
+    BandedRenderer(CANVAS_WIDTH, CANVAS_HEIGHT, 10, BACKGROUND).render(drawSceneOn, writer);
+    UTEST_ASSERT_TRUE(stream.str() == expected);
+}
+
+UTEST_FUNC_DEF(Bands_CoverImageInOrder) {
+    BandCountingWriter writer;
+    BandedRenderer renderer(30, 25, 8);
+    UTEST_ASSERT_EQUALS(renderer.bandCount(), 4u);
+
+    renderer.render(DisplayList(), writer);
+
+    UTEST_ASSERT_TRUE(writer.finished);
+    UTEST_ASSERT_EQUALS(writer.bands.size(), 4u);
+    UTEST_ASSERT_EQUALS(writer.bands[0], 8u);
+    UTEST_ASSERT_EQUALS(writer.bands[3], 1u);
+}
+
+UTEST_FUNC_DEF(WriterError_IsPropagated) {
+    class FailingWriter : public BandCountingWriter {
+    public:
+        virtual void writeRows(const PixelImageBase &) {
+            throw std::runtime_error("disk full");
+        }
+    } failing;
+
+    bool thrown = false;
+    try {
+        BandedRenderer(10, 10, 3).render(drawSceneOn, failing);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+    UTEST_ASSERT_FALSE(failing.finished);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(PpmStreamWriter_EqualsWholeImageWrite);
+    UTEST_FUNC(DisplayList_MatchesDirectDrawing);
+    UTEST_FUNC(DrawFunction_MatchesDirectDrawing);
+    UTEST_FUNC(Bands_CoverImageInOrder);
+    UTEST_FUNC(WriterError_IsPropagated);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,235 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/antialiased_painter_for_pixels.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_sink.h"
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @file test_circle_painter.cpp
+ * @brief Tests for span-based circles, ellipses, rings, arcs and pie slices
+ */
+
+namespace {
+
+const RgbColor GREEN = {0, 255, 0};
+const double PI = 3.14159265358979;
+
+// sink which sums coverage (0-255) painted into each pixel and counts emitted spans and blended pixels
+class CoverageSink {
+public:
+    CoverageSink(int width, int height) : width_(width), height_(height),
+                                          coverage_(static_cast<size_t>(width * height), 0) {}
+
+    void putPixel(unsigned int x, unsigned int y, const RgbColor &) {
+        add(x, y, 255);
+    }
+
+    void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &) {
+        ++spans_;
+        for (unsigned int i = 0; i < length; ++i)
+            add(x + i, y, 255);
+    }
+
+    void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &,
+                   const unsigned char *coverage) {
+        blended_ += static_cast<int>(length);
+        for (unsigned int i = 0; i < length; ++i)
+            add(x + i, y, coverage[i]);
+    }
+
+    int at(int x, int y) const {
+        return coverage_[static_cast<size_t>(y * width_ + x)];
+    }
+
+    double area() const {
+        double total = 0;
+        for (int value : coverage_)
+            total += value / 255.0;
+        return total;
+    }
+
+    int maxValue() const {
+        int result = 0;
+        for (int value : coverage_)
+            result = std::max(result, value);
+        return result;
+    }
+
+    int spans() const {
+        return spans_;
+    }
+
+    int blended() const {
+        return blended_;
+    }
+
+private:
+    void add(unsigned int x, unsigned int y, int value) {
+        if (static_cast<int>(x) < width_ && static_cast<int>(y) < height_)
+            coverage_[y * static_cast<size_t>(width_) + x] += value;
+    }
+
+    int width_;
+    int height_;
+    std::vector<int> coverage_;
+    int spans_ = 0;
+    int blended_ = 0;
+};
+
+// direction of (dx, dy) relative to startAngle in [0, 2 pi)
+double relativeAngle(int dx, int dy, double startAngle) {
+    double angle = std::fmod(std::atan2(static_cast<double>(dy), static_cast<double>(dx)) - startAngle, 2 * PI);
+    return angle < 0 ? angle + 2 * PI : angle;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Circle_FullAndEllipseOneSpanPerRow) {
+    CoverageSink circle(64, 64);
+    CirclePainterForSink<CoverageSink>(circle).drawFull(32, 32, 20, GREEN);
+    UTEST_ASSERT_EQUALS(circle.spans(), 41);
+    bool exact = true;
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x)
+            exact = exact && (circle.at(x, y) == 255) == ((x - 32) * (x - 32) + (y - 32) * (y - 32) <= 400);
+    UTEST_ASSERT_TRUE(exact);
+
+    CoverageSink ellipse(64, 64);
+    EllipsePainterForSink<CoverageSink>(ellipse).drawFull(32, 32, 25, 9, GREEN);
+    UTEST_ASSERT_EQUALS(ellipse.spans(), 19);
+    exact = true;
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x)
+            exact = exact && (ellipse.at(x, y) == 255) == (81 * (x - 32) * (x - 32) + 625 * (y - 32) * (y - 32) <= 625 * 81);
+    UTEST_ASSERT_TRUE(exact);
+
+    // rows above canvas are skipped
+    CoverageSink clipped(16, 16);
+    CirclePainterForSink<CoverageSink>(clipped).drawFull(2, 2, 5, GREEN);
+    UTEST_ASSERT_EQUALS(clipped.spans(), 8);
+}
+
+UTEST_FUNC_DEF(Circle_RingAndBorderPaintEveryPixelOnce) {
+    CoverageSink ring(64, 64);
+    CirclePainterForSink<CoverageSink>(ring).drawRing(32, 32, 20, 12, GREEN);
+    bool exact = true;
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x) {
+            int d2 = (x - 32) * (x - 32) + (y - 32) * (y - 32);
+            exact = exact && (ring.at(x, y) == 255) == (d2 > 144 && d2 <= 400);
+        }
+    UTEST_ASSERT_TRUE(exact);
+
+    CoverageSink bordered(64, 64), disc(64, 64);
+    CirclePainterForSink<CoverageSink>(bordered).drawFullWithBorder(32, 32, 20, 3, GREEN, GREEN);
+    CirclePainterForSink<CoverageSink>(disc).drawFull(32, 32, 20, GREEN);
+    UTEST_ASSERT_EQUALS(bordered.maxValue(), 255);
+    UTEST_ASSERT_EQUALS(bordered.area(), disc.area());
+}
+
+UTEST_FUNC_DEF(Circle_PieSlicesCoverDiscOnce) {
+    // slices given in different turns, last one ends where the first starts
+    const double cuts[] = {-PI / 2, 0.3, 1.9, PI, 4.0, 3 * PI / 2};
+    CoverageSink pie(64, 64), disc(64, 64);
+    CirclePainterForSink<CoverageSink> painter(pie);
+    for (int i = 0; i < 5; ++i)
+        painter.drawPie(32, 32, 25, cuts[i], cuts[i + 1], GREEN);
+    CirclePainterForSink<CoverageSink>(disc).drawFull(32, 32, 25, GREEN);
+
+    UTEST_ASSERT_EQUALS(pie.maxValue(), 255);
+    UTEST_ASSERT_EQUALS(pie.area(), disc.area());
+}
+
+UTEST_FUNC_DEF(Circle_ArcsMatchAngleOfPixels) {
+    int mismatches = 0;
+    for (int k = 0; k < 50; ++k) {
+        double start = -7 + k * 0.37, sweep = 0.1 + k * 0.13;
+        CoverageSink sink(64, 64);
+        CirclePainterForSink<CoverageSink>(sink).drawArc(32, 32, 25, 8, start, start + sweep, GREEN);
+        for (int y = 0; y < 64; ++y)
+            for (int x = 0; x < 64; ++x) {
+                int d2 = (x - 32) * (x - 32) + (y - 32) * (y - 32);
+                double angle = relativeAngle(x - 32, y - 32, start);
+                // pixels just at the boundary rays may go either way
+                if (std::fabs(angle - sweep) < 1e-9 || angle < 1e-9 || 2 * PI - angle < 1e-9)
+                    continue;
+                bool inside = d2 > 64 && d2 <= 625 && (sweep >= 2 * PI || angle < sweep);
+                if ((sink.at(x, y) == 255) != inside)
+                    ++mismatches;
+            }
+    }
+    UTEST_ASSERT_EQUALS(mismatches, 0);
+}
+
+UTEST_FUNC_DEF(Circle_AntiAliasedShapesHaveExactArea) {
+    CoverageSink disc(64, 64);
+    AntiAliasedCirclePainterForSink<CoverageSink> painter(disc, Point(64, 64));
+    painter.drawFull(PointF(30.3f, 31.8f), 17.4f, GREEN);
+    double area = PI * 17.4 * 17.4;
+    UTEST_ASSERT_TRUE(std::fabs(disc.area() - area) < 0.5);
+    // inside rows are filled, only edge pixels are blended
+    UTEST_ASSERT_TRUE(disc.blended() < 2 * 2 * PI * 17.4);
+    UTEST_ASSERT_EQUALS(disc.at(30, 31), 255);
+
+    CoverageSink ring(64, 64);
+    AntiAliasedCirclePainterForSink<CoverageSink>(ring).drawRing(PointF(32, 32), 20.0f, 10.5f, GREEN);
+    UTEST_ASSERT_TRUE(std::fabs(ring.area() - PI * (400 - 10.5 * 10.5)) < 0.5);
+    UTEST_ASSERT_EQUALS(ring.at(32, 32), 0);
+
+    CoverageSink pie(64, 64);
+    AntiAliasedCirclePainterForSink<CoverageSink>(pie).drawPie(PointF(32, 32), 20.0f, 0.5, 2.5, GREEN);
+    UTEST_ASSERT_TRUE(std::fabs(pie.area() - 400 * 2.0 / 2) < 0.5);
+
+    CoverageSink ellipse(64, 64);
+    AntiAliasedCirclePainterForSink<CoverageSink>(ellipse).drawEllipse(PointF(32, 32), 25.0f, 7.5f, GREEN);
+    UTEST_ASSERT_TRUE(std::fabs(ellipse.area() - PI * 25 * 7.5) < 0.5);
+}
+
+UTEST_FUNC_DEF(Circle_AntiAliasedCrossingCanvasSides) {
+    // discs centered on left and right border, half of each is inside
+    CoverageSink sink(32, 32);
+    AntiAliasedCirclePainterForSink<CoverageSink> painter(sink, Point(32, 32));
+    painter.drawFull(PointF(0, 8.5f), 7.3f, GREEN);
+    painter.drawFull(PointF(32, 23.5f), 7.3f, GREEN);
+    UTEST_ASSERT_TRUE(std::fabs(sink.area() - PI * 7.3 * 7.3) < 0.5);
+    UTEST_ASSERT_EQUALS(sink.maxValue(), 255);
+    UTEST_ASSERT_EQUALS(sink.at(0, 8), 255);
+    UTEST_ASSERT_EQUALS(sink.at(31, 23), 255);
+}
+
+UTEST_FUNC_DEF(Circle_AntiAliasedIntoImage) {
+    RgbImage image(32, 32);
+    PixelPainterForRgbImage pixelPainter(image);
+    AntiAliasedCirclePainterForPixels painter(pixelPainter, Point(32, 32));
+    painter.drawFullWithBorder(16, 16, 10, 2, GREEN, RgbColor{255, 0, 0});
+
+    UTEST_ASSERT_TRUE(image.getPixel(16, 16) == GREEN);
+    UTEST_ASSERT_TRUE(image.getPixel(16, 7).red >= 250 && image.getPixel(16, 7).green == 0);
+    UTEST_ASSERT_TRUE(image.getPixel(0, 0) == (RgbColor{0, 0, 0}));
+    // outer edge is 10.5 pixels from center of pixel (16, 16), partially covered pixels are along diagonals
+    int partial = 0;
+    for (int y = 0; y < 32; ++y)
+        for (int x = 0; x < 32; ++x)
+            if (image.getPixel(x, y).red > 20 && image.getPixel(x, y).red < 230 && image.getPixel(x, y).green == 0)
+                ++partial;
+    UTEST_ASSERT_TRUE(partial > 8);
+    UTEST_ASSERT_TRUE(image.getPixel(28, 16) == (RgbColor{0, 0, 0}));
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Circle_FullAndEllipseOneSpanPerRow);
+    UTEST_FUNC(Circle_RingAndBorderPaintEveryPixelOnce);
+    UTEST_FUNC(Circle_PieSlicesCoverDiscOnce);
+    UTEST_FUNC(Circle_ArcsMatchAngleOfPixels);
+    UTEST_FUNC(Circle_AntiAliasedShapesHaveExactArea);
+    UTEST_FUNC(Circle_AntiAliasedCrossingCanvasSides);
+    UTEST_FUNC(Circle_AntiAliasedIntoImage);
+
+    UTEST_EPILOG();
+}
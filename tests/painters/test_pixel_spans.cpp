@@ -0,0 +1,185 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/filters/filter_for_pixels.h"
+
+/**
+ * @file test_pixel_spans.cpp
+ * @brief Tests for span-level PixelPainter operations and span-based primitives
+ */
+
+namespace {
+
+const RgbColor BLACK = {0, 0, 0};
+const RgbColor WHITE = {255, 255, 255};
+const RgbColor RED = {255, 0, 0};
+
+// counts pixels of given color
+int countColor(const RgbImage &image, const RgbColor &color) {
+    int count = 0;
+    for (int y = 0; y < static_cast<int>(image.height()); ++y)
+        for (int x = 0; x < static_cast<int>(image.width()); ++x)
+            if (image.getPixel(x, y) == color)
+                count++;
+    return count;
+}
+
+// pixel painter which uses only the per-pixel fallback of span operations
+class PerPixelPainter : public PixelPainter {
+public:
+    PerPixelPainter(RgbImage &image) : image_(image) {}
+
+    virtual void putPixel(unsigned int x, unsigned int y, const RgbColor &color) {
+        image_.setPixel(Point(static_cast<int>(x), static_cast<int>(y)), color);
+        putCount_++;
+    }
+
+    virtual void getPixel(unsigned int x, unsigned int y, RgbColor &output) {
+        output = image_.getPixel(Point(static_cast<int>(x), static_cast<int>(y)));
+    }
+
+    int putCount() const { return putCount_; }
+
+private:
+    RgbImage &image_;
+    int putCount_ = 0;
+};
+
+} // namespace
+
+UTEST_FUNC_DEF(FillSpan_ClipsToImage) {
+    RgbImage image(10, 4);
+    PixelPainterForRgbImage painter(image);
+
+    painter.fillSpan(6, 1, 100, RED);
+    painter.fillSpan(0, 4, 10, RED);   // row outside of image
+    painter.fillSpan(10, 0, 10, RED);  // column outside of image
+
+    UTEST_ASSERT_EQUALS(countColor(image, RED), 4);
+    UTEST_ASSERT_TRUE(image.getPixel(5, 1) == BLACK);
+    UTEST_ASSERT_TRUE(image.getPixel(6, 1) == RED);
+    UTEST_ASSERT_TRUE(image.getPixel(9, 1) == RED);
+    UTEST_ASSERT_TRUE(image.getPixel(0, 2) == BLACK);
+}
+
+UTEST_FUNC_DEF(CopyAndBlendSpan) {
+    RgbImage image(4, 1);
+    PixelPainterForRgbImage painter(image);
+
+    RgbColor colors[3] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+    painter.copySpan(1, 0, 3, colors);
+    UTEST_ASSERT_TRUE(image.getPixel(1, 0) == colors[0]);
+    UTEST_ASSERT_TRUE(image.getPixel(3, 0) == colors[2]);
+
+    painter.fillSpan(0, 0, 4, BLACK);
+    unsigned char coverage[4] = {0, 128, 255, 64};
+    painter.blendSpan(0, 0, 4, WHITE, coverage);
+
+    UTEST_ASSERT_EQUALS(image.getPixel(0, 0).red, 0);
+    UTEST_ASSERT_EQUALS(image.getPixel(1, 0).red, 128);
+    UTEST_ASSERT_EQUALS(image.getPixel(2, 0).red, 255);
+    UTEST_ASSERT_EQUALS(image.getPixel(3, 0).red, 64);
+}
+
+UTEST_FUNC_DEF(DefaultSpan_FallsBackToPutPixel) {
+    RgbImage image(8, 2);
+    PerPixelPainter painter(image);
+
+    painter.fillSpan(2, 1, 5, RED);
+
+    UTEST_ASSERT_EQUALS(painter.putCount(), 5);
+    UTEST_ASSERT_EQUALS(countColor(image, RED), 5);
+}
+
+UTEST_FUNC_DEF(ClipAndOffsetFilters_ForwardSpans) {
+    RgbImage image(20, 20);
+    PixelPainterForRgbImage painter(image);
+
+    RectInclusive window = RectInclusive::make_rect(5, 5, 9, 9);
+    ClipFilter clip(painter, window);
+    clip.fillSpan(0, 6, 20, RED);
+    clip.fillSpan(0, 2, 20, RED);
+
+    UTEST_ASSERT_EQUALS(countColor(image, RED), 5);
+    UTEST_ASSERT_TRUE(image.getPixel(5, 6) == RED);
+    UTEST_ASSERT_TRUE(image.getPixel(10, 6) == BLACK);
+
+    OffsetFilter offset(painter, Point(-3, 1));
+    RgbColor colors[5] = {{1, 1, 1}, {2, 2, 2}, {3, 3, 3}, {4, 4, 4}, {5, 5, 5}};
+    offset.copySpan(0, 0, 5, colors);
+
+    // first three pixels are shifted below zero
+    UTEST_ASSERT_TRUE(image.getPixel(0, 1) == colors[3]);
+    UTEST_ASSERT_TRUE(image.getPixel(1, 1) == colors[4]);
+    UTEST_ASSERT_TRUE(image.getPixel(2, 1) == BLACK);
+}
+
+UTEST_FUNC_DEF(CircleFill_MatchesDistanceTest) {
+    RgbImage image(40, 40);
+    PixelPainterForRgbImage painter(image);
+    CirclePainterForPixels circlePainter(painter);
+
+    // circle partially outside of left/top edge
+    circlePainter.drawFull(3, 20, 9, RED);
+
+    for (int y = 0; y < 40; ++y) {
+        for (int x = 0; x < 40; ++x) {
+            bool inside = (x - 3) * (x - 3) + (y - 20) * (y - 20) <= 81;
+            UTEST_ASSERT_EQUALS(image.getPixel(x, y) == RED, inside);
+        }
+    }
+}
+
+UTEST_FUNC_DEF(TriangleFill_MatchesEdgeTest) {
+    RgbImage image(30, 30);
+    PixelPainterForRgbImage painter(image);
+    TrianglePainterForPixels trianglePainter(painter);
+
+    Point p1(2, 2), p2(5, 25), p3(27, 14);
+    trianglePainter.drawFull(p1, p2, p3, RED);
+
+    auto edge = [](const Point &a, const Point &b, int x, int y) {
+        return (a.x - b.x) * (y - a.y) - (a.y - b.y) * (x - a.x);
+    };
+
+    for (int y = 0; y < 30; ++y) {
+        for (int x = 0; x < 30; ++x) {
+            bool inside = edge(p1, p2, x, y) >= 0 && edge(p2, p3, x, y) >= 0 && edge(p3, p1, x, y) >= 0;
+            UTEST_ASSERT_EQUALS(image.getPixel(x, y) == RED, inside);
+        }
+    }
+}
+
+UTEST_FUNC_DEF(FloodFill_FillsEnclosedArea) {
+    RgbImage image(20, 20);
+    PixelPainterForRgbImage painter(image);
+    RectPainterForPixels rectPainter(painter);
+    FloodFillPainterForPixels floodPainter(painter, image.getSize());
+
+    rectPainter.drawEmpty(2, 2, 12, 10, WHITE);
+    floodPainter.fill(Point(5, 5), RED);
+
+    // inside of rectangle: 9 x 7 pixels
+    UTEST_ASSERT_EQUALS(countColor(image, RED), 63);
+    UTEST_ASSERT_TRUE(image.getPixel(0, 0) == BLACK);
+
+    // filling with the same color is a no-op
+    floodPainter.fill(Point(5, 5), RED);
+    UTEST_ASSERT_EQUALS(countColor(image, RED), 63);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(FillSpan_ClipsToImage);
+    UTEST_FUNC(CopyAndBlendSpan);
+    UTEST_FUNC(DefaultSpan_FallsBackToPutPixel);
+    UTEST_FUNC(ClipAndOffsetFilters_ForwardSpans);
+    UTEST_FUNC(CircleFill_MatchesDistanceTest);
+    UTEST_FUNC(TriangleFill_MatchesEdgeTest);
+    UTEST_FUNC(FloodFill_FillsEnclosedArea);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,197 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_sink.h"
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @file test_polygon_painter.cpp
+ * @brief Tests for scanline polygon filling with even-odd and non-zero rules
+ */
+
+namespace {
+
+const RgbColor RED = {255, 0, 0};
+
+// sink which counts how many times each pixel was painted and how many spans were emitted
+class CountingSink {
+public:
+    CountingSink(int width, int height) : width_(width), height_(height),
+                                          counts_(static_cast<size_t>(width * height), 0) {}
+
+    void putPixel(unsigned int x, unsigned int y, const RgbColor &) {
+        fillSpan(x, y, 1, RED);
+    }
+
+    void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &) {
+        ++spans_;
+        for (unsigned int i = 0; i < length; ++i)
+            if (static_cast<int>(x + i) < width_ && static_cast<int>(y) < height_)
+                ++counts_[y * static_cast<size_t>(width_) + x + i];
+    }
+
+    int count(int x, int y) const {
+        return counts_[static_cast<size_t>(y * width_ + x)];
+    }
+
+    int painted() const {
+        int total = 0;
+        for (int value : counts_)
+            total += value;
+        return total;
+    }
+
+    int maxCount() const {
+        int result = 0;
+        for (int value : counts_)
+            result = std::max(result, value);
+        return result;
+    }
+
+    int spans() const {
+        return spans_;
+    }
+
+private:
+    int width_;
+    int height_;
+    std::vector<int> counts_;
+    int spans_ = 0;
+};
+
+// reference: crossing number / winding number of pixel center
+bool insideReference(const std::vector<std::vector<PointF>> &contours, double px, double py, bool nonZero) {
+    int winding = 0, crossings = 0;
+    for (const std::vector<PointF> &contour : contours)
+        for (size_t i = 0; i < contour.size(); ++i) {
+            const PointF &a = contour[i];
+            const PointF &b = contour[(i + 1) % contour.size()];
+            bool down = a.y <= py && b.y > py;
+            bool up = b.y <= py && a.y > py;
+            if (!down && !up)
+                continue;
+            double x = a.x + (py - a.y) * (b.x - a.x) / (b.y - a.y);
+            if (x < px) {
+                ++crossings;
+                winding += down ? 1 : -1;
+            }
+        }
+    return nonZero ? winding != 0 : (crossings & 1) != 0;
+}
+
+std::vector<Point> square(int x1, int y1, int x2, int y2, bool clockwise) {
+    if (clockwise)
+        return {Point(x1, y1), Point(x2, y1), Point(x2, y2), Point(x1, y2)};
+    return {Point(x1, y1), Point(x1, y2), Point(x2, y2), Point(x2, y1)};
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Polygon_RectangleCoversExactArea) {
+    CountingSink sink(20, 20);
+    PolygonPainterForSink<CountingSink> painter(sink);
+    painter.drawFull(square(2, 3, 12, 8, true), RED);
+
+    UTEST_ASSERT_EQUALS(sink.painted(), 50);
+    UTEST_ASSERT_EQUALS(sink.spans(), 5);
+    UTEST_ASSERT_EQUALS(sink.count(2, 3), 1);
+    UTEST_ASSERT_EQUALS(sink.count(11, 7), 1);
+    UTEST_ASSERT_EQUALS(sink.count(12, 7), 0);
+    UTEST_ASSERT_EQUALS(sink.count(11, 8), 0);
+}
+
+UTEST_FUNC_DEF(Polygon_FillRulesForHolesAndOverlaps) {
+    // inner square with the same orientation: hole only for even-odd
+    std::vector<std::vector<Point>> same = {square(0, 0, 10, 10, true), square(3, 3, 7, 7, true)};
+    CountingSink evenOdd(10, 10), nonZero(10, 10);
+    PolygonPainterForSink<CountingSink>(evenOdd).drawFull(same, RED, PolygonPainter::EVEN_ODD);
+    PolygonPainterForSink<CountingSink>(nonZero).drawFull(same, RED, PolygonPainter::NON_ZERO);
+    UTEST_ASSERT_EQUALS(evenOdd.painted(), 100 - 16);
+    UTEST_ASSERT_EQUALS(nonZero.painted(), 100);
+    UTEST_ASSERT_EQUALS(nonZero.maxCount(), 1);
+    // overlapping intervals are joined into one span per row
+    UTEST_ASSERT_EQUALS(nonZero.spans(), 10);
+
+    // opposite orientation: hole for both rules
+    std::vector<std::vector<Point>> opposite = {square(0, 0, 10, 10, true), square(3, 3, 7, 7, false)};
+    CountingSink holed(10, 10);
+    PolygonPainterForSink<CountingSink>(holed).drawFull(opposite, RED, PolygonPainter::NON_ZERO);
+    UTEST_ASSERT_EQUALS(holed.painted(), 100 - 16);
+    UTEST_ASSERT_EQUALS(holed.count(5, 5), 0);
+}
+
+UTEST_FUNC_DEF(Polygon_SelfIntersectingMatchesReference) {
+    // pentagram and a random zigzag contour
+    std::vector<std::vector<PointF>> contours(2);
+    const double pi = 3.14159265358979;
+    for (int i = 0; i < 5; ++i) {
+        double angle = -pi / 2 + i * 4 * pi / 5;
+        contours[0].push_back(PointF(static_cast<float>(40 + 35 * std::cos(angle)), static_cast<float>(40 + 35 * std::sin(angle))));
+    }
+    unsigned int seed = 12345;
+    for (int i = 0; i < 30; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        float x = static_cast<float>((seed >> 8) % 8000) / 100.0f;
+        seed = seed * 1103515245u + 12345u;
+        float y = static_cast<float>((seed >> 8) % 8000) / 100.0f;
+        contours[1].push_back(PointF(x, y));
+    }
+
+    bool matches = true;
+    for (int rule = 0; rule < 2; ++rule) {
+        bool nonZero = rule == 1;
+        CountingSink sink(80, 80);
+        PolygonPainterForSink<CountingSink> painter(sink);
+        painter.drawFull(contours, RED, nonZero ? PolygonPainter::NON_ZERO : PolygonPainter::EVEN_ODD);
+        matches = matches && sink.maxCount() == 1;
+        for (int y = 0; y < 80; ++y)
+            for (int x = 0; x < 80; ++x)
+                matches = matches && (sink.count(x, y) == 1) == insideReference(contours, x + 0.5, y + 0.5, nonZero);
+    }
+    UTEST_ASSERT_TRUE(matches);
+}
+
+UTEST_FUNC_DEF(Polygon_SharedEdgesPaintedOnce) {
+    CountingSink sink(40, 40);
+    PolygonPainterForSink<CountingSink> painter(sink);
+    std::vector<Point> first = {Point(1, 1), Point(37, 5), Point(9, 38)};
+    std::vector<Point> second = {Point(37, 5), Point(39, 39), Point(9, 38)};
+    painter.drawFull(first, RED);
+    painter.drawFull(second, RED);
+    UTEST_ASSERT_EQUALS(sink.maxCount(), 1);
+}
+
+UTEST_FUNC_DEF(Polygon_ClipsToCanvas) {
+    RgbImage image(16, 12);
+    PixelPainterForRgbImage pixelPainter(image);
+    PolygonPainterForPixels painter(pixelPainter, Point(16, 12));
+    painter.drawFull(square(-5, -5, 30, 30, true), RED);
+
+    bool allRed = true;
+    for (int y = 0; y < 12; ++y)
+        for (int x = 0; x < 16; ++x)
+            allRed = allRed && image.getPixel(x, y) == RED;
+    UTEST_ASSERT_TRUE(allRed);
+
+    CountingSink sink(10, 10);
+    PolygonPainterForSink<CountingSink> clipped(sink, Point(10, 10));
+    clipped.drawFull(square(-20, 5, 100, 200, true), RED);
+    UTEST_ASSERT_EQUALS(sink.painted(), 50);
+    UTEST_ASSERT_EQUALS(sink.spans(), 5);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Polygon_RectangleCoversExactArea);
+    UTEST_FUNC(Polygon_FillRulesForHolesAndOverlaps);
+    UTEST_FUNC(Polygon_SelfIntersectingMatchesReference);
+    UTEST_FUNC(Polygon_SharedEdgesPaintedOnce);
+    UTEST_FUNC(Polygon_ClipsToCanvas);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,257 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_sink.h"
+#include "uimg/painters/stroker.h"
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @file test_stroker.cpp
+ * @brief Tests for stroking polylines into outline polygons with joins, caps and dashes
+ */
+
+namespace {
+
+const RgbColor BLUE = {0, 0, 255};
+
+// sink which sums coverage (0-255) painted into each pixel
+class CoverageSink {
+public:
+    CoverageSink(int width, int height) : width_(width), height_(height),
+                                          coverage_(static_cast<size_t>(width * height), 0) {}
+
+    void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &) {
+        for (unsigned int i = 0; i < length; ++i)
+            add(x + i, y, 255);
+    }
+
+    void blendSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &,
+                   const unsigned char *coverage) {
+        for (unsigned int i = 0; i < length; ++i)
+            add(x + i, y, coverage[i]);
+    }
+
+    int at(int x, int y) const {
+        return coverage_[static_cast<size_t>(y * width_ + x)];
+    }
+
+    double area() const {
+        double total = 0;
+        for (int value : coverage_)
+            total += value / 255.0;
+        return total;
+    }
+
+    int maxValue() const {
+        int result = 0;
+        for (int value : coverage_)
+            result = std::max(result, value);
+        return result;
+    }
+
+private:
+    void add(unsigned int x, unsigned int y, int value) {
+        if (static_cast<int>(x) < width_ && static_cast<int>(y) < height_)
+            coverage_[y * static_cast<size_t>(width_) + x] += value;
+    }
+
+    int width_;
+    int height_;
+    std::vector<int> coverage_;
+};
+
+StrokeStyle makeStyle(float width, StrokeStyle::LineJoin join, StrokeStyle::LineCap cap) {
+    StrokeStyle style;
+    style.width = width;
+    style.join = join;
+    style.cap = cap;
+    return style;
+}
+
+double distanceToSegment(double px, double py, const PointF &a, const PointF &b) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double t = ((px - a.x) * dx + (py - a.y) * dy) / (dx * dx + dy * dy);
+    t = std::max(0.0, std::min(1.0, t));
+    double x = a.x + t * dx - px, y = a.y + t * dy - py;
+    return std::sqrt(x * x + y * y);
+}
+
+double length(const std::vector<PointF> &points) {
+    double total = 0;
+    for (size_t i = 1; i < points.size(); ++i)
+        total += std::hypot(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y);
+    return total;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Stroker_CapsOfStraightLine) {
+    std::vector<PointF> line = {PointF(4, 10), PointF(20, 10)};
+
+    CoverageSink butt(30, 20);
+    StrokePainterForSink<CoverageSink>(butt, makeStyle(4, StrokeStyle::MITER_JOIN, StrokeStyle::BUTT_CAP)).drawPolyline(line, BLUE);
+    UTEST_ASSERT_EQUALS(butt.area(), 16.0 * 4);
+    UTEST_ASSERT_EQUALS(butt.at(4, 8), 255);
+    UTEST_ASSERT_EQUALS(butt.at(3, 10), 0);
+    UTEST_ASSERT_EQUALS(butt.at(10, 12), 0);
+
+    CoverageSink square(30, 20);
+    StrokePainterForSink<CoverageSink>(square, makeStyle(4, StrokeStyle::MITER_JOIN, StrokeStyle::SQUARE_CAP)).drawPolyline(line, BLUE);
+    UTEST_ASSERT_EQUALS(square.area(), 20.0 * 4);
+    UTEST_ASSERT_EQUALS(square.at(2, 8), 255);
+    UTEST_ASSERT_EQUALS(square.at(21, 11), 255);
+
+    CoverageSink round(30, 20);
+    StrokePainterForSink<CoverageSink>(round, makeStyle(4, StrokeStyle::MITER_JOIN, StrokeStyle::ROUND_CAP), true).drawPolyline(line, BLUE);
+    // arcs are polygons inside of circle
+    double roundArea = 16.0 * 4 + 3.14159265 * 4;
+    UTEST_ASSERT_TRUE(round.area() < roundArea && round.area() > roundArea - 0.5);
+}
+
+UTEST_FUNC_DEF(Stroker_RoundStrokeMatchesDistanceToPolyline) {
+    // zigzag with sharp turns and a segment shorter than width
+    std::vector<PointF> polyline = {PointF(5.3f, 40.2f), PointF(30.7f, 6.1f), PointF(34.2f, 50.8f), PointF(36.0f, 49.5f),
+                                    PointF(70.4f, 12.9f), PointF(20.5f, 20.0f)};
+    float width = 7.0f;
+    CoverageSink sink(80, 64);
+    StrokePainterForSink<CoverageSink> painter(sink, makeStyle(width, StrokeStyle::ROUND_JOIN, StrokeStyle::ROUND_CAP));
+    painter.drawPolyline(polyline, BLUE);
+
+    // one fill: every pixel painted at most once, although the outline overlaps itself
+    UTEST_ASSERT_EQUALS(sink.maxValue(), 255);
+    int mismatches = 0;
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 80; ++x) {
+            double distance = 1e9;
+            for (size_t i = 0; i + 1 < polyline.size(); ++i)
+                distance = std::min(distance, distanceToSegment(x + 0.5, y + 0.5, polyline[i], polyline[i + 1]));
+            // arcs are approximated by chords, skip pixels just at the border
+            if (std::fabs(distance - width / 2) < 0.05)
+                continue;
+            if ((sink.at(x, y) == 255) != (distance < width / 2))
+                ++mismatches;
+        }
+    UTEST_ASSERT_EQUALS(mismatches, 0);
+}
+
+UTEST_FUNC_DEF(Stroker_MiterAndBevelJoins) {
+    // right angle corner at (20, 10), outer corner of stroke is at (22, 8)
+    std::vector<PointF> corner = {PointF(5, 10), PointF(20, 10), PointF(20, 25)};
+
+    CoverageSink miter(30, 30);
+    StrokePainterForSink<CoverageSink>(miter, makeStyle(4, StrokeStyle::MITER_JOIN, StrokeStyle::BUTT_CAP)).drawPolyline(corner, BLUE);
+    UTEST_ASSERT_EQUALS(miter.at(21, 8), 255);
+    // overlap of segments is covered once, miter adds 2x2 corner
+    UTEST_ASSERT_EQUALS(miter.area(), 15.0 * 4 + 15.0 * 4 - 4 + 4);
+
+    CoverageSink bevel(30, 30);
+    StrokePainterForSink<CoverageSink>(bevel, makeStyle(4, StrokeStyle::BEVEL_JOIN, StrokeStyle::BUTT_CAP)).drawPolyline(corner, BLUE);
+    UTEST_ASSERT_EQUALS(bevel.at(21, 8), 0);
+    UTEST_ASSERT_EQUALS(bevel.at(20, 9), 255);
+
+    // miter of right angle is sqrt(2) times longer than width, so this limit turns it into bevel
+    StrokeStyle limited = makeStyle(4, StrokeStyle::MITER_JOIN, StrokeStyle::BUTT_CAP);
+    limited.miterLimit = 1.4f;
+    CoverageSink cut(30, 30);
+    StrokePainterForSink<CoverageSink>(cut, limited).drawPolyline(corner, BLUE);
+    UTEST_ASSERT_EQUALS(cut.area(), bevel.area());
+}
+
+UTEST_FUNC_DEF(Stroker_ClosedPolylineLeavesHole) {
+    std::vector<PointF> square = {PointF(10, 10), PointF(30, 10), PointF(30, 30), PointF(10, 30)};
+    CoverageSink sink(40, 40);
+    StrokePainterForSink<CoverageSink>(sink, makeStyle(4, StrokeStyle::MITER_JOIN, StrokeStyle::BUTT_CAP), true)
+            .drawPolyline(square, BLUE, true);
+
+    UTEST_ASSERT_TRUE(std::fabs(sink.area() - (24.0 * 24 - 16.0 * 16)) < 0.01);
+    UTEST_ASSERT_EQUALS(sink.at(20, 20), 0);
+    UTEST_ASSERT_EQUALS(sink.at(8, 8), 255);
+    UTEST_ASSERT_EQUALS(sink.maxValue(), 255);
+}
+
+UTEST_FUNC_DEF(Stroker_DashesSplitPolyline) {
+    std::vector<PointF> polyline = {PointF(0, 0), PointF(60, 0), PointF(60, 40)};
+    std::vector<std::vector<PointF>> dashes;
+    Stroker::dash(polyline, false, {10, 5}, 0, dashes);
+    // dashes start every 15 pixels along 100 pixels
+    UTEST_ASSERT_EQUALS(dashes.size(), 7u);
+    UTEST_ASSERT_TRUE(std::fabs(length(dashes[0]) - 10) < 1e-4);
+    UTEST_ASSERT_TRUE(std::fabs(dashes[6][1].y - 40) < 1e-4);
+
+    // offset into first dash, dash 57-67 goes around the corner
+    dashes.clear();
+    Stroker::dash(polyline, false, {10, 5}, 3, dashes);
+    UTEST_ASSERT_EQUALS(dashes.size(), 7u);
+    UTEST_ASSERT_TRUE(std::fabs(length(dashes[0]) - 7) < 1e-4);
+    UTEST_ASSERT_EQUALS(dashes[4].size(), 3u);
+    UTEST_ASSERT_TRUE(std::fabs(length(dashes[4]) - 10) < 1e-4);
+
+    // offset into gap
+    dashes.clear();
+    Stroker::dash(polyline, false, {10, 5}, 12, dashes);
+    UTEST_ASSERT_TRUE(std::fabs(dashes[0][0].x - 3) < 1e-4);
+
+    // zero length dashes with round caps are dots, at 0, 10, 20 and 30 pixels
+    StrokeStyle dotted = makeStyle(4, StrokeStyle::ROUND_JOIN, StrokeStyle::ROUND_CAP);
+    dotted.dashes = {0, 10};
+    std::vector<std::vector<PointF>> outline;
+    Stroker(dotted).stroke({PointF(5, 5), PointF(45, 5)}, false, outline);
+    UTEST_ASSERT_EQUALS(outline.size(), 4u);
+
+    bool thrown = false;
+    try {
+        StrokeStyle invalid;
+        invalid.dashes = {0, 0};
+        Stroker stroker(invalid);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+}
+
+UTEST_FUNC_DEF(Stroker_AntiAliasedStrokeCrossingCanvasSides) {
+    CoverageSink straight(30, 20);
+    StrokePainterForSink<CoverageSink>(straight, makeStyle(4, StrokeStyle::MITER_JOIN, StrokeStyle::BUTT_CAP), true)
+            .drawPolyline({PointF(-10.3f, 10), PointF(40.7f, 10)}, BLUE);
+    UTEST_ASSERT_TRUE(std::fabs(straight.area() - 30.0 * 4) < 0.5);
+    UTEST_ASSERT_EQUALS(straight.at(0, 9), 255);
+    UTEST_ASSERT_EQUALS(straight.at(29, 10), 255);
+
+    // slanted edges leave the canvas on both sides between pixel rows
+    CoverageSink slanted(30, 20);
+    StrokePainterForSink<CoverageSink>(slanted, makeStyle(5, StrokeStyle::MITER_JOIN, StrokeStyle::BUTT_CAP), true)
+            .drawPolyline({PointF(-13.3f, 2.1f), PointF(45.7f, 17.9f)}, BLUE);
+    UTEST_ASSERT_EQUALS(slanted.maxValue(), 255);
+    UTEST_ASSERT_TRUE(slanted.area() > 30 * 5 * 0.9 && slanted.area() < 30 * 5 * 1.1);
+}
+
+UTEST_FUNC_DEF(Stroker_PaintsIntoImage) {
+    RgbImage image(20, 10);
+    PixelPainterForRgbImage pixelPainter(image);
+    StrokePainterForPixels painter(pixelPainter, Point(20, 10), makeStyle(3, StrokeStyle::MITER_JOIN, StrokeStyle::SQUARE_CAP));
+    painter.drawLine(2, 4, 30, 4, BLUE);
+
+    UTEST_ASSERT_TRUE(image.getPixel(1, 4) == BLUE);
+    UTEST_ASSERT_TRUE(image.getPixel(19, 3) == BLUE);
+    UTEST_ASSERT_TRUE(image.getPixel(10, 5) == BLUE);
+    UTEST_ASSERT_FALSE(image.getPixel(10, 6) == BLUE);
+    UTEST_ASSERT_FALSE(image.getPixel(0, 4) == BLUE);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Stroker_CapsOfStraightLine);
+    UTEST_FUNC(Stroker_RoundStrokeMatchesDistanceToPolyline);
+    UTEST_FUNC(Stroker_MiterAndBevelJoins);
+    UTEST_FUNC(Stroker_ClosedPolylineLeavesHole);
+    UTEST_FUNC(Stroker_DashesSplitPolyline);
+    UTEST_FUNC(Stroker_AntiAliasedStrokeCrossingCanvasSides);
+    UTEST_FUNC(Stroker_PaintsIntoImage);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,359 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/painters/display_list_painter.h"
+#include "uimg/utils/thread_pool.h"
+#include "uimg/fonts/bdf_font.h"
+#include "uimg/fonts/painter_for_bdf_font.h"
+#include "uimg/fonts/painter_for_bdf_font_ex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @file test_tiled_rasterizer.cpp
+ * @brief Tests for display list recording, tiled parallel rasterization and thread pool
+ */
+
+namespace {
+
+const unsigned int CANVAS_WIDTH = 300;
+const unsigned int CANVAS_HEIGHT = 200;
+
+// simple text painter drawing every character as a filled block above base line
+class BlockTextPainter : public uimg::TextPainter {
+public:
+    BlockTextPainter(PixelPainter &painter) : rectPainter_(painter) {}
+
+    void drawText(unsigned int x, unsigned int y, const std::string &text, const RgbColor &color) override {
+        for (size_t i = 0; i < text.size(); ++i)
+            drawGlyph(x + static_cast<unsigned int>(i) * 6, y, static_cast<uimg::text_char_code_t>(text[i]), color);
+    }
+
+    void drawGlyph(unsigned int x, unsigned int y, uimg::text_char_code_t, const RgbColor &color) override {
+        rectPainter_.drawFull(x, y - 7, x + 4, y + 1, color);
+    }
+
+    void drawText(unsigned int, unsigned int, uimg::TextSource &, const RgbColor &) override {}
+
+    unsigned int textWidth(const std::string &text) override { return static_cast<unsigned int>(text.size()) * 6; }
+
+    Point textSize(const std::string &text) override { return Point(static_cast<int>(textWidth(text)), 8); }
+
+    unsigned int glyphWidth(uimg::text_char_code_t) override { return 6; }
+
+    unsigned int glyphHeight(uimg::text_char_code_t) override { return 8; }
+
+    Point glyphSize(uimg::text_char_code_t) override { return Point(6, 8); }
+
+    unsigned int textWidth(uimg::TextSource &) override { return 0; }
+
+    Point textSize(uimg::TextSource &) override { return Point(0, 0); }
+
+private:
+    RectPainterForPixels rectPainter_;
+};
+
+unsigned int nextRandom(unsigned int &seed, unsigned int range) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) % range;
+}
+
+RgbColor randomColor(unsigned int &seed) {
+    return {static_cast<unsigned char>(nextRandom(seed, 256)), static_cast<unsigned char>(nextRandom(seed, 256)),
+            static_cast<unsigned char>(nextRandom(seed, 256))};
+}
+
+// draws the same pseudo-random scene with any set of painters
+void drawScene(LinePainter &lines, RectPainter &rects, CirclePainter &circles, EllipsePainter &ellipses,
+               TrianglePainter &triangles, uimg::TextPainter &text) {
+    unsigned int seed = 777;
+    for (int i = 0; i < 60; ++i) {
+        lines.drawLine(nextRandom(seed, CANVAS_WIDTH), nextRandom(seed, CANVAS_HEIGHT),
+                       nextRandom(seed, CANVAS_WIDTH), nextRandom(seed, CANVAS_HEIGHT), randomColor(seed));
+
+        // steep line - line painter steps past its end row for these
+        unsigned int x = nextRandom(seed, CANVAS_WIDTH - 2);
+        lines.drawLine(x, nextRandom(seed, 40), x + 1, 60 + nextRandom(seed, 60), randomColor(seed));
+
+        unsigned int rx = 20 + nextRandom(seed, CANVAS_WIDTH - 40);
+        unsigned int ry = 20 + nextRandom(seed, CANVAS_HEIGHT - 40);
+        rects.drawFull(rx, ry, rx + nextRandom(seed, 30), ry + nextRandom(seed, 30), randomColor(seed));
+        rects.drawEmpty(rx, ry, rx + nextRandom(seed, 50), ry + nextRandom(seed, 50), randomColor(seed));
+
+        unsigned int cx = 20 + nextRandom(seed, CANVAS_WIDTH - 40);
+        unsigned int cy = 20 + nextRandom(seed, CANVAS_HEIGHT - 40);
+        circles.drawFull(cx, cy, nextRandom(seed, 40), randomColor(seed));
+        circles.drawEmpty(cx, cy, nextRandom(seed, 20), randomColor(seed));
+        circles.drawFullWithBorder(cx, cy, 3 + nextRandom(seed, 15), 2, randomColor(seed), randomColor(seed));
+        ellipses.drawFull(cx, cy, nextRandom(seed, 60), nextRandom(seed, 20), randomColor(seed));
+        ellipses.drawEmpty(cx, cy, nextRandom(seed, 20), nextRandom(seed, 20), randomColor(seed));
+
+        Point p1(static_cast<int>(nextRandom(seed, CANVAS_WIDTH)), static_cast<int>(nextRandom(seed, CANVAS_HEIGHT)));
+        Point p2(static_cast<int>(nextRandom(seed, CANVAS_WIDTH)), static_cast<int>(nextRandom(seed, CANVAS_HEIGHT)));
+        Point p3(static_cast<int>(nextRandom(seed, CANVAS_WIDTH)), static_cast<int>(nextRandom(seed, CANVAS_HEIGHT)));
+        triangles.drawFull(p1, p2, p3, randomColor(seed));
+        triangles.drawFull(p1, p3, p2, randomColor(seed));
+        triangles.drawEmpty(p1, p2, p3, randomColor(seed));
+
+        text.drawText(10 + nextRandom(seed, CANVAS_WIDTH - 80), 10 + nextRandom(seed, CANVAS_HEIGHT - 20), "tile",
+                      randomColor(seed));
+    }
+}
+
+bool sameImages(RgbImage &a, RgbImage &b) {
+    return a.dataSize() == b.dataSize() && memcmp(a.data(), b.data(), a.dataSize()) == 0;
+}
+
+// glyphs reaching outside of pen position and text height: 'j' starts left of pen, ',' goes 4 rows below
+// base line, 'W' is wider than its advance
+const char *OVERHANG_FONT =
+    "STARTFONT 2.1\nFONT overhang\nSIZE 10 75 75\nFONTBOUNDINGBOX 9 12 -2 -4\nCHARS 4\n"
+    "STARTCHAR j\nENCODING 106\nSWIDTH 700 0\nDWIDTH 7 0\nBBX 5 12 -2 -3\nBITMAP\n"
+    "F8\nF8\nF8\nF8\nF8\nF8\nF8\nF8\nF8\nF8\nF8\nF8\nENDCHAR\n"
+    "STARTCHAR comma\nENCODING 44\nSWIDTH 700 0\nDWIDTH 7 0\nBBX 3 5 1 -4\nBITMAP\n"
+    "E0\nE0\nE0\nE0\nE0\nENDCHAR\n"
+    "STARTCHAR W\nENCODING 87\nSWIDTH 700 0\nDWIDTH 7 0\nBBX 9 10 -1 0\nBITMAP\n"
+    "FF80\nFF80\nFF80\nFF80\nFF80\nFF80\nFF80\nFF80\nFF80\nFF80\nENDCHAR\n"
+    "STARTCHAR question\nENCODING 63\nSWIDTH 700 0\nDWIDTH 7 0\nBBX 5 9 1 0\nBITMAP\n"
+    "F8\nF8\nF8\nF8\nF8\nF8\nF8\nF8\nF8\nENDCHAR\n"
+    "ENDFONT\n";
+
+void loadOverhangFont(uimg::BdfFont &font) {
+    std::istringstream in(OVERHANG_FONT);
+    uimg::BdfFontLoader().load(in, font);
+}
+
+// smallest rectangle of pixels differing from black, empty (x2 < x1) for black image
+RectInclusive paintedBounds(RgbImage &image) {
+    RectInclusive bounds = RectInclusive::make_rect(0, 0, -1, -1);
+    for (int y = 0; y < static_cast<int>(image.getSize().y); ++y)
+        for (int x = 0; x < static_cast<int>(image.getSize().x); ++x) {
+            if (image.getPixel(x, y) == RgbColor{0, 0, 0})
+                continue;
+            if (bounds.x2 < bounds.x1)
+                bounds = RectInclusive::make_rect(x, y, x, y);
+            bounds.x1 = std::min(bounds.x1, x);
+            bounds.y1 = std::min(bounds.y1, y);
+            bounds.x2 = std::max(bounds.x2, x);
+            bounds.y2 = std::max(bounds.y2, y);
+        }
+    return bounds;
+}
+
+bool insideOf(const RectInclusive &inner, const RectInclusive &outer) {
+    return inner.x1 >= outer.x1 && inner.y1 >= outer.y1 && inner.x2 <= outer.x2 && inner.y2 <= outer.y2;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(ThreadPool_RunsAllTasks) {
+    ThreadPool pool(4);
+    std::atomic<int> counter(0);
+
+    for (int i = 0; i < 1000; ++i)
+        pool.submit([&counter]() { counter++; });
+    pool.wait();
+
+    UTEST_ASSERT_EQUALS(counter.load(), 1000);
+    UTEST_ASSERT_EQUALS(pool.threadCount(), 4u);
+
+    // pool can be reused after wait
+    for (int i = 0; i < 10; ++i)
+        pool.submit([&counter]() { counter++; });
+    pool.wait();
+
+    UTEST_ASSERT_EQUALS(counter.load(), 1010);
+}
+
+UTEST_FUNC_DEF(ThreadPool_RethrowsTaskError) {
+    ThreadPool pool(2);
+    std::atomic<int> counter(0);
+
+    pool.submit([]() { throw std::runtime_error("task failed"); });
+    for (int i = 0; i < 10; ++i)
+        pool.submit([&counter]() { counter++; });
+
+    bool thrown = false;
+    try {
+        pool.wait();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+
+    UTEST_ASSERT_TRUE(thrown);
+    UTEST_ASSERT_EQUALS(counter.load(), 10);
+}
+
+UTEST_FUNC_DEF(ThreadPool_SubmitFromSeveralThreads) {
+    ThreadPool pool(3);
+    std::atomic<int> counter(0);
+
+    // workers go idle between rounds, every round has to wake them up again
+    for (int round = 0; round < 50; ++round) {
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 4; ++p)
+            producers.emplace_back([&pool, &counter]() {
+                for (int i = 0; i < 25; ++i)
+                    pool.submit([&counter]() { counter++; });
+            });
+        for (auto &producer : producers)
+            producer.join();
+        pool.wait();
+        UTEST_ASSERT_EQUALS(counter.load(), (round + 1) * 100);
+    }
+}
+
+UTEST_FUNC_DEF(DisplayList_RecordsCommands) {
+    DisplayList list;
+    RecordingLinePainter linePainter(list);
+    RecordingCirclePainter circlePainter(list);
+
+    linePainter.drawLine(1, 2, 30, 4, {255, 0, 0});
+    circlePainter.drawFull(50, 50, 10, {0, 255, 0});
+
+    UTEST_ASSERT_EQUALS(list.size(), 2u);
+    UTEST_ASSERT_TRUE(list.command(0).type == DisplayList::CommandType::Line);
+    UTEST_ASSERT_EQUALS(list.command(1).bounds.x1, 39);
+    UTEST_ASSERT_EQUALS(list.command(1).bounds.y2, 61);
+
+    list.clear();
+    UTEST_ASSERT_TRUE(list.empty());
+}
+
+UTEST_FUNC_DEF(TiledRasterizer_MatchesSequentialOutput) {
+    RgbImage sequentialImage(CANVAS_WIDTH, CANVAS_HEIGHT);
+    {
+        PixelPainterForRgbImage pixelPainter(sequentialImage);
+        LinePainterForPixels lines(pixelPainter);
+        RectPainterForPixels rects(pixelPainter);
+        CirclePainterForPixels circles(pixelPainter);
+        EllipsePainterForPixels ellipses(pixelPainter);
+        TrianglePainterForPixels triangles(pixelPainter);
+        BlockTextPainter text(pixelPainter);
+        drawScene(lines, rects, circles, ellipses, triangles, text);
+    }
+
+    ThreadPool pool(4);
+    unsigned int tileSizes[] = {16, 37, 64, 512};
+
+    for (unsigned int tileSize : tileSizes) {
+        RgbImage tiledImage(CANVAS_WIDTH, CANVAS_HEIGHT);
+        PixelPainterForRgbImage pixelPainter(tiledImage);
+        DisplayListPainter displayListPainter(pixelPainter, tiledImage.getSize(), pool, tileSize);
+
+        BlockTextPainter measurePainter(pixelPainter);
+        RecordingTextPainter text(displayListPainter.displayList(), measurePainter, [](PixelPainter &painter) {
+            return std::unique_ptr<uimg::TextPainter>(new BlockTextPainter(painter));
+        });
+
+        drawScene(displayListPainter.linePainter(), displayListPainter.rectPainter(),
+                  displayListPainter.circlePainter(), displayListPainter.ellipsePainter(),
+                  displayListPainter.trianglePainter(), text);
+
+        // nothing is drawn before flush
+        UTEST_ASSERT_FALSE(sameImages(sequentialImage, tiledImage));
+
+        displayListPainter.flush();
+
+        UTEST_ASSERT_TRUE(sameImages(sequentialImage, tiledImage));
+        UTEST_ASSERT_TRUE(displayListPainter.displayList().empty());
+    }
+}
+
+UTEST_FUNC_DEF(TextBounds_ContainGlyphBoundingBoxes) {
+    uimg::BdfFont font;
+    loadOverhangFont(font);
+    const char *texts[] = {",", "j", "W", "?", "jW,j", ",,W"};
+    for (const char *text : texts) {
+        RgbImage image(64, 48);
+        PixelPainterForRgbImage pixelPainter(image);
+        uimg::TextPainterForBdfFont painter(pixelPainter, image.getSize());
+        painter.setFont(&font);
+        painter.drawText(20, 24, text, {255, 255, 255});
+
+        RectInclusive painted = paintedBounds(image);
+        UTEST_ASSERT_TRUE(painted.x1 <= painted.x2);
+        UTEST_ASSERT_TRUE(insideOf(painted, painter.textBounds(20, 24, text)));
+    }
+
+    RgbImage image(64, 48);
+    PixelPainterForRgbImage pixelPainter(image);
+    uimg::TextPainterForBdfFont painter(pixelPainter, image.getSize());
+    painter.setFont(&font);
+    // comma goes 4 rows below base line although text is 1 row high
+    RectInclusive comma = painter.textBounds(20, 24, ",");
+    UTEST_ASSERT_EQUALS(painter.textSize(",").y, 1);
+    UTEST_ASSERT_EQUALS(comma.y1, 23);
+    UTEST_ASSERT_EQUALS(comma.y2, 27);
+    // 'j' starts 2 pixels left of pen
+    UTEST_ASSERT_EQUALS(painter.textBounds(20, 24, "j").x1, 18);
+
+    uimg::TextPainterForBdfFontEx scaled(pixelPainter, image.getSize());
+    scaled.setFont(&font);
+    scaled.setAlignment(uimg::TextAlignment::CENTER);
+    scaled.setScale(2.0f);
+    scaled.drawText(32, 20, "jW,", {255, 255, 255});
+    UTEST_ASSERT_TRUE(insideOf(paintedBounds(image), scaled.textBounds(32, 20, "jW,")));
+}
+
+UTEST_FUNC_DEF(TiledRasterizer_BdfTextCrossingTiles) {
+    uimg::BdfFont font;
+    loadOverhangFont(font);
+    auto makePainter = [&font](PixelPainter &painter, const Point &canvasSize) {
+        std::unique_ptr<uimg::TextPainterForBdfFontEx> result(new uimg::TextPainterForBdfFontEx(painter, canvasSize));
+        result->setFont(&font);
+        result->setAlignment(uimg::TextAlignment::CENTER);
+        return result;
+    };
+    // with tiles of 16 pixels: comma below base line 29 reaches into tile row at 32, centered text at 34 starts
+    // in tile column at 16
+    auto drawTexts = [](uimg::TextPainter &text) {
+        text.drawText(10, 29, ",", {255, 0, 0});
+        text.drawText(34, 12, "jW", {0, 255, 0});
+        text.drawText(50, 45, "j,W", {0, 0, 255});
+    };
+
+    RgbImage sequentialImage(96, 64);
+    {
+        PixelPainterForRgbImage pixelPainter(sequentialImage);
+        drawTexts(*makePainter(pixelPainter, sequentialImage.getSize()));
+    }
+
+    ThreadPool pool(4);
+    RgbImage tiledImage(96, 64);
+    PixelPainterForRgbImage pixelPainter(tiledImage);
+    DisplayListPainter displayListPainter(pixelPainter, tiledImage.getSize(), pool, 16);
+    Point canvasSize = tiledImage.getSize();
+    auto measurePainter = makePainter(pixelPainter, canvasSize);
+    RecordingTextPainter text(displayListPainter.displayList(), *measurePainter,
+                              [makePainter, canvasSize](PixelPainter &painter) {
+                                  return std::unique_ptr<uimg::TextPainter>(makePainter(painter, canvasSize));
+                              });
+    drawTexts(text);
+    displayListPainter.flush();
+
+    UTEST_ASSERT_TRUE(sameImages(sequentialImage, tiledImage));
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(ThreadPool_RunsAllTasks);
+    UTEST_FUNC(ThreadPool_RethrowsTaskError);
+    UTEST_FUNC(ThreadPool_SubmitFromSeveralThreads);
+    UTEST_FUNC(DisplayList_RecordsCommands);
+    UTEST_FUNC(TiledRasterizer_MatchesSequentialOutput);
+    UTEST_FUNC(TextBounds_ContainGlyphBoundingBoxes);
+    UTEST_FUNC(TiledRasterizer_BdfTextCrossingTiles);
+
+    UTEST_EPILOG();
+}
@@ -0,0 +1,264 @@
+#include "utest/utest.h"
+#include "uimg/base/structs.h"
+#include "uimg/images/rgb_image.h"
+#include "uimg/painters/painter_for_pixels.h"
+#include "uimg/painters/painter_for_rgb_image.h"
+#include "uimg/painters/painter_for_sink.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file test_triangle_mesh.cpp
+ * @brief Tests for block-based half-space triangle rasterization and indexed triangle meshes
+ */
+
+namespace {
+
+const RgbColor RED = {255, 0, 0};
+
+// sink which counts how many times each pixel was painted and remembers the last color
+class CountingSink {
+public:
+    CountingSink(int width, int height) : width_(width), height_(height),
+                                          counts_(static_cast<size_t>(width * height), 0),
+                                          colors_(static_cast<size_t>(width * height), RgbColor{0, 0, 0}) {}
+
+    void putPixel(unsigned int x, unsigned int y, const RgbColor &color) {
+        if (static_cast<int>(x) >= width_ || static_cast<int>(y) >= height_) {
+            ++outside_;
+            return;
+        }
+        ++counts_[y * static_cast<size_t>(width_) + x];
+        colors_[y * static_cast<size_t>(width_) + x] = color;
+    }
+
+    void fillSpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor &color) {
+        ++spans_;
+        for (unsigned int i = 0; i < length; ++i)
+            putPixel(x + i, y, color);
+    }
+
+    void copySpan(unsigned int x, unsigned int y, unsigned int length, const RgbColor *colors) {
+        ++spans_;
+        for (unsigned int i = 0; i < length; ++i)
+            putPixel(x + i, y, colors[i]);
+    }
+
+    int at(int x, int y) const {
+        return counts_[static_cast<size_t>(y * width_ + x)];
+    }
+
+    const RgbColor &colorAt(int x, int y) const {
+        return colors_[static_cast<size_t>(y * width_ + x)];
+    }
+
+    int total() const {
+        int result = 0;
+        for (int count : counts_)
+            result += count;
+        return result;
+    }
+
+    int maxCount() const {
+        int result = 0;
+        for (int count : counts_)
+            result = std::max(result, count);
+        return result;
+    }
+
+    int outside() const {
+        return outside_;
+    }
+
+    int spans() const {
+        return spans_;
+    }
+
+private:
+    int width_;
+    int height_;
+    std::vector<int> counts_;
+    std::vector<RgbColor> colors_;
+    int outside_ = 0;
+    int spans_ = 0;
+};
+
+double edgeFunction(const PointF &a, const PointF &b, double x, double y) {
+    return (static_cast<double>(b.x) - a.x) * (y - a.y) - (static_cast<double>(b.y) - a.y) * (x - a.x);
+}
+
+// pseudo-random coordinate in [0, range) with 1/256 resolution
+float randomCoordinate(unsigned int &state, int range) {
+    state = state * 1103515245u + 12345u;
+    return static_cast<float>((state >> 8) % static_cast<unsigned int>(range * 256)) / 256.0f;
+}
+
+} // namespace
+
+UTEST_FUNC_DEF(Triangle_LegacyFillInAnyOrder) {
+    // inclusive edges with pixel (x, y) at point (x, y), as before
+    Point a(3, 2), b(25, 9), c(8, 28);
+    CountingSink forward(32, 32), backward(32, 32);
+    TrianglePainterForSink<CountingSink>(forward).drawFull(a, c, b, RED);
+    TrianglePainterForSink<CountingSink>(backward).drawFull(a, b, c, RED);
+
+    PointF fa(3, 2), fb(25, 9), fc(8, 28);
+    bool exact = true;
+    for (int y = 0; y < 32; ++y)
+        for (int x = 0; x < 32; ++x) {
+            bool inside = edgeFunction(fa, fb, x, y) >= 0 && edgeFunction(fb, fc, x, y) >= 0 && edgeFunction(fc, fa, x, y) >= 0;
+            exact = exact && forward.at(x, y) == (inside ? 1 : 0) && backward.at(x, y) == forward.at(x, y);
+        }
+    UTEST_ASSERT_TRUE(exact);
+    UTEST_ASSERT_EQUALS(forward.at(3, 2), 1);
+    UTEST_ASSERT_EQUALS(forward.spans(), 27);
+}
+
+UTEST_FUNC_DEF(Triangle_PixelCentersInsideAreFilled) {
+    unsigned int state = 7;
+    int mismatches = 0;
+    for (int k = 0; k < 200; ++k) {
+        PointF t[3] = {PointF(randomCoordinate(state, 40) - 4, randomCoordinate(state, 40) - 4),
+                       PointF(randomCoordinate(state, 40) - 4, randomCoordinate(state, 40) - 4),
+                       PointF(randomCoordinate(state, 40) - 4, randomCoordinate(state, 40) - 4)};
+        if (k % 4 == 0) // sliver
+            t[2] = PointF(std::round((t[0].x + t[1].x) * 128.0f) / 256.0f + 0.75f, std::round((t[0].y + t[1].y) * 128.0f) / 256.0f);
+        CountingSink sink(32, 32);
+        TriangleMeshPainterForSink<CountingSink>(sink, Point(32, 32)).drawTriangle(t[0], t[1], t[2], RED);
+        UTEST_ASSERT_EQUALS(sink.outside(), 0);
+
+        double orientation = edgeFunction(t[0], t[1], t[2].x, t[2].y) > 0 ? 1 : -1;
+        for (int y = 0; y < 32; ++y)
+            for (int x = 0; x < 32; ++x) {
+                double e[3];
+                for (int i = 0; i < 3; ++i)
+                    e[i] = orientation * edgeFunction(t[i], t[(i + 1) % 3], x + 0.5, y + 0.5);
+                // samples on edges depend on top-left rule
+                if (std::fabs(e[0]) < 1e-6 || std::fabs(e[1]) < 1e-6 || std::fabs(e[2]) < 1e-6)
+                    continue;
+                bool inside = e[0] > 0 && e[1] > 0 && e[2] > 0;
+                if (sink.at(x, y) != (inside ? 1 : 0))
+                    ++mismatches;
+            }
+    }
+    UTEST_ASSERT_EQUALS(mismatches, 0);
+}
+
+UTEST_FUNC_DEF(Triangle_MeshCoversSharedEdgesOnce) {
+    // grid of 8x6 cells over [4, 60] x [4, 46], inner vertices moved by fractions of pixel, some onto pixel centers
+    const int columns = 8, rows = 6;
+    std::vector<PointF> vertices;
+    unsigned int state = 11;
+    for (int j = 0; j <= rows; ++j)
+        for (int i = 0; i <= columns; ++i) {
+            float x = 4.0f + 7.0f * static_cast<float>(i), y = 4.0f + 7.0f * static_cast<float>(j);
+            if (i > 0 && i < columns && j > 0 && j < rows) {
+                x += (i + j) % 3 == 0 ? 0.5f : randomCoordinate(state, 4) - 2.0f;
+                y += (i + j) % 3 == 0 ? 0.5f : randomCoordinate(state, 4) - 2.0f;
+            }
+            vertices.push_back(PointF(x, y));
+        }
+    std::vector<unsigned int> indices;
+    for (int j = 0; j < rows; ++j)
+        for (int i = 0; i < columns; ++i) {
+            unsigned int v = static_cast<unsigned int>(j * (columns + 1) + i);
+            unsigned int right = v + 1, down = v + columns + 1, diagonal = down + 1;
+            // alternate diagonals and winding of triangles
+            if ((i + j) % 2 == 0)
+                indices.insert(indices.end(), {v, right, diagonal, v, diagonal, down});
+            else
+                indices.insert(indices.end(), {v, down, right, right, down, diagonal});
+        }
+
+    CountingSink sink(64, 50);
+    TriangleMeshPainterForSink<CountingSink>(sink).drawMesh(vertices, indices, RED);
+    UTEST_ASSERT_EQUALS(sink.maxCount(), 1);
+    UTEST_ASSERT_EQUALS(sink.total(), 56 * 42);
+    UTEST_ASSERT_EQUALS(sink.at(4, 4), 1);
+    UTEST_ASSERT_EQUALS(sink.at(59, 45), 1);
+    UTEST_ASSERT_EQUALS(sink.at(60, 45), 0);
+}
+
+UTEST_FUNC_DEF(Triangle_MeshInterpolatesVertexColors) {
+    std::vector<PointF> vertices = {PointF(0, 0), PointF(64, 0), PointF(0, 64), PointF(64, 64)};
+    std::vector<RgbColor> colors = {{0, 0, 0}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0}};
+    std::vector<unsigned int> indices = {0, 1, 2, 1, 3, 2};
+    CountingSink sink(64, 64);
+    TriangleMeshPainterForSink<CountingSink>(sink).drawMesh(vertices, colors, indices);
+
+    UTEST_ASSERT_EQUALS(sink.total(), 64 * 64);
+    // red follows x and green follows y, sampled at pixel centers
+    bool linear = true;
+    for (int y = 0; y < 64; y += 7)
+        for (int x = 0; x < 64; x += 5) {
+            int red = static_cast<int>(std::lround((x + 0.5) * 255 / 64)), green = static_cast<int>(std::lround((y + 0.5) * 255 / 64));
+            linear = linear && std::abs(sink.colorAt(x, y).red - red) <= 1 && std::abs(sink.colorAt(x, y).green - green) <= 1 &&
+                     sink.colorAt(x, y).blue == 0;
+        }
+    UTEST_ASSERT_TRUE(linear);
+
+    // same color at all vertices is a flat fill
+    CountingSink flat(16, 16);
+    TriangleMeshPainterForSink<CountingSink>(flat).drawTriangle(PointF(1, 1), PointF(15, 2), PointF(3, 14), RED, RED, RED);
+    UTEST_ASSERT_TRUE(flat.colorAt(5, 5) == RED);
+}
+
+UTEST_FUNC_DEF(Triangle_MeshValidatesIndices) {
+    CountingSink sink(8, 8);
+    TriangleMeshPainterForSink<CountingSink> painter(sink);
+    std::vector<PointF> vertices = {PointF(0, 0), PointF(8, 0), PointF(0, 8)};
+
+    bool thrown = false;
+    try {
+        painter.drawMesh(vertices, {0, 1}, RED);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    thrown = false;
+    try {
+        painter.drawMesh(vertices, {0, 1, 3}, RED);
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+
+    thrown = false;
+    try {
+        painter.drawMesh(vertices, {RED, RED}, {0, 1, 2});
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    UTEST_ASSERT_TRUE(thrown);
+    UTEST_ASSERT_EQUALS(sink.total(), 0);
+}
+
+UTEST_FUNC_DEF(Triangle_MeshPaintsIntoImage) {
+    RgbImage image(16, 16);
+    PixelPainterForRgbImage pixelPainter(image);
+    TriangleMeshPainterForPixels painter(pixelPainter, Point(16, 16));
+    // triangle larger than image, clockwise on screen
+    painter.drawTriangle(PointF(-10, -10), PointF(40, 8), PointF(8, 40), RgbColor{0, 0, 255}, RgbColor{0, 0, 255},
+                         RgbColor{0, 255, 255});
+
+    UTEST_ASSERT_EQUALS(static_cast<int>(image.getPixel(0, 0).blue), 255);
+    UTEST_ASSERT_EQUALS(static_cast<int>(image.getPixel(15, 15).blue), 255);
+    UTEST_ASSERT_TRUE(image.getPixel(15, 15).green > image.getPixel(0, 0).green);
+}
+
+int main() {
+    UTEST_PROLOG();
+
+    UTEST_FUNC(Triangle_LegacyFillInAnyOrder);
+    UTEST_FUNC(Triangle_PixelCentersInsideAreFilled);
+    UTEST_FUNC(Triangle_MeshCoversSharedEdgesOnce);
+    UTEST_FUNC(Triangle_MeshInterpolatesVertexColors);
+    UTEST_FUNC(Triangle_MeshValidatesIndices);
+    UTEST_FUNC(Triangle_MeshPaintsIntoImage);
+
+    UTEST_EPILOG();
+}